@@ -0,0 +1,85 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Benchmark the throughput of global function lookups through the FFI.
+Each thread calls TVMFuncGetGlobal and TVMFuncFree in a loop through
+ctypes, which releases the GIL during the calls, so the threads contend
+on the registry. Optionally another thread keeps registering functions.
+see README.md for the usage of this script.
+"""
+import argparse
+import ctypes
+import threading
+import time
+
+import tvm
+from tvm._ffi.base import _LIB, c_str, check_call
+from tvm._ffi.registry import list_global_func_names
+
+
+def lookup_loop(names, iterations, barrier, counts, index):
+    handle = ctypes.c_void_p()
+    barrier.wait()
+    for _ in range(iterations):
+        for name in names:
+            check_call(_LIB.TVMFuncGetGlobal(name, ctypes.byref(handle)))
+            check_call(_LIB.TVMFuncFree(handle))
+    counts[index] = iterations * len(names)
+
+
+def register_loop(stop):
+    i = 0
+    while not stop.is_set():
+        tvm.register_func("benchmark.registry.%d" % i, lambda: None)
+        i += 1
+
+
+def measure(num_threads, names, iterations, with_writer):
+    barrier = threading.Barrier(num_threads + 1)
+    counts = [0] * num_threads
+    threads = [
+        threading.Thread(target=lookup_loop, args=(names, iterations, barrier, counts, i))
+        for i in range(num_threads)
+    ]
+    for thread in threads:
+        thread.start()
+    stop = threading.Event()
+    writer = threading.Thread(target=register_loop, args=(stop,)) if with_writer else None
+    if writer:
+        writer.start()
+    barrier.wait()
+    start = time.perf_counter()
+    for thread in threads:
+        thread.join()
+    elapsed = time.perf_counter() - start
+    if writer:
+        stop.set()
+        writer.join()
+    return sum(counts) / elapsed
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--threads", type=str, default="1,2,4,8", help="thread counts")
+    parser.add_argument("--iterations", type=int, default=20000)
+    parser.add_argument("--with-writer", action="store_true", help="register functions meanwhile")
+    args = parser.parse_args()
+
+    names = [c_str(name) for name in sorted(list_global_func_names())[:16]]
+    print("%-8s %16s" % ("threads", "lookups (M/s)"))
+    for num_threads in [int(x) for x in args.threads.split(",")]:
+        rate = measure(num_threads, names, args.iterations, args.with_writer)
+        print("%-8d %16.2f" % (num_threads, rate / 1e6))
@@ -0,0 +1,83 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Benchmark the tensor transfer throughput of the RPC protocol.
+A local RPC server is started on the loopback interface and tensors are
+uploaded to and downloaded from it as a single packet, in chunks, and in
+compressed chunks. Random tensors show the cost of the compression while
+sparse tensors show its benefit.
+see README.md for the usage of this script.
+"""
+import argparse
+import time
+
+import numpy as np
+
+import tvm
+from tvm import rpc
+
+
+def make_tensor(kind, size_mb):
+    num = size_mb * (1 << 20) // 4
+    if kind == "random":
+        return np.random.uniform(size=num).astype("float32")
+    data = np.zeros(num, dtype="float32")
+    data[::97] = np.random.uniform(size=data[::97].shape)
+    return data
+
+
+def measure(remote, data, repeat):
+    dev = remote.cpu()
+    remote_arr = tvm.nd.empty(data.shape, data.dtype, dev)
+    local_arr = tvm.nd.array(data)
+    remote_arr.copyfrom(local_arr)
+    start = time.perf_counter()
+    for _ in range(repeat):
+        remote_arr.copyfrom(local_arr)
+    upload = (time.perf_counter() - start) / repeat
+    start = time.perf_counter()
+    for _ in range(repeat):
+        result = remote_arr.numpy()
+    download = (time.perf_counter() - start) / repeat
+    np.testing.assert_equal(result, data)
+    return upload, download
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--size-mb", type=int, default=64, help="tensor size in MiB")
+    parser.add_argument("--chunk-kb", type=int, default=1024, help="chunk size in KiB")
+    parser.add_argument("--repeat", type=int, default=10)
+    args = parser.parse_args()
+
+    server = rpc.Server(host="127.0.0.1")
+    remote = rpc.connect("127.0.0.1", server.port)
+    modes = [
+        ("single packet", 0, False),
+        ("chunked", args.chunk_kb << 10, False),
+        ("chunked+lz", args.chunk_kb << 10, True),
+    ]
+    print("%-8s %-14s %12s %12s" % ("tensor", "mode", "up (MB/s)", "down (MB/s)"))
+    for kind in ["random", "sparse"]:
+        data = make_tensor(kind, args.size_mb)
+        for name, chunk_bytes, compress in modes:
+            remote.set_transfer_options(chunk_bytes, compress)
+            upload, download = measure(remote, data, args.repeat)
+            print(
+                "%-8s %-14s %12.1f %12.1f"
+                % (kind, name, args.size_mb / upload, args.size_mb / download)
+            )
+    server.terminate()
@@ -0,0 +1,100 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Benchmark the tail latency of the CPU thread pool under co-located load.
+A few busy processes are pinned to some of the cores used by the thread pool
+to emulate noisy neighbours, then the same parallel dense operator is measured
+with the static schedule and with work stealing.
+see README.md for the usage of this script.
+"""
+import argparse
+import multiprocessing
+import os
+import time
+
+import numpy as np
+
+import tvm
+from tvm import te
+
+
+def busy_loop(cpu):
+    if hasattr(os, "sched_setaffinity"):
+        os.sched_setaffinity(0, [cpu])
+    while True:
+        pass
+
+
+def build_dense(n):
+    A = te.placeholder((n, n), name="A")
+    B = te.placeholder((n, n), name="B")
+    k = te.reduce_axis((0, n), name="k")
+    C = te.compute((n, n), lambda i, j: te.sum(A[i, k] * B[j, k], axis=k), name="C")
+    s = te.create_schedule(C.op)
+    s[C].parallel(C.op.axis[0])
+    return tvm.build(s, [A, B, C], target="llvm")
+
+
+def measure(func, args, repeat):
+    func(*args)
+    costs = []
+    for _ in range(repeat):
+        start = time.perf_counter()
+        func(*args)
+        costs.append((time.perf_counter() - start) * 1000)
+    return np.array(costs)
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--size", type=int, default=256, help="size of the dense operator")
+    parser.add_argument("--repeat", type=int, default=1000)
+    parser.add_argument("--noisy-cores", type=int, default=1, help="number of busy cores")
+    parser.add_argument("--granularity", type=int, default=4, help="tasks per worker")
+    args = parser.parse_args()
+
+    dev = tvm.cpu()
+    func = build_dense(args.size)
+    data = [
+        tvm.nd.array(np.random.uniform(size=(args.size, args.size)).astype("float32"), dev)
+        for _ in range(3)
+    ]
+    config_work_stealing = tvm.get_global_func("runtime.config_threadpool_work_stealing")
+
+    noise = [
+        multiprocessing.Process(target=busy_loop, args=(cpu,), daemon=True)
+        for cpu in range(args.noisy_cores)
+    ]
+    for proc in noise:
+        proc.start()
+
+    print("%-16s %-10s %-10s %-10s" % ("schedule", "p50", "p99", "max"))
+    for name, granularity in [("static", 0), ("work-stealing", args.granularity)]:
+        config_work_stealing(granularity)
+        res = measure(func, data, args.repeat)
+        print(
+            "%-16s %-10s %-10s %-10s"
+            % (
+                name,
+                "%.3f ms" % np.percentile(res, 50),
+                "%.3f ms" % np.percentile(res, 99),
+                "%.3f ms" % np.max(res),
+            )
+        )
+    config_work_stealing(0)
+
+    for proc in noise:
+        proc.terminate()
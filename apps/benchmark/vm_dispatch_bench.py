@@ -0,0 +1,87 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Benchmark the instruction dispatch cost of the Relay VM.
+A while loop over tiny tensors keeps the kernels negligible, so the time per
+iteration is dominated by the interpreter. The loop runs for two trip counts and
+the difference is divided by the number of iterations and by the number of
+instructions of the loop function.
+see README.md for the usage of this script.
+"""
+import argparse
+import re
+import time
+
+import numpy as np
+
+import tvm
+from tvm import relay
+from tvm.relay.loops import while_loop
+
+
+def build_loop(target):
+    n = relay.var("n", shape=(), dtype="int32")
+    x = relay.var("x", shape=(1,), dtype="float32")
+    i = relay.var("i", shape=(), dtype="int32")
+    acc = relay.var("acc", shape=(1,), dtype="float32")
+    loop = while_loop(
+        lambda i, acc: relay.less(i, n),
+        [i, acc],
+        lambda i, acc: [relay.add(i, relay.const(1)), relay.nn.relu(relay.add(acc, x))],
+    )
+    result = loop(relay.const(0), relay.zeros_like(x))
+    mod = tvm.IRModule.from_expr(relay.Function([n, x], relay.TupleGetItem(result, 1)))
+    with tvm.transform.PassContext(opt_level=3):
+        return relay.vm.compile(mod, target)
+
+
+def loop_instruction_count(exe):
+    """The number of instructions of the largest function other than main."""
+    counts = []
+    for func in exe.bytecode.split("VM Function[")[1:]:
+        name = func.split(":", 1)[1].split("(", 1)[0].strip()
+        if name != "main":
+            counts.append(int(re.search(r"# instruction count = (\d+)", func).group(1)))
+    return max(counts)
+
+
+def measure(vm, trips, x, repeat):
+    n = tvm.nd.array(np.array(trips, dtype="int32"))
+    vm.invoke("main", n, x)
+    start = time.perf_counter()
+    for _ in range(repeat):
+        vm.invoke("main", n, x)
+    return (time.perf_counter() - start) / repeat
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--iterations", type=int, default=10000, help="loop trip count")
+    parser.add_argument("--repeat", type=int, default=20)
+    args = parser.parse_args()
+
+    dev = tvm.cpu()
+    exe = build_loop("llvm")
+    vm = tvm.runtime.vm.VirtualMachine(exe, dev)
+    x = tvm.nd.array(np.ones((1,), dtype="float32"), dev)
+
+    base = measure(vm, 1, x, args.repeat)
+    total = measure(vm, args.iterations + 1, x, args.repeat)
+    per_iter = (total - base) / args.iterations * 1e9
+    num_instrs = loop_instruction_count(exe)
+    print("instructions per iteration: %d" % num_instrs)
+    print("time per iteration:         %.1f ns" % per_iter)
+    print("time per instruction:       %.1f ns" % (per_iter / num_instrs))
@@ -296,6 +296,9 @@ set(USE_PT_TVMDSOOP OFF)
 # Whether to use STL's std::unordered_map or TVM's POD compatible Map
 set(USE_FALLBACK_STL_MAP OFF)
 
+# Whether make_object allocates from thread-caching size-class pools instead of new/delete
+set(USE_OBJECT_POOL OFF)
+
 # Whether to use hexagon device
 set(USE_HEXAGON_DEVICE OFF)
 set(USE_HEXAGON_SDK /path/to/sdk)
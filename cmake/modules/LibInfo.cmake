@@ -62,6 +62,7 @@ function(add_lib_info src_file)
     TVM_INFO_USE_TF_TVMDSOOP="${USE_TF_TVMDSOOP}"
     TVM_INFO_USE_PT_TVMDSOOP="${USE_PT_TVMDSOOP}"
     TVM_INFO_USE_FALLBACK_STL_MAP="${USE_FALLBACK_STL_MAP}"
+    TVM_INFO_USE_OBJECT_POOL="${USE_OBJECT_POOL}"
     TVM_INFO_USE_BYODT_POSIT="${USE_BYODT_POSIT}"
     TVM_INFO_USE_BLAS="${USE_BLAS}"
     TVM_INFO_USE_MKL="${USE_MKL}"
@@ -20,6 +20,7 @@
 #ifndef TVM_META_SCHEDULE_COST_MODEL_H_
 #define TVM_META_SCHEDULE_COST_MODEL_H_
 
+#include <tvm/meta_schedule/feature_extractor.h>
 #include <tvm/meta_schedule/search_strategy.h>
 
 #include <vector>
@@ -173,6 +174,30 @@ class CostModel : public runtime::ObjectRef {
                                        PyCostModelNode::FUpdate f_update,    //
                                        PyCostModelNode::FPredict f_predict,  //
                                        PyCostModelNode::FAsString f_as_string);
+  /*!
+   * \brief Create a gradient boosted tree cost model trained and evaluated natively, with the
+   *  same objective as the python XGBModel: the score of a candidate is the sum of the scores of
+   *  its stores, fitted to the normalized throughput of the measured candidates.
+   * \param extractor The feature extractor.
+   * \param max_depth The maximum depth of a tree.
+   * \param num_bins The number of histogram bins per feature, at most 256.
+   * \param learning_rate The shrinkage applied to each tree.
+   * \param min_child_weight The minimum sum of hessians in a child.
+   * \param reg_lambda The L2 regularization on the leaf values.
+   * \param gamma The minimum loss reduction of a split.
+   * \param max_rounds The maximum number of boosting rounds.
+   * \param early_stopping_rounds Stop boosting when the training loss did not improve for this
+   *  many rounds.
+   * \param num_warmup_samples The number of measured samples before the model predicts, random
+   *  scores are returned before that.
+   * \param seed The seed of the random scores.
+   * \return The cost model created.
+   */
+  TVM_DLL static CostModel GBDTModel(FeatureExtractor extractor, int max_depth, int num_bins,
+                                     double learning_rate, double min_child_weight,
+                                     double reg_lambda, double gamma, int max_rounds,
+                                     int early_stopping_rounds, int num_warmup_samples,
+                                     int64_t seed);
   TVM_DEFINE_MUTABLE_OBJECT_REF_METHODS(CostModel, ObjectRef, CostModelNode);
 };
 
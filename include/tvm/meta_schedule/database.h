@@ -288,6 +288,16 @@ class Database : public runtime::ObjectRef {
    */
   TVM_DLL static Database JSONDatabase(String path_workload, String path_tuning_record,
                                        bool allow_missing);
+  /*!
+   * \brief Create a database that stores the tuning records in append-only binary segments and
+   * indexes the records of each workload by running time. It is safe to share between processes,
+   * which see the records committed by each other.
+   * \param path The path of the file naming the live segments, which are stored next to it.
+   * \param allow_missing Whether to create a new database when the given path is not found.
+   * \param max_segment_bytes The size after which the records are appended to a new segment.
+   */
+  TVM_DLL static Database IndexedDatabase(String path, bool allow_missing,
+                                          int64_t max_segment_bytes);
   /*!
    * \brief Create a database with customized methods on the python-side.
    * \param f_has_workload The packed function of `HasWorkload`.
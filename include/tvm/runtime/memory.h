@@ -25,10 +25,19 @@
 
 #include <tvm/runtime/object.h>
 
+#include <cstddef>
 #include <cstdlib>
 #include <type_traits>
 #include <utility>
 
+#ifndef TVM_OBJECT_POOL_ALLOCATOR
+/*!
+ * \brief Whether make_object allocates from the thread-caching pools of PoolObjAllocator,
+ *  set by the USE_OBJECT_POOL build option.
+ */
+#define TVM_OBJECT_POOL_ALLOCATOR 0
+#endif
+
 namespace tvm {
 namespace runtime {
 /*!
@@ -47,7 +56,6 @@ inline ObjectPtr<T> make_object(Args&&... args);
 //
 // Possible future allocator optimizations:
 // - Arena allocator that gives ownership of memory to arena (deleter_= nullptr)
-// - Thread-local object pools: one pool per size and alignment requirement.
 // - Can specialize by type of object to give the specific allocator to each object.
 
 /*!
@@ -191,15 +199,106 @@ class SimpleObjAllocator : public ObjAllocatorBase<SimpleObjAllocator> {
   };
 };
 
+namespace detail {
+/*!
+ * \brief Allocate memory from the thread-caching object pools.
+ * \param size The number of bytes, the memory is aligned to alignof(std::max_align_t).
+ * \param type_index The type index of the object, to count the allocations of each type.
+ * \return The memory.
+ */
+TVM_DLL void* ObjectPoolAlloc(size_t size, uint32_t type_index);
+/*!
+ * \brief Free memory allocated by ObjectPoolAlloc, possibly from another thread.
+ * \param ptr The memory.
+ * \param size The number of bytes passed to ObjectPoolAlloc.
+ * \param type_index The type index passed to ObjectPoolAlloc.
+ */
+TVM_DLL void ObjectPoolFree(void* ptr, size_t size, uint32_t type_index);
+}  // namespace detail
+
+/*!
+ * \brief Allocator that takes objects from size-class pools with a cache per thread.
+ *
+ *  Small objects reuse the blocks of freed objects of the same size class without going through
+ *  the global heap, and the number of allocations and frees of each type is counted, see the
+ *  global function runtime.ObjectAllocatorStats. make_object uses it when TVM is built with
+ *  USE_OBJECT_POOL. Objects record their deleter, so they can be mixed with objects of other
+ *  allocators.
+ */
+class PoolObjAllocator : public ObjAllocatorBase<PoolObjAllocator> {
+ public:
+  template <typename T>
+  class Handler {
+   public:
+    static_assert(alignof(T) <= alignof(std::max_align_t), "over-aligned object");
+
+    template <typename... Args>
+    static T* New(PoolObjAllocator*, Args&&... args) {
+      void* data = detail::ObjectPoolAlloc(sizeof(T), T::RuntimeTypeIndex());
+      new (data) T(std::forward<Args>(args)...);
+      return reinterpret_cast<T*>(data);
+    }
+
+    static Object::FDeleter Deleter() { return Deleter_; }
+
+   private:
+    static void Deleter_(Object* objptr) {
+      // See SimpleObjAllocator::Handler for why to cast back to T* and call T::~T.
+      T* tptr = static_cast<T*>(objptr);
+      tptr->T::~T();
+      detail::ObjectPoolFree(tptr, sizeof(T), T::RuntimeTypeIndex());
+    }
+  };
+
+  // Array handler that keeps the size of the allocation in front of the array.
+  template <typename ArrayType, typename ElemType>
+  class ArrayHandler {
+   public:
+    static_assert(alignof(ArrayType) <= alignof(std::max_align_t), "over-aligned object");
+    static_assert(alignof(ArrayType) % alignof(ElemType) == 0 &&
+                      sizeof(ArrayType) % alignof(ElemType) == 0,
+                  "element alignment constraint");
+
+    template <typename... Args>
+    static ArrayType* New(PoolObjAllocator*, size_t num_elems, Args&&... args) {
+      size_t size = kPrefix + sizeof(ArrayType) + num_elems * sizeof(ElemType);
+      char* data = static_cast<char*>(detail::ObjectPoolAlloc(size, ArrayType::RuntimeTypeIndex()));
+      *reinterpret_cast<size_t*>(data) = size;
+      new (data + kPrefix) ArrayType(std::forward<Args>(args)...);
+      return reinterpret_cast<ArrayType*>(data + kPrefix);
+    }
+
+    static Object::FDeleter Deleter() { return Deleter_; }
+
+   private:
+    static constexpr size_t kPrefix = alignof(std::max_align_t);
+
+    static void Deleter_(Object* objptr) {
+      ArrayType* tptr = static_cast<ArrayType*>(objptr);
+      tptr->ArrayType::~ArrayType();
+      char* data = reinterpret_cast<char*>(tptr) - kPrefix;
+      detail::ObjectPoolFree(data, *reinterpret_cast<size_t*>(data),
+                             ArrayType::RuntimeTypeIndex());
+    }
+  };
+};
+
+/*! \brief The allocator of make_object, chosen at build time. */
+#if TVM_OBJECT_POOL_ALLOCATOR
+using DefaultObjAllocator = PoolObjAllocator;
+#else
+using DefaultObjAllocator = SimpleObjAllocator;
+#endif
+
 template <typename T, typename... Args>
 inline ObjectPtr<T> make_object(Args&&... args) {
-  return SimpleObjAllocator().make_object<T>(std::forward<Args>(args)...);
+  return DefaultObjAllocator().make_object<T>(std::forward<Args>(args)...);
 }
 
 template <typename ArrayType, typename ElemType, typename... Args>
 inline ObjectPtr<ArrayType> make_inplace_array_object(size_t num_elems, Args&&... args) {
-  return SimpleObjAllocator().make_inplace_array<ArrayType, ElemType>(num_elems,
-                                                                      std::forward<Args>(args)...);
+  return DefaultObjAllocator().make_inplace_array<ArrayType, ElemType>(
+      num_elems, std::forward<Args>(args)...);
 }
 
 }  // namespace runtime
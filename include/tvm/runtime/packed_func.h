@@ -74,6 +74,17 @@ class PackedFuncObj : public Object {
    */
   TVM_ALWAYS_INLINE void CallPacked(TVMArgs args, TVMRetValue* rv) const;
 
+  /*!
+   * \brief Get the callable object wrapped by the function, if it has the given type.
+   *
+   *  This lets a caller which knows how a function was created bypass the type-erased call.
+   *
+   * \tparam TCallable The type of the callable object.
+   * \return pointer to the callable object, nullptr if the function wraps another type.
+   */
+  template <typename TCallable>
+  inline const TCallable* GetCallable() const;
+
   static constexpr const uint32_t _type_index = TypeIndex::kRuntimePackedFunc;
   static constexpr const char* _type_key = "runtime.PackedFunc";
   TVM_DECLARE_FINAL_OBJECT_INFO(PackedFuncObj, Object);
@@ -1217,6 +1228,13 @@ TVM_ALWAYS_INLINE void PackedFuncObj::CallPacked(TVMArgs args, TVMRetValue* rv)
   (*f_call_packed_)(this, args, rv);
 }
 
+template <typename TCallable>
+inline const TCallable* PackedFuncObj::GetCallable() const {
+  using TSubObj = PackedFuncSubObj<TCallable>;
+  if (f_call_packed_ != Extractor<TSubObj>::Call) return nullptr;
+  return &(static_cast<const TSubObj*>(this)->callable_);
+}
+
 TVM_ALWAYS_INLINE void PackedFunc::CallPacked(TVMArgs args, TVMRetValue* rv) const {
   (static_cast<PackedFuncObj*>(data_.get()))->CallPacked(args, rv);
 }
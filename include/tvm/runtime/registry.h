@@ -45,6 +45,7 @@
 
 #include <tvm/runtime/packed_func.h>
 
+#include <atomic>
 #include <string>
 #include <type_traits>
 #include <utility>
@@ -309,6 +310,14 @@ class Registry {
    *   nullptr if it does not exist.
    */
   TVM_DLL static const PackedFunc* Get(const std::string& name);  // NOLINT(*)
+  /*!
+   * \brief Get the global function by name.
+   * \param name The name of the function.
+   * \param size The length of the name.
+   * \return pointer to the registered function,
+   *   nullptr if it does not exist.
+   */
+  TVM_DLL static const PackedFunc* Get(const char* name, size_t size);
   /*!
    * \brief Get the names of currently registered global function.
    * \return The names
@@ -318,6 +327,49 @@ class Registry {
   // Internal class.
   struct Manager;
 
+  /*!
+   * \brief The interned name of a global function.
+   *
+   *  A handle stays valid until program exit and follows registrations, overrides and removals
+   *  of the name, so a lookup through it is a single pointer load.
+   *
+   * \code
+   *   static const Registry::Handle* fdebug = Registry::Intern("relay.debug");
+   *   if (const PackedFunc* f = fdebug->Get()) (*f)(...);
+   * \endcode
+   */
+  class Handle {
+   public:
+    /*!
+     * \brief Get the function currently registered under the name.
+     * \return pointer to the registered function, nullptr if it does not exist.
+     */
+    const PackedFunc* Get() const {
+      Registry* reg = registry_.load(std::memory_order_acquire);
+      return reg != nullptr ? &reg->func_ : nullptr;
+    }
+    /*! \return The name of the function. */
+    const std::string& name() const { return name_; }
+
+   private:
+    Handle(std::string name, uint64_t hash) : name_(std::move(name)), hash_(hash) {}
+
+    /*! \brief The name of the function. */
+    std::string name_;
+    /*! \brief The hash of the name. */
+    uint64_t hash_;
+    /*! \brief The registered function, nullptr if there is none. */
+    std::atomic<Registry*> registry_{nullptr};
+    friend class Registry;
+    friend struct Manager;
+  };
+  /*!
+   * \brief Intern the name of a global function, which need not be registered yet.
+   * \param name The name of the function.
+   * \return The handle of the name.
+   */
+  TVM_DLL static const Handle* Intern(const std::string& name);
+
  protected:
   /*! \brief name of the function */
   std::string name_;
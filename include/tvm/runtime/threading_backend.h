@@ -140,6 +140,32 @@ void ResetThreadPool();
 void Configure(tvm::runtime::threading::ThreadGroup::AffinityMode mode, int nthreads,
                std::vector<unsigned int> cpus);
 
+/*!
+ * \brief Configuring work stealing for the parallel launches of the thread pool.
+ *
+ *  When enabled, a launch which lets the pool choose the number of tasks is split
+ *  into `granularity` tasks per worker, and idle workers steal pending tasks from
+ *  the slower ones. The default is read from the TVM_THREAD_POOL_WORK_STEALING
+ *  environment variable. Note that this does nothing when openmp is used.
+ *
+ * \param granularity The number of tasks per worker, 0 disables work stealing.
+ */
+void ConfigureWorkStealing(int granularity);
+
+/*!
+ * \brief Configuring whether the parallel launches of all the threads are multiplexed
+ *  on one thread pool shared by the process.
+ *
+ *  By default every launching thread owns a thread pool, which oversubscribes cores
+ *  when several threads launch concurrently, and a launch nested in a parallel task
+ *  runs serially. The shared thread pool serves concurrent and nested launches with
+ *  the same workers. The default is read from the TVM_THREAD_POOL_SHARED environment
+ *  variable. Note that this does nothing when openmp is used.
+ *
+ * \param enable Whether to use the shared thread pool.
+ */
+void ConfigureSharedThreadPool(bool enable);
+
 }  // namespace threading
 }  // namespace runtime
 }  // namespace tvm
@@ -203,6 +203,11 @@ struct Instruction {
       DLDataType dtype_hint;
       /*! \brief The index of the device on which the allocation will be made. */
       Index device_index;
+      /*!
+       * \brief The offset of the storage in the statically planned arena of the function,
+       *  or -1 if the storage is allocated dynamically.
+       */
+      Index arena_offset;
     } alloc_storage;
     struct /* ShapeOf Operands */ {
       RegName tensor;
@@ -32,6 +32,7 @@
 #include <tvm/runtime/vm/bytecode.h>
 
 #include <map>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -136,6 +137,9 @@ class Executable : public ModuleNode {
 
   /*!
    * \brief As for \p LoadLateBoundConstantsFromStream, but load from file at \p path.
+   *
+   * Files written by \p MoveLateBoundConstantsToFile are memory mapped, and the constants alias
+   * the mapping instead of being copied.
    */
   void LoadLateBoundConstantsFromFile(const std::string& path);
 
@@ -240,7 +244,32 @@ class Executable : public ModuleNode {
    */
   std::string GetFunctionParameterName(std::string func, uint32_t index) const;
 
-  virtual ~Executable() {}
+  /*!
+   * \brief Get a constant of the executable.
+   *
+   * The immediate constants of a loaded executable stay serialized in the code section until they
+   * are first requested, so constants only used by branches which never run are never decoded.
+   * This method is thread safe.
+   *
+   * \param const_index The index of the constant.
+   * \return The constant.
+   */
+  const ObjectRef& GetConstant(Index const_index) const;
+
+  /*!
+   * \brief Start decoding the pending constants on a background thread, in the order in which
+   * the functions load them, starting with "main". Constants requested by \p GetConstant while
+   * the prefetch runs are decoded by the requesting thread if the prefetch has not reached them.
+   */
+  void PrefetchConstants();
+
+  /*! \brief The number of constants decoded from the code section so far. */
+  int64_t NumDecodedConstants() const;
+
+  /*! \brief The time spent decoding constants from the code section so far, in microseconds. */
+  double ConstantDecodeTime() const;
+
+  virtual ~Executable();
 
   const char* type_key() const final { return "VMExecutable"; }
 
@@ -258,7 +287,8 @@ class Executable : public ModuleNode {
    * \brief The global constant array.
    *
    * LoadConst instructions indexes are w.r.t. this vector. Late-bound constants are removed
-   * from this table after saving late-bound constants.
+   * from this table after saving late-bound constants. The immediate constants of a loaded
+   * executable are undefined until decoded, use \p GetConstant to read them.
    */
   std::vector<ObjectRef> constants;
   /*!
@@ -281,6 +311,27 @@ class Executable : public ModuleNode {
   std::vector<Index> const_device_indexes;
 
  private:
+  /*! \brief The immediate constants waiting to be decoded from the code section. */
+  struct LazyConstants;
+
+  /*!
+   * \brief Decode every pending constant into \p constants.
+   */
+  void DecodeConstants();
+
+  /*!
+   * \brief Mark the constants of at least \p byte_limit bytes as late-bound and move them out
+   *  of the executable.
+   * \return The late-bound constants by name.
+   */
+  Map<String, NDArray> MoveLateBoundConstants(size_t byte_limit);
+
+  /*!
+   * \brief Bind the late-bound constants of the executable.
+   * \param map The late-bound constants by name.
+   */
+  void SetLateBoundConstants(Map<String, NDArray> map);
+
   /*!
    * \brief Save the virtual devices
    *
@@ -303,11 +354,12 @@ class Executable : public ModuleNode {
   void SaveConstantSection(dmlc::Stream* stream);
 
   /*!
-   * \brief Load the constant pool.
+   * \brief Load the constant pool. The immediate constants are only indexed, and decoded on first
+   * use by \p GetConstant.
    *
-   * \param stream The input stream.
+   * \param stream The input stream over \p code_.
    */
-  void LoadConstantSection(dmlc::Stream* stream);
+  void LoadConstantSection(dmlc::SeekStream* stream);
 
   /*!
    * \brief Save primitive op names.
@@ -353,6 +405,8 @@ class Executable : public ModuleNode {
 
   /*! \brief The serialized bytecode. */
   std::string code_;
+  /*! \brief The constants which are still serialized in \p code_, if any. */
+  std::unique_ptr<LazyConstants> lazy_constants_;
 };
 
 }  // namespace vm
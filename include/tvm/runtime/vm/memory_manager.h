@@ -50,6 +50,7 @@ struct Buffer {
 enum AllocatorType {
   kNaive = 1,
   kPooled,
+  kBinned,
 };
 
 class Allocator {
@@ -115,6 +116,11 @@ class StorageObj : public Object {
  public:
   /*! \brief The index into the VM function table. */
   Buffer buffer;
+  /*!
+   * \brief The arena storage this storage is a view of, undefined if the storage owns
+   *  its buffer. A view never frees its buffer.
+   */
+  ObjectRef arena;
 
   /*! \brief Allocate an NDArray from a given piece of storage. */
   NDArray AllocNDArray(size_t offset, std::vector<int64_t> shape, DLDataType dtype);
@@ -123,6 +129,7 @@ class StorageObj : public Object {
   static void Deleter(Object* ptr);
 
   ~StorageObj() {
+    if (arena.defined()) return;
     auto alloc = MemoryManager::Global()->GetAllocator(buffer.device);
     alloc->Free(buffer);
   }
@@ -33,7 +33,10 @@
 #include <tvm/runtime/vm/executable.h>
 #include <tvm/runtime/vm/memory_manager.h>
 
+#include <atomic>
+#include <chrono>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -85,6 +88,11 @@ struct VMFunction {
   Index register_file_size = 0;
   /*! \brief The indexes for the device holding each function parameter. */
   std::vector<Index> param_device_indexes;
+  /*!
+   * \brief The size of the arena holding the statically planned storages on each device,
+   *  empty if no storage of the function is planned.
+   */
+  std::vector<Index> arena_sizes;
 
   VMFunction(std::string name, std::vector<std::string> params,
              std::vector<Instruction> instructions, Index register_file_size,
@@ -118,6 +126,8 @@ struct VMFrame {
   Index args;
   /*! \brief A pointer into the caller function's instructions. */
   const Instruction* code;
+  /*! \brief A pointer into the caller function's dispatch stream. */
+  const uint8_t* dispatch{nullptr};
 
   /*! \brief Statically allocated space for objects */
   std::vector<ObjectRef> register_file;
@@ -125,6 +135,11 @@ struct VMFrame {
   /*! \brief Register in caller's frame to put return value */
   RegName caller_return_register;
 
+  /*! \brief The function owning the arenas, nullptr if the frame holds no arena. */
+  const VMFunction* arena_owner{nullptr};
+  /*! \brief The arenas of the statically planned storages, one per device. */
+  std::vector<Storage> arenas;
+
   VMFrame(Index pc, Index func_index, Index args, const Instruction* code, Index register_file_size)
       : pc(pc),
         func_index(func_index),
@@ -178,6 +193,28 @@ class VirtualMachine : public runtime::ModuleNode {
    */
   virtual void LoadExecutable(const ObjectPtr<Executable>& exec);
 
+  /*!
+   * \brief Let several threads run requests on this virtual machine at the same time.
+   *
+   * All the constants are loaded to their devices first, then the functions setting inputs,
+   * invoking and reading outputs run on an execution context owned by the calling thread. The
+   * contexts share the executable, the constants, the packed functions and the allocators of
+   * this virtual machine, and only own the frames, the registers and the inputs. The context of a
+   * thread is freed when the thread exits.
+   *
+   * \note Must be called after Init.
+   */
+  void EnableConcurrentExecution();
+
+  /*!
+   * \brief Get the latency statistics of the invocations, which tell the cold start cost apart
+   *  from the steady state: the time from loading the executable to the end of the first
+   *  invocation, the latency of the first invocation, the mean latency of the later ones and the
+   *  number of constants the executable decoded on demand.
+   * \return The statistics by name.
+   */
+  Map<String, ObjectRef> GetInvokeStats() const;
+
  protected:
   /*! \brief Push a call frame on to the call stack. */
   void PushFrame(Index arg_count, Index ret_pc, const VMFunction& vm_func);
@@ -251,6 +288,13 @@ class VirtualMachine : public runtime::ModuleNode {
   /*! \brief Run VM dispatch loop. */
   void RunLoop();
 
+  /*! \brief Execute an AllocStorage instruction. */
+  inline void ExecuteAllocStorage(const Instruction& instr);
+  /*! \brief Execute an AllocTensor instruction. */
+  inline void ExecuteAllocTensor(const Instruction& instr);
+  /*! \brief Execute an InvokePacked instruction. */
+  inline void ExecuteInvokePacked(const Instruction& instr);
+
   /*! \brief Get device from the device list based on a given device index. */
   Device GetDevice(Index device_index) const;
   Allocator* GetAllocator(Index device_index) const;
@@ -290,13 +334,38 @@ class VirtualMachine : public runtime::ModuleNode {
    *
    * \param instr Instruction that will be executed after this hook fires
    */
-  virtual void OpStartHook(Instruction instr);
+  virtual void OpStartHook(const Instruction& instr);
 
   /*!
    * \brief Internal hook for profiling the end of an op.
    */
   virtual void OpStopHook();
 
+  /*!
+   * \brief Get a function whose state belongs to the request being run, i.e. which reads or
+   *  writes the inputs, the frames or the return register. In concurrent mode such a function
+   *  runs on the execution context of the calling thread.
+   * \param name The function name.
+   * \param sptr_to_self The pointer to the module node.
+   * \return The function, or nullptr if name is not a per request function.
+   */
+  virtual PackedFunc GetRequestFunction(const std::string& name,
+                                        const ObjectPtr<Object>& sptr_to_self);
+
+  /*!
+   * \brief Create an execution context for a thread running requests concurrently. Subclasses
+   *  override it so that the contexts run with their hooks.
+   * \return A virtual machine sharing the program state of this one.
+   */
+  virtual ObjectPtr<VirtualMachine> CreateExecutionContext();
+
+  /*!
+   * \brief Share the executable, the constants, the packed functions and the allocators of this
+   *  virtual machine with an execution context.
+   * \param context The execution context.
+   */
+  void ShareProgramState(VirtualMachine* context) const;
+
  private:
   /*!
    * \brief Get index of input tensor from its name.
@@ -339,15 +408,92 @@ class VirtualMachine : public runtime::ModuleNode {
   void SetInputTensorWithIndex(std::vector<ObjectRef>& tensors,  // NOLINT(*)
                                const TVMArgValue& tensor, int index, Device dev);
 
+  /*!
+   * \brief Get a per request function of the execution context of the calling thread, creating
+   *  the context on first use.
+   * \param name The function name.
+   * \return The function.
+   */
+  PackedFunc GetThreadContextFunction(const std::string& name);
+
+  /*! \brief The execution state of one thread when running concurrent requests. */
+  struct ThreadContext {
+    /*! \brief The virtual machine holding the frames, registers and inputs of the thread. */
+    ObjectPtr<VirtualMachine> vm;
+    /*! \brief The per request functions of vm. */
+    std::unordered_map<std::string, PackedFunc> functions;
+  };
+  /*!
+   * \brief The execution contexts of the threads running requests concurrently, keyed by a
+   *  thread local object of each thread rather than its id, which the system may reuse.
+   */
+  struct ThreadContextTable {
+    /*! \brief Protects contexts. */
+    std::mutex mutex;
+    /*! \brief The execution context of each thread. */
+    std::unordered_map<const void*, ThreadContext> contexts;
+  };
+  /*! \brief Drops the execution contexts of a thread when the thread exits. */
+  class ThreadContextReleaser;
+  /*! \brief Whether requests run on the execution context of the calling thread. */
+  std::atomic<bool> concurrent_{false};
+  /*!
+   * \brief The execution contexts of the live threads which ran a request concurrently, shared
+   *  with the releasers of these threads.
+   */
+  std::shared_ptr<ThreadContextTable> thread_contexts_{std::make_shared<ThreadContextTable>()};
+
+  /*! \brief The latencies of the invocations, shared with the thread contexts. */
+  struct InvokeStats {
+    /*! \brief Protects the statistics. */
+    std::mutex mutex;
+    /*! \brief When the executable was loaded. */
+    std::chrono::steady_clock::time_point load_time;
+    /*! \brief The number of finished invocations. */
+    int64_t num_invokes{0};
+    /*! \brief The time from loading the executable to the end of the first invocation. */
+    double time_to_first_inference_us{0};
+    /*! \brief The latency of the first invocation. */
+    double first_invoke_us{0};
+    /*! \brief The number of constants decoded while the first invocation ran. */
+    int64_t first_invoke_decoded_constants{0};
+    /*! \brief The total latency of the invocations after the first one. */
+    double steady_invoke_total_us{0};
+  };
+  std::shared_ptr<InvokeStats> invoke_stats_;
+
+  /*!
+   * \brief Get the arenas for the statically planned storages of a function, reusing the
+   *  arenas released by a previous frame of the same function when possible.
+   * \param func The VM function.
+   * \return The arenas, one per device.
+   */
+  std::vector<Storage> AcquireArenas(const VMFunction& func);
+
  protected:
   /*! \brief The virtual machine's packed function table. */
   std::vector<PackedFunc> packed_funcs_;
   /*! \brief The current stack of call frames. */
   std::vector<VMFrame> frames_;
+  /*! \brief The arenas released by popped frames, keyed by their function. */
+  std::unordered_map<const VMFunction*, std::vector<std::vector<Storage>>> idle_arenas_;
   /*! \brief The fuction table index of the current function. */
   Index func_index_;
   /*! \brief The current pointer to the code section. */
   const Instruction* code_;
+  /*!
+   * \brief The pre-decoded dispatch stream of each function, holding for every instruction the
+   *  handler to run, which may be a superinstruction covering the following instructions too.
+   */
+  std::vector<std::vector<uint8_t>> dispatch_streams_;
+  /*! \brief The current pointer to the dispatch stream. */
+  const uint8_t* dispatch_{nullptr};
+  /*! \brief Scratch space for the arguments of InvokePacked, reused across calls. */
+  std::vector<ObjectRef> packed_args_;
+  /*! \brief Scratch space for the packed values of InvokePacked, reused across calls. */
+  std::vector<TVMValue> packed_values_;
+  /*! \brief Scratch space for the packed type codes of InvokePacked, reused across calls. */
+  std::vector<int> packed_codes_;
   /*! \brief The virtual machine PC. */
   Index pc_;
   /*! \brief The special return register. */
@@ -61,8 +61,10 @@ TVM_DLL std::vector<std::vector<int>> rr_partitioner(int begin, int end, int ste
  * \param step The traversal step to the index.
  * \param partitioner A partition function to split tasks to different threads. Use Round-robin
  * partitioner by default.
- * \note 1. Currently do not support nested parallel_for; 2. The order of execution in each thread
- * is not guaranteed, the for loop task should be thread independent and thread safe.
+ * \note 1. The loop runs on the calling thread and a persistent pool of threads, a thread which
+ * finishes its partition steals the tasks of the others. Nested parallel_for calls are supported.
+ * 2. The order of execution in each thread is not guaranteed, the for loop task should be thread
+ * independent and thread safe.
  */
 TVM_DLL void parallel_for(int begin, int end, const std::function<void(int)>& f, int step = 1,
                           const PartitionerFuncType partitioner = rr_partitioner);
@@ -80,10 +82,15 @@ TVM_DLL void parallel_for(int begin, int end, const std::function<void(int)>& f,
  *
  * \param begin The start index of this parallel loop (inclusive).
  * \param end The end index of this parallel loop (exclusive).
- * \param num_threads The number of threads to be used.
+ * \param num_threads The maximum number of threads to be used, the calling thread and the idle
+ * threads of the pool shared with `parallel_for`.
  * \param f The task function to be executed. Takes the thread index and the task index as
- * input with no output.
- * \note `step` support is left for future work.
+ * input with no output. The thread index is in [0, num_threads) and unique among the threads
+ * running the call, the calling thread is 0.
+ * \note 1. `num_threads` is an upper bound rather than a guarantee: the threads of the pool only
+ * join the call when they are idle, so fewer threads, down to the calling thread alone, may run
+ * the tasks. A task must therefore never wait for another task of the same call.
+ * 2. `step` support is left for future work.
  */
 TVM_DLL void parallel_for_dynamic(int begin, int end, int num_threads,
                                   const std::function<void(int thread_id, int task_id)>& f);
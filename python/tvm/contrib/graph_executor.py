@@ -15,6 +15,10 @@
 # specific language governing permissions and limitations
 # under the License.
 """Minimum graph executor that executes graph containing TVM PackedFunc."""
+import contextlib
+import threading
+import time
+
 import numpy as np
 import tvm._ffi
 
@@ -66,6 +70,33 @@ def create(graph_json_str, libmod, device):
     return GraphModule(fcreate(graph_json_str, libmod, *device_type_id))
 
 
+def create_pool(factory, num_instances, device):
+    """Create a pool of graph executors for serving concurrent requests.
+
+    The executors share the parsed graph, the kernels and the parameters of
+    the factory, and each only owns its activations.
+
+    Parameters
+    ----------
+    factory : tvm.runtime.Module or GraphExecutorFactoryModule
+        The factory module returned by :py:func:`tvm.relay.build`.
+
+    num_instances : int
+        The number of executors in the pool.
+
+    device : Device or list of Device
+        The device(s) to run the executors on.
+
+    Returns
+    -------
+    pool : GraphExecutorPool
+        The pool of executors.
+    """
+    if isinstance(device, Device):
+        device = [device]
+    return GraphExecutorPool(factory["create_pool"](num_instances, *device))
+
+
 def get_device(libmod, device):
     """Parse and validate all the device(s).
 
@@ -162,6 +193,8 @@ class GraphModule(object):
         self._get_num_inputs = module["get_num_inputs"]
         self._load_params = module["load_params"]
         self._share_params = module["share_params"]
+        self._load_params_from_file = module["load_params_from_file"]
+        self._set_inter_op_parallelism = module["set_inter_op_parallelism"]
 
     def set_input(self, key=None, value=None, **params):
         """Set inputs to the module via kwargs
@@ -207,6 +240,23 @@ class GraphModule(object):
             self.set_input(**input_dict)
         self._run()
 
+    def set_inter_op_parallelism(self, num_threads=0):
+        """Run independent operators of the graph concurrently.
+
+        The operators whose inputs are ready are launched together on the runtime
+        thread pool, and the next ones start when they are all done. An operator
+        also waits for the operators that used the storage it writes before it in
+        the memory plan. This helps graphs with parallel branches made of small
+        operators.
+
+        Parameters
+        ----------
+        num_threads : int
+            The number of threads running operators. 1 restores sequential
+            execution and 0 uses all the threads of the runtime thread pool.
+        """
+        self._set_inter_op_parallelism(num_threads)
+
     def get_num_outputs(self):
         """Get the number of outputs from the graph
 
@@ -325,6 +375,20 @@ class GraphModule(object):
         """
         self._load_params(bytearray(params_bytes))
 
+    def load_params_from_file(self, path):
+        """Load parameters from a parameter file.
+
+        Files saved by :py:func:`tvm.runtime.save_mappable_param_dict` are
+        memory mapped, and the parameters on the CPU alias the file instead of
+        being copied.
+
+        Parameters
+        ----------
+        path : str
+            The path of the parameter file.
+        """
+        self._load_params_from_file(path)
+
     def share_params(self, other, params_bytes):
         """Share parameters from pre-existing GraphExecutor instance.
 
@@ -434,3 +498,53 @@ class GraphModule(object):
         return self.module.time_evaluator(
             func_name, device, repeat=repeat, number=number, min_repeat_ms=min_repeat_ms
         )()
+
+
+class GraphExecutorPool(object):
+    """A pool of graph executors sharing one graph and its parameters.
+
+    Parameters
+    ----------
+    module : tvm.runtime.Module
+        The GraphExecutorPool module created by :py:func:`create_pool`.
+
+    Examples
+    --------
+
+    .. code-block:: python
+
+        pool = graph_executor.create_pool(lib, 4, tvm.cpu())
+        # in each request thread
+        with pool.checkout() as m:
+            m.set_input("x", data)
+            m.run()
+            out = m.get_output(0).numpy()
+    """
+
+    def __init__(self, module):
+        self.module = module
+        self._try_acquire = module["try_acquire"]
+        self._release = module["release"]
+        num_instances = module["num_instances"]()
+        self.instances = [GraphModule(module["get_instance"](i)) for i in range(num_instances)]
+        # Wait for an instance without holding the GIL, the executor which is
+        # being waited for may need it to be released.
+        self._available = threading.Semaphore(num_instances)
+
+    @contextlib.contextmanager
+    def checkout(self):
+        """Check out an idle executor for the duration of the with block.
+
+        Blocks while all the executors are checked out.
+        """
+        self._available.acquire()
+        index = self._try_acquire()
+        while index < 0:
+            # Only happens when native threads also check out instances.
+            time.sleep(1e-4)
+            index = self._try_acquire()
+        try:
+            yield self.instances[index]
+        finally:
+            self._release(index)
+            self._available.release()
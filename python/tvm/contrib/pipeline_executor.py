@@ -229,6 +229,48 @@ class PipelineModule(object):
         """
         return self._get_num_outputs()
 
+    def get_stage_stats(self):
+        """Get the per-stage statistics of the pipeline mode.
+
+        Every backend runtime is a row of the report, with its busy time ("Duration (us)"), the
+        time it waits for the data of its parents ("Starve (us)"), the time it waits for space in
+        the queue of a child ("Blocked (us)") and the occupancy histogram of its input queues.
+        The "pipeline" device metrics name the bottleneck stage.
+
+        Returns
+        -------
+        report : tvm.runtime.profiling.Report
+            The statistics.
+        """
+        return self.module["get_stage_stats"]()
+
+    def reset_stage_stats(self):
+        """Clear the per-stage statistics."""
+        self.module["reset_stage_stats"]()
+
+    def create_batcher(self, max_batch_size=0, max_wait_ms=1.0):
+        """Create a front stage which coalesces requests into batches of the pipeline.
+
+        The modules of the pipeline must be built for a batch size on the leading dimension of
+        every global input and output. While the batcher is alive, the pipeline should only be
+        run through it.
+
+        Parameters
+        ----------
+        max_batch_size : int
+            The maximum number of rows of a batch, 0 uses the batch size of the pipeline.
+
+        max_wait_ms : float
+            How long the oldest queued request waits for the batch to fill up.
+
+        Returns
+        -------
+        batcher : PipelineBatcher
+            The batcher.
+        """
+        create = self.module["create_batcher"]
+        return PipelineBatcher(create(max_batch_size, int(max_wait_ms * 1000)))
+
     @staticmethod
     def load_library(config_file_name):
         """Import files to create a pipeline executor.
@@ -262,6 +304,88 @@ class PipelineModule(object):
         return PipelineModule(module)
 
 
+class PipelineFuture(object):
+    """The pending outputs of a request submitted to a PipelineBatcher.
+
+    The batcher keeps the outputs of the request until the future takes them with result, or
+    until the future is deleted.
+    """
+
+    def __init__(self, batcher, request_id):
+        self._batcher = batcher
+        self._request_id = request_id
+        self._outputs = None
+
+    def __del__(self):
+        if self._outputs is None:
+            self._batcher._release(self._request_id)
+
+    def done(self):
+        """Return whether the outputs are ready."""
+        return self._outputs is not None or self._batcher._is_ready(self._request_id)
+
+    def result(self):
+        """Wait for the request to complete.
+
+        Returns
+        -------
+        outputs : List[NDArray]
+            The global outputs holding the rows of the request.
+        """
+        if self._outputs is None:
+            self._outputs = list(self._batcher._wait(self._request_id))
+        return self._outputs
+
+
+class PipelineBatcher(object):
+    """Wrapper of the runtime module coalescing requests into batches of a pipeline executor.
+
+    Parameters
+    ----------
+    module : Module
+        The batcher module created by PipelineModule.create_batcher.
+    """
+
+    def __init__(self, module):
+        self.module = module
+        self._submit = module["submit"]
+        self._is_ready = module["is_ready"]
+        self._wait = module["wait"]
+        self._release = module["release"]
+        self._get_max_batch_size = module["get_max_batch_size"]
+        self._get_num_batches = module["get_num_batches"]
+
+    def submit(self, inputs):
+        """Queue a request.
+
+        Parameters
+        ----------
+        inputs : Dict[str, Union[NDArray, numpy.ndarray]]
+            The value of every global input, with the rows of the request on the leading
+            dimension.
+
+        Returns
+        -------
+        future : PipelineFuture
+            The pending outputs of the request.
+        """
+        inputs = {
+            key: value if isinstance(value, tvm.nd.NDArray) else tvm.nd.array(value)
+            for key, value in inputs.items()
+        }
+        return PipelineFuture(self, self._submit(inputs))
+
+    @property
+    def max_batch_size(self):
+        """The maximum number of rows of a batch."""
+        return self._get_max_batch_size()
+
+    @property
+    def num_batches(self):
+        """The number of batches the pipeline has run."""
+        return self._get_num_batches()
+
+
 class PipelineConfig(object):
     """Pipeline configuration information, this class contains the DAG that expresses
     the dependency of each module involved in a pipeline and the parameters for building
@@ -49,6 +49,9 @@ def main(args):
         custom_addr=args.custom_addr,
         silent=args.silent,
         no_fork=not args.fork,
+        num_workers=args.num_workers,
+        session_timeout=args.session_timeout,
+        max_sessions_per_worker=args.max_sessions_per_worker,
     )
     server.proc.join()
 
@@ -90,6 +93,23 @@ if __name__ == "__main__":
     parser.add_argument(
         "--custom-addr", type=str, help="Custom IP Address to Report to RPC Tracker"
     )
+    parser.add_argument(
+        "--num-workers",
+        type=int,
+        default=0,
+        help="Serve this many sessions concurrently with a pool of pre-forked workers.",
+    )
+    parser.add_argument(
+        "--session-timeout",
+        type=float,
+        help="The default timeout of a session in seconds with --num-workers.",
+    )
+    parser.add_argument(
+        "--max-sessions-per-worker",
+        type=int,
+        default=0,
+        help="Replace a worker after it served this many sessions, 0 never replaces it.",
+    )
 
     parser.set_defaults(fork=True)
     args = parser.parse_args()
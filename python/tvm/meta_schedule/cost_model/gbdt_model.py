@@ -0,0 +1,100 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Native gradient boosted tree cost model"""
+from typing import Optional
+
+from tvm._ffi import register_object
+
+from .. import _ffi_api
+from ..feature_extractor import FeatureExtractor, PerStoreFeature
+from .cost_model import CostModel
+
+
+@register_object("meta_schedule.GBDTModel")
+class GBDTModel(CostModel):
+    """Gradient boosted tree cost model trained and evaluated in C++, with the same objective as
+    XGBModel but without calling into python or xgboost during tuning.
+
+    Parameters
+    ----------
+    extractor : Optional[FeatureExtractor]
+        The feature extractor, PerStoreFeature by default.
+    max_depth : int
+        The maximum depth of a tree.
+    num_bins : int
+        The number of histogram bins per feature, at most 256.
+    learning_rate : float
+        The shrinkage applied to each tree.
+    min_child_weight : float
+        The minimum sum of hessians in a child.
+    reg_lambda : float
+        The L2 regularization on the leaf values.
+    gamma : float
+        The minimum loss reduction of a split.
+    max_rounds : int
+        The maximum number of boosting rounds.
+    early_stopping_rounds : int
+        Stop boosting when the training loss did not improve for this many rounds.
+    num_warmup_samples : int
+        The number of measured samples before the model predicts, random scores are returned
+        before that.
+    seed : int
+        The seed of the random scores, -1 for a random seed.
+    """
+
+    extractor: FeatureExtractor
+    max_depth: int
+    num_bins: int
+    learning_rate: float
+    min_child_weight: float
+    reg_lambda: float
+    gamma: float
+    max_rounds: int
+    early_stopping_rounds: int
+    num_warmup_samples: int
+
+    def __init__(
+        self,
+        *,
+        extractor: Optional[FeatureExtractor] = None,
+        max_depth: int = 10,
+        num_bins: int = 256,
+        learning_rate: float = 0.2,
+        min_child_weight: float = 0.0,
+        reg_lambda: float = 1.0,
+        gamma: float = 0.001,
+        max_rounds: int = 1000,
+        early_stopping_rounds: int = 50,
+        num_warmup_samples: int = 100,
+        seed: int = 43,
+    ):
+        if extractor is None:
+            extractor = PerStoreFeature()
+        self.__init_handle_by_constructor__(
+            _ffi_api.CostModelGBDTModel,  # type: ignore # pylint: disable=no-member
+            extractor,
+            max_depth,
+            num_bins,
+            learning_rate,
+            min_child_weight,
+            reg_lambda,
+            gamma,
+            max_rounds,
+            early_stopping_rounds,
+            num_warmup_samples,
+            seed,
+        )
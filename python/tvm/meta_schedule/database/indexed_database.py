@@ -0,0 +1,82 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""A database that stores tuning records in binary segments indexed by workload"""
+from tvm._ffi import register_object
+
+from .. import _ffi_api
+from .database import Database
+
+
+@register_object("meta_schedule.IndexedDatabase")
+class IndexedDatabase(Database):
+    """A database that appends tuning records to binary segments and keeps the records of each
+    workload sorted by running time, so that the best records of a workload are found without
+    scanning the others. Records are parsed lazily, the first time they are looked up, which is
+    also when a record damaged on disk is reported.
+
+    The database may be shared by several processes, for example the workers of a distributed
+    tuning job. Appends are serialized by a lock on the file `path + ".lock"`, a workload is
+    stored once however many processes commit it, and the records committed by one process are
+    seen by the others the next time they query the database.
+
+    Parameters
+    ----------
+    path : str
+        The path of the file naming the live segments, which are stored next to it.
+    max_segment_bytes : int
+        The size after which the records are appended to a new segment.
+    """
+
+    path: str
+    max_segment_bytes: int
+
+    def __init__(
+        self,
+        path: str,
+        allow_missing: bool = True,
+        max_segment_bytes: int = 256 * 1024 * 1024,
+    ) -> None:
+        """Constructor.
+
+        Parameters
+        ----------
+        path : str
+            The path of the file naming the live segments, which are stored next to it.
+        allow_missing : bool
+            Whether to create a new database when the given path is not found.
+        max_segment_bytes : int
+            The size after which the records are appended to a new segment.
+        """
+        self.__init_handle_by_constructor__(
+            _ffi_api.DatabaseIndexedDatabase,  # type: ignore # pylint: disable=no-member
+            path,
+            allow_missing,
+            max_segment_bytes,
+        )
+
+    def compact(self, records_per_workload: int = 0) -> None:
+        """Rewrite the segments into one, with the records of each workload stored together.
+
+        Parameters
+        ----------
+        records_per_workload : int
+            The number of best records to keep for each workload, 0 to keep all of them.
+        """
+        _ffi_api.IndexedDatabaseCompact(  # type: ignore # pylint: disable=no-member
+            self,
+            records_per_workload,
+        )
@@ -17,6 +17,8 @@
 """We extract one feature vector per BufferStoreNode statement in a TIR Stmt,
 so we call this feature as "per-store" feature.
 """
+from typing import Dict
+
 from tvm._ffi import register_object
 
 from .. import _ffi_api
@@ -35,6 +37,9 @@ class PerStoreFeature(FeatureExtractor):
         The number of samples used in the arithmetic intensity curve.
     cache_line_bytes : int
         The number of bytes in a cache line.
+    feature_cache_size : int
+        The number of recently extracted modules whose features are cached by structural hash,
+        0 to disable the cache.
     """
 
     buffers_per_store: int
@@ -45,16 +50,31 @@ class PerStoreFeature(FeatureExtractor):
     """The number of bytes in a cache line."""
     feature_vector_length: int
     """Length of the feature vector."""
+    feature_cache_size: int
+    """The number of modules whose features are cached."""
 
     def __init__(
         self,
         buffers_per_store: int = 5,
         arith_intensity_curve_num_samples: int = 10,
         cache_line_bytes: int = 64,
+        feature_cache_size: int = 4096,
     ):
         self.__init_handle_by_constructor__(
             _ffi_api.FeatureExtractorPerStoreFeature,  # type: ignore # pylint: disable=no-member
             buffers_per_store,
             arith_intensity_curve_num_samples,
             cache_line_bytes,
+            feature_cache_size,
         )
+
+    def cache_stats(self) -> Dict[str, int]:
+        """Get the statistics of the feature cache.
+
+        Returns
+        -------
+        stats : Dict[str, int]
+            The number of cache hits, misses and cached modules, empty if the cache is disabled.
+        """
+        f_stats = _ffi_api.FeatureExtractorPerStoreFeatureCacheStats  # type: ignore # pylint: disable=no-member
+        return {str(k): int(v) for k, v in f_stats(self).items()}
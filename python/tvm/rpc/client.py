@@ -25,12 +25,58 @@ import tvm._ffi
 from tvm.contrib import utils
 from tvm._ffi.base import TVMError
 from tvm.runtime import ndarray as nd
+from tvm.runtime import Object
+from tvm.runtime import _ffi_api as _runtime_api
+from tvm.runtime.module import BenchmarkResult
 
 from . import base
 from . import server
 from . import _ffi_api
 
 
+@tvm._ffi.register_object("rpc.RPCFuture")
+class RPCFuture(Object):
+    """The pending result of a call or copy submitted to an RPC session."""
+
+    def done(self):
+        """Whether the submission completed, without waiting for the remote."""
+        return _ffi_api.FutureDone(self)
+
+    def result(self):
+        """Wait for the submission and get its result.
+
+        Returns
+        -------
+        value : object
+            The return value of the call, None for a copy.
+        """
+        return _ffi_api.FutureResult(self)
+
+
+class RPCTimeEvaluatorFuture(object):
+    """The pending result of a time evaluator submitted to an RPC session."""
+
+    def __init__(self, future, repeat):
+        self._future = future
+        self._repeat = repeat
+
+    def done(self):
+        """Whether the evaluation completed, without waiting for the remote."""
+        return self._future.done()
+
+    def result(self):
+        """Wait for the evaluation and get its result.
+
+        Returns
+        -------
+        result : BenchmarkResult
+            The `repeat` time costs in seconds.
+        """
+        blob = self._future.result()
+        fmt = "@" + ("d" * self._repeat)
+        return BenchmarkResult(struct.unpack(fmt, blob))
+
+
 class RPCSession(object):
     """RPC Client session module
 
@@ -197,6 +243,114 @@ class RPCSession(object):
             )
         return self._remote_funcs["download_linked_module"](path)
 
+    def set_transfer_options(self, chunk_bytes=1 << 20, compress=False):
+        """Configure how tensors are copied to and from the remote.
+
+        Tensors larger than chunk_bytes are split into chunks which are
+        pipelined with the device copy on the remote.
+
+        Parameters
+        ----------
+        chunk_bytes : int
+            The size of a chunk in bytes, 0 sends every tensor as a single packet.
+
+        compress : bool
+            Whether to compress the chunks, which pays off for sparse or
+            low entropy tensors on slow links.
+
+        Note
+        ----
+        The options only take effect if the remote supports the chunked transfer,
+        otherwise tensors are sent as a single packet.
+        """
+        _ffi_api.SetTransferOptions(self._sess, chunk_bytes, compress)
+
+    def submit(self, func, *args):
+        """Call a remote function without waiting for its return.
+
+        The submissions are sent back to back over the connection, so many
+        small calls, e.g. of time evaluators through submit_time_evaluator,
+        pay the round trip time once.
+        They complete in order, and any synchronous call first waits for all
+        the pending submissions.
+
+        Parameters
+        ----------
+        func : PackedFunc
+            A function of this session, a local function is rejected.
+
+        args : list
+            The arguments of the call.
+
+        Returns
+        -------
+        future : RPCFuture
+            The future of the return value.
+        """
+        return _ffi_api.SubmitCall(func, *args)
+
+    def submit_time_evaluator(
+        self, mod, func_name, dev, *args, number=10, repeat=1, min_repeat_ms=0, f_preproc=""
+    ):
+        """Run a time evaluator of a remote module without waiting for its result.
+
+        Parameters
+        ----------
+        mod : runtime.Module
+            A module of this session.
+
+        func_name : str
+            The name of the function in the module.
+
+        dev : Device
+            The remote device to run the function on.
+
+        args : list
+            The arguments of the function.
+
+        number, repeat, min_repeat_ms, f_preproc :
+            The options of :py:meth:`tvm.runtime.Module.time_evaluator`.
+
+        Returns
+        -------
+        future : RPCTimeEvaluatorFuture
+            The future of the BenchmarkResult.
+        """
+        feval = _runtime_api.RPCTimeEvaluator(
+            mod,
+            func_name,
+            dev.device_type,
+            dev.device_id,
+            number,
+            repeat,
+            min_repeat_ms,
+            f_preproc,
+        )
+        return RPCTimeEvaluatorFuture(self.submit(feval, *args), repeat)
+
+    def submit_copy(self, source, target):
+        """Copy between a local CPU array and a remote array without waiting.
+
+        Parameters
+        ----------
+        source : NDArray
+            The source array.
+
+        target : NDArray
+            The target array. A local target must stay unchanged until the copy
+            completes.
+
+        Returns
+        -------
+        future : RPCFuture
+            The future of the copy.
+        """
+        return _ffi_api.SubmitCopy(source, target)
+
+    def wait_all(self):
+        """Wait for all the submissions of this session."""
+        _ffi_api.WaitSubmitted(self._sess)
+
     def cpu(self, dev_id=0):
         """Construct CPU device."""
         return self.device(1, dev_id)
@@ -247,7 +401,7 @@ class LocalSession(RPCSession):
 
 
 @tvm._ffi.register_func("rpc.PopenSession")
-def _popen_session(binary):
+def _popen_session(binary, shared_memory_bytes=0):
     temp = utils.tempdir()
 
     if isinstance(binary, (bytes, bytearray)):
@@ -263,6 +417,8 @@ def _popen_session(binary):
         if not os.access(path_exec, os.X_OK):
             raise RuntimeError(f"{path_exec} is not executable.")
 
+    if shared_memory_bytes:
+        return _ffi_api.CreateSharedMemoryPipeClient(shared_memory_bytes, path_exec)
     sess = _ffi_api.CreatePipeClient(path_exec)
     return sess
 
@@ -274,10 +430,15 @@ class PopenSession(RPCSession):
     ----------
     binary : List[Union[str, bytes]]
         The binary to be executed.
+
+    shared_memory_bytes : int, optional
+        If non-zero, the bytes are moved through two rings of this size in
+        shared memory and the pipes only carry wake ups, which avoids the
+        copies through the kernel for large tensors.
     """
 
-    def __init__(self, binary):
-        RPCSession.__init__(self, _popen_session(binary))
+    def __init__(self, binary, shared_memory_bytes=0):
+        RPCSession.__init__(self, _popen_session(binary, shared_memory_bytes))
 
 
 class TrackerSession(object):
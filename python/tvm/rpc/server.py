@@ -25,6 +25,7 @@ Server is TCP based with the following protocol:
    - {server|client}:device-type[:random-key] [-timeout=timeout]
 """
 # pylint: disable=invalid-name
+import collections
 import ctypes
 import socket
 import select
@@ -32,6 +33,7 @@ import struct
 import logging
 import threading
 import multiprocessing
+from multiprocessing import reduction
 import time
 import errno
 import tvm._ffi
@@ -40,7 +42,7 @@ from tvm._ffi.base import py_str
 from tvm._ffi.libinfo import find_lib_path
 from tvm.runtime.module import load_module as _load_module
 from tvm.contrib import utils
-from tvm.contrib.popen_pool import PopenWorker
+from tvm.contrib.popen_pool import PopenWorker, kill_child_processes
 from . import _ffi_api
 from . import base
 
@@ -128,6 +130,39 @@ def _parse_server_opt(opts):
     return ret
 
 
+def _server_handshake(conn, addr, matchkey, rpc_key):
+    """Reply to the handshake of a client.
+
+    Returns
+    -------
+    opts : dict or None
+        The session options of the client, None if the connection was rejected and closed.
+    """
+    magic = struct.unpack("<i", base.recvall(conn, 4))[0]
+    if magic != base.RPC_MAGIC:
+        conn.close()
+        return None
+    keylen = struct.unpack("<i", base.recvall(conn, 4))[0]
+    key = py_str(base.recvall(conn, keylen))
+    return _reply_handshake(conn, addr, key, matchkey, rpc_key)
+
+
+def _reply_handshake(conn, addr, key, matchkey, rpc_key):
+    """Reply to the key a client sent in its handshake."""
+    arr = key.split()
+    expect_header = "client:" + matchkey
+    server_key = "server:" + rpc_key
+    if arr[0] != expect_header:
+        conn.sendall(struct.pack("<i", base.RPC_CODE_MISMATCH))
+        conn.close()
+        logger.warning("mismatch key from %s", addr)
+        return None
+    conn.sendall(struct.pack("<i", base.RPC_CODE_SUCCESS))
+    conn.sendall(struct.pack("<i", len(server_key)))
+    conn.sendall(server_key.encode("utf-8"))
+    return _parse_server_opt(arr[1:])
+
+
 def _listen_loop(sock, port, rpc_key, tracker_addr, load_library, custom_addr):
     """Listening loop of the server."""
 
@@ -181,24 +216,10 @@ def _listen_loop(sock, port, rpc_key, tracker_addr, load_library, custom_addr):
                         unmatch_period_count = 0
                     continue
             conn, addr = listen_sock.accept()
-            magic = struct.unpack("<i", base.recvall(conn, 4))[0]
-            if magic != base.RPC_MAGIC:
-                conn.close()
+            opts = _server_handshake(conn, addr, matchkey, rpc_key)
+            if opts is None:
                 continue
-            keylen = struct.unpack("<i", base.recvall(conn, 4))[0]
-            key = py_str(base.recvall(conn, keylen))
-            arr = key.split()
-            expect_header = "client:" + matchkey
-            server_key = "server:" + rpc_key
-            if arr[0] != expect_header:
-                conn.sendall(struct.pack("<i", base.RPC_CODE_MISMATCH))
-                conn.close()
-                logger.warning("mismatch key from %s", addr)
-                continue
-            conn.sendall(struct.pack("<i", base.RPC_CODE_SUCCESS))
-            conn.sendall(struct.pack("<i", len(server_key)))
-            conn.sendall(server_key.encode("utf-8"))
-            return conn, addr, _parse_server_opt(arr[1:])
+            return conn, addr, opts
 
     # Server logic
     tracker_conn = None
@@ -254,6 +275,197 @@ def _listen_loop(sock, port, rpc_key, tracker_addr, load_library, custom_addr):
         work_path.remove()
 
 
+def _pool_worker_loop(channel, load_library):
+    """Serve the sessions handed over by the dispatcher until the channel closes."""
+    while True:
+        try:
+            fd = reduction.recv_handle(channel)
+            addr = channel.recv()
+        except (EOFError, OSError):
+            break
+        sock = socket.socket(fileno=fd)
+        try:
+            _serve_loop(sock, addr, load_library)
+        except Exception as err:  # pylint: disable=broad-except
+            logger.warning("Error in RPC session from %s: %s", addr, str(err))
+        finally:
+            # the server loop closes the socket.
+            sock.detach()
+        channel.send(addr)
+
+
+class _PoolWorker(object):
+    """A pre-forked worker process of the multiplexed server."""
+
+    def __init__(self, load_library):
+        self.channel, child_channel = multiprocessing.Pipe()
+        self.proc = multiprocessing.Process(
+            target=_pool_worker_loop, args=(child_channel, load_library)
+        )
+        self.proc.daemon = True
+        self.proc.start()
+        child_channel.close()
+        self.deadline = None
+        self.addr = None
+        self.num_sessions = 0
+
+    @property
+    def busy(self):
+        return self.addr is not None
+
+    def assign(self, conn, addr, timeout):
+        reduction.send_handle(self.channel, conn.fileno(), self.proc.pid)
+        self.channel.send(addr)
+        self.addr = addr
+        self.deadline = time.time() + timeout if timeout else None
+        self.num_sessions += 1
+
+    def kill(self):
+        self.channel.close()
+        kill_child_processes(self.proc.pid)
+        self.proc.terminate()
+        self.proc.join()
+
+
+class _Handshake(object):
+    """A connection of the multiplexed server whose handshake is in progress.
+
+    The handshake is read without blocking, so a slow or idle client does not hold
+    up the dispatcher.
+    """
+
+    def __init__(self, conn, addr, timeout):
+        conn.setblocking(False)
+        self.conn = conn
+        self.addr = addr
+        self.deadline = time.time() + timeout
+        self.data = b""
+        self.opts = None
+
+    def receive(self, matchkey, rpc_key):
+        """Receive the available bytes of the handshake.
+
+        Returns
+        -------
+        finished : bool
+            Whether the handshake is over, opts is None if the connection was rejected.
+        """
+        data = self.conn.recv(4096)
+        if not data:
+            raise IOError("connection closed by the peer")
+        self.data += data
+        if len(self.data) >= 4 and struct.unpack("<i", self.data[:4])[0] != base.RPC_MAGIC:
+            self.conn.close()
+            return True
+        if len(self.data) < 8:
+            return False
+        keylen = struct.unpack("<i", self.data[4:8])[0]
+        if len(self.data) < 8 + keylen:
+            return False
+        self.conn.setblocking(True)
+        key = py_str(self.data[8 : 8 + keylen])
+        self.opts = _reply_handshake(self.conn, self.addr, key, matchkey, rpc_key)
+        return True
+
+
+def _multiplex_listen_loop(
+    sock, rpc_key, load_library, num_workers, session_timeout, max_sessions_per_worker
+):
+    """Listening loop of the multiplexed server.
+
+    The sessions are dispatched to a pool of pre-forked worker processes, each of them
+    serves one session at a time in a fresh work directory. A worker which exceeds the
+    timeout of its session is killed and replaced, and a worker is recycled after
+    max_sessions_per_worker sessions. Connections wait in order for a free worker.
+    A connection which does not finish its handshake within handshake_timeout is
+    dropped, as is a waiting connection whose client went away.
+    """
+    workers = [_PoolWorker(load_library) for _ in range(num_workers)]
+    handshakes = {}
+    pending = collections.deque()
+    # The waiting connections from which no session data arrived yet, watched for a close.
+    unread = set()
+    handshake_timeout = 5
+
+    while True:
+        busy = [w for w in workers if w.busy]
+        deadlines = [w.deadline for w in busy if w.deadline is not None]
+        deadlines += [h.deadline for h in handshakes.values()]
+        wait = max(0, min(deadlines) - time.time()) if deadlines else None
+        watched = [sock] + list(handshakes) + list(unread) + [w.channel for w in busy]
+        readable = select.select(watched, [], [], wait)[0]
+
+        if sock in readable:
+            conn, addr = sock.accept()
+            handshakes[conn] = _Handshake(conn, addr, handshake_timeout)
+
+        for conn, handshake in list(handshakes.items()):
+            if conn in readable:
+                try:
+                    if not handshake.receive(rpc_key, rpc_key):
+                        continue
+                except (socket.error, IOError) as err:
+                    logger.warning("Handshake with %s failed: %s", handshake.addr, str(err))
+                    conn.close()
+                    del handshakes[conn]
+                    continue
+                del handshakes[conn]
+                if handshake.opts is not None:
+                    pending.append((conn, handshake.addr, handshake.opts))
+                    unread.add(conn)
+                    logger.info("connection from %s", handshake.addr)
+            elif time.time() >= handshake.deadline:
+                logger.warning("Handshake with %s timed out", handshake.addr)
+                conn.close()
+                del handshakes[conn]
+
+        for conn in [c for c in unread if c in readable]:
+            unread.discard(conn)
+            try:
+                closed = not conn.recv(1, socket.MSG_PEEK)
+            except (socket.error, IOError):
+                closed = True
+            if closed:
+                addr = next(p[1] for p in pending if p[0] is conn)
+                logger.info("Connection from %s closed before it was served", addr)
+                pending = collections.deque(p for p in pending if p[0] is not conn)
+                conn.close()
+
+        for i, worker in enumerate(workers):
+            if not worker.busy:
+                continue
+            expired = worker.deadline is not None and time.time() >= worker.deadline
+            finished = False
+            if worker.channel in readable:
+                try:
+                    worker.channel.recv()
+                    finished = True
+                except (EOFError, OSError):
+                    logger.warning("Worker serving %s exited", worker.addr)
+                    expired = True
+            if finished and (
+                not max_sessions_per_worker or worker.num_sessions < max_sessions_per_worker
+            ):
+                logger.info("Finish serving %s", worker.addr)
+                worker.addr = None
+                worker.deadline = None
+            elif finished or expired:
+                if not finished:
+                    logger.info("Timeout in RPC session from %s, kill..", worker.addr)
+                worker.kill()
+                workers[i] = _PoolWorker(load_library)
+
+        for worker in workers:
+            if not pending:
+                break
+            if not worker.busy:
+                conn, addr, opts = pending.popleft()
+                unread.discard(conn)
+                worker.assign(conn, addr, opts.get("timeout", session_timeout))
+                # the worker owns a duplicate of the connection.
+                conn.close()
+
+
 def _connect_proxy_loop(addr, key, load_library):
     key = "server:" + key
     retry_count = 0
@@ -310,6 +522,9 @@ class PopenRPCServerState(object):
         load_library=None,
         custom_addr=None,
         silent=False,
+        num_workers=0,
+        session_timeout=None,
+        max_sessions_per_worker=0,
     ):
 
         # start update
@@ -336,12 +551,26 @@ class PopenRPCServerState(object):
             if not self.port:
                 raise ValueError("cannot bind to any port in [%d, %d)" % (port, port_end))
             logger.info("bind to %s:%d", host, self.port)
-            sock.listen(1)
             self.sock = sock
-            self.thread = threading.Thread(
-                target=_listen_loop,
-                args=(self.sock, self.port, key, tracker_addr, load_library, self.custom_addr),
-            )
+            if num_workers:
+                sock.listen(128)
+                self.thread = threading.Thread(
+                    target=_multiplex_listen_loop,
+                    args=(
+                        self.sock,
+                        key,
+                        load_library,
+                        num_workers,
+                        session_timeout,
+                        max_sessions_per_worker,
+                    ),
+                )
+            else:
+                sock.listen(1)
+                self.thread = threading.Thread(
+                    target=_listen_loop,
+                    args=(self.sock, self.port, key, tracker_addr, load_library, self.custom_addr),
+                )
             self.thread.start()
         else:
             self.thread = threading.Thread(
@@ -362,6 +591,9 @@ def _popen_start_rpc_server(
     silent=False,
     no_fork=False,
     server_init_callback=None,
+    num_workers=0,
+    session_timeout=None,
+    max_sessions_per_worker=0,
 ):
     if no_fork:
         multiprocessing.set_start_method("spawn")
@@ -373,7 +605,18 @@ def _popen_start_rpc_server(
     # Popen worker to run on a separate process.
     # Create and start the server in a different thread
     state = PopenRPCServerState(
-        host, port, port_end, is_proxy, tracker_addr, key, load_library, custom_addr, silent
+        host,
+        port,
+        port_end,
+        is_proxy,
+        tracker_addr,
+        key,
+        load_library,
+        custom_addr,
+        silent,
+        num_workers,
+        session_timeout,
+        max_sessions_per_worker,
     )
     PopenRPCServerState.current = state
     # returns the port so that the main can get the port number.
@@ -425,6 +668,20 @@ class Server(object):
     server_init_callback: Callable, optional
         Additional initialization function when starting the server.
 
+    num_workers: int, optional
+        Serve up to this many sessions concurrently with a pool of pre-forked
+        worker processes. By default one session is served at a time in a
+        process forked for it. Cannot be combined with a proxy or a tracker.
+
+    session_timeout: float, optional
+        The default timeout of a session in seconds when num_workers is set,
+        the worker of a session which times out is killed and replaced.
+        A client can override it with the -timeout option of its key.
+
+    max_sessions_per_worker: int, optional
+        Replace a worker after it served this many sessions, 0 keeps the
+        workers for the lifetime of the server.
+
     Note
     ----
     The RPC server only sees functions in the tvm namespace.
@@ -455,12 +712,17 @@ class Server(object):
         silent=False,
         no_fork=False,
         server_init_callback=None,
+        num_workers=0,
+        session_timeout=None,
+        max_sessions_per_worker=0,
     ):
         try:
             if _ffi_api.ServerLoop is None:
                 raise RuntimeError("Please compile with USE_RPC=1")
         except NameError:
             raise RuntimeError("Please compile with USE_RPC=1")
+        if num_workers and (is_proxy or tracker_addr):
+            raise ValueError("num_workers cannot be combined with a proxy or a tracker")
         self.proc = PopenWorker()
         # send the function
         self.proc.send(
@@ -477,6 +739,9 @@ class Server(object):
                 silent,
                 no_fork,
                 server_init_callback,
+                num_workers,
+                session_timeout,
+                max_sessions_per_worker,
             ],
         )
         # receive the port
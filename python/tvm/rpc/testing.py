@@ -17,6 +17,9 @@
 
 # pylint: disable=invalid-name,unnecessary-comprehension
 """ Testing functions for the RPC server."""
+import os
+import time
+
 import numpy as np
 import tvm
 
@@ -37,6 +40,16 @@ def _remotethrow(name):
     raise ValueError("%s" % name)
 
 
+@tvm.register_func("rpc.test.getpid")
+def _getpid():
+    return os.getpid()
+
+
+@tvm.register_func("rpc.test.sleep")
+def _sleep(seconds):
+    time.sleep(seconds)
+
+
 @tvm.register_func("rpc.test.runtime_str_concat")
 def _strcat(x, y):
     return x + y
@@ -67,3 +67,48 @@ def load_param_dict(param_bytes):
     if isinstance(param_bytes, (bytes, str)):
         param_bytes = bytearray(param_bytes)
     return _ffi_api.LoadParams(param_bytes)
+
+
+def save_mappable_param_dict(params, alignment=64):
+    """Save parameter dictionary to binary bytes in the mappable format.
+
+    The data of every tensor starts at a multiple of ``alignment`` in the
+    result, so a file holding it can be memory mapped by
+    :py:func:`load_param_dict_from_file` or the GraphModule API
+    "load_params_from_file" without copying the tensors. The result can also
+    be loaded like the bytes of :py:func:`save_param_dict`.
+
+    Parameters
+    ----------
+    params : dict of str to NDArray
+        The parameter dictionary.
+
+    alignment : int
+        The alignment of the tensor data in bytes.
+
+    Returns
+    -------
+    param_bytes: bytearray
+        Serialized parameters.
+    """
+    transformed = {k: ndarray.array(v) for (k, v) in params.items()}
+    return _ffi_api.SaveMappableParams(transformed, alignment)
+
+
+def load_param_dict_from_file(path):
+    """Load parameter dictionary from a file.
+
+    Files in the mappable format are memory mapped and the CPU tensors alias
+    the file, so processes loading the same file share its pages.
+
+    Parameters
+    ----------
+    path: str
+        The path of the parameter file.
+
+    Returns
+    -------
+    params : dict of str to NDArray
+        The parameter dictionary.
+    """
+    return _ffi_api.LoadParamsFromFile(path)
@@ -79,6 +79,7 @@ class Executable(object):
         self._get_function_param_name = self.mod["get_function_param_name"]
         self._move_late_bound_consts = self.mod["move_late_bound_consts"]
         self._load_late_bound_consts = self.mod["load_late_bound_consts"]
+        self._prefetch_constants = self.mod["prefetch_constants"]
 
     def save(self):
         """Save the Relay VM Executable.
@@ -308,6 +309,15 @@ class Executable(object):
         """Re-load constants previously saved to file at path"""
         return self._load_late_bound_consts(path)
 
+    def prefetch_constants(self):
+        """Decode the constants of a loaded executable on a background thread.
+
+        The constants of a loaded executable are decoded the first time they are
+        used. Prefetching decodes them ahead of their first use, in the order the
+        functions load them, while the VM is being set up or runs.
+        """
+        self._prefetch_constants()
+
 
 class VirtualMachine(object):
     """Relay VM runtime.
@@ -323,7 +333,7 @@ class VirtualMachine(object):
 
     memory_cfg : str or Dict[tvm.runtime.Device, str], optional
         Config the type of memory allocator. The allocator type can be ["naive",
-        "pooled"]. If memory_cfg is None, all devices will use pooled allocator
+        "pooled", "binned"]. If memory_cfg is None, all devices will use pooled allocator
         by default. If memory_cfg is string, all devices will use the specified
         allocator type. If memory_cfg is a dict, each device uses the allocator
         type specified in the dict, or pooled allocator if not specified in the
@@ -332,6 +342,7 @@ class VirtualMachine(object):
 
     NAIVE_ALLOCATOR = 1
     POOLED_ALLOCATOR = 2
+    BINNED_ALLOCATOR = 3
 
     def __init__(self, exe, device, memory_cfg=None):
         """
@@ -399,9 +410,11 @@ class VirtualMachine(object):
         if memory_cfg is None:
             memory_cfg = {}
         elif isinstance(memory_cfg, str):
-            assert memory_cfg in ["naive", "pooled"]
+            assert memory_cfg in ["naive", "pooled", "binned"]
             if memory_cfg == "naive":
                 default_alloc_type = VirtualMachine.NAIVE_ALLOCATOR
+            elif memory_cfg == "binned":
+                default_alloc_type = VirtualMachine.BINNED_ALLOCATOR
             memory_cfg = {}
         elif not isinstance(memory_cfg, dict):
             raise TypeError(
@@ -563,6 +576,32 @@ class VirtualMachine(object):
         """
         return self._get_input_index(input_name, func_name)
 
+    def enable_concurrent_execution(self):
+        """Let several threads run requests on this VM at the same time.
+
+        All the constants are loaded to the devices first. Afterwards, setting the
+        inputs, invoking functions and reading the outputs use an execution context
+        owned by the calling thread, while the executable, the constants and the
+        kernels stay shared between the threads.
+        """
+        self.module["enable_concurrent_execution"]()
+
+    def invoke_stats(self):
+        """Get the latency statistics of the invocations of this VM.
+
+        Returns
+        -------
+        stats : Dict[str, Object]
+            ``time_to_first_inference`` is the time from creating the VM to the end
+            of the first invocation, ``first_invoke`` and ``steady_state_invoke``
+            the latency of the first invocation and the mean latency of the later
+            ones, as :py:class:`tvm.runtime.profiling.Duration`.
+            ``num_invokes``, ``first_invoke_decoded_constants`` and
+            ``decoded_constants`` are :py:class:`tvm.runtime.profiling.Count`, and
+            ``constant_decode_time`` the total time spent decoding constants.
+        """
+        return dict(self.module["get_invoke_stats"]())
+
     def benchmark(
         self,
         device,
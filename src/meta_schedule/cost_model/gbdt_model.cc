@@ -0,0 +1,605 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+#include "../../runtime/file_utils.h"
+#include "../utils.h"
+
+namespace tvm {
+namespace meta_schedule {
+
+/*! \brief A regression tree stored as flat arrays, node 0 is the root. */
+struct GBDTTree {
+  /*! \brief The split feature of each node, -1 for a leaf. */
+  std::vector<int32_t> feature;
+  /*! \brief Rows whose feature is not greater than the threshold go to the left child. */
+  std::vector<float> threshold;
+  /*! \brief The left child of each node, the right child is the node after it. */
+  std::vector<int32_t> left;
+  /*! \brief The value of each leaf, shrinkage included. */
+  std::vector<float> value;
+
+  /*! \return The index of a new leaf. */
+  int32_t AddNode() {
+    feature.push_back(-1);
+    threshold.push_back(0.0f);
+    left.push_back(-1);
+    value.push_back(0.0f);
+    return static_cast<int32_t>(feature.size()) - 1;
+  }
+
+  /*! \return The value of the leaf the row falls into. */
+  float Predict(const float* row) const {
+    int32_t i = 0;
+    while (feature[i] >= 0) {
+      i = row[feature[i]] <= threshold[i] ? left[i] : left[i] + 1;
+    }
+    return value[i];
+  }
+
+  void Save(dmlc::Stream* strm) const {
+    strm->Write(feature);
+    strm->Write(threshold);
+    strm->Write(left);
+    strm->Write(value);
+  }
+
+  bool Load(dmlc::Stream* strm) {
+    return strm->Read(&feature) && strm->Read(&threshold) && strm->Read(&left) &&
+           strm->Read(&value) && !feature.empty() && feature.size() == threshold.size() &&
+           feature.size() == left.size() && feature.size() == value.size();
+  }
+};
+
+/*!
+ * \brief Fits the trees of a GBDTModel with the pack-sum squared error: the prediction of a
+ *  candidate is the sum of the predictions of its rows, and each row takes the gradient of the
+ *  candidate it belongs to.
+ */
+class GBDTTrainer {
+ public:
+  /*! \brief The training parameters. */
+  struct Param {
+    int max_depth;
+    int num_bins;
+    double learning_rate;
+    double min_child_weight;
+    double reg_lambda;
+    double gamma;
+    int max_rounds;
+    int early_stopping_rounds;
+    int num_threads;
+  };
+
+  /*!
+   * \brief Constructor.
+   * \param param The training parameters.
+   * \param features The rows, row major.
+   * \param num_features The number of features of a row.
+   * \param row_ptr The rows of candidate i are [row_ptr[i], row_ptr[i + 1]).
+   * \param labels The label of each candidate.
+   */
+  GBDTTrainer(const Param& param, const std::vector<float>& features, int num_features,
+              const std::vector<int64_t>& row_ptr, std::vector<double> labels)
+      : param_(param),
+        features_(features),
+        num_features_(num_features),
+        row_ptr_(row_ptr),
+        labels_(std::move(labels)),
+        num_rows_(row_ptr.back()) {}
+
+  /*! \return The trees, up to the round with the lowest training loss. */
+  std::vector<GBDTTree> Train() {
+    std::vector<GBDTTree> trees;
+    if (num_rows_ == 0) return trees;
+    BuildBins();
+    int num_candidates = static_cast<int>(labels_.size());
+    row_pred_.assign(num_rows_, 0.0);
+    grad_.resize(num_rows_);
+    hess_.resize(num_rows_);
+    double best_loss = std::numeric_limits<double>::infinity();
+    int best_rounds = 0;
+    for (int round = 0; round < param_.max_rounds; ++round) {
+      for (int i = 0; i < num_candidates; ++i) {
+        double y = labels_[i];
+        double g = (CandidatePrediction(i) - y) * y;
+        for (int64_t r = row_ptr_[i]; r < row_ptr_[i + 1]; ++r) {
+          grad_[r] = g;
+          hess_[r] = y;
+        }
+      }
+      trees.push_back(GrowTree());
+      double loss = 0.0;
+      for (int i = 0; i < num_candidates; ++i) {
+        double diff = CandidatePrediction(i) - labels_[i];
+        loss += diff * diff;
+      }
+      loss = std::sqrt(loss / num_candidates);
+      if (loss < best_loss) {
+        best_loss = loss;
+        best_rounds = round + 1;
+      } else if (round + 1 - best_rounds >= param_.early_stopping_rounds) {
+        break;
+      }
+    }
+    trees.resize(best_rounds);
+    return trees;
+  }
+
+ private:
+  /*! \brief The sums over the rows of a histogram bin. */
+  struct Bin {
+    double grad = 0.0;
+    double hess = 0.0;
+    int64_t count = 0;
+  };
+
+  /*! \brief The best split of a node on one feature. */
+  struct Split {
+    double gain = 0.0;
+    int bin = -1;
+  };
+
+  /*! \brief A node waiting to be split. */
+  struct PendingNode {
+    int32_t node;
+    int depth;
+    std::vector<int64_t> rows;
+  };
+
+  double CandidatePrediction(int i) const {
+    double sum = 0.0;
+    for (int64_t r = row_ptr_[i]; r < row_ptr_[i + 1]; ++r) {
+      sum += row_pred_[r];
+    }
+    return sum;
+  }
+
+  /*! \brief Run f(feature) for each feature, in parallel when the work is large enough. */
+  template <typename F>
+  void ForEachFeature(int64_t rows_per_feature, const F& f) const {
+    if (param_.num_threads <= 1 || rows_per_feature * num_features_ < kMinParallelWork) {
+      for (int j = 0; j < num_features_; ++j) {
+        f(j);
+      }
+    } else {
+      support::parallel_for_dynamic(0, num_features_, param_.num_threads,
+                                    [&f](int, int j) { f(j); });
+    }
+  }
+
+  /*! \brief Quantize each feature into at most num_bins bins, column major. */
+  void BuildBins() {
+    cuts_.assign(num_features_, std::vector<float>());
+    bins_.resize(static_cast<size_t>(num_rows_) * num_features_);
+    int64_t stride = std::max<int64_t>(1, num_rows_ / kMaxSketchRows);
+    ForEachFeature(num_rows_, [this, stride](int j) {
+      std::vector<float> values;
+      values.reserve(num_rows_ / stride + 1);
+      for (int64_t r = 0; r < num_rows_; r += stride) {
+        values.push_back(features_[r * num_features_ + j]);
+      }
+      std::sort(values.begin(), values.end());
+      std::vector<float> unique_values = values;
+      unique_values.erase(std::unique(unique_values.begin(), unique_values.end()),
+                          unique_values.end());
+      std::vector<float>& cuts = cuts_[j];
+      if (static_cast<int>(unique_values.size()) <= param_.num_bins) {
+        cuts.assign(unique_values.begin(), unique_values.end() - 1);
+      } else {
+        for (int b = 1; b < param_.num_bins; ++b) {
+          cuts.push_back(values[values.size() * b / param_.num_bins]);
+        }
+        cuts.erase(std::unique(cuts.begin(), cuts.end()), cuts.end());
+        if (cuts.back() == values.back()) cuts.pop_back();
+      }
+      uint8_t* column = &bins_[static_cast<size_t>(j) * num_rows_];
+      for (int64_t r = 0; r < num_rows_; ++r) {
+        float v = features_[r * num_features_ + j];
+        column[r] = static_cast<uint8_t>(std::lower_bound(cuts.begin(), cuts.end(), v) -
+                                         cuts.begin());
+      }
+    });
+  }
+
+  /*! \return The best split of the rows on feature j. */
+  Split FindSplit(int j, const std::vector<int64_t>& rows, const Bin& total) const {
+    const std::vector<float>& cuts = cuts_[j];
+    Split best;
+    if (cuts.empty()) return best;
+    Bin hist[kMaxBins];
+    const uint8_t* column = &bins_[static_cast<size_t>(j) * num_rows_];
+    for (int64_t r : rows) {
+      Bin& bin = hist[column[r]];
+      bin.grad += grad_[r];
+      bin.hess += hess_[r];
+      bin.count += 1;
+    }
+    double parent_score = Score(total);
+    Bin left;
+    for (int b = 0; b < static_cast<int>(cuts.size()); ++b) {
+      left.grad += hist[b].grad;
+      left.hess += hist[b].hess;
+      left.count += hist[b].count;
+      Bin right;
+      right.grad = total.grad - left.grad;
+      right.hess = total.hess - left.hess;
+      right.count = total.count - left.count;
+      if (left.count == 0) continue;
+      if (right.count == 0) break;
+      if (left.hess < param_.min_child_weight || right.hess < param_.min_child_weight) continue;
+      double gain = 0.5 * (Score(left) + Score(right) - parent_score) - param_.gamma;
+      if (gain > best.gain) {
+        best.gain = gain;
+        best.bin = b;
+      }
+    }
+    return best;
+  }
+
+  double Score(const Bin& bin) const {
+    return bin.grad * bin.grad / (bin.hess + param_.reg_lambda);
+  }
+
+  /*! \brief Grow a tree depth first and add its output to the row predictions. */
+  GBDTTree GrowTree() {
+    GBDTTree tree;
+    std::vector<PendingNode> stack;
+    std::vector<int64_t> all_rows(num_rows_);
+    for (int64_t r = 0; r < num_rows_; ++r) {
+      all_rows[r] = r;
+    }
+    stack.push_back(PendingNode{tree.AddNode(), 0, std::move(all_rows)});
+    std::vector<Split> splits(num_features_);
+    while (!stack.empty()) {
+      PendingNode pending = std::move(stack.back());
+      stack.pop_back();
+      Bin total;
+      for (int64_t r : pending.rows) {
+        total.grad += grad_[r];
+        total.hess += hess_[r];
+      }
+      total.count = pending.rows.size();
+      int best_feature = -1;
+      if (pending.depth < param_.max_depth && total.count > 1) {
+        const std::vector<int64_t>& rows = pending.rows;
+        ForEachFeature(total.count, [this, &splits, &rows, &total](int j) {
+          splits[j] = FindSplit(j, rows, total);
+        });
+        double best_gain = 0.0;
+        for (int j = 0; j < num_features_; ++j) {
+          if (splits[j].bin >= 0 && splits[j].gain > best_gain) {
+            best_gain = splits[j].gain;
+            best_feature = j;
+          }
+        }
+      }
+      int32_t node = pending.node;
+      if (best_feature < 0) {
+        double value = -total.grad / (total.hess + param_.reg_lambda) * param_.learning_rate;
+        tree.value[node] = static_cast<float>(value);
+        for (int64_t r : pending.rows) {
+          row_pred_[r] += tree.value[node];
+        }
+        continue;
+      }
+      int bin = splits[best_feature].bin;
+      const uint8_t* column = &bins_[static_cast<size_t>(best_feature) * num_rows_];
+      std::vector<int64_t> left_rows, right_rows;
+      for (int64_t r : pending.rows) {
+        (column[r] <= bin ? left_rows : right_rows).push_back(r);
+      }
+      int32_t left = tree.AddNode();
+      int32_t right = tree.AddNode();
+      ICHECK_EQ(right, left + 1);
+      tree.feature[node] = best_feature;
+      tree.threshold[node] = cuts_[best_feature][bin];
+      tree.left[node] = left;
+      int depth = pending.depth + 1;
+      stack.push_back(PendingNode{right, depth, std::move(right_rows)});
+      stack.push_back(PendingNode{left, depth, std::move(left_rows)});
+    }
+    return tree;
+  }
+
+  /*! \brief The maximum number of bins of a feature. */
+  static constexpr int kMaxBins = 256;
+  /*! \brief The number of rows sampled to place the bin boundaries. */
+  static constexpr int64_t kMaxSketchRows = 1 << 16;
+  /*! \brief The number of row visits below which a histogram pass stays on one thread. */
+  static constexpr int64_t kMinParallelWork = 1 << 14;
+
+  const Param& param_;
+  const std::vector<float>& features_;
+  int num_features_;
+  const std::vector<int64_t>& row_ptr_;
+  std::vector<double> labels_;
+  int64_t num_rows_;
+  /*! \brief The bin boundaries of each feature, bin b holds the values in (cuts[b-1], cuts[b]]. */
+  std::vector<std::vector<float>> cuts_;
+  /*! \brief The bin of each row on each feature, column major. */
+  std::vector<uint8_t> bins_;
+  /*! \brief The prediction of each row by the trees grown so far. */
+  std::vector<double> row_pred_;
+  std::vector<double> grad_;
+  std::vector<double> hess_;
+};
+
+/*! \brief A gradient boosted tree cost model trained and evaluated in C++. */
+class GBDTModelNode : public CostModelNode {
+ public:
+  /*! \brief The feature extractor. */
+  FeatureExtractor extractor{nullptr};
+  /*! \brief The maximum depth of a tree. */
+  int max_depth;
+  /*! \brief The number of histogram bins per feature. */
+  int num_bins;
+  /*! \brief The shrinkage applied to each tree. */
+  double learning_rate;
+  /*! \brief The minimum sum of hessians in a child. */
+  double min_child_weight;
+  /*! \brief The L2 regularization on the leaf values. */
+  double reg_lambda;
+  /*! \brief The minimum loss reduction of a split. */
+  double gamma;
+  /*! \brief The maximum number of boosting rounds. */
+  int max_rounds;
+  /*! \brief The number of rounds without improvement before boosting stops. */
+  int early_stopping_rounds;
+  /*! \brief The number of measured samples before the model predicts. */
+  int num_warmup_samples;
+  /*! \brief The random state of the scores returned during warm up. */
+  support::LinearCongruentialEngine::TRandState rand_state;
+
+  void VisitAttrs(tvm::AttrVisitor* v) {
+    v->Visit("extractor", &extractor);
+    v->Visit("max_depth", &max_depth);
+    v->Visit("num_bins", &num_bins);
+    v->Visit("learning_rate", &learning_rate);
+    v->Visit("min_child_weight", &min_child_weight);
+    v->Visit("reg_lambda", &reg_lambda);
+    v->Visit("gamma", &gamma);
+    v->Visit("max_rounds", &max_rounds);
+    v->Visit("early_stopping_rounds", &early_stopping_rounds);
+    v->Visit("num_warmup_samples", &num_warmup_samples);
+    // `rand_state` is not visited
+    // `num_features_`, `features_`, `row_ptr_`, `median_costs_` and `trees_` are not visited
+  }
+
+  void Load(const String& path) final {
+    std::string data;
+    runtime::LoadBinaryFromFile(path, &data);
+    dmlc::MemoryStringStream strm(&data);
+    uint64_t magic = 0;
+    int num_features = -1;
+    std::vector<float> features;
+    std::vector<int64_t> row_ptr;
+    std::vector<double> median_costs;
+    uint64_t num_trees = 0;
+    bool ok = strm.Read(&magic) && magic == kMagic && strm.Read(&num_features) &&
+              strm.Read(&features) && strm.Read(&row_ptr) && strm.Read(&median_costs) &&
+              strm.Read(&num_trees);
+    ok = ok && !row_ptr.empty() && row_ptr.size() == median_costs.size() + 1 &&
+         static_cast<int64_t>(features.size()) == row_ptr.back() * std::max(num_features, 0);
+    std::vector<GBDTTree> trees(ok ? num_trees : 0);
+    for (GBDTTree& tree : trees) {
+      ok = ok && tree.Load(&strm);
+    }
+    CHECK(ok) << "ValueError: Invalid GBDTModel file: " << path;
+    num_features_ = num_features;
+    features_ = std::move(features);
+    row_ptr_ = std::move(row_ptr);
+    median_costs_ = std::move(median_costs);
+    trees_ = std::move(trees);
+  }
+
+  void Save(const String& path) final {
+    std::string data;
+    dmlc::MemoryStringStream strm(&data);
+    uint64_t magic = kMagic;
+    strm.Write(magic);
+    strm.Write(num_features_);
+    strm.Write(features_);
+    strm.Write(row_ptr_);
+    strm.Write(median_costs_);
+    strm.Write(static_cast<uint64_t>(trees_.size()));
+    for (const GBDTTree& tree : trees_) {
+      tree.Save(&strm);
+    }
+    runtime::SaveBinaryToFile(path, data);
+  }
+
+  void Update(const TuneContext& context, const Array<MeasureCandidate>& candidates,
+              const Array<RunnerResult>& results) final {
+    ICHECK_EQ(candidates.size(), results.size());
+    if (candidates.empty()) {
+      return;
+    }
+    Array<runtime::NDArray> features = extractor->ExtractFrom(context, candidates);
+    ICHECK_EQ(features.size(), candidates.size());
+    for (int i = 0, n = candidates.size(); i < n; ++i) {
+      AppendFeatures(features[i], &num_features_, &features_);
+      row_ptr_.push_back(features_.size() / std::max(num_features_, 1));
+      median_costs_.push_back(MedianCost(results[i]));
+    }
+    // Like XGBModel, train from scratch on all the samples measured so far
+    double normalizer = 1.0;
+    double min_cost = std::numeric_limits<double>::infinity();
+    for (double cost : median_costs_) {
+      if (cost > 0) min_cost = std::min(min_cost, cost);
+    }
+    if (std::isfinite(min_cost)) normalizer = min_cost;
+    std::vector<double> labels;
+    labels.reserve(median_costs_.size());
+    for (double cost : median_costs_) {
+      labels.push_back(cost > 0 ? normalizer / cost : 0.0);
+    }
+    GBDTTrainer::Param param{max_depth,        num_bins,   learning_rate,
+                             min_child_weight, reg_lambda, gamma,
+                             max_rounds,       early_stopping_rounds, NumThreads(context)};
+    trees_ = GBDTTrainer(param, features_, num_features_, row_ptr_, std::move(labels)).Train();
+  }
+
+  std::vector<double> Predict(const TuneContext& context,
+                              const Array<MeasureCandidate>& candidates) final {
+    int num_candidates = candidates.size();
+    std::vector<double> result(num_candidates, 0.0);
+    if (trees_.empty() || static_cast<int>(median_costs_.size()) < num_warmup_samples) {
+      support::LinearCongruentialEngine rand_engine(&rand_state);
+      std::uniform_real_distribution<double> dist(0.0, 1.0);
+      for (double& score : result) {
+        score = dist(rand_engine);
+      }
+      return result;
+    }
+    Array<runtime::NDArray> features = extractor->ExtractFrom(context, candidates);
+    ICHECK_EQ(static_cast<int>(features.size()), num_candidates);
+    int num_features = num_features_;
+    std::vector<float> rows;
+    std::vector<int64_t> row_ptr{0};
+    for (const runtime::NDArray& feature : features) {
+      AppendFeatures(feature, &num_features, &rows);
+      row_ptr.push_back(rows.size() / num_features);
+    }
+    // Evaluate tree by tree over a block of rows, so that the nodes of a tree stay in cache
+    int64_t num_rows = row_ptr.back();
+    std::vector<double> row_pred(num_rows, 0.0);
+    int num_blocks = (num_rows + kPredictBlockRows - 1) / kPredictBlockRows;
+    auto f_block = [this, num_rows, num_features, &rows, &row_pred](int, int block) {
+      int64_t begin = static_cast<int64_t>(block) * kPredictBlockRows;
+      int64_t end = std::min(begin + kPredictBlockRows, num_rows);
+      for (const GBDTTree& tree : trees_) {
+        for (int64_t r = begin; r < end; ++r) {
+          row_pred[r] += tree.Predict(&rows[r * num_features]);
+        }
+      }
+    };
+    support::parallel_for_dynamic(0, num_blocks, NumThreads(context), f_block);
+    for (int i = 0; i < num_candidates; ++i) {
+      for (int64_t r = row_ptr[i]; r < row_ptr[i + 1]; ++r) {
+        result[i] += row_pred[r];
+      }
+    }
+    return result;
+  }
+
+  static constexpr const char* _type_key = "meta_schedule.GBDTModel";
+  TVM_DECLARE_FINAL_OBJECT_INFO(GBDTModelNode, CostModelNode);
+
+ private:
+  /*! \brief The magic number of a saved model. */
+  static constexpr uint64_t kMagic = 0x4c444f4d54444247;
+  /*! \brief The number of rows evaluated together during prediction. */
+  static constexpr int64_t kPredictBlockRows = 256;
+
+  static int NumThreads(const TuneContext& context) { return std::max(context->num_threads, 1); }
+
+  /*!
+   * \return The median running time, as XGBModel uses, or 1e10 if the candidate failed to run.
+   */
+  static double MedianCost(const RunnerResult& result) {
+    if (!result->run_secs.defined() || result->run_secs.value().empty()) {
+      return 1e10;
+    }
+    std::vector<double> secs;
+    for (const FloatImm& sec : result->run_secs.value()) {
+      secs.push_back(sec->value);
+    }
+    size_t n = secs.size();
+    std::sort(secs.begin(), secs.end());
+    return n % 2 == 1 ? secs[n / 2] : (secs[n / 2 - 1] + secs[n / 2]) / 2.0;
+  }
+
+  /*!
+   * \brief Append the rows of a feature matrix of shape [n_rows, n_features].
+   * \param feature The feature matrix, float32 or float64 on CPU.
+   * \param num_features The number of features, set from the first matrix when negative.
+   * \param rows The rows to append to.
+   */
+  static void AppendFeatures(const runtime::NDArray& feature, int* num_features,
+                             std::vector<float>* rows) {
+    ICHECK_EQ(feature->ndim, 2) << "ValueError: Expect a feature matrix of 2 dimensions";
+    ICHECK_EQ(feature->device.device_type, kDLCPU);
+    ICHECK(feature.IsContiguous());
+    int64_t n_rows = feature->shape[0];
+    int64_t n_features = feature->shape[1];
+    if (*num_features < 0) {
+      *num_features = n_features;
+    }
+    CHECK_EQ(n_features, *num_features)
+        << "ValueError: The feature extractor returns a different number of features";
+    int64_t size = n_rows * n_features;
+    const DLDataType& dtype = feature->dtype;
+    if (dtype.code == kDLFloat && dtype.bits == 32 && dtype.lanes == 1) {
+      const float* data = static_cast<const float*>(feature->data);
+      rows->insert(rows->end(), data, data + size);
+    } else if (dtype.code == kDLFloat && dtype.bits == 64 && dtype.lanes == 1) {
+      const double* data = static_cast<const double*>(feature->data);
+      rows->insert(rows->end(), data, data + size);
+    } else {
+      LOG(FATAL) << "TypeError: Unsupported feature dtype: " << runtime::DLDataType2String(dtype);
+    }
+  }
+
+  /*! \brief The number of features of a row, -1 before the first update. */
+  int num_features_ = -1;
+  /*! \brief The feature rows of the measured candidates, row major. */
+  std::vector<float> features_;
+  /*! \brief The rows of measured candidate i are [row_ptr_[i], row_ptr_[i + 1]). */
+  std::vector<int64_t> row_ptr_{0};
+  /*! \brief The median running time of each measured candidate. */
+  std::vector<double> median_costs_;
+  /*! \brief The trained trees. */
+  std::vector<GBDTTree> trees_;
+};
+
+CostModel CostModel::GBDTModel(FeatureExtractor extractor, int max_depth, int num_bins,
+                               double learning_rate, double min_child_weight, double reg_lambda,
+                               double gamma, int max_rounds, int early_stopping_rounds,
+                               int num_warmup_samples, int64_t seed) {
+  CHECK_GT(max_depth, 0) << "ValueError: max_depth must be positive";
+  CHECK(num_bins >= 2 && num_bins <= 256) << "ValueError: num_bins must be in [2, 256]";
+  CHECK_GT(max_rounds, 0) << "ValueError: max_rounds must be positive";
+  CHECK_GT(early_stopping_rounds, 0) << "ValueError: early_stopping_rounds must be positive";
+  ObjectPtr<GBDTModelNode> n = make_object<GBDTModelNode>();
+  n->extractor = std::move(extractor);
+  n->max_depth = max_depth;
+  n->num_bins = num_bins;
+  n->learning_rate = learning_rate;
+  n->min_child_weight = min_child_weight;
+  n->reg_lambda = reg_lambda;
+  n->gamma = gamma;
+  n->max_rounds = max_rounds;
+  n->early_stopping_rounds = early_stopping_rounds;
+  n->num_warmup_samples = num_warmup_samples;
+  if (seed == -1) {
+    seed = support::LinearCongruentialEngine::DeviceRandom();
+  }
+  support::LinearCongruentialEngine(&n->rand_state).Seed(seed);
+  return CostModel(n);
+}
+
+TVM_REGISTER_NODE_TYPE(GBDTModelNode);
+TVM_REGISTER_GLOBAL("meta_schedule.CostModelGBDTModel").set_body_typed(CostModel::GBDTModel);
+
+}  // namespace meta_schedule
+}  // namespace tvm
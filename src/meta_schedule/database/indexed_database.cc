@@ -0,0 +1,874 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include "../utils.h"
+
+namespace tvm {
+namespace meta_schedule {
+
+/*!
+ * \brief A read only view of a file from an offset to its end. A whole file is mapped into
+ *  memory where mmap is available, the tail appended to a file is read into a buffer.
+ */
+class FileChunk {
+ public:
+  /*!
+   * \param path The path of the file.
+   * \param offset The offset in the file where the chunk starts.
+   */
+  FileChunk(const std::string& path, int64_t offset) {
+#ifndef _WIN32
+    int fd = open(path.c_str(), O_RDONLY);
+    CHECK_GE(fd, 0) << "ValueError: Cannot open the file to read: " << path;
+    struct stat st;
+    CHECK_EQ(fstat(fd, &st), 0) << "ValueError: Cannot stat the file: " << path;
+    size_ = st.st_size > offset ? static_cast<size_t>(st.st_size - offset) : 0;
+    if (size_ != 0 && offset == 0) {
+      void* addr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      CHECK(addr != MAP_FAILED) << "ValueError: Cannot map the file: " << path;
+      data_ = static_cast<const char*>(addr);
+      mapped_ = true;
+    } else if (size_ != 0) {
+      buffer_.resize(size_);
+      size_t done = 0;
+      while (done < size_) {
+        ssize_t n = pread(fd, &buffer_[done], size_ - done, offset + done);
+        if (n < 0 && errno == EINTR) {
+          continue;
+        }
+        CHECK_GT(n, 0) << "ValueError: Cannot read the file: " << path;
+        done += n;
+      }
+      data_ = buffer_.data();
+    }
+    close(fd);
+#else
+    std::ifstream is(path, std::ios::binary);
+    CHECK(is.good()) << "ValueError: Cannot open the file to read: " << path;
+    is.seekg(offset);
+    buffer_.assign(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+#endif
+  }
+
+  ~FileChunk() {
+#ifndef _WIN32
+    if (mapped_) {
+      munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+  }
+
+  FileChunk(const FileChunk&) = delete;
+  FileChunk& operator=(const FileChunk&) = delete;
+
+  /*! \return The contents of the chunk. */
+  const char* data() const { return data_; }
+  /*! \return The size of the chunk. */
+  size_t size() const { return size_; }
+
+ private:
+  const char* data_{nullptr};
+  size_t size_{0};
+  bool mapped_{false};
+  std::string buffer_;
+};
+
+/*!
+ * \brief An advisory lock on a file shared by the processes using a database, exclusive for
+ *  writers and shared for readers. It meets the requirements of std::lock_guard and
+ *  std::shared_lock.
+ */
+class FileLock {
+ public:
+  FileLock() = default;
+  FileLock(const FileLock&) = delete;
+  FileLock& operator=(const FileLock&) = delete;
+
+  ~FileLock() {
+#ifndef _WIN32
+    if (fd_ >= 0) {
+      close(fd_);
+    }
+#else
+    if (handle_ != INVALID_HANDLE_VALUE) {
+      CloseHandle(handle_);
+    }
+#endif
+  }
+
+  /*! \param path The path of the lock file, created on first use. */
+  void Open(std::string path) { path_ = std::move(path); }
+
+  void lock() { Acquire(true); }
+  void unlock() { Release(); }
+  void lock_shared() { Acquire(false); }
+  void unlock_shared() { Release(); }
+
+ private:
+  void Acquire(bool exclusive) {
+#ifndef _WIN32
+    // A descriptor inherited through fork shares its lock with the parent, so a forked process
+    // opens the file again
+    if (fd_ < 0 || pid_ != getpid()) {
+      if (fd_ >= 0) {
+        close(fd_);
+      }
+      fd_ = open(path_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+      CHECK_GE(fd_, 0) << "ValueError: Cannot open the lock file: " << path_;
+      pid_ = getpid();
+    }
+    while (flock(fd_, exclusive ? LOCK_EX : LOCK_SH) != 0) {
+      CHECK_EQ(errno, EINTR) << "ValueError: Cannot lock the file: " << path_;
+    }
+#else
+    if (handle_ == INVALID_HANDLE_VALUE) {
+      handle_ = CreateFileA(path_.c_str(), GENERIC_READ | GENERIC_WRITE,
+                            FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                            OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+      CHECK(handle_ != INVALID_HANDLE_VALUE) << "ValueError: Cannot open the lock file: " << path_;
+    }
+    OVERLAPPED overlapped = {};
+    CHECK(LockFileEx(handle_, exclusive ? LOCKFILE_EXCLUSIVE_LOCK : 0, 0, MAXDWORD, MAXDWORD,
+                     &overlapped))
+        << "ValueError: Cannot lock the file: " << path_;
+#endif
+  }
+
+  void Release() {
+#ifndef _WIN32
+    flock(fd_, LOCK_UN);
+#else
+    OVERLAPPED overlapped = {};
+    UnlockFileEx(handle_, 0, MAXDWORD, MAXDWORD, &overlapped);
+#endif
+  }
+
+  std::string path_;
+#ifndef _WIN32
+  int fd_{-1};
+  pid_t pid_{-1};
+#else
+  HANDLE handle_{INVALID_HANDLE_VALUE};
+#endif
+};
+
+/*! \brief The header at the start of a segment file. */
+struct SegmentHeader {
+  /*! \brief Identifies a segment file. */
+  uint64_t magic;
+  /*! \brief The version of the format. */
+  uint64_t version;
+  /*! \brief The segments numbered below it are superseded, set by compaction. */
+  uint64_t base;
+  /*! \brief Reserved, zero. */
+  uint64_t reserved;
+};
+
+/*! \brief The header of an entry in a segment, followed by its payload. */
+struct EntryHeader {
+  /*! \brief Whether the entry is a workload or a tuning record. */
+  uint32_t kind;
+  /*! \brief The number of bytes of the payload. */
+  uint32_t payload_size;
+  /*! \brief The structural hash of a workload, or the ordinal of the workload entry of a record. */
+  uint64_t key;
+  /*! \brief The mean running time of a record. */
+  double mean_run_secs;
+  /*! \brief The checksum of the payload, to notice an entry damaged by a crash. */
+  uint64_t checksum;
+};
+
+static_assert(sizeof(SegmentHeader) == 32 && sizeof(EntryHeader) == 32,
+              "The segment format must not depend on padding");
+
+/*!
+ * \brief A database of tuning records stored in append-only binary segments, with the records
+ *  of each workload kept in a sorted index.
+ *
+ *  The file at `path` names the first live segment, and the segments are the files
+ *  `path.<number>`. A segment is a SegmentHeader followed by entries: the workloads as
+ *  SaveJSON of their modules and the records as their JSON. Loading maps the segments and only
+ *  reads the entry headers and the payload of the last entry of a segment, which is the only one
+ *  a crash can damage. A workload or a record is parsed, and its checksum verified, the first
+ *  time it is looked up.
+ *  The binary layout is the one of the host, so the files are not portable across endianness.
+ *
+ *  Several processes may share a database. Writers hold an exclusive lock of `path.lock` while
+ *  they append, and readers a shared one while they index the entries appended since they last
+ *  looked, so the records committed by one process are seen by the others without reloading.
+ *  A workload is written once across the processes, and the entries of a workload committed
+ *  more than once, by writers of an older version, are merged on load.
+ */
+class IndexedDatabaseNode : public DatabaseNode {
+ public:
+  /*! \brief The path of the file naming the live segments. */
+  String path;
+  /*! \brief The size after which appends go to a new segment. */
+  int64_t max_segment_bytes;
+
+  void VisitAttrs(tvm::AttrVisitor* v) {
+    v->Visit("path", &path);
+    v->Visit("max_segment_bytes", &max_segment_bytes);
+    // `segments_` is not visited
+    // `workloads_` is not visited
+    // `ordinal2idx_` is not visited
+    // `shash2idx_` is not visited
+    // `token2idx_` is not visited
+  }
+
+  static constexpr const char* _type_key = "meta_schedule.IndexedDatabase";
+  TVM_DECLARE_FINAL_OBJECT_INFO(IndexedDatabaseNode, DatabaseNode);
+
+ public:
+  bool HasWorkload(const IRModule& mod) final {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Sync();
+    return FindWorkload(mod, tvm::StructuralHash()(mod)) >= 0;
+  }
+
+  Workload CommitWorkload(const IRModule& mod) final {
+    Workload::THashCode shash = tvm::StructuralHash()(mod);
+    std::lock_guard<std::mutex> lock(mutex_);
+    Sync();
+    int idx = FindWorkload(mod, shash);
+    if (idx < 0) {
+      // Only a new workload needs the exclusive lock, under which another process may have
+      // committed it since the look above
+      std::lock_guard<FileLock> file_lock(file_lock_);
+      Refresh();
+      idx = FindWorkload(mod, shash);
+      if (idx < 0) {
+        idx = AddWorkload(Workload(mod, shash));
+      }
+    }
+    return GetWorkload(idx);
+  }
+
+  void CommitTuningRecord(const TuningRecord& record) final {
+    std::string payload = JSONObj2Str(record->AsJSON());
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<FileLock> file_lock(file_lock_);
+    Refresh();
+    int idx = FindWorkload(record->workload);
+    if (idx < 0) {
+      idx = AddWorkload(record->workload);
+    }
+    double mean = SortTuningRecordByMeanRunSecs::Mean(record->run_secs);
+    Append(kRecordEntry, workloads_[idx].ordinal, mean, payload);
+    workloads_[idx].records.emplace(mean, RecordSlot{nullptr, 0, 0, record});
+    ++num_records_;
+  }
+
+  Array<TuningRecord> GetTopK(const Workload& workload, int top_k) final {
+    CHECK_GE(top_k, 0) << "ValueError: top_k must be non-negative";
+    if (top_k == 0) {
+      return {};
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    Sync();
+    int idx = FindWorkload(workload);
+    if (idx < 0) {
+      return {};
+    }
+    std::vector<RecordSlot*> slots;
+    Array<String> unparsed;
+    for (auto& kv : workloads_[idx].records) {
+      RecordSlot& slot = kv.second;
+      if (!slot.record.defined()) {
+        VerifyPayload(slot.payload, slot.payload_size, slot.checksum);
+        unparsed.push_back(String(std::string(slot.payload, slot.payload_size)));
+      }
+      slots.push_back(&slot);
+      if (static_cast<int>(slots.size()) == top_k) {
+        break;
+      }
+    }
+    // Parse the records not looked up before in one batch
+    if (!unparsed.empty()) {
+      Array<ObjectRef> json_objs = JSONStr2Obj(unparsed);
+      Workload owner = GetWorkload(idx);
+      int i = 0;
+      for (RecordSlot* slot : slots) {
+        if (!slot->record.defined()) {
+          slot->record = TuningRecord::FromJSON(json_objs[i++], owner);
+        }
+      }
+    }
+    Array<TuningRecord> results;
+    results.reserve(slots.size());
+    for (RecordSlot* slot : slots) {
+      results.push_back(slot->record.value());
+    }
+    return results;
+  }
+
+  int64_t Size() final {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Sync();
+    return num_records_;
+  }
+
+  /*!
+   * \brief Rewrite the live segments into one, with each workload stored once and its records
+   *  in order.
+   * \param records_per_workload The number of best records to keep for each workload, 0 to keep
+   *  all of them.
+   */
+  void Compact(int records_per_workload) {
+    CHECK_GE(records_per_workload, 0) << "ValueError: records_per_workload must be non-negative";
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<FileLock> file_lock(file_lock_);
+    Refresh();
+    writer_.reset();
+    int64_t new_segment = last_segment_ + 1;
+    std::string tmp_path = SegmentPath(new_segment) + ".tmp";
+    {
+      std::ofstream os(tmp_path, std::ios::binary | std::ios::trunc);
+      CHECK(os.good()) << "ValueError: Cannot open the file to write: " << tmp_path;
+      WriteSegmentHeader(&os, new_segment);
+      for (const WorkloadSlot& slot : workloads_) {
+        WriteEntry(&os, kWorkloadEntry, slot.shash, 0.0, WorkloadPayload(slot));
+      }
+      for (int idx = 0, n = workloads_.size(); idx < n; ++idx) {
+        int count = 0;
+        for (const auto& kv : workloads_[idx].records) {
+          if (records_per_workload != 0 && count++ == records_per_workload) {
+            break;
+          }
+          WriteEntry(&os, kRecordEntry, idx, kv.first, RecordPayload(kv.second));
+        }
+      }
+      os.flush();
+      CHECK(os.good()) << "ValueError: Cannot write the file: " << tmp_path;
+    }
+    CHECK_EQ(std::rename(tmp_path.c_str(), SegmentPath(new_segment).c_str()), 0)
+        << "ValueError: Cannot rename " << tmp_path << " to " << SegmentPath(new_segment);
+    // The new segment supersedes the old ones by its base even if the process dies here
+    int64_t old_first = first_segment_;
+    int64_t old_last = last_segment_;
+    WriteManifest(new_segment);
+    segments_.clear();
+    for (int64_t i = old_first; i <= old_last; ++i) {
+      std::remove(SegmentPath(i).c_str());
+    }
+    Load();
+  }
+
+  /*!
+   * \brief Open the database, called on construction.
+   * \param allow_missing Whether to create the database if it does not exist.
+   */
+  void Open(bool allow_missing) {
+    if (!allow_missing) {
+      CHECK(std::ifstream(path).good()) << "ValueError: File doesn't exist: " << path;
+    }
+    file_lock_.Open(std::string(path) + ".lock");
+    std::lock_guard<FileLock> file_lock(file_lock_);
+    if (!std::ifstream(path).good()) {
+      WriteManifest(0);
+    }
+    Load();
+  }
+
+ private:
+  /*! \brief A tuning record, parsed on first use. */
+  struct RecordSlot {
+    /*! \brief The JSON of the record in a loaded chunk. */
+    const char* payload;
+    /*! \brief The size of the JSON. */
+    uint32_t payload_size;
+    /*! \brief The checksum of the JSON, verified when it is parsed. */
+    uint64_t checksum;
+    /*! \brief The record, if it has been parsed or committed in this process. */
+    Optional<TuningRecord> record;
+  };
+
+  /*! \brief A workload and the index of its records. */
+  struct WorkloadSlot {
+    /*! \brief The structural hash of the module. */
+    Workload::THashCode shash;
+    /*! \brief The ordinal of the entry of the workload, which its records refer to. */
+    int ordinal;
+    /*! \brief The SaveJSON of the module in a loaded chunk. */
+    const char* payload;
+    /*! \brief The size of the JSON. */
+    uint32_t payload_size;
+    /*! \brief The checksum of the JSON, verified when it is parsed. */
+    uint64_t checksum;
+    /*! \brief The workload, if it has been parsed or committed in this process. */
+    Optional<Workload> workload;
+    /*! \brief The records of the workload from the fastest to the slowest. */
+    std::multimap<double, RecordSlot> records;
+  };
+
+  static constexpr uint64_t kMagic = 0x3142444d534d5654;  // "TVMMSDB1"
+  static constexpr uint64_t kVersion = 1;
+  static constexpr uint32_t kWorkloadEntry = 1;
+  static constexpr uint32_t kRecordEntry = 2;
+
+  std::string SegmentPath(int64_t segment) const {
+    return std::string(path) + "." + std::to_string(segment);
+  }
+
+  static int64_t FileSize(const std::string& path) {
+    std::ifstream is(path, std::ios::binary | std::ios::ate);
+    return is.good() ? static_cast<int64_t>(is.tellg()) : -1;
+  }
+
+  /*! \brief What tells a change of a file apart without reading it. */
+  struct FileStamp {
+    /*! \brief The size of the file, -1 if it does not exist. */
+    int64_t size{-1};
+    /*! \brief The time of the last modification. */
+    int64_t mtime{0};
+    /*! \brief The file serial number, which changes when a file is renamed over. */
+    uint64_t inode{0};
+
+    bool operator==(const FileStamp& other) const {
+      return size == other.size && mtime == other.mtime && inode == other.inode;
+    }
+  };
+
+  static FileStamp Stamp(const std::string& path) {
+    FileStamp stamp;
+#ifndef _WIN32
+    struct stat st;
+    if (stat(path.c_str(), &st) == 0) {
+      stamp.size = st.st_size;
+      stamp.mtime = st.st_mtime;
+      stamp.inode = st.st_ino;
+    }
+#else
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &data)) {
+      stamp.size = (static_cast<int64_t>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+      stamp.mtime = (static_cast<int64_t>(data.ftLastWriteTime.dwHighDateTime) << 32) |
+                    data.ftLastWriteTime.dwLowDateTime;
+    }
+#endif
+    return stamp;
+  }
+
+  static uint64_t Checksum(const char* data, size_t size) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < size; ++i) {
+      hash = (hash ^ static_cast<unsigned char>(data[i])) * 0x100000001b3ULL;
+    }
+    return hash;
+  }
+
+  int64_t ReadManifest() const {
+    std::ifstream is(path);
+    int64_t first = 0;
+    CHECK(is.good() && (is >> first) && first >= 0) << "ValueError: Invalid database: " << path;
+    return first;
+  }
+
+  void WriteManifest(int64_t first) {
+    std::string tmp_path = std::string(path) + ".tmp";
+    {
+      std::ofstream os(tmp_path, std::ios::trunc);
+      os << first << std::endl;
+      CHECK(os.good()) << "ValueError: Cannot write the file: " << tmp_path;
+    }
+#ifdef _WIN32
+    // rename does not replace an existing file on Windows
+    std::remove(std::string(path).c_str());
+#endif
+    CHECK_EQ(std::rename(tmp_path.c_str(), std::string(path).c_str()), 0)
+        << "ValueError: Cannot rename " << tmp_path << " to " << path;
+  }
+
+  /*!
+   * \brief Read the header of a segment.
+   * \return Whether the segment exists.
+   */
+  bool ReadSegmentHeader(int64_t segment, SegmentHeader* header) const {
+    std::ifstream is(SegmentPath(segment), std::ios::binary);
+    if (!is.good()) {
+      return false;
+    }
+    if (!is.read(reinterpret_cast<char*>(header), sizeof(*header)) || header->magic != kMagic) {
+      LOG(FATAL) << "ValueError: Invalid segment: " << SegmentPath(segment);
+    }
+    CHECK(header->version == kVersion) << "ValueError: Unsupported segment version "
+                                       << header->version << ": " << SegmentPath(segment);
+    return true;
+  }
+
+  static void WriteSegmentHeader(std::ostream* os, int64_t base) {
+    SegmentHeader header;
+    header.magic = kMagic;
+    header.version = kVersion;
+    header.base = base;
+    header.reserved = 0;
+    os->write(reinterpret_cast<const char*>(&header), sizeof(header));
+  }
+
+  static int64_t WriteEntry(std::ostream* os, uint32_t kind, uint64_t key, double mean_run_secs,
+                            const std::string& payload) {
+    CHECK_LE(payload.size(), std::numeric_limits<uint32_t>::max())
+        << "ValueError: The entry is too large to store: " << payload.size() << " bytes";
+    EntryHeader header;
+    header.kind = kind;
+    header.payload_size = static_cast<uint32_t>(payload.size());
+    header.key = key;
+    header.mean_run_secs = mean_run_secs;
+    header.checksum = Checksum(payload.data(), payload.size());
+    os->write(reinterpret_cast<const char*>(&header), sizeof(header));
+    os->write(payload.data(), payload.size());
+    return sizeof(header) + payload.size();
+  }
+
+  /*! \brief Load the live segments, called on opening, after compaction, and when another
+   *  process compacted the database. Needs the file lock. */
+  void Load() {
+    segments_.clear();
+    workloads_.clear();
+    ordinal2idx_.clear();
+    shash2idx_.clear();
+    token2idx_.clear();
+    writer_.reset();
+    num_records_ = 0;
+    manifest_first_ = ReadManifest();
+    // A compacted segment supersedes the segments before it, which may still exist if the
+    // process died before removing them
+    std::vector<std::pair<int64_t, SegmentHeader>> found;
+    SegmentHeader header;
+    for (int64_t i = manifest_first_; ReadSegmentHeader(i, &header); ++i) {
+      found.emplace_back(i, header);
+    }
+    int64_t base = manifest_first_;
+    for (const auto& kv : found) {
+      base = std::max(base, static_cast<int64_t>(kv.second.base));
+    }
+    first_segment_ = base;
+    last_segment_ = base - 1;
+    last_segment_size_ = 0;
+    for (const auto& kv : found) {
+      if (kv.first >= base) {
+        last_segment_ = kv.first;
+        last_segment_size_ = LoadSegment(kv.first, 0);
+      }
+    }
+    UpdateStamps();
+  }
+
+  /*! \brief Index the entries appended by other processes since the last look. Needs the file
+   *  lock. */
+  void Refresh() {
+    // Appends grow the last segment or start the next one, and a compaction renames the manifest
+    // and removes the old segments, so files which look unchanged hold nothing new
+    if (Stamp(path) == manifest_stamp_ &&
+        Stamp(SegmentPath(last_segment_)) == last_segment_stamp_ &&
+        Stamp(SegmentPath(last_segment_ + 1)).size < 0) {
+      return;
+    }
+    if (ReadManifest() != manifest_first_) {
+      Load();
+      return;
+    }
+    if (last_segment_ >= first_segment_ && last_segment_size_ >= 0 &&
+        FileSize(SegmentPath(last_segment_)) > last_segment_size_) {
+      last_segment_size_ = LoadSegment(last_segment_, last_segment_size_);
+    }
+    SegmentHeader header;
+    while (ReadSegmentHeader(last_segment_ + 1, &header)) {
+      if (static_cast<int64_t>(header.base) > first_segment_) {
+        // Compacted by a process which died before naming the new segment in the manifest
+        Load();
+        return;
+      }
+      ++last_segment_;
+      last_segment_size_ = LoadSegment(last_segment_, 0);
+    }
+    UpdateStamps();
+  }
+
+  /*! \brief Remember how the manifest and the last segment looked when they were indexed. */
+  void UpdateStamps() {
+    manifest_stamp_ = Stamp(path);
+    last_segment_stamp_ = Stamp(SegmentPath(last_segment_));
+  }
+
+  /*! \brief Refresh under a shared lock of the file. */
+  void Sync() {
+    std::shared_lock<FileLock> file_lock(file_lock_);
+    Refresh();
+  }
+
+  /*!
+   * \brief Index the entries of a segment from an offset to its end.
+   * \return The size of the segment up to the end of its valid entries, or -1 if an entry cut
+   *  short by a crash ends the segment.
+   */
+  int64_t LoadSegment(int64_t segment, int64_t begin) {
+    segments_.emplace_back(new FileChunk(SegmentPath(segment), begin));
+    const FileChunk& chunk = *segments_.back();
+    size_t start = begin == 0 ? sizeof(SegmentHeader) : 0;
+    // Find the end of the whole entries by their headers only
+    size_t end = start;
+    size_t last = start;
+    while (end + sizeof(EntryHeader) <= chunk.size()) {
+      EntryHeader header;
+      std::memcpy(&header, chunk.data() + end, sizeof(header));
+      if ((header.kind != kWorkloadEntry && header.kind != kRecordEntry) ||
+          header.payload_size > chunk.size() - end - sizeof(header)) {
+        break;
+      }
+      last = end;
+      end += sizeof(header) + header.payload_size;
+    }
+    // Appends are sequential, so a crash can only damage the last entry, the checksums of the
+    // others are verified when they are parsed
+    if (end != start) {
+      EntryHeader header;
+      std::memcpy(&header, chunk.data() + last, sizeof(header));
+      if (header.checksum != Checksum(chunk.data() + last + sizeof(header), header.payload_size)) {
+        end = last;
+      }
+    }
+    for (size_t offset = start; offset < end;) {
+      EntryHeader header;
+      std::memcpy(&header, chunk.data() + offset, sizeof(header));
+      const char* payload = chunk.data() + offset + sizeof(header);
+      if (header.kind == kWorkloadEntry) {
+        int ordinal = ordinal2idx_.size();
+        int idx = workloads_.size();
+        workloads_.push_back(WorkloadSlot{header.key, ordinal, payload, header.payload_size,
+                                          header.checksum, NullOpt, {}});
+        // Only a workload whose hash is already known is parsed, to merge it with an equal one
+        int same = shash2idx_.count(header.key) ? FindWorkload(GetWorkload(idx)->mod, header.key)
+                                                : -1;
+        if (same >= 0) {
+          token2idx_.erase(workloads_.back().workload.get());
+          workloads_.pop_back();
+          idx = same;
+        } else {
+          shash2idx_.emplace(header.key, idx);
+        }
+        ordinal2idx_.push_back(idx);
+      } else {
+        CHECK_LT(header.key, ordinal2idx_.size())
+            << "ValueError: A record refers to a missing workload in " << SegmentPath(segment);
+        workloads_[ordinal2idx_[header.key]].records.emplace(
+            header.mean_run_secs,
+            RecordSlot{payload, header.payload_size, header.checksum, NullOpt});
+        ++num_records_;
+      }
+      offset += sizeof(header) + header.payload_size;
+    }
+    // Entries are only read under the file lock, so a partial one was left by a crash
+    if (end != chunk.size()) {
+      LOG(WARNING) << "Ignoring the incomplete tail of " << SegmentPath(segment) << " at byte "
+                   << begin + end;
+      return -1;
+    }
+    return begin + end;
+  }
+
+  /*!
+   * \brief Append an entry to the last segment, starting a new one when it is full. Needs the
+   *  exclusive file lock and a refresh.
+   */
+  void Append(uint32_t kind, uint64_t key, double mean_run_secs, const std::string& payload) {
+    int64_t entry_size = sizeof(EntryHeader) + payload.size();
+    bool full = last_segment_size_ > static_cast<int64_t>(sizeof(SegmentHeader)) &&
+                last_segment_size_ + entry_size > max_segment_bytes;
+    // A segment with a damaged tail is never appended to
+    if (last_segment_ < first_segment_ || last_segment_size_ < 0 || full) {
+      writer_.reset();
+      ++last_segment_;
+      // Renamed into place, so that a segment file always starts with a whole header
+      std::string tmp_path = SegmentPath(last_segment_) + ".tmp";
+      {
+        std::ofstream os(tmp_path, std::ios::binary | std::ios::trunc);
+        WriteSegmentHeader(&os, first_segment_);
+        os.flush();
+        CHECK(os.good()) << "ValueError: Cannot write the file: " << tmp_path;
+      }
+      CHECK_EQ(std::rename(tmp_path.c_str(), SegmentPath(last_segment_).c_str()), 0)
+          << "ValueError: Cannot rename " << tmp_path << " to " << SegmentPath(last_segment_);
+      last_segment_size_ = sizeof(SegmentHeader);
+    }
+    // Another process may have started the last segment
+    if (writer_ == nullptr || writer_segment_ != last_segment_) {
+      writer_ = std::make_unique<std::ofstream>(SegmentPath(last_segment_),
+                                                std::ios::binary | std::ios::app);
+      CHECK(writer_->good()) << "ValueError: Cannot open the file to write: "
+                             << SegmentPath(last_segment_);
+      writer_segment_ = last_segment_;
+    }
+    last_segment_size_ += WriteEntry(writer_.get(), kind, key, mean_run_secs, payload);
+    writer_->flush();
+    CHECK(writer_->good()) << "ValueError: Cannot write the file: " << SegmentPath(last_segment_);
+  }
+
+  int AddWorkload(const Workload& workload) {
+    int ordinal = ordinal2idx_.size();
+    int idx = workloads_.size();
+    Append(kWorkloadEntry, workload->shash, 0.0, SaveJSON(workload->mod));
+    workloads_.push_back(WorkloadSlot{workload->shash, ordinal, nullptr, 0, 0, workload, {}});
+    ordinal2idx_.push_back(idx);
+    shash2idx_.emplace(workload->shash, idx);
+    token2idx_.emplace(workload.get(), idx);
+    return idx;
+  }
+  /*! \return The workload at the index, parsed on first use. */
+  Workload GetWorkload(int idx) {
+    WorkloadSlot& slot = workloads_[idx];
+    if (!slot.workload.defined()) {
+      VerifyPayload(slot.payload, slot.payload_size, slot.checksum);
+      IRModule mod = Downcast<IRModule>(LoadJSON(std::string(slot.payload, slot.payload_size)));
+      Workload::THashCode shash = tvm::StructuralHash()(mod);
+      CHECK_EQ(shash, slot.shash) << "ValueError: Structural hash changed. Given: "
+                                  << SHash2Str(slot.shash)
+                                  << "; Recalculated: " << SHash2Str(shash);
+      slot.workload = Workload(mod, shash);
+      token2idx_.emplace(slot.workload.get(), idx);
+    }
+    return slot.workload.value();
+  }
+
+  /*! \return The index of the workload of the module, or -1 if there is none. */
+  int FindWorkload(const IRModule& mod, Workload::THashCode shash) {
+    auto range = shash2idx_.equal_range(shash);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (tvm::StructuralEqual()(GetWorkload(it->second)->mod, mod)) {
+        return it->second;
+      }
+    }
+    return -1;
+  }
+
+  /*! \return The index of the workload, or -1 if there is none. */
+  int FindWorkload(const Workload& workload) {
+    // The workloads handed out by this database are found without comparing modules
+    auto it = token2idx_.find(workload.get());
+    if (it != token2idx_.end()) {
+      return it->second;
+    }
+    return FindWorkload(workload->mod, workload->shash);
+  }
+
+  /*! \brief Check that a payload in a loaded chunk was not damaged since it was written. */
+  void VerifyPayload(const char* payload, uint32_t payload_size, uint64_t checksum) const {
+    CHECK_EQ(Checksum(payload, payload_size), checksum)
+        << "ValueError: A damaged entry in the database " << path
+        << " does not match its checksum";
+  }
+
+  std::string WorkloadPayload(const WorkloadSlot& slot) const {
+    if (slot.payload != nullptr) {
+      VerifyPayload(slot.payload, slot.payload_size, slot.checksum);
+      return std::string(slot.payload, slot.payload_size);
+    }
+    return SaveJSON(slot.workload.value()->mod);
+  }
+
+  std::string RecordPayload(const RecordSlot& slot) const {
+    if (slot.payload != nullptr) {
+      VerifyPayload(slot.payload, slot.payload_size, slot.checksum);
+      return std::string(slot.payload, slot.payload_size);
+    }
+    return JSONObj2Str(slot.record.value()->AsJSON());
+  }
+
+  /*! \brief Guards all the state below. */
+  std::mutex mutex_;
+  /*! \brief Orders the accesses to the files across processes, taken after mutex_. */
+  FileLock file_lock_;
+  /*! \brief The loaded chunks of the live segments, which the unparsed payloads point into. */
+  std::vector<std::unique_ptr<FileChunk>> segments_;
+  /*! \brief The distinct workloads in the order they were committed. */
+  std::vector<WorkloadSlot> workloads_;
+  /*! \brief The indices of the workloads by the ordinals of their entries. */
+  std::vector<int> ordinal2idx_;
+  /*! \brief The indices of the workloads by structural hash. */
+  std::unordered_multimap<Workload::THashCode, int> shash2idx_;
+  /*! \brief The indices of the workload objects handed out, which the slots keep alive. */
+  std::unordered_map<const Object*, int> token2idx_;
+  /*! \brief The number of records. */
+  int64_t num_records_{0};
+  /*! \brief The first live segment named by the manifest when it was last read. */
+  int64_t manifest_first_{0};
+  /*! \brief The number of the first live segment. */
+  int64_t first_segment_{0};
+  /*! \brief The number of the last segment, first_segment_ - 1 if there is none. */
+  int64_t last_segment_{-1};
+  /*! \brief The size of the last segment indexed so far, -1 if its tail is damaged. */
+  int64_t last_segment_size_{0};
+  /*! \brief The manifest when it was last read. */
+  FileStamp manifest_stamp_;
+  /*! \brief The last segment when it was last indexed. */
+  FileStamp last_segment_stamp_;
+  /*! \brief The stream appending to a segment. */
+  std::unique_ptr<std::ofstream> writer_;
+  /*! \brief The segment writer_ appends to. */
+  int64_t writer_segment_{-1};
+};
+
+Database Database::IndexedDatabase(String path, bool allow_missing, int64_t max_segment_bytes) {
+  CHECK_GT(max_segment_bytes, 0) << "ValueError: max_segment_bytes must be positive";
+  ObjectPtr<IndexedDatabaseNode> n = make_object<IndexedDatabaseNode>();
+  n->path = path;
+  n->max_segment_bytes = max_segment_bytes;
+  n->Open(allow_missing);
+  return Database(n);
+}
+
+TVM_REGISTER_NODE_TYPE(IndexedDatabaseNode);
+TVM_REGISTER_GLOBAL("meta_schedule.DatabaseIndexedDatabase")
+    .set_body_typed(Database::IndexedDatabase);
+TVM_REGISTER_GLOBAL("meta_schedule.IndexedDatabaseCompact")
+    .set_body_typed([](Database database, int records_per_workload) {
+      IndexedDatabaseNode* self = const_cast<IndexedDatabaseNode*>(
+          database.as<IndexedDatabaseNode>());
+      CHECK(self) << "TypeError: Expect IndexedDatabase, but gets: " << database->GetTypeKey();
+      self->Compact(records_per_workload);
+    });
+
+}  // namespace meta_schedule
+}  // namespace tvm
@@ -18,8 +18,11 @@
  */
 #include <tvm/tir/transform.h>
 
+#include <atomic>
 #include <cmath>
+#include <list>
 #include <memory>
+#include <mutex>
 #include <numeric>
 #include <unordered_map>
 #include <unordered_set>
@@ -1277,18 +1280,128 @@ class PerStoreFeatureCollector : private StmtVisitor {
 namespace tvm {
 namespace meta_schedule {
 
+/*!
+ * \brief A bounded cache of the features of recently extracted modules, keyed by structural hash.
+ *  Evolutionary search scores the surviving schedules again in every generation, and the cost
+ *  model extracts each measured candidate once more when it updates, so most extractions repeat
+ *  a module which has been lowered and walked before.
+ */
+class PerStoreFeatureCache {
+ public:
+  /*! \param capacity The maximum number of modules cached. */
+  explicit PerStoreFeatureCache(int capacity)
+      : shard_capacity_(std::max<size_t>(1, (capacity + kNumShards - 1) / kNumShards)) {}
+
+  /*!
+   * \brief Look up the features of a module.
+   * \param mod The module.
+   * \param shash The structural hash of the module.
+   * \param is_gpu Whether the features are extracted for a GPU target.
+   * \return The features, or an undefined NDArray if the module is not cached.
+   */
+  runtime::NDArray Get(const IRModule& mod, size_t shash, bool is_gpu) {
+    Shard& shard = shards_[shash % kNumShards];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto range = shard.index.equal_range(shash);
+    for (auto it = range.first; it != range.second; ++it) {
+      const Entry& entry = *it->second;
+      if (entry.is_gpu == is_gpu && StructuralEqual()(entry.mod, mod)) {
+        shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        return entry.features;
+      }
+    }
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    return runtime::NDArray(nullptr);
+  }
+
+  /*!
+   * \brief Cache the features of a module, evicting the least recently used module when full.
+   * \param mod The module.
+   * \param shash The structural hash of the module.
+   * \param is_gpu Whether the features are extracted for a GPU target.
+   * \param features The features of the module.
+   */
+  void Put(IRModule mod, size_t shash, bool is_gpu, runtime::NDArray features) {
+    Shard& shard = shards_[shash % kNumShards];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto range = shard.index.equal_range(shash);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second->is_gpu == is_gpu && StructuralEqual()(it->second->mod, mod)) {
+        return;
+      }
+    }
+    shard.entries.push_front(Entry{shash, is_gpu, std::move(mod), std::move(features)});
+    shard.index.emplace(shash, shard.entries.begin());
+    if (shard.entries.size() > shard_capacity_) {
+      auto last = std::prev(shard.entries.end());
+      auto victims = shard.index.equal_range(last->shash);
+      for (auto it = victims.first; it != victims.second; ++it) {
+        if (it->second == last) {
+          shard.index.erase(it);
+          break;
+        }
+      }
+      shard.entries.pop_back();
+    }
+  }
+
+  /*! \return The number of cached modules. */
+  int64_t Size() {
+    int64_t size = 0;
+    for (Shard& shard : shards_) {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      size += shard.entries.size();
+    }
+    return size;
+  }
+
+  /*! \return The number of lookups which found the module. */
+  int64_t Hits() const { return hits_.load(std::memory_order_relaxed); }
+  /*! \return The number of lookups which missed. */
+  int64_t Misses() const { return misses_.load(std::memory_order_relaxed); }
+
+ private:
+  struct Entry {
+    size_t shash;
+    bool is_gpu;
+    IRModule mod;
+    runtime::NDArray features;
+  };
+
+  /*! \brief A part of the cache behind its own lock, in the order of last use. */
+  struct Shard {
+    std::mutex mutex;
+    std::list<Entry> entries;
+    std::unordered_multimap<size_t, std::list<Entry>::iterator> index;
+  };
+
+  /*! \brief The number of shards, so that the extraction threads rarely wait on each other. */
+  static constexpr size_t kNumShards = 16;
+
+  size_t shard_capacity_;
+  Shard shards_[kNumShards];
+  std::atomic<int64_t> hits_{0};
+  std::atomic<int64_t> misses_{0};
+};
+
 class PerStoreFeatureNode : public FeatureExtractorNode {
  public:
   int buffers_per_store;
   int arith_intensity_curve_num_samples;
   int cache_line_bytes;
   int feature_vector_length;
+  int feature_cache_size;
+  /*! \brief The features of recently extracted modules, null if caching is disabled. */
+  std::unique_ptr<PerStoreFeatureCache> cache;
 
   void VisitAttrs(tvm::AttrVisitor* v) {
     v->Visit("buffers_per_store", &buffers_per_store);
     v->Visit("arith_intensity_curve_num_samples", &arith_intensity_curve_num_samples);
     v->Visit("cache_line_bytes", &cache_line_bytes);
     v->Visit("feature_vector_length", &feature_vector_length);
+    v->Visit("feature_cache_size", &feature_cache_size);
+    // `cache` is not visited
   }
 
   void ExtractSingle(IRModule mod, bool is_gpu, std::vector<std::vector<double>>* results) {
@@ -1318,9 +1431,22 @@ class PerStoreFeatureNode : public FeatureExtractorNode {
     results.resize(candidates.size());
     auto f = [this, is_gpu, &candidates, &results](int, int task_id) -> void {
       const auto& candidate = candidates[task_id];
+      IRModule mod = candidate->sch->mod();
+      size_t shash = 0;
+      if (cache != nullptr) {
+        shash = StructuralHash()(mod);
+        runtime::NDArray cached = cache->Get(mod, shash, is_gpu);
+        if (cached.defined()) {
+          results[task_id] = cached;
+          return;
+        }
+      }
       std::vector<std::vector<double>> features;
-      ExtractSingle(DeepCopyIRModule(candidate->sch->mod()), is_gpu, &features);
+      ExtractSingle(DeepCopyIRModule(mod), is_gpu, &features);
       results[task_id] = tir::utils::AsNDArray(features);
+      if (cache != nullptr) {
+        cache->Put(mod, shash, is_gpu, results[task_id]);
+      }
     };
     support::parallel_for_dynamic(0, candidates.size(), tune_context->num_threads, f);
     return results;
@@ -1332,11 +1458,16 @@ class PerStoreFeatureNode : public FeatureExtractorNode {
 
 FeatureExtractor FeatureExtractor::PerStoreFeature(int buffers_per_store,
                                                    int arith_intensity_curve_num_samples,
-                                                   int cache_line_bytes) {
+                                                   int cache_line_bytes,
+                                                   int feature_cache_size) {
   ObjectPtr<PerStoreFeatureNode> n = make_object<PerStoreFeatureNode>();
   n->buffers_per_store = buffers_per_store;
   n->arith_intensity_curve_num_samples = arith_intensity_curve_num_samples;
   n->cache_line_bytes = cache_line_bytes;
+  n->feature_cache_size = feature_cache_size;
+  if (feature_cache_size > 0) {
+    n->cache = std::make_unique<PerStoreFeatureCache>(feature_cache_size);
+  }
   n->feature_vector_length = tir::group1::Feature::kCount +                                  //
                              tir::group2::Feature::SubFeature::kCount * buffers_per_store +  //
                              arith_intensity_curve_num_samples +                             //
@@ -1348,6 +1479,18 @@ FeatureExtractor FeatureExtractor::PerStoreFeature(int buffers_per_store,
 TVM_REGISTER_NODE_TYPE(PerStoreFeatureNode);
 TVM_REGISTER_GLOBAL("meta_schedule.FeatureExtractorPerStoreFeature")
     .set_body_typed(FeatureExtractor::PerStoreFeature);
+TVM_REGISTER_GLOBAL("meta_schedule.FeatureExtractorPerStoreFeatureCacheStats")
+    .set_body_typed([](FeatureExtractor extractor) -> Map<String, Integer> {
+      const auto* self = extractor.as<PerStoreFeatureNode>();
+      ICHECK(self) << "TypeError: Expect PerStoreFeature, but gets: " << extractor->GetTypeKey();
+      Map<String, Integer> stats;
+      if (self->cache != nullptr) {
+        stats.Set("hits", Integer(self->cache->Hits()));
+        stats.Set("misses", Integer(self->cache->Misses()));
+        stats.Set("size", Integer(self->cache->Size()));
+      }
+      return stats;
+    });
 
 }  // namespace meta_schedule
 }  // namespace tvm
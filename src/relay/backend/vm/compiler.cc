@@ -87,6 +87,8 @@ using namespace relay::transform;
 /*! \brief The host device is always stored at device index 0. */
 constexpr Index kHostDeviceIndex = 0;
 
+TVM_REGISTER_PASS_CONFIG_OPTION("relay.vm.plan_static_arena", Bool);
+
 // (@jroesch): VM passes, eventually declare as passes.
 bool IsClosure(const Function& func);
 
@@ -888,6 +890,8 @@ void VMCompiler::Lower(IRModule mod, TargetMap targets, tvm::Target target_host)
   // the global state.
   exec_->functions.resize(num_functions);
 
+  bool plan_static_arena =
+      PassContext::Current()->GetConfig<Bool>("relay.vm.plan_static_arena", Bool(false)).value();
   for (const auto& pair : context_.module->functions) {
     auto gvar = pair.first;
     if (auto* n = pair.second.as<FunctionNode>()) {
@@ -898,6 +902,9 @@ void VMCompiler::Lower(IRModule mod, TargetMap targets, tvm::Target target_host)
       auto func = GetRef<Function>(n);
       VMFunctionCompiler func_compiler(&context_, config_->host_virtual_device);
       auto vm_func = func_compiler.Compile(gvar, func);
+      if (plan_static_arena) {
+        PlanStaticArenas(&vm_func, context_);
+      }
 
       size_t func_index = context_.global_map.at(gvar);
       ICHECK(func_index < exec_->functions.size());
@@ -84,6 +84,15 @@ struct VMCompilerContext {
   std::vector<VirtualDevice> virtual_devices_;
 };
 
+/*!
+ * \brief Plan the storages of a compiled function whose size is known at compile time and which
+ *  do not escape the function into per-device arenas with fixed offsets, so that the VM allocates
+ *  a single arena per device on function entry instead of allocating every storage.
+ * \param func The compiled VM function, updated in place.
+ * \param context The compiler context holding the constants and devices of the function.
+ */
+void PlanStaticArenas(VMFunction* func, const VMCompilerContext& context);
+
 class VMCompiler : public runtime::ModuleNode {
  public:
   VMCompiler() = default;
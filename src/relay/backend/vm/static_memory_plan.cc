@@ -0,0 +1,306 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/relay/backend/vm/static_memory_plan.cc
+ * \brief Plan the statically sized storages of a compiled VM function into per-device arenas.
+ *
+ * The storages produced by memory lowering are allocated one by one at runtime. When the size of
+ * a storage is a compile time constant and neither the storage nor any tensor carved out of it
+ * escapes the function, its lifetime is fully described by the bytecode: from its allocation to
+ * the last instruction reading one of its registers (which is where ManifestLifetimes places the
+ * kill). Since the VM only emits forward jumps, two storages whose [alloc, last use] intervals are
+ * disjoint in program order are never live at the same time and can share memory. We assign each
+ * such storage a fixed offset in an arena per device, and the VM allocates the arena once per
+ * frame instead of allocating every storage.
+ */
+
+#include <tvm/runtime/device_api.h>
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+#include "compiler.h"
+
+namespace tvm {
+namespace relay {
+namespace vm {
+
+namespace {
+
+/*! \brief A storage which is a candidate for the static plan. */
+struct StorageGroup {
+  /*! \brief The index of the AllocStorage instruction. */
+  Index alloc_pc;
+  /*! \brief The last instruction reading a register of the group. */
+  Index last_use_pc;
+  /*! \brief The size of the storage in bytes. */
+  int64_t size;
+  /*! \brief The alignment of the storage. */
+  int64_t alignment;
+  /*! \brief The device index of the storage. */
+  Index device_index;
+  /*! \brief Whether the storage or a tensor in it escapes the function. */
+  bool escapes{false};
+};
+
+/*! \brief Whether a device can address into a buffer by offsetting its data pointer. */
+bool SupportsPointerArithmetic(DLDeviceType device_type) {
+  switch (device_type) {
+    case kDLCPU:
+    case kDLCUDA:
+    case kDLCUDAHost:
+    case kDLCUDAManaged:
+    case kDLROCM:
+    case kDLROCMHost:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/*!
+ * \brief Call f(reg, escapes) for every register read by instr, where escapes tells whether the
+ *  value read may outlive the frame (returned, moved, captured or passed to another function).
+ */
+template <typename F>
+void ForEachRead(const Instruction& instr, F f) {
+  switch (instr.op) {
+    case Opcode::Move:
+      f(instr.from, true);
+      break;
+    case Opcode::Ret:
+      f(instr.result, true);
+      break;
+    case Opcode::Invoke:
+      for (Index i = 0; i < instr.num_args; ++i) f(instr.invoke_args_registers[i], true);
+      break;
+    case Opcode::InvokeClosure:
+      f(instr.closure, true);
+      for (Index i = 0; i < instr.num_closure_args; ++i) f(instr.closure_args[i], true);
+      break;
+    case Opcode::InvokePacked:
+      for (Index i = 0; i < instr.arity; ++i) f(instr.packed_args[i], false);
+      break;
+    case Opcode::AllocTensor:
+      f(instr.alloc_tensor.storage, false);
+      break;
+    case Opcode::AllocTensorReg:
+      f(instr.alloc_tensor_reg.storage, false);
+      f(instr.alloc_tensor_reg.shape_register, false);
+      break;
+    case Opcode::AllocADT:
+      for (Index i = 0; i < instr.num_fields; ++i) f(instr.datatype_fields[i], true);
+      break;
+    case Opcode::AllocClosure:
+      for (Index i = 0; i < instr.num_freevar; ++i) f(instr.free_vars[i], true);
+      break;
+    case Opcode::GetField:
+      f(instr.object, false);
+      break;
+    case Opcode::GetTag:
+      f(instr.get_tag.object, false);
+      break;
+    case Opcode::If:
+      f(instr.if_op.test, false);
+      f(instr.if_op.target, false);
+      break;
+    case Opcode::AllocStorage:
+      f(instr.alloc_storage.allocation_size, false);
+      break;
+    case Opcode::ShapeOf:
+      f(instr.shape_of.tensor, false);
+      break;
+    case Opcode::ReshapeTensor:
+      f(instr.reshape_tensor.tensor, false);
+      f(instr.reshape_tensor.newshape, false);
+      break;
+    case Opcode::DeviceCopy:
+      f(instr.device_copy.src, false);
+      break;
+    case Opcode::KillRegister:
+      f(instr.dst, false);
+      break;
+    case Opcode::LoadConst:
+    case Opcode::LoadConsti:
+    case Opcode::Goto:
+    case Opcode::Fatal:
+      break;
+  }
+}
+
+/*! \brief Whether instr writes its dst register. */
+bool WritesDst(const Instruction& instr) {
+  switch (instr.op) {
+    case Opcode::Ret:
+    case Opcode::InvokePacked:
+    case Opcode::If:
+    case Opcode::Goto:
+    case Opcode::Fatal:
+    case Opcode::KillRegister:
+      return false;
+    default:
+      return true;
+  }
+}
+
+/*! \brief Get the value of a constant if it is an integer scalar. */
+bool GetConstantSize(const NDArray& constant, int64_t* size) {
+  if (constant->ndim != 0 || constant->device.device_type != kDLCPU ||
+      constant->dtype.code != kDLInt || constant->dtype.lanes != 1) {
+    return false;
+  }
+  if (constant->dtype.bits == 64) {
+    *size = static_cast<const int64_t*>(constant->data)[0];
+  } else if (constant->dtype.bits == 32) {
+    *size = static_cast<const int32_t*>(constant->data)[0];
+  } else {
+    return false;
+  }
+  return *size >= 0;
+}
+
+}  // namespace
+
+void PlanStaticArenas(VMFunction* func, const VMCompilerContext& context) {
+  const std::vector<Instruction>& code = func->instructions;
+
+  std::unordered_map<RegName, int> num_defs;
+  std::unordered_map<RegName, Index> const_index_of;
+  for (const Instruction& instr : code) {
+    if (!WritesDst(instr)) continue;
+    num_defs[instr.dst]++;
+    if (instr.op == Opcode::LoadConst) const_index_of[instr.dst] = instr.const_index;
+  }
+  auto single_def = [&num_defs](RegName reg) {
+    auto it = num_defs.find(reg);
+    return it != num_defs.end() && it->second == 1;
+  };
+
+  // Find the candidate storages and the registers aliasing their memory.
+  std::vector<StorageGroup> groups;
+  std::unordered_map<RegName, size_t> group_of;
+  for (Index pc = 0; pc < static_cast<Index>(code.size()); ++pc) {
+    const Instruction& instr = code[pc];
+    RegName src = -1;
+    switch (instr.op) {
+      case Opcode::AllocStorage: {
+        RegName size_reg = instr.alloc_storage.allocation_size;
+        Index device_index = instr.alloc_storage.device_index;
+        auto it = const_index_of.find(size_reg);
+        int64_t size = 0;
+        if (!single_def(instr.dst) || it == const_index_of.end() || !single_def(size_reg) ||
+            !GetConstantSize(context.constants[it->second], &size)) {
+          break;
+        }
+        int64_t alignment = instr.alloc_storage.alignment;
+        if (alignment <= 0 || runtime::kAllocAlignment % alignment != 0) break;
+        ICHECK_LT(device_index, context.virtual_devices_.size());
+        if (!SupportsPointerArithmetic(context.virtual_devices_[device_index]->device_type())) {
+          break;
+        }
+        group_of[instr.dst] = groups.size();
+        groups.push_back(StorageGroup{pc, pc, size, alignment, device_index});
+        break;
+      }
+      case Opcode::AllocTensor:
+        src = instr.alloc_tensor.storage;
+        break;
+      case Opcode::AllocTensorReg:
+        src = instr.alloc_tensor_reg.storage;
+        break;
+      case Opcode::ReshapeTensor:
+        src = instr.reshape_tensor.tensor;
+        break;
+      default:
+        break;
+    }
+    if (src < 0) continue;
+    auto it = group_of.find(src);
+    if (it == group_of.end()) continue;
+    if (!single_def(instr.dst)) {
+      groups[it->second].escapes = true;
+    } else {
+      group_of[instr.dst] = it->second;
+    }
+  }
+  if (groups.empty()) return;
+
+  // Compute the live interval of every group and whether it escapes.
+  for (Index pc = 0; pc < static_cast<Index>(code.size()); ++pc) {
+    ForEachRead(code[pc], [&](RegName reg, bool escapes) {
+      auto it = group_of.find(reg);
+      if (it == group_of.end()) return;
+      StorageGroup& group = groups[it->second];
+      group.last_use_pc = std::max(group.last_use_pc, pc);
+      group.escapes |= escapes;
+    });
+  }
+
+  // Greedily place the largest storages first at the lowest offset which does not overlap any
+  // placed storage with an intersecting live interval.
+  std::vector<size_t> order;
+  for (size_t i = 0; i < groups.size(); ++i) {
+    if (!groups[i].escapes) order.push_back(i);
+  }
+  if (order.empty()) return;
+  std::stable_sort(order.begin(), order.end(),
+                   [&groups](size_t a, size_t b) { return groups[a].size > groups[b].size; });
+
+  std::vector<Index> arena_sizes(context.virtual_devices_.size(), 0);
+  std::vector<int64_t> offsets(groups.size(), -1);
+  std::vector<size_t> placed;
+  for (size_t i : order) {
+    const StorageGroup& group = groups[i];
+    // The occupied [begin, end) ranges of the storages live at the same time on the device.
+    std::vector<std::pair<int64_t, int64_t>> occupied;
+    for (size_t j : placed) {
+      const StorageGroup& other = groups[j];
+      if (other.device_index != group.device_index || other.last_use_pc < group.alloc_pc ||
+          group.last_use_pc < other.alloc_pc) {
+        continue;
+      }
+      occupied.emplace_back(offsets[j], offsets[j] + other.size);
+    }
+    std::sort(occupied.begin(), occupied.end());
+    int64_t offset = 0;
+    for (const auto& range : occupied) {
+      if (offset + group.size <= range.first) break;
+      offset = std::max(offset, (range.second + group.alignment - 1) / group.alignment *
+                                    group.alignment);
+    }
+    offsets[i] = offset;
+    placed.push_back(i);
+    arena_sizes[group.device_index] =
+        std::max<Index>(arena_sizes[group.device_index], offset + group.size);
+  }
+
+  for (size_t i : placed) {
+    Instruction& instr = func->instructions[groups[i].alloc_pc];
+    instr.alloc_storage.arena_offset = offsets[i];
+  }
+  func->arena_sizes = std::move(arena_sizes);
+  VLOG(1) << "planned " << placed.size() << " of " << groups.size()
+          << " static storages of function " << func->name << " into arenas";
+}
+
+}  // namespace vm
+}  // namespace relay
+}  // namespace tvm
@@ -24,11 +24,20 @@
 
 #include <dmlc/json.h>
 #include <dmlc/memory_io.h>
+#include <tvm/runtime/device_api.h>
 #include <tvm/runtime/logging.h>
 #include <tvm/runtime/registry.h>
 #include <tvm/runtime/serializer.h>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #include <fstream>
+#include <memory>
 #include <unordered_map>
 #include <vector>
 
@@ -169,7 +178,8 @@ Map<String, NDArray> LoadParams(dmlc::Stream* strm) {
   Map<String, NDArray> params;
   uint64_t header, reserved;
   ICHECK(strm->Read(&header)) << "Invalid parameters file format";
-  ICHECK(header == kTVMNDArrayListMagic) << "Invalid parameters file format";
+  ICHECK(header == kTVMNDArrayListMagic || header == kTVMNDArrayListMappableMagic)
+      << "Invalid parameters file format";
   ICHECK(strm->Read(&reserved)) << "Invalid parameters file format";
 
   std::vector<std::string> names;
@@ -178,7 +188,15 @@ Map<String, NDArray> LoadParams(dmlc::Stream* strm) {
   strm->Read(&sz);
   size_t size = static_cast<size_t>(sz);
   ICHECK(size == names.size()) << "Invalid parameters file format";
+  std::vector<char> padding;
   for (size_t i = 0; i < size; ++i) {
+    if (header == kTVMNDArrayListMappableMagic) {
+      uint64_t padding_size;
+      ICHECK(strm->Read(&padding_size)) << "Invalid parameters file format";
+      padding.resize(padding_size);
+      ICHECK_EQ(strm->Read(padding.data(), padding_size), padding_size)
+          << "Invalid parameters file format";
+    }
     // The data_entry is allocated on device, NDArray.load always load the array into CPU.
     NDArray temp;
     temp.Load(strm);
@@ -216,6 +234,150 @@ std::string SaveParams(const Map<String, NDArray>& params) {
   return bytes;
 }
 
+std::string SaveMappableParams(const Map<String, NDArray>& params, size_t alignment) {
+  ICHECK_GT(alignment, 0U);
+  std::string bytes;
+  dmlc::MemoryStringStream strm(&bytes);
+  std::vector<std::string> names;
+  std::vector<const DLTensor*> arrays;
+  for (auto& p : params) {
+    names.push_back(p.first);
+    arrays.push_back(p.second.operator->());
+  }
+
+  uint64_t header = kTVMNDArrayListMappableMagic;
+  strm.Write(header);
+  strm.Write(static_cast<uint64_t>(alignment));
+  strm.Write(names);
+  strm.Write(static_cast<uint64_t>(arrays.size()));
+  std::string zeros;
+  for (const DLTensor* array : arrays) {
+    // The bytes SaveDLTensor writes before the data: magic, reserved, device, ndim, dtype, shape
+    // and data size.
+    size_t tensor_header_size = sizeof(uint64_t) * 2 + sizeof(DLDevice) + sizeof(int) +
+                                sizeof(DLDataType) + sizeof(int64_t) * (array->ndim + 1);
+    size_t data_offset = bytes.size() + sizeof(uint64_t) + tensor_header_size;
+    uint64_t padding_size = (alignment - data_offset % alignment) % alignment;
+    zeros.resize(padding_size, '\0');
+    strm.Write(padding_size);
+    strm.Write(zeros.data(), padding_size);
+    SaveDLTensor(&strm, array);
+  }
+  return bytes;
+}
+
+namespace {
+
+/*! \brief A file mapped in memory, unmapped when the last tensor aliasing it is freed. */
+class MappedFile {
+ public:
+  MappedFile(char* data, size_t size) : data_(data), size_(size) {}
+  ~MappedFile() {
+#ifndef _WIN32
+    munmap(data_, size_);
+#endif
+  }
+  char* data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  char* data_;
+  size_t size_;
+};
+
+void MappedNDArrayDeleter(Object* obj) {
+  auto* container = static_cast<NDArray::Container*>(obj);
+  delete static_cast<std::shared_ptr<MappedFile>*>(container->manager_ctx);
+  delete container;
+}
+
+/*! \brief Map a file in memory, or return nullptr if the platform cannot. */
+std::shared_ptr<MappedFile> MapFile(const std::string& file_name) {
+#ifndef _WIN32
+  int fd = open(file_name.c_str(), O_RDONLY);
+  ICHECK_GE(fd, 0) << "Cannot open " << file_name;
+  struct stat st;
+  ICHECK_EQ(fstat(fd, &st), 0) << "Cannot stat " << file_name;
+  size_t size = static_cast<size_t>(st.st_size);
+  void* data = size == 0 ? MAP_FAILED
+                         : mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data != MAP_FAILED) {
+    return std::make_shared<MappedFile>(static_cast<char*>(data), size);
+  }
+#endif
+  return nullptr;
+}
+
+/*! \brief Load parameters in the mappable format, aliasing the mapped file. */
+Map<String, NDArray> MapParams(const std::shared_ptr<MappedFile>& file) {
+  dmlc::MemoryFixedSizeStream strm(file->data(), file->size());
+  uint64_t header, alignment;
+  ICHECK(strm.Read(&header)) << "Invalid parameters file format";
+  ICHECK(header == kTVMNDArrayListMappableMagic) << "Invalid parameters file format";
+  ICHECK(strm.Read(&alignment)) << "Invalid parameters file format";
+  std::vector<std::string> names;
+  ICHECK(strm.Read(&names)) << "Invalid parameters file format";
+  uint64_t sz;
+  ICHECK(strm.Read(&sz)) << "Invalid parameters file format";
+  ICHECK(static_cast<size_t>(sz) == names.size()) << "Invalid parameters file format";
+
+  Map<String, NDArray> params;
+  for (const std::string& name : names) {
+    uint64_t padding_size, tensor_header, reserved;
+    ICHECK(strm.Read(&padding_size)) << "Invalid parameters file format";
+    strm.Seek(strm.Tell() + padding_size);
+    Device dev;
+    int ndim;
+    DLDataType dtype;
+    ICHECK(strm.Read(&tensor_header)) << "Invalid DLTensor file format";
+    ICHECK(tensor_header == kTVMNDArrayMagic) << "Invalid DLTensor file format";
+    ICHECK(strm.Read(&reserved)) << "Invalid DLTensor file format";
+    ICHECK(strm.Read(&dev)) << "Invalid DLTensor file format";
+    ICHECK(strm.Read(&ndim)) << "Invalid DLTensor file format";
+    ICHECK(strm.Read(&dtype)) << "Invalid DLTensor file format";
+    ICHECK_EQ(dev.device_type, kDLCPU) << "Invalid DLTensor device: can only save as CPU tensor";
+    std::vector<int64_t> shape(ndim);
+    if (ndim != 0) {
+      ICHECK(strm.ReadArray(&shape[0], ndim)) << "Invalid DLTensor file format";
+    }
+    int64_t data_byte_size;
+    ICHECK(strm.Read(&data_byte_size)) << "Invalid DLTensor file format";
+    size_t offset = strm.Tell();
+    ICHECK_LE(offset + data_byte_size, file->size()) << "Invalid DLTensor file format";
+    strm.Seek(offset + data_byte_size);
+
+    char* data = file->data() + offset;
+    if (reinterpret_cast<uintptr_t>(data) % kAllocAlignment != 0) {
+      // Kernels may assume aligned data, so misaligned tensors are copied.
+      NDArray array = NDArray::Empty(ShapeTuple(shape), dtype, dev);
+      array.CopyFromBytes(data, data_byte_size);
+      params.Set(name, array);
+      continue;
+    }
+    auto* container = new NDArray::Container(data, ShapeTuple(shape), dtype, dev);
+    container->manager_ctx = new std::shared_ptr<MappedFile>(file);
+    container->SetDeleter(MappedNDArrayDeleter);
+    params.Set(name, NDArray(GetObjectPtr<Object>(container)));
+  }
+  return params;
+}
+
+}  // namespace
+
+Map<String, NDArray> LoadParamsFromFile(const std::string& file_name) {
+  if (DMLC_IO_NO_ENDIAN_SWAP) {
+    std::shared_ptr<MappedFile> file = MapFile(file_name);
+    if (file != nullptr && file->size() >= sizeof(uint64_t) &&
+        *reinterpret_cast<const uint64_t*>(file->data()) == kTVMNDArrayListMappableMagic) {
+      return MapParams(file);
+    }
+  }
+  std::string bytes;
+  LoadBinaryFromFile(file_name, &bytes);
+  return LoadParams(bytes);
+}
+
 TVM_REGISTER_GLOBAL("runtime.SaveParams").set_body_typed([](const Map<String, NDArray>& params) {
   std::string s = ::tvm::runtime::SaveParams(params);
   // copy return array so it is owned by the ret value
@@ -226,6 +388,16 @@ TVM_REGISTER_GLOBAL("runtime.SaveParams").set_body_typed([](const Map<String, ND
 TVM_REGISTER_GLOBAL("runtime.LoadParams").set_body_typed([](const String& s) {
   return ::tvm::runtime::LoadParams(s);
 });
+TVM_REGISTER_GLOBAL("runtime.SaveMappableParams")
+    .set_body_typed([](const Map<String, NDArray>& params, int alignment) {
+      std::string s = ::tvm::runtime::SaveMappableParams(params, alignment);
+      TVMRetValue rv;
+      rv = TVMByteArray{s.data(), s.size()};
+      return rv;
+    });
+TVM_REGISTER_GLOBAL("runtime.LoadParamsFromFile").set_body_typed([](const String& file_name) {
+  return ::tvm::runtime::LoadParamsFromFile(file_name);
+});
 
 }  // namespace runtime
 }  // namespace tvm
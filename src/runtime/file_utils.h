@@ -97,6 +97,16 @@ void LoadMetaDataFromFile(const std::string& file_name,
 void RemoveFile(const std::string& file_name);
 
 constexpr uint64_t kTVMNDArrayListMagic = 0xF7E58D4F05049CB7;
+/*!
+ * \brief Magic number of the mappable parameters format.
+ *
+ * The layout follows the kTVMNDArrayListMagic format, with the alignment in place of the reserved
+ * field and every tensor saved by SaveDLTensor preceded by a uint64 padding size and that many
+ * zero bytes, so that the data of each tensor starts at an aligned offset of the file.
+ */
+constexpr uint64_t kTVMNDArrayListMappableMagic = 0xF7E58D4F05049CB8;
+/*! \brief The default alignment of the tensor data in the mappable parameters format. */
+constexpr size_t kMappableParamsAlignment = 64;
 /*!
  * \brief Load parameters from a string.
  * \param param_blob Serialized string of parameters.
@@ -121,6 +131,26 @@ std::string SaveParams(const Map<String, NDArray>& params);
  * \param params Parameters to save.
  */
 void SaveParams(dmlc::Stream* strm, const Map<String, NDArray>& params);
+/*!
+ * \brief Serialize parameters to a byte array in the mappable format.
+ * \param params Parameters to save.
+ * \param alignment The alignment of the data of each tensor in the byte array.
+ * \return String containing binary parameter data.
+ */
+std::string SaveMappableParams(const Map<String, NDArray>& params,
+                               size_t alignment = kMappableParamsAlignment);
+/*!
+ * \brief Load parameters from a file.
+ *
+ * Files in the mappable format are memory mapped, and the returned CPU tensors alias the mapping
+ * instead of copying the data, so processes loading the same file share its page cache pages.
+ * The mapping is private: writing a tensor does not change the file. Other files are read and
+ * copied as by LoadParams.
+ *
+ * \param file_name The file to load from.
+ * \return Map of parameter name to parameter value.
+ */
+Map<String, NDArray> LoadParamsFromFile(const std::string& file_name);
 }  // namespace runtime
 }  // namespace tvm
 #endif  // TVM_RUNTIME_FILE_UTILS_H_
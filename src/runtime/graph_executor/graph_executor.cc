@@ -22,6 +22,7 @@
  */
 #include "graph_executor.h"
 
+#include <tvm/runtime/c_backend_api.h>
 #include <tvm/runtime/container/map.h>
 #include <tvm/runtime/container/string.h>
 #include <tvm/runtime/data_type.h>
@@ -33,6 +34,7 @@
 #include <tvm/runtime/serializer.h>
 
 #include <algorithm>
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <numeric>
@@ -42,6 +44,7 @@
 #include <vector>
 
 #include "../file_utils.h"
+#include "../library_module.h"
 
 namespace tvm {
 namespace runtime {
@@ -57,12 +60,129 @@ inline size_t GetDataAlignment(const DLTensor& arr) {
  * \brief Run all the operations one by one.
  */
 void GraphExecutor::Run() {
+  if (inter_op_threads_ != 1) {
+    RunInterOpParallel();
+    return;
+  }
   // setup the array and requirements.
   for (size_t i = 0; i < op_execs_.size(); ++i) {
     if (op_execs_[i]) op_execs_[i]();
   }
 }
 
+void GraphExecutor::SetInterOpParallelism(int num_threads) {
+  ICHECK_GE(num_threads, 0) << "The number of threads must be non negative";
+  inter_op_threads_ = num_threads;
+  if (inter_op_threads_ != 1 && op_num_predecessors_.size() != nodes_.size()) {
+    SetupOpDependencies();
+  }
+}
+
+void GraphExecutor::SetupOpDependencies() {
+  // Replay the sequential order: a node depends on the last writer of every storage it reads or
+  // writes, and a node writing a storage also depends on the readers since the last write.
+  std::vector<int64_t> last_writer(storage_pool_.size(), -1);
+  std::vector<std::vector<uint32_t>> readers(storage_pool_.size());
+  op_successors_.assign(nodes_.size(), {});
+  op_num_predecessors_.assign(nodes_.size(), 0);
+  std::vector<uint32_t> deps;
+  for (uint32_t nid = 0; nid < nodes_.size(); ++nid) {
+    if (!op_execs_[nid]) continue;
+    const auto& inode = nodes_[nid];
+    deps.clear();
+    for (const auto& e : inode.inputs) {
+      uint32_t sid = static_cast<uint32_t>(attrs_.storage_id[entry_id(e)]);
+      if (last_writer[sid] >= 0) deps.push_back(static_cast<uint32_t>(last_writer[sid]));
+      readers[sid].push_back(nid);
+    }
+    for (uint32_t index = 0; index < inode.param.num_outputs; ++index) {
+      uint32_t sid = static_cast<uint32_t>(attrs_.storage_id[entry_id(nid, index)]);
+      if (last_writer[sid] >= 0) deps.push_back(static_cast<uint32_t>(last_writer[sid]));
+      for (uint32_t reader : readers[sid]) {
+        if (reader != nid) deps.push_back(reader);
+      }
+      readers[sid].clear();
+    }
+    for (uint32_t index = 0; index < inode.param.num_outputs; ++index) {
+      last_writer[attrs_.storage_id[entry_id(nid, index)]] = nid;
+    }
+    std::sort(deps.begin(), deps.end());
+    deps.erase(std::unique(deps.begin(), deps.end()), deps.end());
+    for (uint32_t dep : deps) {
+      op_successors_[dep].push_back(nid);
+    }
+    op_num_predecessors_[nid] = static_cast<uint32_t>(deps.size());
+  }
+}
+
+namespace {
+/*! \brief The operators of the graph whose predecessors are done, claimed by the tasks. */
+struct InterOpWave {
+  const std::vector<std::function<void()>>* op_execs;
+  /*! \brief The nodes of the wave, lowest first to stay close to the sequential order. */
+  std::vector<uint32_t> nodes;
+  /*! \brief The index of the next node to be claimed. */
+  std::atomic<size_t> next{0};
+  /*! \brief The error of each node, empty if it succeeded. */
+  std::vector<std::string> errors;
+};
+
+/*!
+ * \brief Run the nodes of the wave until all of them are claimed. A task never waits for the
+ *  other tasks, so the wave finishes even if the thread pool runs the tasks one after the other.
+ */
+int RunInterOpTask(int task_id, TVMParallelGroupEnv* penv, void* cdata) {
+  InterOpWave* wave = static_cast<InterOpWave*>(cdata);
+  int ret = 0;
+  for (size_t i = wave->next.fetch_add(1); i < wave->nodes.size(); i = wave->next.fetch_add(1)) {
+    try {
+      (*wave->op_execs)[wave->nodes[i]]();
+    } catch (const std::exception& e) {
+      wave->errors[i] = e.what();
+      ret = -1;
+    } catch (...) {
+      wave->errors[i] = "Unknown exception";
+      ret = -1;
+    }
+  }
+  return ret;
+}
+}  // namespace
+
+void GraphExecutor::RunInterOpParallel() {
+  std::vector<uint32_t> num_pending = op_num_predecessors_;
+  InterOpWave wave;
+  wave.op_execs = &op_execs_;
+  for (uint32_t nid = 0; nid < op_execs_.size(); ++nid) {
+    if (op_execs_[nid] && num_pending[nid] == 0) wave.nodes.push_back(nid);
+  }
+  std::vector<uint32_t> next_nodes;
+  while (!wave.nodes.empty()) {
+    if (wave.nodes.size() == 1) {
+      // A lone operator runs in the calling thread, where its kernel keeps its own parallelism.
+      op_execs_[wave.nodes[0]]();
+    } else {
+      wave.next.store(0);
+      wave.errors.assign(wave.nodes.size(), std::string());
+      int num_task = inter_op_threads_;
+      if (num_task > 0) num_task = static_cast<int>(std::min(wave.nodes.size(), size_t(num_task)));
+      TVMBackendParallelLaunch(RunInterOpTask, &wave, num_task);
+      for (const std::string& error : wave.errors) {
+        if (!error.empty()) LOG(FATAL) << error;
+      }
+    }
+    // Only the calling thread updates the dependencies, between the waves.
+    next_nodes.clear();
+    for (uint32_t nid : wave.nodes) {
+      for (uint32_t succ : op_successors_[nid]) {
+        if (--num_pending[succ] == 0) next_nodes.push_back(succ);
+      }
+    }
+    std::sort(next_nodes.begin(), next_nodes.end());
+    wave.nodes.swap(next_nodes);
+  }
+}
+
 /*!
  * \brief Initialize the graph executor with graph and device.
  * \param graph_json The execution graph.
@@ -212,6 +332,18 @@ void GraphExecutor::SetOutputZeroCopy(int index, DLTensor* data_ref) {
     t->data = data_ref->data;
   }
 }
+/*!
+ * \brief Check whether the index-th output is written by an operator, so that setting it
+ *  without copying the data takes effect.
+ * \param index The output index.
+ * \return Whether the output supports zero copy.
+ */
+bool GraphExecutor::OutputSupportsZeroCopy(int index) const {
+  ICHECK_LT(static_cast<size_t>(index), outputs_.size());
+  // An output which is not produced by an operator (e.g. an input passed through) has no
+  // tensor to redirect.
+  return !output_dltensors_[this->entry_id(outputs_[index])].empty();
+}
 /*!
  * \brief Get the number of outputs
  *
@@ -285,10 +417,46 @@ void GraphExecutor::LoadParams(dmlc::Stream* strm) {
   }
 }
 
+void GraphExecutor::LoadParamsFromFile(const std::string& file_name) {
+  Map<String, NDArray> params = ::tvm::runtime::LoadParamsFromFile(file_name);
+  // The number of entries in each storage, a storage of the parameter alone can be released.
+  std::vector<uint32_t> sid_num_entries(storage_pool_.size(), 0);
+  for (int sid : attrs_.storage_id) {
+    ++sid_num_entries[sid];
+  }
+  bool aliased = false;
+  for (auto& p : params) {
+    param_names_.insert(p.first);
+    int in_idx = GetInputIndex(p.first);
+    if (in_idx < 0) continue;
+    uint32_t eid = this->entry_id(input_nodes_[in_idx], 0);
+    const NDArray& entry = data_entry_[eid];
+    const DLTensor* param = p.second.operator->();
+    // Alias the parameter when it already has the layout the graph expects.
+    if (entry->device.device_type == kDLCPU && param->device.device_type == kDLCPU &&
+        entry.Shape() == p.second.Shape() && entry.DataType() == p.second.DataType() &&
+        reinterpret_cast<uintptr_t>(param->data) % data_alignment_[eid] == 0) {
+      data_entry_[eid] = p.second;
+      // The parameter becomes the storage, which frees the pool memory it was allocated.
+      uint32_t sid = static_cast<uint32_t>(attrs_.storage_id[eid]);
+      if (sid_num_entries[sid] == 1 && !linked_param_sids_.count(sid)) {
+        storage_pool_[sid] = p.second;
+      }
+      aliased = true;
+    } else {
+      data_entry_[eid].CopyFrom(p.second);
+    }
+  }
+  if (aliased) {
+    this->SetupOpExecs();
+  }
+}
+
 void GraphExecutor::ShareParams(const GraphExecutor& other, dmlc::Stream* strm) {
   uint64_t header, reserved;
   ICHECK(strm->Read(&header)) << "Invalid parameters file format";
-  ICHECK(header == kTVMNDArrayListMagic) << "Invalid parameters file format";
+  ICHECK(header == kTVMNDArrayListMagic || header == kTVMNDArrayListMappableMagic)
+      << "Invalid parameters file format";
   ICHECK(strm->Read(&reserved)) << "Invalid parameters file format";
   std::vector<std::string> names;
   ICHECK(strm->Read(&names)) << "Invalid parameters file format";
@@ -406,6 +574,7 @@ void GraphExecutor::SetupStorage() {
     });
     Device dev = cit == devices_.end() ? devices_[0] : *cit;
     if (pit.linked_param.defined()) {
+      linked_param_sids_.insert(static_cast<uint32_t>(storage_pool_.size()));
       storage_pool_.push_back(pit.linked_param);
     } else {
       std::vector<int64_t> shape;
@@ -414,6 +583,10 @@ void GraphExecutor::SetupStorage() {
     }
   }
 
+  SetupDataEntries();
+}
+
+void GraphExecutor::SetupDataEntries() {
   // Assign the pooled entries. A unified memory pool is used to simplifiy
   // memory assignment for each node entry. The allocated memory on each device
   // is mapped to this pool.
@@ -422,18 +595,69 @@ void GraphExecutor::SetupStorage() {
   for (size_t i = 0; i < data_entry_.size(); ++i) {
     int storage_id = attrs_.storage_id[i];
     ICHECK_LT(static_cast<size_t>(storage_id), storage_pool_.size());
-    data_entry_[i] = storage_pool_[storage_id].CreateView(attrs_.shape[i], vtype[i]);
+    data_entry_[i] = storage_pool_[storage_id].CreateView(
+        attrs_.shape[i], tvm::runtime::String2DLDataType(attrs_.dltype[i]));
 
     const DLTensor* tmp = data_entry_[i].operator->();
     data_alignment_[i] = details::GetDataAlignment(*tmp);
   }
 }
 
+void GraphExecutor::InitFrom(const GraphExecutor& other,
+                             const std::unordered_set<std::string>& shared_inputs) {
+  nodes_ = other.nodes_;
+  input_nodes_ = other.input_nodes_;
+  param_names_ = other.param_names_;
+  input_map_ = other.input_map_;
+  output_map_ = other.output_map_;
+  node_row_ptr_ = other.node_row_ptr_;
+  outputs_ = other.outputs_;
+  attrs_ = other.attrs_;
+  module_ = other.module_;
+  devices_ = other.devices_;
+  linked_param_sids_ = other.linked_param_sids_;
+  op_funcs_ = other.op_funcs_;
+  inter_op_threads_ = other.inter_op_threads_;
+  op_successors_ = other.op_successors_;
+  op_num_predecessors_ = other.op_num_predecessors_;
+  lookup_linked_param_ = PackedFunc(
+      [this](TVMArgs args, TVMRetValue* rv) { this->DefaultLookupLinkedParam(args, rv); });
+
+  // A storage is shared when it holds a linked parameter or only shared inputs.
+  std::vector<uint32_t> shared_eids;
+  std::vector<bool> shared_sid(other.storage_pool_.size(), true);
+  for (uint32_t nid : input_nodes_) {
+    if (shared_inputs.count(nodes_[nid].name)) shared_eids.push_back(entry_id(nid, 0));
+  }
+  std::unordered_set<uint32_t> shared_eid_set(shared_eids.begin(), shared_eids.end());
+  for (uint32_t eid = 0; eid < num_node_entries(); ++eid) {
+    uint32_t sid = static_cast<uint32_t>(attrs_.storage_id[eid]);
+    if (!shared_eid_set.count(eid) && !linked_param_sids_.count(sid)) shared_sid[sid] = false;
+  }
+  storage_pool_.clear();
+  for (size_t sid = 0; sid < other.storage_pool_.size(); ++sid) {
+    const NDArray& storage = other.storage_pool_[sid];
+    if (shared_sid[sid]) {
+      storage_pool_.push_back(storage);
+    } else {
+      storage_pool_.push_back(NDArray::Empty(storage.Shape(), storage.DataType(), storage->device));
+    }
+  }
+  SetupDataEntries();
+  // The shared inputs may have been replaced by LoadParamsFromFile or ShareParams.
+  for (uint32_t eid : shared_eids) {
+    data_entry_[eid] = other.data_entry_[eid];
+    data_alignment_[eid] = other.data_alignment_[eid];
+  }
+  SetupOpExecs();
+}
+
 void GraphExecutor::SetupOpExecs() {
-  op_execs_.resize(this->GetNumOfNodes());
-  input_dltensors_.resize(num_node_entries());
-  output_dltensors_.resize(num_node_entries());
-  both_output_opinput_dltensors_.resize(num_node_entries());
+  // Called again when the inputs are rebound, drop the pointers into the previous arguments.
+  op_execs_.assign(this->GetNumOfNodes(), nullptr);
+  input_dltensors_.assign(num_node_entries(), {});
+  output_dltensors_.assign(num_node_entries(), {});
+  both_output_opinput_dltensors_.assign(num_node_entries(), {});
   std::unordered_set<uint32_t> input_node_eids;
   for (size_t i = 0; i < input_nodes_.size(); i++) {
     uint32_t nid = input_nodes_[i];
@@ -525,9 +749,22 @@ GraphExecutor::CreateTVMOp(const TVMOpParam& param, const std::vector<DLTensor>&
 
   // Get compiled function from the module that contains both host and device
   // code.
-  tvm::runtime::PackedFunc pf = module_.GetFunction(param.func_name, true);
+  auto it = op_funcs_.find(param.func_name);
+  if (it == op_funcs_.end()) {
+    it = op_funcs_.emplace(param.func_name, module_.GetFunction(param.func_name, true)).first;
+  }
+  tvm::runtime::PackedFunc pf = it->second;
   ICHECK(pf != nullptr) << "no such function in module: " << param.func_name;
 
+  // Kernels of a library module are called directly with the prepared arguments.
+  if (TVMBackendPackedCFunc faddr = GetBackendPackedCFunc(pf)) {
+    auto fexec = [arg_ptr, pf, faddr]() {
+      CallBackendPackedCFunc(faddr, arg_ptr->arg_values.data(), arg_ptr->arg_tcodes.data(),
+                             static_cast<int>(arg_ptr->arg_values.size()));
+    };
+    return {fexec, arg_ptr};
+  }
+
   auto fexec = [arg_ptr, pf]() {
     TVMRetValue rv;
     TVMArgs targs(arg_ptr->arg_values.data(), arg_ptr->arg_tcodes.data(),
@@ -567,6 +804,10 @@ PackedFunc GraphExecutor::GetFunction(const std::string& name,
         this->SetOutputZeroCopy(args[0], args[1]);
       }
     });
+  } else if (name == "output_supports_zero_copy") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      *rv = this->OutputSupportsZeroCopy(args[0]);
+    });
   } else if (name == "get_output") {
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
       if (args.num_args == 2) {
@@ -595,6 +836,10 @@ PackedFunc GraphExecutor::GetFunction(const std::string& name,
         [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = this->NumInputs(); });
   } else if (name == "run") {
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { this->Run(); });
+  } else if (name == "set_inter_op_parallelism") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      this->SetInterOpParallelism(args[0]);
+    });
   } else if (name == "run_from_inputs") {
     return PackedFunc(
         [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
@@ -627,6 +872,10 @@ PackedFunc GraphExecutor::GetFunction(const std::string& name,
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
       this->LoadParams(args[0].operator std::string());
     });
+  } else if (name == "load_params_from_file") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      this->LoadParamsFromFile(args[0].operator std::string());
+    });
   } else if (name == "share_params") {
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
       const auto& module = args[0].operator Module();
@@ -89,6 +89,22 @@ class TVM_DLL GraphExecutor : public ModuleNode {
   const char* type_key() const final { return "GraphExecutor"; }
   void Run();
 
+  /*!
+   * \brief Set how many threads run the operators of the graph.
+   *
+   *  With more than one thread, the operators run in waves: the operators whose predecessors
+   *  are done are launched together on the runtime thread pool, and the next wave starts when
+   *  they finish, so the pool tasks never wait for each other. Besides the data dependencies,
+   *  an operator waits for the operators which used the storage it writes earlier in the
+   *  topological order, so the memory plan stays valid. A kernel parallelizing its loops runs
+   *  as a nested launch, except in a wave of a single operator, which runs in the calling
+   *  thread.
+   *
+   * \param num_threads The number of threads, 1 for sequential execution and 0 for all the
+   *  threads of the runtime thread pool.
+   */
+  void SetInterOpParallelism(int num_threads);
+
   /*!
    * \brief Initialize the graph executor with graph and device.
    * \param graph_json The execution graph.
@@ -104,6 +120,19 @@ class TVM_DLL GraphExecutor : public ModuleNode {
   void Init(const std::string& graph_json, tvm::runtime::Module module,
             const std::vector<Device>& devs, const PackedFunc lookup_linked_param_func = nullptr);
 
+  /*!
+   * \brief Initialize the graph executor as a lightweight copy of another one.
+   *
+   *  The copy shares the parsed graph, the resolved kernels, the storage of the linked
+   *  parameters and the tensors of the given inputs with \p other, and only allocates the
+   *  storage of the other entries.
+   *
+   * \param other An initialized graph executor.
+   * \param shared_inputs The names of the inputs whose tensors are shared, usually the params.
+   *  Setting one of them on either executor changes it for both.
+   */
+  void InitFrom(const GraphExecutor& other, const std::unordered_set<std::string>& shared_inputs);
+
   /*!
    * \brief Get the input index given the name of input.
    * \param name The name of the input.
@@ -142,6 +171,13 @@ class TVM_DLL GraphExecutor : public ModuleNode {
    * \param data_ref The output data that is referred.
    */
   void SetOutputZeroCopy(int index, DLTensor* data_ref);
+  /*!
+   * \brief Check whether the index-th output is written by an operator, so that setting it
+   *  without copying the data takes effect.
+   * \param index The output index.
+   * \return Whether the output supports zero copy.
+   */
+  bool OutputSupportsZeroCopy(int index) const;
   /*!
    * \brief Get the number of outputs
    *
@@ -184,6 +220,12 @@ class TVM_DLL GraphExecutor : public ModuleNode {
    * \param param_blob A binary blob of parameter.
    */
   void LoadParams(const std::string& param_blob);
+  /*!
+   * \brief Load parameters from a file. The parameters of a file in the mappable format which
+   *  live on the CPU alias the mapped file instead of being copied.
+   * \param file_name The parameter file.
+   */
+  void LoadParamsFromFile(const std::string& file_name);
 
   /*!
    * \brief Share parameters from pre-existing GraphExecutor instance.
@@ -401,6 +443,8 @@ class TVM_DLL GraphExecutor : public ModuleNode {
   static void LinkedNDArrayDeleter(Object* container);
   /*! \brief Setup the temporal storage */
   void SetupStorage();
+  /*! \brief Create the data entries as views of the storage pool. */
+  void SetupDataEntries();
   /*! \brief Setup the executors. */
   void SetupOpExecs();
   /*!
@@ -417,6 +461,10 @@ class TVM_DLL GraphExecutor : public ModuleNode {
    */
   std::pair<std::function<void()>, std::shared_ptr<OpArgs>> CreateTVMOp(
       const TVMOpParam& attrs, const std::vector<DLTensor>& args);
+  /*! \brief Compute the dependencies between the operators for the inter-op parallel mode. */
+  void SetupOpDependencies();
+  /*! \brief Run the operators concurrently in waves respecting their dependencies. */
+  void RunInterOpParallel();
   // Get node entry index.
   uint32_t entry_id(uint32_t nid, uint32_t index) const { return node_row_ptr_[nid] + index; }
   // Get node entry index.
@@ -451,12 +499,22 @@ class TVM_DLL GraphExecutor : public ModuleNode {
   std::vector<Device> devices_;
   /*! \brief Common storage pool for all devices. */
   std::vector<NDArray> storage_pool_;
+  /*! \brief The storage ids holding linked parameters. */
+  std::unordered_set<uint32_t> linked_param_sids_;
+  /*! \brief The kernels of the module by name, resolved once. */
+  std::unordered_map<std::string, PackedFunc> op_funcs_;
   /*! \brief Data entry of each node. */
   std::vector<NDArray> data_entry_;
   /*! \brief Data alignment of each node. */
   std::vector<size_t> data_alignment_;
   /*! \brief Operator on each node. */
   std::vector<std::function<void()>> op_execs_;
+  /*! \brief The number of threads running the operators, see SetInterOpParallelism. */
+  int inter_op_threads_{1};
+  /*! \brief The nodes which must wait for each node in the inter-op parallel mode. */
+  std::vector<std::vector<uint32_t>> op_successors_;
+  /*! \brief The number of nodes each node must wait for in the inter-op parallel mode. */
+  std::vector<uint32_t> op_num_predecessors_;
   /*! \brief Linked parameter lookup function. */
   PackedFunc lookup_linked_param_;
   /*! \brief Module's _lookup_linked_param function, used by DefaultLookupLinkedParam. */
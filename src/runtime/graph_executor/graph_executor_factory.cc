@@ -30,8 +30,11 @@
 #include <tvm/runtime/registry.h>
 
 #include <iterator>
+#include <unordered_set>
 #include <vector>
 
+#include "./graph_executor_pool.h"
+
 namespace tvm {
 namespace runtime {
 
@@ -85,6 +88,16 @@ PackedFunc GraphExecutorFactory::GetFunction(
       exec->Import(this->imports_[0]);
       *rv = Module(exec);
     });
+  } else if (name == "create_pool") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      ICHECK_GE(args.size(), 2);
+      int num_instances = args[0];
+      std::vector<Device> devices;
+      for (int i = 1; i < args.num_args; ++i) {
+        devices.emplace_back(args[i].operator Device());
+      }
+      *rv = this->ExecutorPoolCreate(num_instances, devices);
+    });
   } else if (name == "cuda_graph_create") {
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
       std::vector<Device> devices;
@@ -124,6 +137,24 @@ Module GraphExecutorFactory::ExecutorCreate(const std::vector<Device>& devs) {
   return Module(exec);
 }
 
+Module GraphExecutorFactory::ExecutorPoolCreate(int num_instances,
+                                                const std::vector<Device>& devs) {
+  ICHECK_GT(num_instances, 0) << "The pool needs at least one instance";
+  Module first = ExecutorCreate(devs);
+  const GraphExecutor* first_exec = first.as<GraphExecutor>();
+  std::unordered_set<std::string> param_names;
+  for (const auto& kv : params_) {
+    param_names.insert(kv.first);
+  }
+  std::vector<Module> instances{first};
+  for (int i = 1; i < num_instances; ++i) {
+    auto exec = make_object<GraphExecutor>();
+    exec->InitFrom(*first_exec, param_names);
+    instances.push_back(Module(exec));
+  }
+  return Module(make_object<GraphExecutorPool>(std::move(instances)));
+}
+
 Module GraphExecutorFactory::DebugExecutorCreate(const std::vector<Device>& devs) {
   const PackedFunc* pf = tvm::runtime::Registry::Get("tvm.graph_executor_debug.create");
   ICHECK(pf != nullptr) << "Cannot find function tvm.graph_executor_debug.create in registry. "
@@ -97,6 +97,15 @@ class TVM_DLL GraphExecutorFactory : public runtime::ModuleNode {
    */
   Module CudaGraphExecutorCreate(const std::vector<Device>& devs);
 
+  /*!
+   * \brief Create a pool of executors sharing the graph, the kernels and the params.
+   * \param num_instances The number of executors.
+   * \param devs The device of the host and devices where graph nodes will be
+   *  executed on.
+   * \return created GraphExecutorPool module
+   */
+  Module ExecutorPoolCreate(int num_instances, const std::vector<Device>& devs);
+
   /*!
    * \brief Set params.
    * \param graph_executor The graph executor we want to set the params into.
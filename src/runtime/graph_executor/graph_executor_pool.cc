@@ -0,0 +1,101 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file graph_executor_pool.cc
+ * \brief A pool of graph executors sharing one graph and its parameters.
+ */
+
+#include "./graph_executor_pool.h"
+
+#include <tvm/runtime/logging.h>
+
+#include <utility>
+
+namespace tvm {
+namespace runtime {
+
+GraphExecutorPool::GraphExecutorPool(std::vector<Module> instances)
+    : instances_(std::move(instances)), busy_(new std::atomic<bool>[instances_.size()]) {
+  ICHECK(!instances_.empty()) << "A graph executor pool needs at least one instance";
+  for (size_t i = 0; i < instances_.size(); ++i) busy_[i].store(false);
+}
+
+int GraphExecutorPool::TryAcquire() {
+  uint32_t size = static_cast<uint32_t>(instances_.size());
+  uint32_t start = next_.fetch_add(1, std::memory_order_relaxed) % size;
+  for (uint32_t k = 0; k < size; ++k) {
+    uint32_t index = (start + k) % size;
+    if (!busy_[index].load(std::memory_order_relaxed) && !busy_[index].exchange(true)) {
+      return static_cast<int>(index);
+    }
+  }
+  return -1;
+}
+
+int GraphExecutorPool::Acquire() {
+  int index = TryAcquire();
+  while (index < 0) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    // Register as a waiter before the last check, so that a concurrent Release either frees an
+    // instance this check sees or notifies.
+    num_waiters_.fetch_add(1);
+    index = TryAcquire();
+    if (index < 0) cv_.wait(lock);
+    num_waiters_.fetch_sub(1);
+  }
+  return index;
+}
+
+void GraphExecutorPool::Release(int index) {
+  ICHECK(index >= 0 && index < NumInstances()) << "Invalid instance index " << index;
+  ICHECK(busy_[index].load()) << "Instance " << index << " is not checked out";
+  busy_[index].store(false);
+  if (num_waiters_.load() > 0) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cv_.notify_one();
+  }
+}
+
+Module GraphExecutorPool::GetInstance(int index) const {
+  ICHECK(index >= 0 && index < NumInstances()) << "Invalid instance index " << index;
+  return instances_[index];
+}
+
+PackedFunc GraphExecutorPool::GetFunction(const std::string& name,
+                                          const ObjectPtr<Object>& sptr_to_self) {
+  if (name == "acquire") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = Acquire(); });
+  } else if (name == "try_acquire") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = TryAcquire(); });
+  } else if (name == "release") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { Release(args[0]); });
+  } else if (name == "get_instance") {
+    return PackedFunc(
+        [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = GetInstance(args[0]); });
+  } else if (name == "num_instances") {
+    return PackedFunc(
+        [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = NumInstances(); });
+  } else {
+    return PackedFunc();
+  }
+}
+
+}  // namespace runtime
+}  // namespace tvm
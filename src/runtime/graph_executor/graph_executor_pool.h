@@ -0,0 +1,117 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file tvm/runtime/graph_executor/graph_executor_pool.h
+ * \brief A pool of graph executors sharing one graph and its parameters.
+ */
+
+#ifndef TVM_RUNTIME_GRAPH_EXECUTOR_GRAPH_EXECUTOR_POOL_H_
+#define TVM_RUNTIME_GRAPH_EXECUTOR_GRAPH_EXECUTOR_POOL_H_
+
+#include <tvm/runtime/module.h>
+#include <tvm/runtime/packed_func.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+
+/*!
+ * \brief A pool of graph executors serving concurrent requests.
+ *
+ *  The instances are created by GraphExecutorFactory, the first one as usual and the others
+ *  with GraphExecutor::InitFrom, so they share the graph, the kernels and the parameters and
+ *  only own their activations. A request thread checks out an instance with Acquire, runs it and
+ *  returns it with Release. Both are a few atomic operations unless every instance is busy, in
+ *  which case Acquire blocks until one is released.
+ */
+class TVM_DLL GraphExecutorPool : public ModuleNode {
+ public:
+  /*!
+   * \brief Construct the pool.
+   * \param instances The graph executor modules of the pool.
+   */
+  explicit GraphExecutorPool(std::vector<Module> instances);
+
+  /*!
+   * \brief Get member function to front-end
+   * \param name The name of the function.
+   * \param sptr_to_self The pointer to the module node.
+   * \return The corresponding member function.
+   */
+  PackedFunc GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) final;
+
+  /*!
+   * \return The type key of the executor.
+   */
+  const char* type_key() const final { return "GraphExecutorPool"; }
+
+  /*!
+   * \brief Check out an idle instance, waiting for one if they are all busy.
+   * \return The index of the instance.
+   */
+  int Acquire();
+
+  /*!
+   * \brief Check out an idle instance without waiting.
+   * \return The index of the instance, or -1 if they are all busy.
+   */
+  int TryAcquire();
+
+  /*!
+   * \brief Return an instance checked out by Acquire or TryAcquire to the pool.
+   * \param index The index of the instance.
+   */
+  void Release(int index);
+
+  /*!
+   * \brief Get an instance of the pool.
+   * \param index The index of the instance.
+   * \return The graph executor module.
+   */
+  Module GetInstance(int index) const;
+
+  /*! \return The number of instances. */
+  int NumInstances() const { return static_cast<int>(instances_.size()); }
+
+ private:
+  /*! \brief The graph executor modules. */
+  std::vector<Module> instances_;
+  /*! \brief Whether each instance is checked out. */
+  std::unique_ptr<std::atomic<bool>[]> busy_;
+  /*! \brief Where the next search for an idle instance starts, spreading the threads. */
+  std::atomic<uint32_t> next_{0};
+  /*! \brief The number of threads waiting in Acquire. */
+  std::atomic<int> num_waiters_{0};
+  /*! \brief Protects the waits on cv_. */
+  std::mutex mutex_;
+  /*! \brief Signaled when an instance is released while threads wait. */
+  std::condition_variable cv_;
+};
+
+}  // namespace runtime
+}  // namespace tvm
+
+#endif  // TVM_RUNTIME_GRAPH_EXECUTOR_GRAPH_EXECUTOR_POOL_H_
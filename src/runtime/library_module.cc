@@ -71,8 +71,12 @@ class ModuleInternal {
   static std::vector<Module>* GetImportsAddr(ModuleNode* node) { return &(node->imports_); }
 };
 
-PackedFunc WrapPackedFunc(TVMBackendPackedCFunc faddr, const ObjectPtr<Object>& sptr_to_self) {
-  return PackedFunc([faddr, sptr_to_self](TVMArgs args, TVMRetValue* rv) {
+/*! \brief The callable of the functions created by WrapPackedFunc. */
+struct BackendPackedCFuncCaller {
+  TVMBackendPackedCFunc faddr;
+  ObjectPtr<Object> sptr_to_self;
+
+  void operator()(TVMArgs args, TVMRetValue* rv) const {
     TVMValue ret_value;
     int ret_type_code = kTVMNullptr;
     int ret = (*faddr)(const_cast<TVMValue*>(args.values), const_cast<int*>(args.type_codes),
@@ -81,7 +85,18 @@ PackedFunc WrapPackedFunc(TVMBackendPackedCFunc faddr, const ObjectPtr<Object>&
     if (ret_type_code != kTVMNullptr) {
       *rv = TVMRetValue::MoveFromCHost(ret_value, ret_type_code);
     }
-  });
+  }
+};
+
+PackedFunc WrapPackedFunc(TVMBackendPackedCFunc faddr, const ObjectPtr<Object>& sptr_to_self) {
+  return PackedFunc(BackendPackedCFuncCaller{faddr, sptr_to_self});
+}
+
+TVMBackendPackedCFunc GetBackendPackedCFunc(const PackedFunc& pf) {
+  if (pf == nullptr) return nullptr;
+  const auto* obj = static_cast<const PackedFuncObj*>(pf.get());
+  const BackendPackedCFuncCaller* caller = obj->GetCallable<BackendPackedCFuncCaller>();
+  return caller != nullptr ? caller->faddr : nullptr;
 }
 
 void InitContextFunctions(std::function<void*(const char*)> fgetsymbol) {
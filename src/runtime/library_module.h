@@ -72,6 +72,37 @@ class Library : public Object {
  */
 PackedFunc WrapPackedFunc(TVMBackendPackedCFunc faddr, const ObjectPtr<Object>& mptr);
 
+/*!
+ * \brief Get the TVMBackendPackedCFunc wrapped by WrapPackedFunc.
+ * \param pf The packed function.
+ * \return The function address, nullptr if pf is not created by WrapPackedFunc.
+ */
+TVMBackendPackedCFunc GetBackendPackedCFunc(const PackedFunc& pf);
+
+/*!
+ * \brief Call a TVMBackendPackedCFunc directly with packed arguments.
+ *
+ *  This skips the construction of TVMArgs and TVMRetValue and the type-erased call of a
+ *  PackedFunc, for callers such as the executors which invoke kernels generated by MakePackedAPI
+ *  with prepared arrays of tensor handles. The return value of the function is discarded.
+ *
+ * \param faddr The function address, see GetBackendPackedCFunc.
+ * \param values The argument values.
+ * \param type_codes The argument type codes.
+ * \param num_args The number of arguments.
+ */
+inline void CallBackendPackedCFunc(TVMBackendPackedCFunc faddr, TVMValue* values, int* type_codes,
+                                   int num_args) {
+  TVMValue ret_value;
+  int ret_type_code = kTVMNullptr;
+  int ret = (*faddr)(values, type_codes, num_args, &ret_value, &ret_type_code, nullptr);
+  ICHECK_EQ(ret, 0) << TVMGetLastError();
+  if (ret_type_code != kTVMNullptr) {
+    // Release the returned value, if any.
+    TVMRetValue::MoveFromCHost(ret_value, ret_type_code);
+  }
+}
+
 /*!
  * \brief Utility to initialize conext function symbols during startup
  * \param fgetsymbol A symbol lookup function.
@@ -20,10 +20,13 @@
 // Disable constructor to bring minimum dep on c++ABI.
 #define TVM_ARENA_HAS_DESTRUCTOR 0
 
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 #include <cstdlib>
 
+#include "../../../support/shm_ring.h"
 #include "minrpc_server.h"
 
 namespace tvm {
@@ -57,21 +60,67 @@ class PosixIOHandler {
   int write_fd_{1};
 };
 
+/*!
+ * \brief IOHandler which moves the bytes through shared memory,
+ *  the pipes only carry the wake ups.
+ */
+class SharedMemoryIOHandler : public PosixIOHandler {
+ public:
+  SharedMemoryIOHandler(int read_fd, int write_fd) : PosixIOHandler(read_fd, write_fd) {}
+
+  /*!
+   * \brief Map the shared memory created by the client.
+   * \param shm_fd The descriptor of the shared memory.
+   * \return Whether the shared memory is valid.
+   */
+  bool Attach(int read_fd, int write_fd, int shm_fd) {
+    struct stat st;
+    if (fstat(shm_fd, &st) != 0) return false;
+    void* region = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
+    close(shm_fd);
+    if (region == MAP_FAILED) return false;
+    return shm_.Attach(region, st.st_size, false, read_fd, write_fd);
+  }
+
+  ssize_t PosixRead(void* data, size_t size) { return shm_.Recv(data, size); }
+
+  ssize_t PosixWrite(const void* data, size_t size) { return shm_.Send(data, size); }
+
+ private:
+  support::SharedMemoryPipe shm_;
+};
+
 /*! \brief Type for the posix version of min rpc server. */
 using PosixMinRPCServer = MinRPCServer<PosixIOHandler>;
 
-}  // namespace runtime
-}  // namespace tvm
+/*! \brief Type for the shared memory version of min rpc server. */
+using SharedMemoryMinRPCServer = MinRPCServer<SharedMemoryIOHandler>;
 
-int main(int argc, char* argv[]) {
-  if (argc != 3) return -1;
-  // pass the descriptor via arguments.
-  tvm::runtime::PosixIOHandler handler(atoi(argv[1]), atoi(argv[2]));
-  tvm::runtime::PosixMinRPCServer server(&handler);
+template <typename TServer, typename TIOHandler>
+void RunServer(TIOHandler* handler) {
+  TServer server(handler);
   bool is_running = true;
   while (is_running) {
     is_running = server.ProcessOnePacket();
   }
+}
+
+}  // namespace runtime
+}  // namespace tvm
 
+int main(int argc, char* argv[]) {
+  if (argc != 3 && argc != 4) return -1;
+  // pass the descriptor via arguments.
+  int read_fd = atoi(argv[1]);
+  int write_fd = atoi(argv[2]);
+  if (argc == 4) {
+    // the client also passes the shared memory to move the bytes through.
+    tvm::runtime::SharedMemoryIOHandler handler(read_fd, write_fd);
+    if (!handler.Attach(read_fd, write_fd, atoi(argv[3]))) return -1;
+    tvm::runtime::RunServer<tvm::runtime::SharedMemoryMinRPCServer>(&handler);
+  } else {
+    tvm::runtime::PosixIOHandler handler(read_fd, write_fd);
+    tvm::runtime::RunServer<tvm::runtime::PosixMinRPCServer>(&handler);
+  }
   return 0;
 }
@@ -58,6 +58,10 @@ enum class RPCCode : int {
   kDevCreateStream,
   kDevFreeStream,
   kDevSetStream,
+  // Chunked tensor transfer, only sent to servers advertising it in
+  // tvm.rpc.server.GetTransferFeatures.
+  kCopyToRemoteChunk,
+  kCopyFromRemoteChunked,
 };
 
 /*!
@@ -122,6 +126,10 @@ inline const char* RPCCodeToString(RPCCode code) {
       return "kCopyAmongRemote";
     case RPCCode::kDevAllocDataWithScope:
       return "kDevAllocDataWithScope";
+    case RPCCode::kCopyToRemoteChunk:
+      return "kCopyToRemoteChunk";
+    case RPCCode::kCopyFromRemoteChunked:
+      return "kCopyFromRemoteChunked";
     default:
       return "";
   }
@@ -0,0 +1,391 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*!
+ * \file src/runtime/object_pool.cc
+ * \brief Thread-caching size-class pools of PoolObjAllocator.
+ */
+#include <tvm/runtime/container/map.h>
+#include <tvm/runtime/container/shape_tuple.h>
+#include <tvm/runtime/container/string.h>
+#include <tvm/runtime/memory.h>
+#include <tvm/runtime/registry.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <unordered_set>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+namespace {
+
+/*! \brief The granularity of the size classes. */
+constexpr size_t kSizeGranule = alignof(std::max_align_t);
+/*! \brief The largest size served from the pools, larger ones go to the global heap. */
+constexpr size_t kMaxPooledSize = 512;
+/*! \brief The number of size classes. */
+constexpr size_t kNumSizeClasses = kMaxPooledSize / kSizeGranule;
+/*! \brief The bytes of the chunks carved into blocks. */
+constexpr size_t kChunkBytes = 64 << 10;
+/*! \brief The bytes of blocks moved between a thread cache and the central pool at once. */
+constexpr size_t kBatchBytes = 16 << 10;
+/*! \brief The number of types per page of counters. */
+constexpr uint32_t kCounterPageSize = 256;
+/*! \brief The maximum number of pages of counters, types beyond them are not counted. */
+constexpr uint32_t kMaxCounterPages = 64;
+
+/*! \brief A free block, linked through its first bytes. */
+struct FreeBlock {
+  FreeBlock* next;
+};
+
+/*! \brief A list of free blocks of one size class. */
+struct FreeList {
+  FreeBlock* head{nullptr};
+  size_t size{0};
+
+  void Push(void* ptr) {
+    FreeBlock* block = static_cast<FreeBlock*>(ptr);
+    block->next = head;
+    head = block;
+    ++size;
+  }
+
+  void* Pop() {
+    FreeBlock* block = head;
+    head = block->next;
+    --size;
+    return block;
+  }
+
+  /*! \brief Move up to n blocks to another list. */
+  void MoveTo(FreeList* other, size_t n) {
+    for (; n != 0 && head != nullptr; --n) {
+      other->Push(Pop());
+    }
+  }
+};
+
+/*! \return The size class of a pooled size. */
+inline size_t SizeClass(size_t size) { return (size + kSizeGranule - 1) / kSizeGranule - 1; }
+
+/*! \return The number of blocks moved at once for a size class. */
+inline size_t BatchSize(size_t size_class) {
+  return std::max<size_t>(kBatchBytes / ((size_class + 1) * kSizeGranule), 4);
+}
+
+/*! \brief The allocation counters of a type. */
+struct TypeCounters {
+  std::atomic<uint64_t> num_alloc{0};
+  std::atomic<uint64_t> num_free{0};
+};
+
+/*!
+ * \brief Allocation counters indexed by type index, with pages created on first use.
+ *
+ *  Each set of counters is written by a single thread, so the counters are updated with plain
+ *  loads and stores, which are atomic only so that the statistics can read them meanwhile.
+ */
+class CounterTable {
+ public:
+  CounterTable() {
+    for (auto& page : pages_) {
+      page.store(nullptr, std::memory_order_relaxed);
+    }
+  }
+
+  ~CounterTable() {
+    for (auto& page : pages_) {
+      delete[] page.load(std::memory_order_relaxed);
+    }
+  }
+
+  /*!
+   * \brief Get the counters of a type, created if needed, only called by the owning thread.
+   * \return The counters, nullptr if the type index is beyond the table.
+   */
+  TypeCounters* Get(uint32_t type_index) {
+    uint32_t page_index = type_index / kCounterPageSize;
+    if (page_index >= kMaxCounterPages) return nullptr;
+    TypeCounters* page = pages_[page_index].load(std::memory_order_relaxed);
+    if (page == nullptr) {
+      page = new TypeCounters[kCounterPageSize];
+      pages_[page_index].store(page, std::memory_order_release);
+    }
+    return page + type_index % kCounterPageSize;
+  }
+
+  /*! \brief Add the counters to a vector of (num_alloc, num_free) indexed by type index. */
+  void AddTo(std::vector<std::pair<uint64_t, uint64_t>>* totals) const {
+    for (uint32_t i = 0; i < kMaxCounterPages; ++i) {
+      const TypeCounters* page = pages_[i].load(std::memory_order_acquire);
+      if (page == nullptr) continue;
+      for (uint32_t j = 0; j < kCounterPageSize; ++j) {
+        uint64_t num_alloc = page[j].num_alloc.load(std::memory_order_relaxed);
+        if (num_alloc == 0 && page[j].num_free.load(std::memory_order_relaxed) == 0) continue;
+        size_t type_index = i * kCounterPageSize + j;
+        if (totals->size() <= type_index) totals->resize(type_index + 1);
+        (*totals)[type_index].first += num_alloc;
+        (*totals)[type_index].second += page[j].num_free.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /*! \brief Add the counters of another table, only called by the owning thread. */
+  void Merge(const CounterTable& other) {
+    for (uint32_t i = 0; i < kMaxCounterPages; ++i) {
+      const TypeCounters* page = other.pages_[i].load(std::memory_order_acquire);
+      if (page == nullptr) continue;
+      for (uint32_t j = 0; j < kCounterPageSize; ++j) {
+        uint64_t num_alloc = page[j].num_alloc.load(std::memory_order_relaxed);
+        uint64_t num_free = page[j].num_free.load(std::memory_order_relaxed);
+        if (num_alloc == 0 && num_free == 0) continue;
+        TypeCounters* counters = Get(i * kCounterPageSize + j);
+        Increase(&counters->num_alloc, num_alloc);
+        Increase(&counters->num_free, num_free);
+      }
+    }
+  }
+
+  /*! \brief Increase a counter written by a single thread. */
+  static void Increase(std::atomic<uint64_t>* counter, uint64_t value) {
+    counter->store(counter->load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+  }
+
+ private:
+  std::atomic<TypeCounters*> pages_[kMaxCounterPages];
+};
+
+class ThreadCache;
+
+/*!
+ * \brief The pools shared by all threads, which hold the blocks beyond the thread caches and the
+ *  counters of exited threads.
+ */
+class CentralPool {
+ public:
+  static CentralPool* Global() {
+    // Deliberately leaked, the thread caches of threads which exit late return their blocks here.
+    static CentralPool* inst = new CentralPool();
+    return inst;
+  }
+
+  /*! \brief Fill a thread list with a batch of blocks. */
+  void Refill(size_t size_class, FreeList* list) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t batch = BatchSize(size_class);
+    FreeList& free = free_[size_class];
+    if (free.head == nullptr) {
+      size_t block_size = (size_class + 1) * kSizeGranule;
+      char* chunk = static_cast<char*>(::operator new(kChunkBytes));
+      chunks_.push_back(chunk);
+      for (size_t offset = 0; offset + block_size <= kChunkBytes; offset += block_size) {
+        free.Push(chunk + offset);
+      }
+    }
+    free.MoveTo(list, batch);
+  }
+
+  /*! \brief Take back up to n blocks of a thread list. */
+  void Release(size_t size_class, FreeList* list, size_t n) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    list->MoveTo(&free_[size_class], n);
+  }
+
+  /*! \brief Allocate directly, for threads whose cache is already destroyed. */
+  void* Alloc(size_t size_class) {
+    FreeList list;
+    Refill(size_class, &list);
+    void* ptr = list.Pop();
+    Release(size_class, &list, list.size);
+    return ptr;
+  }
+
+  /*! \brief Free directly, for threads whose cache is already destroyed. */
+  void Free(void* ptr, size_t size_class) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_[size_class].Push(ptr);
+  }
+
+  /*! \brief Count an allocation or a free of a thread without cache. */
+  void Count(uint32_t type_index, bool alloc) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    TypeCounters* counters = exited_counters_.Get(type_index);
+    if (counters == nullptr) return;
+    CounterTable::Increase(alloc ? &counters->num_alloc : &counters->num_free, 1);
+  }
+
+  void AddThread(ThreadCache* cache) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    threads_.insert(cache);
+  }
+
+  /*! \brief Remove the cache of an exiting thread and keep its counters. */
+  void RemoveThread(ThreadCache* cache, const CounterTable& counters) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    threads_.erase(cache);
+    exited_counters_.Merge(counters);
+  }
+
+  /*! \return The (num_alloc, num_free) of each type index over all threads. */
+  std::vector<std::pair<uint64_t, uint64_t>> Stats();
+
+ private:
+  std::mutex mutex_;
+  FreeList free_[kNumSizeClasses];
+  std::vector<char*> chunks_;
+  std::unordered_set<ThreadCache*> threads_;
+  CounterTable exited_counters_;
+};
+
+/*! \brief The free blocks and the counters of a thread. */
+class ThreadCache {
+ public:
+  ThreadCache() { CentralPool::Global()->AddThread(this); }
+
+  ~ThreadCache() {
+    CentralPool* central = CentralPool::Global();
+    for (size_t i = 0; i < kNumSizeClasses; ++i) {
+      central->Release(i, &free_[i], free_[i].size);
+    }
+    central->RemoveThread(this, counters_);
+  }
+
+  void* Alloc(size_t size_class) {
+    FreeList& list = free_[size_class];
+    if (list.head == nullptr) {
+      CentralPool::Global()->Refill(size_class, &list);
+    }
+    return list.Pop();
+  }
+
+  void Free(void* ptr, size_t size_class) {
+    FreeList& list = free_[size_class];
+    list.Push(ptr);
+    // Keep at most two batches, the blocks freed by a consumer thread flow back to the producer.
+    size_t batch = BatchSize(size_class);
+    if (list.size > 2 * batch) {
+      CentralPool::Global()->Release(size_class, &list, batch);
+    }
+  }
+
+  /*! \brief Count an allocation or a free. */
+  void Count(uint32_t type_index, bool alloc) {
+    TypeCounters* counters = counters_.Get(type_index);
+    if (counters == nullptr) return;
+    CounterTable::Increase(alloc ? &counters->num_alloc : &counters->num_free, 1);
+  }
+
+  const CounterTable& counters() const { return counters_; }
+
+ private:
+  FreeList free_[kNumSizeClasses];
+  CounterTable counters_;
+};
+
+std::vector<std::pair<uint64_t, uint64_t>> CentralPool::Stats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<std::pair<uint64_t, uint64_t>> totals;
+  exited_counters_.AddTo(&totals);
+  for (const ThreadCache* cache : threads_) {
+    cache->counters().AddTo(&totals);
+  }
+  return totals;
+}
+
+/*! \brief The cache of the thread, nullptr before its creation and after its destruction. */
+thread_local ThreadCache* thread_cache = nullptr;
+/*! \brief Whether the cache of the thread was destroyed. */
+thread_local bool thread_cache_destroyed = false;
+
+/*! \brief Owns the cache of the thread and marks its destruction. */
+struct ThreadCacheHolder {
+  ThreadCache cache;
+
+  ThreadCacheHolder() { thread_cache = &cache; }
+
+  ~ThreadCacheHolder() {
+    thread_cache = nullptr;
+    thread_cache_destroyed = true;
+  }
+};
+
+/*! \return The cache of the thread, nullptr if it was already destroyed. */
+inline ThreadCache* GetThreadCache() {
+  if (thread_cache == nullptr && !thread_cache_destroyed) {
+    static thread_local ThreadCacheHolder holder;
+  }
+  return thread_cache;
+}
+
+}  // namespace
+
+namespace detail {
+
+void* ObjectPoolAlloc(size_t size, uint32_t type_index) {
+  ThreadCache* cache = GetThreadCache();
+  if (cache != nullptr) {
+    cache->Count(type_index, true);
+  } else {
+    CentralPool::Global()->Count(type_index, true);
+  }
+  if (size > kMaxPooledSize) return ::operator new(size);
+  size_t size_class = SizeClass(size);
+  return cache != nullptr ? cache->Alloc(size_class) : CentralPool::Global()->Alloc(size_class);
+}
+
+void ObjectPoolFree(void* ptr, size_t size, uint32_t type_index) {
+  ThreadCache* cache = GetThreadCache();
+  if (cache != nullptr) {
+    cache->Count(type_index, false);
+  } else {
+    CentralPool::Global()->Count(type_index, false);
+  }
+  if (size > kMaxPooledSize) {
+    ::operator delete(ptr);
+    return;
+  }
+  size_t size_class = SizeClass(size);
+  if (cache != nullptr) {
+    cache->Free(ptr, size_class);
+  } else {
+    CentralPool::Global()->Free(ptr, size_class);
+  }
+}
+
+}  // namespace detail
+
+TVM_REGISTER_GLOBAL("runtime.ObjectAllocatorStats").set_body_typed([]() {
+  // type key -> (number of allocations, number of frees) by PoolObjAllocator.
+  Map<String, ShapeTuple> stats;
+  std::vector<std::pair<uint64_t, uint64_t>> totals = CentralPool::Global()->Stats();
+  for (size_t i = 0; i < totals.size(); ++i) {
+    if (totals[i].first == 0 && totals[i].second == 0) continue;
+    stats.Set(Object::TypeIndex2Key(static_cast<uint32_t>(i)),
+              ShapeTuple({static_cast<int64_t>(totals[i].first),
+                          static_cast<int64_t>(totals[i].second)}));
+  }
+  return stats;
+});
+
+}  // namespace runtime
+}  // namespace tvm
@@ -0,0 +1,262 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*!
+ * \file pipeline_batcher.cc
+ */
+#include "pipeline_batcher.h"
+
+#include <utility>
+namespace tvm {
+namespace runtime {
+namespace {
+/*!
+ * \brief Copying rows on the leading dimension between two compact tensors.
+ * \param from The source tensor.
+ * \param from_row The first row to copy in the source.
+ * \param to The destination tensor.
+ * \param to_row The first row to write in the destination.
+ * \param rows The number of rows.
+ */
+void CopyRows(const NDArray& from, int64_t from_row, const NDArray& to, int64_t to_row,
+              int64_t rows) {
+  ICHECK(from.IsContiguous() && to.IsContiguous()) << "Batching requires compact tensors";
+  DLTensor src = *from.operator->();
+  DLTensor dst = *to.operator->();
+  size_t row_bytes = GetDataSize(src) / src.shape[0];
+  std::vector<int64_t> src_shape(src.shape, src.shape + src.ndim);
+  std::vector<int64_t> dst_shape(dst.shape, dst.shape + dst.ndim);
+  src_shape[0] = rows;
+  dst_shape[0] = rows;
+  src.shape = src_shape.data();
+  dst.shape = dst_shape.data();
+  src.byte_offset += from_row * row_bytes;
+  dst.byte_offset += to_row * row_bytes;
+  NDArray::CopyFromTo(&src, &dst);
+}
+}  // namespace
+
+PipelineBatcher::PipelineBatcher(Module executor, int max_batch_size, int64_t max_wait_us)
+    : executor_module_(executor), max_wait_(max_wait_us) {
+  executor_ = static_cast<PipelineExecutor*>(executor_module_.operator->());
+  input_names_ = executor_->GetInputNames();
+  ICHECK(!input_names_.empty()) << "The pipeline has no global input.";
+  int64_t batch_size = -1;
+  for (const auto& name : input_names_) {
+    NDArray input = executor_->GetInput(name);
+    ICHECK_GE(input->ndim, 1) << "The pipeline input " << name << " has no batch dimension.";
+    if (batch_size < 0) batch_size = input->shape[0];
+    ICHECK_EQ(input->shape[0], batch_size)
+        << "The pipeline input " << name << " does not have the batch size " << batch_size;
+  }
+  for (const auto& output : executor_->GetOutput()) {
+    ICHECK(output->ndim >= 1 && output->shape[0] == batch_size)
+        << "The pipeline outputs must have the batch size " << batch_size;
+  }
+  max_batch_size_ = max_batch_size > 0 ? max_batch_size : static_cast<int>(batch_size);
+  ICHECK_LE(max_batch_size_, batch_size)
+      << "The maximum batch size is larger than the batch size of the pipeline.";
+  dispatcher_ = std::thread([this]() { this->DispatchLoop(); });
+}
+
+PipelineBatcher::~PipelineBatcher() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  submit_cv_.notify_all();
+  if (dispatcher_.joinable()) {
+    dispatcher_.join();
+  }
+}
+
+int64_t PipelineBatcher::Submit(const Map<String, NDArray>& inputs) {
+  ICHECK_EQ(inputs.size(), input_names_.size())
+      << "The request must set every input of the pipeline.";
+  auto request = std::make_shared<Request>();
+  request->rows = -1;
+  for (const auto& name : input_names_) {
+    auto it = inputs.find(name);
+    ICHECK(it != inputs.end()) << "The request does not set the input " << name;
+    NDArray data = (*it).second;
+    NDArray input = executor_->GetInput(name);
+    ICHECK_EQ(data->ndim, input->ndim) << "Wrong number of dimensions of the input " << name;
+    for (int i = 1; i < input->ndim; i++) {
+      ICHECK_EQ(data->shape[i], input->shape[i]) << "Wrong shape of the input " << name;
+    }
+    ICHECK(TypeEqual(data->dtype, input->dtype)) << "Wrong data type of the input " << name;
+    if (request->rows < 0) request->rows = data->shape[0];
+    ICHECK_EQ(data->shape[0], request->rows)
+        << "The inputs of a request must have the same number of rows.";
+    request->inputs.push_back(data);
+  }
+  ICHECK(request->rows >= 1 && request->rows <= max_batch_size_)
+      << "A request must have between 1 and " << max_batch_size_ << " rows, got "
+      << request->rows;
+  request->submit_time = std::chrono::steady_clock::now();
+  int64_t request_id;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    request_id = next_id_++;
+    requests_[request_id] = request;
+    pending_.push_back(request);
+    pending_rows_ += request->rows;
+  }
+  submit_cv_.notify_one();
+  return request_id;
+}
+
+bool PipelineBatcher::IsReady(int64_t request_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ICHECK(request_id >= 0 && request_id < next_id_) << "Unknown request " << request_id;
+  auto it = requests_.find(request_id);
+  // The outputs of a request which is not tracked any more were taken or released.
+  return it == requests_.end() || it->second->done;
+}
+
+Array<NDArray> PipelineBatcher::Wait(int64_t request_id) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto it = requests_.find(request_id);
+  ICHECK(it != requests_.end()) << "Unknown request " << request_id
+                                 << ", or its outputs were already taken or released";
+  std::shared_ptr<Request> request = it->second;
+  done_cv_.wait(lock, [&request]() { return request->done; });
+  requests_.erase(request_id);
+  if (!request->error.empty()) {
+    LOG(FATAL) << "The batch of request " << request_id << " failed: " << request->error;
+  }
+  return request->outputs;
+}
+
+void PipelineBatcher::Release(int64_t request_id) {
+  std::shared_ptr<Request> request;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = requests_.find(request_id);
+    if (it == requests_.end()) return;
+    request = std::move(it->second);
+    requests_.erase(it);
+  }
+  // A completed request frees its outputs here, outside of the lock.
+}
+
+void PipelineBatcher::DispatchLoop() {
+  while (true) {
+    std::vector<std::shared_ptr<Request>> batch;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      submit_cv_.wait(lock, [this]() { return stop_ || !pending_.empty(); });
+      if (stop_) break;
+      // Waiting for the batch to fill up until the oldest request reaches the deadline.
+      auto deadline = pending_.front()->submit_time + max_wait_;
+      submit_cv_.wait_until(lock, deadline,
+                            [this]() { return stop_ || pending_rows_ >= max_batch_size_; });
+      if (stop_) break;
+      // Admitting the requests in order while they fit into the batch.
+      int64_t rows = 0;
+      while (!pending_.empty() && rows + pending_.front()->rows <= max_batch_size_) {
+        rows += pending_.front()->rows;
+        batch.push_back(std::move(pending_.front()));
+        pending_.pop_front();
+      }
+      pending_rows_ -= rows;
+    }
+    RunBatch(batch);
+  }
+  // Failing the requests which never ran.
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& request : pending_) {
+    request->error = "the batcher is destroyed";
+    request->done = true;
+  }
+  pending_.clear();
+  done_cv_.notify_all();
+}
+
+void PipelineBatcher::RunBatch(const std::vector<std::shared_ptr<Request>>& batch) {
+  std::vector<Array<NDArray>> results;
+  std::string error;
+  try {
+    int64_t row = 0;
+    for (const auto& request : batch) {
+      for (size_t i = 0; i < input_names_.size(); i++) {
+        CopyRows(request->inputs[i], 0, executor_->GetInput(input_names_[i]), row, request->rows);
+      }
+      row += request->rows;
+    }
+    executor_->Run(true);
+    Array<NDArray> outputs = executor_->GetOutput();
+    row = 0;
+    for (const auto& request : batch) {
+      Array<NDArray> result;
+      for (const auto& output : outputs) {
+        std::vector<int64_t> shape(output->shape, output->shape + output->ndim);
+        shape[0] = request->rows;
+        NDArray data = NDArray::Empty(shape, output->dtype, output->device);
+        CopyRows(output, row, data, 0, request->rows);
+        result.push_back(data);
+      }
+      results.push_back(result);
+      row += request->rows;
+    }
+  } catch (const std::exception& e) {
+    error = e.what();
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < batch.size(); i++) {
+      if (error.empty()) {
+        batch[i]->outputs = results[i];
+      } else {
+        batch[i]->error = error;
+      }
+      batch[i]->done = true;
+    }
+    num_batches_++;
+  }
+  done_cv_.notify_all();
+}
+
+PackedFunc PipelineBatcher::GetFunction(const std::string& name,
+                                        const ObjectPtr<Object>& sptr_to_self) {
+  if (name == "submit") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      *rv = this->Submit(args[0].operator Map<String, NDArray>());
+    });
+  } else if (name == "is_ready") {
+    return PackedFunc(
+        [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = this->IsReady(args[0]); });
+  } else if (name == "wait") {
+    return PackedFunc(
+        [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = this->Wait(args[0]); });
+  } else if (name == "release") {
+    return PackedFunc(
+        [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { this->Release(args[0]); });
+  } else if (name == "get_max_batch_size") {
+    return PackedFunc(
+        [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = this->MaxBatchSize(); });
+  } else if (name == "get_num_batches") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      *rv = num_batches_;
+    });
+  }
+  return PackedFunc();
+}
+}  // namespace runtime
+}  // namespace tvm
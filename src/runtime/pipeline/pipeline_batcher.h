@@ -0,0 +1,163 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*!
+ * \file pipeline_batcher.h
+ * \brief A front stage of the pipeline executor coalescing requests into batches.
+ */
+#ifndef TVM_RUNTIME_PIPELINE_PIPELINE_BATCHER_H_
+#define TVM_RUNTIME_PIPELINE_PIPELINE_BATCHER_H_
+
+#include <tvm/runtime/container/map.h>
+#include <tvm/runtime/container/string.h>
+#include <tvm/runtime/data_type.h>
+#include <tvm/runtime/module.h>
+#include <tvm/runtime/ndarray.h>
+#include <tvm/runtime/packed_func.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "pipeline_executor.h"
+namespace tvm {
+namespace runtime {
+/*!
+ * \brief Micro-batching front stage of a pipeline executor.
+ *
+ *  The modules of the pipeline are built for a batch size B on the leading dimension of every
+ *  global input and output. Callers submit requests with any number of rows up to the maximum
+ *  batch size. A dispatcher thread admits the queued requests in order until the next one does
+ *  not fit into the batch, or until the oldest request has waited longer than the deadline,
+ *  copies their rows into the pipeline inputs, runs the pipeline once and slices the outputs
+ *  back to every request. The rows not covered by a request keep stale data and their results
+ *  are dropped, so callers never pad their inputs.
+ *
+ *  While a batcher is active the pipeline executor must not be run directly.
+ */
+class TVM_DLL PipelineBatcher : public ModuleNode {
+ public:
+  /*!
+   * \brief Construct the batcher and start its dispatcher thread.
+   * \param executor The pipeline executor module.
+   * \param max_batch_size The maximum number of rows of a batch, 0 uses the batch size the
+   *  pipeline is built for.
+   * \param max_wait_us How long the oldest queued request waits for the batch to fill up.
+   */
+  PipelineBatcher(Module executor, int max_batch_size, int64_t max_wait_us);
+  ~PipelineBatcher();
+  /*!
+   * \return The type key of the executor.
+   */
+  const char* type_key() const final { return "PipelineBatcher"; }
+  /*!
+   * \brief Give frontends an access to packed functions.
+   * \param name The name of the function.
+   * \param sptr_to_self The pointer to the module node.
+   * \return The corresponding packed function.
+   */
+  PackedFunc GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) final;
+  /*!
+   * \brief Queue a request.
+   * \param inputs The value of every global input, with the rows of the request on the leading
+   *  dimension.
+   * \return The ID of the request.
+   */
+  int64_t Submit(const Map<String, NDArray>& inputs);
+  /*!
+   * \brief Check whether the outputs of a request are ready.
+   * \param request_id The ID returned by Submit.
+   * \return Whether the request completed, true once its outputs are taken or released.
+   */
+  bool IsReady(int64_t request_id);
+  /*!
+   * \brief Wait for a request to complete and take its outputs.
+   * \param request_id The ID returned by Submit.
+   * \return The global outputs holding the rows of the request.
+   */
+  Array<NDArray> Wait(int64_t request_id);
+  /*!
+   * \brief Drop a request whose outputs will not be taken. The request still runs if it is
+   *  queued, but its outputs are freed when it completes.
+   * \param request_id The ID returned by Submit.
+   */
+  void Release(int64_t request_id);
+  /*!\brief The maximum number of rows of a batch.*/
+  int MaxBatchSize() const { return max_batch_size_; }
+
+ private:
+  /*!\brief A queued request.*/
+  struct Request {
+    /*!\brief The inputs of the request in the order of input_names_.*/
+    std::vector<NDArray> inputs;
+    /*!\brief The number of rows.*/
+    int64_t rows;
+    /*!\brief When the request was queued.*/
+    std::chrono::steady_clock::time_point submit_time;
+    /*!\brief Whether the request completed.*/
+    bool done = false;
+    /*!\brief The outputs of the request.*/
+    Array<NDArray> outputs;
+    /*!\brief The error message if the batch failed.*/
+    std::string error;
+  };
+  /*!\brief The loop of the dispatcher thread.*/
+  void DispatchLoop();
+  /*!\brief Run the pipeline for one batch and scatter the results.*/
+  void RunBatch(const std::vector<std::shared_ptr<Request>>& batch);
+
+  /*!\brief Keeps the pipeline executor alive.*/
+  Module executor_module_;
+  /*!\brief The pipeline executor.*/
+  PipelineExecutor* executor_;
+  /*!\brief The names of the global inputs.*/
+  std::vector<std::string> input_names_;
+  /*!\brief The maximum number of rows of a batch.*/
+  int max_batch_size_;
+  /*!\brief The deadline of a batch relative to its oldest request.*/
+  std::chrono::microseconds max_wait_;
+  /*!\brief The requests waiting to be admitted into a batch.*/
+  std::deque<std::shared_ptr<Request>> pending_;
+  /*!\brief The number of rows of the pending requests.*/
+  int64_t pending_rows_ = 0;
+  /*!\brief All requests which have not been taken by Wait or released.*/
+  std::unordered_map<int64_t, std::shared_ptr<Request>> requests_;
+  /*!\brief The ID of the next request.*/
+  int64_t next_id_ = 0;
+  /*!\brief The number of batches the pipeline has run.*/
+  int64_t num_batches_ = 0;
+  /*!\brief Whether the dispatcher thread is asked to exit.*/
+  bool stop_ = false;
+  /*!\brief Protects the request states.*/
+  std::mutex mutex_;
+  /*!\brief Signaled when a request is queued or the batcher stops.*/
+  std::condition_variable submit_cv_;
+  /*!\brief Signaled when a batch completes.*/
+  std::condition_variable done_cv_;
+  /*!\brief The dispatcher thread.*/
+  std::thread dispatcher_;
+};
+}  // namespace runtime
+}  // namespace tvm
+#endif  // TVM_RUNTIME_PIPELINE_PIPELINE_BATCHER_H_
@@ -21,6 +21,10 @@
  * \file pipeline_executor.cc
  */
 #include "pipeline_executor.h"
+
+#include <algorithm>
+
+#include "pipeline_batcher.h"
 namespace tvm {
 namespace runtime {
 /*!
@@ -82,6 +86,17 @@ PackedFunc PipelineExecutor::GetFunction(const std::string& name,
   } else if (name == "get_execute_count") {
     return PackedFunc(
         [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = this->GetExecutionCount(); });
+  } else if (name == "get_stage_stats") {
+    return PackedFunc(
+        [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = this->GetStageStatistics(); });
+  } else if (name == "reset_stage_stats") {
+    return PackedFunc(
+        [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { this->ResetStageStatistics(); });
+  } else if (name == "create_batcher") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      auto batcher = make_object<PipelineBatcher>(Module(sptr_to_self), args[0], args[1]);
+      *rv = Module(batcher);
+    });
   } else {
     LOG(FATAL) << "Unknown packed function: " << name;
     return PackedFunc();
@@ -236,6 +251,49 @@ std::pair<int, int> PipelineExecutor::GetInputIndex(const std::string& name) {
   auto gruntime = runtimes_[index.first];
   return std::make_pair(index.first, gruntime->GetInputIndex(index.second));
 }
+/*!
+ * \brief Getting the per-stage statistics of the pipeline mode.
+ */
+profiling::Report PipelineExecutor::GetStageStatistics() {
+  Array<Map<String, ObjectRef>> calls;
+  String bottleneck = "";
+  double max_busy_per_run = -1;
+  for (auto runtime : runtimes_) {
+    Map<String, ObjectRef> row = runtime->GetStatistics();
+    int64_t count = row["Count"].as<profiling::CountNode>()->value;
+    double busy = row["Duration (us)"].as<profiling::DurationNode>()->microseconds;
+    if (count > 0 && busy / count > max_busy_per_run) {
+      max_busy_per_run = busy / count;
+      bottleneck = Downcast<String>(row["Name"]);
+    }
+    calls.push_back(row);
+  }
+  Map<String, ObjectRef> pipeline;
+  pipeline.Set("Count", ObjectRef(make_object<profiling::CountNode>(GetExecutionCount())));
+  pipeline.Set("Bottleneck", bottleneck);
+  Map<String, Map<String, ObjectRef>> device_metrics;
+  device_metrics.Set("pipeline", pipeline);
+  return profiling::Report(calls, device_metrics);
+}
+/*!
+ * \brief Clearing the per-stage statistics.
+ */
+void PipelineExecutor::ResetStageStatistics() {
+  for (auto runtime : runtimes_) {
+    runtime->ResetStatistics();
+  }
+}
+/*!
+ * \brief Return the names of the global inputs in alphabetical order.
+ */
+std::vector<std::string> PipelineExecutor::GetInputNames() const {
+  std::vector<std::string> names;
+  for (const auto& input : input_connection_config.input_connection) {
+    names.push_back(input.first);
+  }
+  std::sort(names.begin(), names.end());
+  return names;
+}
 /*!
  * \brief Getting the count of running pipeline.
  */
@@ -137,6 +137,18 @@ class TVM_DLL PipelineExecutor : public ModuleNode {
    *  return Return a module index and a input index.
    */
   std::pair<int, int> GetInputIndex(const std::string& name);
+  /*!
+   * \brief Getting the per-stage statistics of the pipeline mode. Every backend runtime is a row
+   *  with its busy, starve and blocked time and its input queue occupancy histogram. The
+   *  "pipeline" device metrics name the bottleneck, i.e. the stage with the longest busy time
+   *  per run, which bounds the throughput of the pipeline.
+   * \return The statistics as a profiling report.
+   */
+  profiling::Report GetStageStatistics();
+  /*!\brief Clearing the per-stage statistics.*/
+  void ResetStageStatistics();
+  /*!\brief Return the names of the global inputs in alphabetical order.*/
+  std::vector<std::string> GetInputNames() const;
   /*!\brief Load the module files information.*/
   ModuleConfig& LoadModuleConfig(dmlc::JSONReader* reader) {
     reader->BeginArray();
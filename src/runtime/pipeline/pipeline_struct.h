@@ -23,13 +23,17 @@
 #include <dmlc/json.h>
 #include <tvm/runtime/ndarray.h>
 #include <tvm/runtime/packed_func.h>
+#include <tvm/runtime/profiling.h>
 #include <tvm/runtime/threading_backend.h>
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <functional>
 #include <limits>
 #include <memory>
+#include <sstream>
 #include <string>
 #include <thread>
 #include <unordered_map>
@@ -176,63 +180,6 @@ class DataNotify {
    */
   bool GetExitState(void) { return exit_state_.load(std::memory_order_acquire); }
 };
-/*!\brief The container used to store the forwarding data of the pipeline.*/
-class QueueData {
- public:
-  /*!\brief Doing a deep copy for the 'QueueData' structure.*/
-  QueueData& operator=(const QueueData& data) {
-    CreateCopyFrom(data.GetDLData());
-    return *this;
-  }
-  QueueData& operator=(const NDArray& from) {
-    CreateCopyFrom(const_cast<DLTensor*>(from.operator->()));
-    return *this;
-  }
-  QueueData& operator=(const DLTensor* from) {
-    CreateCopyFrom(from);
-    return *this;
-  }
-  /*!\brief Create a deep copy of the 'DLTensor' data.*/
-  DLTensor* CreateCopyFrom(const DLTensor* from) {
-    if (!from) {
-      LOG(FATAL) << "the 'from' pointer is a null pointer!";
-      return nullptr;
-    }
-    size_t fromLen = tvm::runtime::GetDataSize(*from);
-    size_t toLen = data_ ? tvm::runtime::GetDataSize(*data_) : 0;
-    if (!(device_type_ == from->device.device_type && device_id_ == from->device.device_id) ||
-        fromLen != toLen) {
-      if (data_) {
-        TVMArrayFree(data_);
-        data_ = nullptr;
-      }
-      TVMArrayAlloc(from->shape, from->ndim, from->dtype.code, from->dtype.bits, from->dtype.lanes,
-                    from->device.device_type, from->device.device_id, &data_);
-    }
-    TVMArrayCopyFromTo(const_cast<DLTensor*>(from), data_, nullptr);
-    device_type_ = from->device.device_type;
-    device_id_ = from->device.device_id;
-    return data_;
-  }
-  /*!\brief Return a pointer to the 'DLTensor' data.*/
-  DLTensor* GetDLData() const { return data_; }
-  const int DeviceType() { return device_type_; }
-  const int DeviceID() { return device_id_; }
-  ~QueueData() {
-    if (data_) {
-      TVMArrayFree(data_);
-      data_ = nullptr;
-    }
-  }
-
- private:
-  /*!\brief Pointer to the forwarding data.*/
-  DLTensor* data_ = nullptr;
-  /*!\brief The type of device which generated the QueueData container.*/
-  int device_type_;
-  /*!\brief The id of device which generated the data in this container.*/
-  int device_id_;
-};
 /*!
  * \brief All binding information of an output interface.
  */
@@ -612,11 +559,48 @@ struct ParamConnectionConfig {
     }
   }
 };
+/*!\brief The number of tensors which can be in flight between two interfaces of backend cores.*/
+constexpr size_t kForwardQueueCapacity = 4;
 /*!
  * \brief The single consumer single producer queue which is used to forward data between two
- * interfaces of backend cores.
+ *  interfaces of backend cores. The queue carries references to the buffers of the producer's
+ *  output ring, so forwarding a tensor hands over its ownership instead of copying it.
+ */
+using ForwardQueue = SPSCLockFreeQueue<NDArray, ModuleInterfaceID>;
+/*!
+ * \brief The timing counters of a backend runtime in the pipeline mode. They are written by the
+ *  thread of the runtime and read by any thread.
  */
-using ForwardQueue = SPSCLockFreeQueue<QueueData, ModuleInterfaceID>;
+struct StageStatistics {
+  /*!\brief The number of runs.*/
+  std::atomic<int64_t> num_runs{0};
+  /*!\brief The time spent running the module and forwarding its outputs.*/
+  std::atomic<int64_t> busy_ns{0};
+  /*!\brief The time spent waiting for the data of the parent runtimes.*/
+  std::atomic<int64_t> starve_ns{0};
+  /*!\brief The time spent waiting for space in a full queue of a child runtime.*/
+  std::atomic<int64_t> blocked_ns{0};
+  /*!
+   * \brief The histogram of the input queue occupancy, sampled for every input queue when the
+   *  runtime starts waiting for data. The bucket i counts the samples finding i tensors.
+   */
+  std::vector<std::atomic<int64_t>> occupancy;
+  StageStatistics() : occupancy(kForwardQueueCapacity + 1) {}
+  /*!\brief Clearing the counters.*/
+  void Reset() {
+    num_runs = 0;
+    busy_ns = 0;
+    starve_ns = 0;
+    blocked_ns = 0;
+    for (auto& bucket : occupancy) bucket = 0;
+  }
+  /*!\brief The nanoseconds elapsed since the given time.*/
+  static int64_t Since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                                                start)
+        .count();
+  }
+};
 /*
  *!\brief Backend Runtime.
  */
@@ -642,6 +626,8 @@ class BackendRuntime {
   std::unordered_map<int, std::shared_ptr<DataNotify>> parents_notify_;
   /*!\brief The execution count of the 'RunPipeline' function. */
   uint32_t pipeline_execution_count_ = 0;
+  /*!\brief The timing counters of the pipeline mode.*/
+  StageStatistics stats_;
   /*!
    * \brief A list of SPSC input queues in which the input interface will poll the data sent from
    *  other backend cores.
@@ -658,8 +644,32 @@ class BackendRuntime {
    * input data and local tensor vairable.
    */
   std::unordered_map<DLTensor*, DLTensor*> input_tensor_local_copy_;
+  /*!
+   * \brief The buffer ring of each forwarded output. A buffer is free when the ring holds the
+   *  only reference to it, i.e. no queue and no child runtime still uses it.
+   */
+  std::unordered_map<int, std::vector<NDArray>> output_rings_;
+  /*!\brief Whether an output can be written by the module directly into a ring buffer.*/
+  std::unordered_map<int, bool> output_zero_copy_;
+  /*!\brief The ring buffers bound as outputs for the current run.*/
+  std::unordered_map<int, NDArray> bound_outputs_;
+  /*!\brief Whether any output was bound to a ring buffer since the last 'Run'.*/
+  bool outputs_rebound_ = false;
+  /*!
+   * \brief Whether the inputs can be bound to the forwarded buffers. It is false when an output
+   *  of the module is not produced by an operator, as such an output reads the internal buffer
+   *  of an input.
+   */
+  bool input_zero_copy_allowed_ = false;
+  /*!\brief Whether an input can be bound to a forwarded buffer.*/
+  std::unordered_map<int, bool> input_zero_copy_;
+  /*!\brief The forwarded buffers bound as inputs, kept alive until the next data arrives.*/
+  std::unordered_map<int, NDArray> bound_inputs_;
   /*!\brief The packed functions.*/
   tvm::runtime::PackedFunc set_input_;
+  tvm::runtime::PackedFunc set_input_zero_copy_;
+  tvm::runtime::PackedFunc set_output_zero_copy_;
+  tvm::runtime::PackedFunc output_supports_zero_copy_;
   tvm::runtime::PackedFunc get_input_;
   tvm::runtime::PackedFunc get_output_;
   tvm::runtime::PackedFunc get_num_output_;
@@ -711,6 +721,11 @@ class BackendRuntime {
    * \return Returning 'true' when getting a 'exit' notification otherwise returning 'false'.
    */
   bool WaitAndLoadPipelineData() {
+    auto start = std::chrono::steady_clock::now();
+    for (auto& queue : input_queue_) {
+      size_t size = std::min<size_t>(queue.second->Size(), kForwardQueueCapacity);
+      stats_.occupancy[size].fetch_add(1, std::memory_order_relaxed);
+    }
     std::unordered_map<int, std::shared_ptr<DataNotify>> notifys = parents_notify_;
     bool exit_notify = false;
     while (!notifys.empty() && !exit_notify) {
@@ -734,6 +749,7 @@ class BackendRuntime {
               << ").input(" << target_input_interface_index << ")";
       notifys.erase(notify);
     }
+    stats_.starve_ns.fetch_add(StageStatistics::Since(start), std::memory_order_relaxed);
     return exit_notify;
   }
   /*!
@@ -747,14 +763,92 @@ class BackendRuntime {
       return false;
     }
     auto queue = input_queue_[input_index];
-    QueueData data;
-    // TODO(huajsj): Doing the 'SetInput' inside the poll function to avoid one time data copy.
-    if (!queue->Poll<QueueData>(&data)) {
+    NDArray data;
+    if (!queue->Poll<NDArray>(&data)) {
       return false;
     }
-    SetInput(input_index, data.GetDLData());
+    DLTensor* dltensor = const_cast<DLTensor*>(data.operator->());
+    auto zero_copy = input_zero_copy_.find(input_index);
+    if (input_zero_copy_allowed_ && (zero_copy == input_zero_copy_.end() || zero_copy->second)) {
+      // The first binding tells whether the module accepts the forwarded buffer, e.g. it is
+      // rejected when the buffer lives on another device.
+      try {
+        set_input_zero_copy_(input_index, dltensor);
+        input_zero_copy_[input_index] = true;
+        // Releasing the previously bound buffer back to the ring of the parent runtime.
+        bound_inputs_[input_index] = data;
+        return true;
+      } catch (const std::exception& e) {
+        VLOG(1) << "Runtime " << runtime_idx_ << " input " << input_index
+                << " falls back to copying the forwarded data: " << e.what();
+        input_zero_copy_[input_index] = false;
+      }
+    }
+    SetInput(input_index, dltensor);
     return true;
   }
+  /*!
+   * \brief Finding a free buffer in the ring of a forwarded output, the ring grows when all of
+   *  its buffers are in flight. The capacity of the forwarding queues bounds the ring size.
+   */
+  NDArray AcquireRingBuffer(int output_idx) {
+    auto& ring = output_rings_[output_idx];
+    for (auto& buffer : ring) {
+      if (buffer.unique()) {
+        // Pairs with the release decrement of the reference count in the child runtime, so the
+        // child has finished reading the buffer before it gets overwritten.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return buffer;
+      }
+    }
+    ring.push_back(CreateFromOutput(output_idx));
+    return ring.back();
+  }
+  /*!\brief Binding a free ring buffer to every forwarded output which supports zero copy.*/
+  void BindForwardingOutputs() {
+    for (auto& output : output_zero_copy_) {
+      if (!output.second) continue;
+      NDArray buffer = AcquireRingBuffer(output.first);
+      set_output_zero_copy_(output.first, const_cast<DLTensor*>(buffer.operator->()));
+      bound_outputs_[output.first] = buffer;
+      outputs_rebound_ = true;
+    }
+  }
+  /*!\brief Binding the inputs and outputs back to the internal buffers of the module.*/
+  void RestoreInternalBuffers() {
+    if (outputs_rebound_) {
+      for (auto& output : output_zero_copy_) {
+        if (!output.second) continue;
+        NDArray internal = get_output_(output.first);
+        set_output_zero_copy_(output.first, const_cast<DLTensor*>(internal.operator->()));
+      }
+      outputs_rebound_ = false;
+    }
+    for (auto& input : bound_inputs_) {
+      NDArray internal = get_input_(input.first);
+      set_input_zero_copy_(input.first, const_cast<DLTensor*>(internal.operator->()));
+    }
+    bound_inputs_.clear();
+  }
+  /*!
+   * \brief Checking which outputs the module can write directly into an external buffer. A
+   *  module which can not tell is assumed to support none of them.
+   */
+  void CheckOutputZeroCopy() {
+    input_zero_copy_allowed_ = true;
+    for (int i = 0; i < NumOutputs(); i++) {
+      bool supported = false;
+      if (output_supports_zero_copy_ != nullptr) {
+        supported = output_supports_zero_copy_(i);
+      }
+      if (!supported) {
+        input_zero_copy_allowed_ = false;
+      }
+      if (children_.find(i) != children_.end()) {
+        output_zero_copy_[i] = supported;
+      }
+    }
+  }
   /*!
    * \brief Forwarding the output data into the child runtimes.
    * \return bool Return false when the "PipelineIsStop" function returns true or this function
@@ -767,8 +861,19 @@ class BackendRuntime {
         LOG(FATAL) << "Not find the forwarding queue map for output(" << output_idx << ")!";
         return false;
       }
-      NDArray output = GetOutput(output_idx);
-      auto forward_queue_map = output_queue_[output_idx];
+      NDArray output;
+      auto bound = bound_outputs_.find(output_idx);
+      if (bound != bound_outputs_.end()) {
+        // The module wrote the output into the ring buffer.
+        output = bound->second;
+        bound_outputs_.erase(bound);
+      } else {
+        output = AcquireRingBuffer(output_idx);
+        NDArray internal = GetOutput(output_idx);
+        CopyFromTo(const_cast<DLTensor*>(internal.operator->()),
+                   const_cast<DLTensor*>(output.operator->()));
+      }
+      auto& forward_queue_map = output_queue_[output_idx];
       // Notifying the 'children runtime' that the forwarding data are ready.
       for (auto module_pair : child.second) {
         auto child_runtime = module_pair.first;
@@ -781,10 +886,13 @@ class BackendRuntime {
                      << runtime_idx_ << ").output(" << output_idx << ")";
         }
         auto forward_queue = forward_queue_map[queue_id];
-        // If the queue is full, keep try until the push get success or the pipeline run into
-        // a STOP state.
+        // If the queue is full, wait until the child runtime consumes the data or the pipeline
+        // runs into a STOP state.
         while (!forward_queue->Push<NDArray>(output)) {
-          if (PipelineIsStop()) {
+          auto start = std::chrono::steady_clock::now();
+          bool has_space = forward_queue->WaitForSpace([this]() { return PipelineIsStop(); });
+          stats_.blocked_ns.fetch_add(StageStatistics::Since(start), std::memory_order_relaxed);
+          if (!has_space) {
             LOG(INFO) << "The forwarding process is stopped after the pipeline status is changed"
                       << " into stop.";
             return false;
@@ -874,6 +982,9 @@ class BackendRuntime {
     get_num_output_ = module_.GetFunction("get_num_outputs");
     get_num_inputs_ = module_.GetFunction("get_num_inputs");
     set_input_ = module_.GetFunction("set_input");
+    set_input_zero_copy_ = module_.GetFunction("set_input_zero_copy");
+    set_output_zero_copy_ = module_.GetFunction("set_output_zero_copy");
+    output_supports_zero_copy_ = module_.GetFunction("output_supports_zero_copy");
     get_input_ = module_.GetFunction("get_input");
     get_output_ = module_.GetFunction("get_output");
     run_ = module_.GetFunction("run");
@@ -921,6 +1032,7 @@ class BackendRuntime {
         },
         runtime_idx_);
 
+    CheckOutputZeroCopy();
     StartWorkThread();
   }
   /*!
@@ -967,7 +1079,7 @@ class BackendRuntime {
                  << " is already created!";
       return;
     }
-    auto queue = std::make_shared<ForwardQueue>(queue_id);
+    auto queue = std::make_shared<ForwardQueue>(queue_id, kForwardQueueCapacity);
     queue_map[queue_id] = queue;
     // Use the created queue as the consumer queue for the input interface of this forwarding
     // pair.
@@ -989,6 +1101,12 @@ class BackendRuntime {
   int NumInputs() const { return get_num_inputs_(); }
   /*!\brief Setting the data to this module via input index.*/
   void SetInput(const int index, DLTensor* data_in) {
+    auto bound = bound_inputs_.find(index);
+    if (bound != bound_inputs_.end()) {
+      NDArray internal = get_input_(index);
+      set_input_zero_copy_(index, const_cast<DLTensor*>(internal.operator->()));
+      bound_inputs_.erase(bound);
+    }
     NDArray input = get_input_(index);
     DLTensor* dltensor_input = const_cast<DLTensor*>(input.operator->());
     CopyFromTo(data_in, dltensor_input);
@@ -1005,17 +1123,53 @@ class BackendRuntime {
   /*!\brief Using the output index to get the module output.*/
   NDArray GetOutput(int index) { return get_output_(index); }
   /*!\brief Running the runtime.*/
-  void Run() { run_(); }
+  void Run() {
+    RestoreInternalBuffers();
+    run_();
+  }
   /*!
    * \brief Running the runtime in the pipeline mode.
    * \return Returning false if the forwarding function failed. Otherwise, returning true.;
    */
   bool RunPipeline() {
-    Run();
+    auto start = std::chrono::steady_clock::now();
+    int64_t blocked_ns = stats_.blocked_ns.load(std::memory_order_relaxed);
+    BindForwardingOutputs();
+    run_();
     bool ret = ForwardingOutputDataToChildren();
+    blocked_ns = stats_.blocked_ns.load(std::memory_order_relaxed) - blocked_ns;
+    stats_.busy_ns.fetch_add(StageStatistics::Since(start) - blocked_ns,
+                             std::memory_order_relaxed);
+    stats_.num_runs.fetch_add(1, std::memory_order_relaxed);
     pipeline_execution_count_++;
     return ret;
   }
+  /*!
+   * \brief Getting the statistics of the pipeline mode as a row of a profiling report.
+   * \return The metrics of the runtime, the durations are totals over all runs.
+   */
+  Map<String, ObjectRef> GetStatistics() const {
+    int64_t busy_ns = stats_.busy_ns.load(std::memory_order_relaxed);
+    int64_t starve_ns = stats_.starve_ns.load(std::memory_order_relaxed);
+    int64_t blocked_ns = stats_.blocked_ns.load(std::memory_order_relaxed);
+    int64_t total_ns = busy_ns + starve_ns + blocked_ns;
+    std::ostringstream occupancy;
+    for (size_t i = 0; i < stats_.occupancy.size(); i++) {
+      occupancy << (i ? " " : "") << i << ":" << stats_.occupancy[i].load();
+    }
+    Map<String, ObjectRef> row;
+    row.Set("Name", String("runtime" + std::to_string(runtime_idx_)));
+    row.Set("Count", ObjectRef(make_object<profiling::CountNode>(stats_.num_runs.load())));
+    row.Set("Duration (us)", ObjectRef(make_object<profiling::DurationNode>(busy_ns / 1e3)));
+    row.Set("Starve (us)", ObjectRef(make_object<profiling::DurationNode>(starve_ns / 1e3)));
+    row.Set("Blocked (us)", ObjectRef(make_object<profiling::DurationNode>(blocked_ns / 1e3)));
+    row.Set("Busy (%)", ObjectRef(make_object<profiling::PercentNode>(
+                            total_ns ? 100.0 * busy_ns / total_ns : 0.0)));
+    row.Set("Input Queue Occupancy", String(occupancy.str()));
+    return row;
+  }
+  /*!\brief Clearing the statistics of the pipeline mode.*/
+  void ResetStatistics() { stats_.Reset(); }
 };
 /*!
  * \brief The information used to initialize the graph executor module, the information
@@ -18,27 +18,39 @@
  */
 #ifndef TVM_RUNTIME_PIPELINE_SPSC_QUEUE_H_
 #define TVM_RUNTIME_PIPELINE_SPSC_QUEUE_H_
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstddef>
+#include <mutex>
 #include <thread>
-/*!\brief A single producer and single consumer lock free queue.
+#include <utility>
+#include <vector>
+/*!
+ * \brief A single producer and single consumer lock free queue with a bounded capacity.
+ *
+ *  The producer and the consumer each own one index, published with release stores and read
+ *  with acquire loads. A producer finding the queue full can block in WaitForSpace, the mutex
+ *  and the condition variable are only touched while it waits.
  */
 template <typename SlotType, typename IDType = int, int QueueLength = 1024>
 class SPSCLockFreeQueue {
  public:
-  explicit SPSCLockFreeQueue(IDType id) : id_(id) {}
-  /*A read barrier enforcing the CPU to performe the reads before this barrier.*/
-  inline void read_barrier() { std::atomic_thread_fence(std::memory_order_acquire); }
-  /*A write barrier enforcing the CPU to performe the writes before this barrier.*/
-  inline void write_barrier() { std::atomic_thread_fence(std::memory_order_release); }
-  /*!\brief Checking whether the queue is full.*/
-  bool Full() {
-    read_barrier();
-    return ((tail_ + 1) % len_) == head_;
+  /*!
+   * \brief Construct the queue.
+   * \param id The ID of the queue.
+   * \param capacity The maximum number of elements in the queue.
+   */
+  explicit SPSCLockFreeQueue(IDType id, size_t capacity = QueueLength - 1)
+      : len_(capacity + 1), queue_(capacity + 1), id_(id) {}
+  /*!\brief Checking whether the queue is full. Only meaningful for the producer.*/
+  bool Full() const {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    return ((tail + 1) % len_) == head_.load(std::memory_order_acquire);
   }
-  /*!brief Checking whether the queue is empty.*/
-  bool Empty() {
-    read_barrier();
-    return head_ == tail_;
+  /*!brief Checking whether the queue is empty. Only meaningful for the consumer.*/
+  bool Empty() const {
+    return head_.load(std::memory_order_relaxed) == tail_.load(std::memory_order_acquire);
   }
   /*!
    * \brief Pushing the data into the queue. Only a single producer will call this function.
@@ -47,37 +59,75 @@ class SPSCLockFreeQueue {
    */
   template <typename data_type>
   bool Push(const data_type& data) {
-    if (Full()) return false;
-    queue_[tail_] = data;
-    write_barrier();
-    tail_ = (tail_ + 1) % len_;
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    size_t next = (tail + 1) % len_;
+    if (next == head_.load(std::memory_order_acquire)) return false;
+    queue_[tail] = data;
+    tail_.store(next, std::memory_order_release);
     return true;
   }
   /*!
    * \brief Poll the data from the front of the queue. Only the single consumer will call this
-   *  function.
+   *  function. The slot is moved out, so the queue does not keep a reference to the data.
    * \param data A pointer to the structure which stores the polled data..
    * \return Returning false when the queue is empty. Otherwise, return true.
    */
   template <typename data_type>
   bool Poll(data_type* data) {
-    if (Empty()) return false;
-    *data = queue_[head_];
-    write_barrier();
-    head_ = (head_ + 1) % len_;
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) return false;
+    *data = std::move(queue_[head]);
+    queue_[head] = SlotType();
+    head_.store((head + 1) % len_, std::memory_order_seq_cst);
+    if (producer_waiting_.load(std::memory_order_seq_cst)) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      space_cv_.notify_one();
+    }
     return true;
   }
+  /*!
+   * \brief Block the producer until the queue has space or \p stop returns true.
+   * \param stop Polled periodically, the wait gives up when it returns true.
+   * \return Whether the queue has space.
+   */
+  template <typename StopFunc>
+  bool WaitForSpace(StopFunc stop) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    producer_waiting_.store(true, std::memory_order_seq_cst);
+    while (Full()) {
+      if (stop()) break;
+      space_cv_.wait_for(lock, std::chrono::milliseconds(10));
+    }
+    producer_waiting_.store(false, std::memory_order_relaxed);
+    return !Full();
+  }
+  /*!\brief The number of elements in the queue, a snapshot when read by another thread.*/
+  size_t Size() const {
+    size_t head = head_.load(std::memory_order_acquire);
+    size_t tail = tail_.load(std::memory_order_acquire);
+    return (tail + len_ - head) % len_;
+  }
+  /*!\brief The maximum number of elements in the queue.*/
+  size_t Capacity() const { return len_ - 1; }
 
  private:
   /*!\brief The pointer points to the first slot with valid data in the queue.*/
-  size_t head_ = 0;
+  std::atomic<size_t> head_{0};
+  /*!\brief Keeps the indices of the producer and the consumer on different cache lines.*/
+  char padding_[64];
   /*!\brief The end of the queue at which elements are added.*/
-  size_t tail_ = 0;
-  /*!\brief The length of the queue.*/
-  size_t len_ = QueueLength;
+  std::atomic<size_t> tail_{0};
+  /*!\brief The number of slots, one more than the capacity.*/
+  size_t len_;
   /*!\brief The queue used to store the data.*/
-  SlotType queue_[QueueLength];
+  std::vector<SlotType> queue_;
   /*!\brief The ID of the queue.*/
   IDType id_;
+  /*!\brief Whether the producer waits for space.*/
+  std::atomic<bool> producer_waiting_{false};
+  /*!\brief Protects the wait on space_cv_.*/
+  std::mutex mutex_;
+  /*!\brief Signaled when the consumer frees a slot while the producer waits.*/
+  std::condition_variable space_cv_;
 };
 #endif  // TVM_RUNTIME_PIPELINE_SPSC_QUEUE_H_
@@ -27,9 +27,11 @@
 #include <tvm/runtime/registry.h>
 
 #include <array>
+#include <cstring>
 #include <memory>
 #include <mutex>
-#include <unordered_map>
+#include <string>
+#include <vector>
 
 #include "runtime_base.h"
 
@@ -37,24 +39,117 @@ namespace tvm {
 namespace runtime {
 
 struct Registry::Manager {
-  // map storing the functions.
-  // We deliberately used raw pointer.
-  // This is because PackedFunc can contain callbacks into the host language (Python) and the
-  // resource can become invalid because of indeterministic order of destruction and forking.
-  // The resources will only be recycled during program exit.
-  std::unordered_map<std::string, Registry*> fmap;
-  // mutex
-  std::mutex mutex;
+  // The functions are stored in interned handles of their names, which are kept in open
+  // addressing tables. Lookups probe a table without locks; registrations take the lock of a
+  // shard, insert new handles with release stores and replace the table of the shard by a larger
+  // copy when it becomes half full.
+  //
+  // We deliberately used raw pointer and never free the handles, the registries and the
+  // replaced tables. This is because PackedFunc can contain callbacks into the host language
+  // (Python) and the resource can become invalid because of indeterministic order of destruction
+  // and forking. It also keeps the pointers returned by lookups which race with an override or a
+  // removal valid. The resources will only be recycled during program exit.
+  struct Table {
+    explicit Table(size_t capacity)
+        : mask(capacity - 1), slots(new std::atomic<Handle*>[capacity]) {
+      for (size_t i = 0; i < capacity; ++i) {
+        slots[i].store(nullptr, std::memory_order_relaxed);
+      }
+    }
+    // capacity - 1, the capacity is a power of two.
+    size_t mask;
+    // the handles, nullptr for an empty slot.
+    std::unique_ptr<std::atomic<Handle*>[]> slots;
+  };
+
+  struct Shard {
+    // the current table.
+    std::atomic<Table*> table{nullptr};
+    // all tables of the shard, readers can still probe the replaced ones.
+    std::vector<std::unique_ptr<Table>> tables;
+    // number of handles in the table.
+    size_t size{0};
+    // mutex of writers.
+    std::mutex mutex;
+  };
 
-  Manager() {}
+  static constexpr int kShardBits = 4;
+  static constexpr size_t kInitialCapacity = 64;
+
+  std::array<Shard, 1 << kShardBits> shards;
+
+  Manager() {
+    for (Shard& shard : shards) {
+      shard.tables.emplace_back(new Table(kInitialCapacity));
+      shard.table.store(shard.tables.back().get(), std::memory_order_release);
+    }
+  }
 
   static Manager* Global() {
     // We deliberately leak the Manager instance, to avoid leak sanitizers
-    // complaining about the entries in Manager::fmap being leaked at program
-    // exit.
+    // complaining about the handles being leaked at program exit.
     static Manager* inst = new Manager();
     return inst;
   }
+
+  static uint64_t Hash(const char* name, size_t size) {
+    // FNV-1a, followed by the finalizer of MurmurHash3 to mix the high bits used by the shards.
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; ++i) {
+      hash = (hash ^ static_cast<unsigned char>(name[i])) * 1099511628211ULL;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb3fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+  }
+
+  Shard& ShardOf(uint64_t hash) { return shards[hash >> (64 - kShardBits)]; }
+
+  // Find the handle of a name without locking, nullptr if it was never interned.
+  Handle* Find(const char* name, size_t size, uint64_t hash) {
+    const Table* table = ShardOf(hash).table.load(std::memory_order_acquire);
+    for (size_t i = hash & table->mask;; i = (i + 1) & table->mask) {
+      Handle* handle = table->slots[i].load(std::memory_order_acquire);
+      if (handle == nullptr) return nullptr;
+      if (handle->hash_ == hash && handle->name_.size() == size &&
+          std::memcmp(handle->name_.data(), name, size) == 0) {
+        return handle;
+      }
+    }
+  }
+
+  // Find or create the handle of a name, the shard of the hash must be locked.
+  Handle* InternLocked(const std::string& name, uint64_t hash) {
+    Handle* handle = Find(name.data(), name.size(), hash);
+    if (handle != nullptr) return handle;
+    Shard& shard = ShardOf(hash);
+    Table* table = shard.table.load(std::memory_order_relaxed);
+    if ((shard.size + 1) * 2 > table->mask + 1) {
+      std::unique_ptr<Table> grown(new Table((table->mask + 1) * 2));
+      for (size_t i = 0; i <= table->mask; ++i) {
+        Handle* h = table->slots[i].load(std::memory_order_relaxed);
+        if (h != nullptr) Insert(grown.get(), h);
+      }
+      table = grown.get();
+      shard.tables.push_back(std::move(grown));
+      shard.table.store(table, std::memory_order_release);
+    }
+    handle = new Handle(name, hash);
+    Insert(table, handle);
+    ++shard.size;
+    return handle;
+  }
+
+  static void Insert(Table* table, Handle* handle) {
+    size_t i = handle->hash_ & table->mask;
+    while (table->slots[i].load(std::memory_order_relaxed) != nullptr) {
+      i = (i + 1) & table->mask;
+    }
+    table->slots[i].store(handle, std::memory_order_release);
+  }
 };
 
 Registry& Registry::set_body(PackedFunc f) {  // NOLINT(*)
@@ -64,41 +159,60 @@ Registry& Registry::set_body(PackedFunc f) {  // NOLINT(*)
 
 Registry& Registry::Register(const std::string& name, bool can_override) {  // NOLINT(*)
   Manager* m = Manager::Global();
-  std::lock_guard<std::mutex> lock(m->mutex);
-  if (m->fmap.count(name)) {
+  uint64_t hash = Manager::Hash(name.data(), name.size());
+  std::lock_guard<std::mutex> lock(m->ShardOf(hash).mutex);
+  Handle* handle = m->InternLocked(name, hash);
+  if (handle->registry_.load(std::memory_order_relaxed) != nullptr) {
     ICHECK(can_override) << "Global PackedFunc " << name << " is already registered";
   }
 
   Registry* r = new Registry();
   r->name_ = name;
-  m->fmap[name] = r;
+  handle->registry_.store(r, std::memory_order_release);
   return *r;
 }
 
 bool Registry::Remove(const std::string& name) {
   Manager* m = Manager::Global();
-  std::lock_guard<std::mutex> lock(m->mutex);
-  auto it = m->fmap.find(name);
-  if (it == m->fmap.end()) return false;
-  m->fmap.erase(it);
+  uint64_t hash = Manager::Hash(name.data(), name.size());
+  std::lock_guard<std::mutex> lock(m->ShardOf(hash).mutex);
+  Handle* handle = m->Find(name.data(), name.size(), hash);
+  if (handle == nullptr || handle->registry_.load(std::memory_order_relaxed) == nullptr) {
+    return false;
+  }
+  handle->registry_.store(nullptr, std::memory_order_release);
   return true;
 }
 
-const PackedFunc* Registry::Get(const std::string& name) {
+const PackedFunc* Registry::Get(const std::string& name) { return Get(name.data(), name.size()); }
+
+const PackedFunc* Registry::Get(const char* name, size_t size) {
+  Manager* m = Manager::Global();
+  Handle* handle = m->Find(name, size, Manager::Hash(name, size));
+  return handle != nullptr ? handle->Get() : nullptr;
+}
+
+const Registry::Handle* Registry::Intern(const std::string& name) {
   Manager* m = Manager::Global();
-  std::lock_guard<std::mutex> lock(m->mutex);
-  auto it = m->fmap.find(name);
-  if (it == m->fmap.end()) return nullptr;
-  return &(it->second->func_);
+  uint64_t hash = Manager::Hash(name.data(), name.size());
+  Handle* handle = m->Find(name.data(), name.size(), hash);
+  if (handle != nullptr) return handle;
+  std::lock_guard<std::mutex> lock(m->ShardOf(hash).mutex);
+  return m->InternLocked(name, hash);
 }
 
 std::vector<std::string> Registry::ListNames() {
   Manager* m = Manager::Global();
-  std::lock_guard<std::mutex> lock(m->mutex);
   std::vector<std::string> keys;
-  keys.reserve(m->fmap.size());
-  for (const auto& kv : m->fmap) {
-    keys.push_back(kv.first);
+  for (Manager::Shard& shard : m->shards) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    const Manager::Table* table = shard.table.load(std::memory_order_relaxed);
+    for (size_t i = 0; i <= table->mask; ++i) {
+      Handle* handle = table->slots[i].load(std::memory_order_relaxed);
+      if (handle != nullptr && handle->registry_.load(std::memory_order_relaxed) != nullptr) {
+        keys.push_back(handle->name_);
+      }
+    }
   }
   return keys;
 }
@@ -199,7 +313,7 @@ int TVMFuncRegisterGlobal(const char* name, TVMFunctionHandle f, int override) {
 
 int TVMFuncGetGlobal(const char* name, TVMFunctionHandle* out) {
   API_BEGIN();
-  const tvm::runtime::PackedFunc* fp = tvm::runtime::Registry::Get(name);
+  const tvm::runtime::PackedFunc* fp = tvm::runtime::Registry::Get(name, std::strlen(name));
   if (fp != nullptr) {
     tvm::runtime::TVMRetValue ret;
     ret = *fp;
@@ -39,6 +39,7 @@
 #include <vector>
 
 #include "../../support/arena.h"
+#include "../../support/lz_codec.h"
 #include "../../support/ring_buffer.h"
 #include "../object_internal.h"
 #include "rpc_local_session.h"
@@ -468,6 +469,160 @@ class RPCEndpoint::EventHandler : public dmlc::Stream {
     }
   }
 
+  void HandleCopyToRemoteChunk() {
+    DLTensor* arr = RPCReference::ReceiveDLTensor(this);
+    uint64_t data_bytes;
+    int32_t codec;
+    int32_t last;
+    uint64_t payload_bytes;
+    this->Read(&data_bytes);
+    this->Read(&codec);
+    this->Read(&last);
+    this->Read(&payload_bytes);
+    size_t elem_bytes = (arr->dtype.bits * arr->dtype.lanes + 7) / 8;
+    auto* sess = GetServingSession();
+
+    // When session is local, we can directly write the chunk into the cpu tensor.
+    bool direct = arr->device.device_type == kDLCPU && sess->IsLocalSession();
+    char* data = direct ? reinterpret_cast<char*>(arr->data) + arr->byte_offset
+                        : this->ArenaAlloc<char>(data_bytes);
+    if (static_cast<RPCChunkCodec>(codec) == RPCChunkCodec::kLZ) {
+      char* payload = this->ArenaAlloc<char>(payload_bytes);
+      this->ReadArray(payload, payload_bytes);
+      if (!support::LZDecompress(payload, payload_bytes, data, data_bytes) &&
+          stream_error_.empty()) {
+        stream_error_ = "CopyToRemote: received a corrupted compressed chunk";
+      }
+    } else {
+      ICHECK_EQ(payload_bytes, data_bytes);
+      this->ReadArray(data, data_bytes);
+    }
+    if (!DMLC_IO_NO_ENDIAN_SWAP) {
+      dmlc::ByteSwap(data, elem_bytes, data_bytes / elem_bytes);
+    }
+
+    // Errors are reported once the last chunk arrives, as the client does not wait for the
+    // other chunks.
+    auto on_copy_complete = [this, last](RPCCode status, TVMArgs args) {
+      if (status == RPCCode::kException && stream_error_.empty()) {
+        stream_error_ = args.values[0].v_str;
+      }
+      if (last) {
+        if (stream_error_.empty()) {
+          this->ReturnVoid();
+        } else {
+          this->ReturnException(stream_error_.c_str());
+          stream_error_.clear();
+        }
+      }
+      this->SwitchToState(kRecvPacketNumBytes);
+    };
+
+    if (direct || !stream_error_.empty()) {
+      on_copy_complete(RPCCode::kReturn, TVMArgs(nullptr, nullptr, 0));
+    } else {
+      this->SwitchToState(kWaitForAsyncCallback);
+      sess->AsyncCopyToRemote(static_cast<void*>(data), arr, data_bytes, on_copy_complete);
+    }
+  }
+
+  /*! \brief The state of a chunked CopyFromRemote, which may continue in async callbacks. */
+  struct ChunkedCopy {
+    DLTensor tensor;
+    std::vector<int64_t> shape;
+    uint64_t base_offset;
+    uint64_t nbytes;
+    uint64_t chunk_bytes;
+    uint64_t offset{0};
+    bool compress;
+    std::vector<char> data;
+    std::vector<char> payload;
+    bool in_call{false};
+    bool completed_inline{false};
+  };
+
+  void HandleCopyFromRemoteChunked() {
+    DLTensor* arr = RPCReference::ReceiveDLTensor(this);
+    auto copy = std::make_shared<ChunkedCopy>();
+    int32_t compress;
+    this->Read(&copy->nbytes);
+    this->Read(&copy->chunk_bytes);
+    this->Read(&compress);
+    ICHECK_GT(copy->chunk_bytes, 0U);
+    // The tensor lives in the arena which is recycled when the state switches.
+    copy->tensor = *arr;
+    copy->shape.assign(arr->shape, arr->shape + arr->ndim);
+    copy->tensor.shape = copy->shape.data();
+    copy->base_offset = arr->byte_offset;
+    copy->compress = compress != 0;
+    copy->data.resize(std::min(copy->chunk_bytes, copy->nbytes));
+
+    this->SwitchToState(kWaitForAsyncCallback);
+    this->ContinueChunkedCopy(copy);
+  }
+
+  // Copy the remaining chunks, an asynchronous session continues in the callback.
+  void ContinueChunkedCopy(std::shared_ptr<ChunkedCopy> copy) {
+    auto* sess = GetServingSession();
+    while (copy->offset < copy->nbytes) {
+      uint64_t num_bytes = std::min(copy->chunk_bytes, copy->nbytes - copy->offset);
+      copy->tensor.byte_offset = copy->base_offset + copy->offset;
+      copy->in_call = true;
+      copy->completed_inline = false;
+      sess->AsyncCopyFromRemote(
+          &copy->tensor, copy->data.data(), num_bytes,
+          [this, copy, num_bytes](RPCCode status, TVMArgs args) {
+            if (status == RPCCode::kException) {
+              this->ReturnException(args.values[0].v_str);
+              copy->offset = copy->nbytes;
+            } else {
+              this->SendCopyChunk(copy.get(), num_bytes);
+              copy->offset += num_bytes;
+            }
+            if (copy->in_call) {
+              copy->completed_inline = true;
+            } else {
+              this->ContinueChunkedCopy(copy);
+            }
+          });
+      copy->in_call = false;
+      if (!copy->completed_inline) return;
+    }
+    this->SwitchToState(kRecvPacketNumBytes);
+  }
+
+  // Send a chunk of a chunked CopyFromRemote as a copy ack packet.
+  void SendCopyChunk(ChunkedCopy* copy, uint64_t num_bytes) {
+    char* data = copy->data.data();
+    if (!DMLC_IO_NO_ENDIAN_SWAP) {
+      size_t elem_bytes = (copy->tensor.dtype.bits * copy->tensor.dtype.lanes + 7) / 8;
+      dmlc::ByteSwap(data, elem_bytes, num_bytes / elem_bytes);
+    }
+    int32_t codec = static_cast<int32_t>(RPCChunkCodec::kRaw);
+    const char* payload = data;
+    uint64_t payload_bytes = num_bytes;
+    if (copy->compress) {
+      copy->payload.resize(support::LZCompressBound(num_bytes));
+      size_t compressed_bytes = support::LZCompress(data, num_bytes, copy->payload.data());
+      if (compressed_bytes < num_bytes) {
+        codec = static_cast<int32_t>(RPCChunkCodec::kLZ);
+        payload = copy->payload.data();
+        payload_bytes = compressed_bytes;
+      }
+    }
+    RPCCode code = RPCCode::kCopyAck;
+    uint64_t packet_nbytes =
+        sizeof(code) + sizeof(num_bytes) + sizeof(codec) + sizeof(payload_bytes) + payload_bytes;
+    this->Write(packet_nbytes);
+    this->Write(code);
+    this->Write(num_bytes);
+    this->Write(codec);
+    this->Write(payload_bytes);
+    this->WriteArray(payload, payload_bytes);
+    // Push the chunk out while the next one is copied from the device.
+    flush_writer_();
+  }
+
   // Handle for packed call.
   void HandleNormalCallFunc() {
     uint64_t call_handle;
@@ -619,6 +774,8 @@ class RPCEndpoint::EventHandler : public dmlc::Stream {
   std::string* remote_key_;
   // function to flush the writer.
   std::function<void()> flush_writer_;
+  // The first error of the current chunked CopyToRemote.
+  std::string stream_error_;
 };
 
 RPCCode RPCEndpoint::HandleUntilReturnEvent(bool client_mode, RPCSession::FEncodeReturn setreturn) {
@@ -646,23 +803,46 @@ RPCCode RPCEndpoint::HandleUntilReturnEvent(bool client_mode, RPCSession::FEncod
   return code;
 }
 
+void RPCEndpoint::FlushWriter() {
+  while (writer_.bytes_available() != 0) {
+    size_t n = writer_.ReadWithCallback(
+        [this](const void* data, size_t size) { return channel_->Send(data, size); },
+        writer_.bytes_available());
+    if (n == 0) break;
+  }
+}
+
+/*!
+ * \brief Holds the mutex of an endpoint, and releases the submissions completed meanwhile after
+ *  unlocking it. Their callbacks hold the results, whose destructors may free remote handles
+ *  through the endpoint.
+ */
+class RPCEndpoint::SessionLock {
+ public:
+  explicit SessionLock(RPCEndpoint* endpoint) : endpoint_(endpoint), lock_(endpoint->mutex_) {}
+
+  ~SessionLock() {
+    std::vector<Submission> completed;
+    completed.swap(endpoint_->completed_);
+    lock_.unlock();
+  }
+
+ private:
+  RPCEndpoint* endpoint_;
+  std::unique_lock<std::mutex> lock_;
+};
+
 void RPCEndpoint::Init() {
   // callback to flush the writer.
-  auto flush_writer = [this]() {
-    while (writer_.bytes_available() != 0) {
-      size_t n = writer_.ReadWithCallback(
-          [this](const void* data, size_t size) { return channel_->Send(data, size); },
-          writer_.bytes_available());
-      if (n == 0) break;
-    }
-  };
+  auto flush_writer = [this]() { this->FlushWriter(); };
 
   // Event handler
   handler_ = std::make_shared<EventHandler>(&reader_, &writer_, name_, &remote_key_, flush_writer);
 
   // Quick function to for syscall remote.
   syscall_remote_ = PackedFunc([this](TVMArgs all_args, TVMRetValue* rv) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    SessionLock lock(this);
+    this->DrainSubmissions();
     RPCCode code = static_cast<RPCCode>(all_args[0].operator int());
     TVMArgs args(all_args.values + 1, all_args.type_codes + 1, all_args.num_args - 1);
 
@@ -758,7 +938,7 @@ int RPCEndpoint::ServerAsyncIOEventHandler(const std::string& in_bytes, int even
 }
 
 void RPCEndpoint::InitRemoteSession(TVMArgs args) {
-  std::lock_guard<std::mutex> lock(mutex_);
+  SessionLock lock(this);
   RPCCode code = RPCCode::kInitServer;
   std::string protocol_ver = kRPCProtocolVer;
   uint64_t length = protocol_ver.length();
@@ -782,8 +962,32 @@ void RPCEndpoint::InitRemoteSession(TVMArgs args) {
 void RPCEndpoint::CallFunc(RPCSession::PackedFuncHandle h, const TVMValue* arg_values,
                            const int* arg_type_codes, int num_args,
                            RPCSession::FEncodeReturn encode_return) {
-  std::lock_guard<std::mutex> lock(mutex_);
+  SessionLock lock(this);
+  this->DrainSubmissions();
+  this->SendCallFunc(h, arg_values, arg_type_codes, num_args);
+  RPCCode code = HandleUntilReturnEvent(true, encode_return);
+  ICHECK(code == RPCCode::kReturn) << "code=" << RPCCodeToString(code);
+}
+
+void RPCEndpoint::CopyToRemote(void* from_bytes, DLTensor* to, uint64_t nbytes) {
+  SessionLock lock(this);
+  this->DrainSubmissions();
+  this->SendCopyToRemote(from_bytes, to, nbytes);
+  ICHECK(HandleUntilReturnEvent(true, [](TVMArgs) {}) == RPCCode::kReturn);
+}
+
+void RPCEndpoint::CopyFromRemote(DLTensor* from, void* to_bytes, uint64_t nbytes) {
+  SessionLock lock(this);
+  this->DrainSubmissions();
+  this->SendCopyFromRemote(from, nbytes);
+  ICHECK(HandleUntilReturnEvent(true, [](TVMArgs) {}) == RPCCode::kCopyAck);
 
+  handler_->ReadArray(reinterpret_cast<char*>(to_bytes), nbytes);
+  handler_->FinishCopyAck();
+}
+
+void RPCEndpoint::SendCallFunc(RPCSession::PackedFuncHandle h, const TVMValue* arg_values,
+                               const int* arg_type_codes, int num_args) {
   handler_->ValidateArguments(arg_values, arg_type_codes, num_args);
   RPCCode code = RPCCode::kCallFunc;
   uint64_t handle = reinterpret_cast<uint64_t>(h);
@@ -796,13 +1000,9 @@ void RPCEndpoint::CallFunc(RPCSession::PackedFuncHandle h, const TVMValue* arg_v
   handler_->Write(code);
   handler_->Write(handle);
   handler_->SendPackedSeq(arg_values, arg_type_codes, num_args, true);
-
-  code = HandleUntilReturnEvent(true, encode_return);
-  ICHECK(code == RPCCode::kReturn) << "code=" << RPCCodeToString(code);
 }
 
-void RPCEndpoint::CopyToRemote(void* from_bytes, DLTensor* to, uint64_t nbytes) {
-  std::lock_guard<std::mutex> lock(mutex_);
+void RPCEndpoint::SendCopyToRemote(void* from_bytes, DLTensor* to, uint64_t nbytes) {
   RPCCode code = RPCCode::kCopyToRemote;
 
   uint64_t tensor_total_size_bytes = static_cast<uint64_t>(GetDataSize(*to));
@@ -818,11 +1018,9 @@ void RPCEndpoint::CopyToRemote(void* from_bytes, DLTensor* to, uint64_t nbytes)
   RPCReference::SendDLTensor(handler_, to);
   handler_->Write(nbytes);
   handler_->WriteArray(reinterpret_cast<char*>(from_bytes), nbytes);
-  ICHECK(HandleUntilReturnEvent(true, [](TVMArgs) {}) == RPCCode::kReturn);
 }
 
-void RPCEndpoint::CopyFromRemote(DLTensor* from, void* to_bytes, uint64_t nbytes) {
-  std::lock_guard<std::mutex> lock(mutex_);
+void RPCEndpoint::SendCopyFromRemote(DLTensor* from, uint64_t nbytes) {
   RPCCode code = RPCCode::kCopyFromRemote;
 
   uint64_t tensor_total_size_bytes = static_cast<uint64_t>(GetDataSize(*from));
@@ -837,10 +1035,195 @@ void RPCEndpoint::CopyFromRemote(DLTensor* from, void* to_bytes, uint64_t nbytes
   handler_->Write(code);
   RPCReference::SendDLTensor(handler_, from);
   handler_->Write(nbytes);
-  ICHECK(HandleUntilReturnEvent(true, [](TVMArgs) {}) == RPCCode::kCopyAck);
+}
 
-  handler_->ReadArray(reinterpret_cast<char*>(to_bytes), nbytes);
-  handler_->FinishCopyAck();
+uint64_t RPCEndpoint::SubmitCallFunc(RPCSession::PackedFuncHandle h, const TVMValue* arg_values,
+                                     const int* arg_type_codes, int num_args,
+                                     RPCSession::FAsyncCallback callback) {
+  SessionLock lock(this);
+  this->ReserveSubmission();
+  this->SendCallFunc(h, arg_values, arg_type_codes, num_args);
+  return this->PushSubmission(RPCCode::kCallFunc, nullptr, 0, callback);
+}
+
+uint64_t RPCEndpoint::SubmitCopyToRemote(void* from_bytes, DLTensor* to, uint64_t nbytes,
+                                         RPCSession::FAsyncCallback callback) {
+  SessionLock lock(this);
+  this->ReserveSubmission();
+  this->SendCopyToRemote(from_bytes, to, nbytes);
+  return this->PushSubmission(RPCCode::kCopyToRemote, nullptr, 0, callback);
+}
+
+uint64_t RPCEndpoint::SubmitCopyFromRemote(DLTensor* from, void* to_bytes, uint64_t nbytes,
+                                           RPCSession::FAsyncCallback callback) {
+  SessionLock lock(this);
+  this->ReserveSubmission();
+  this->SendCopyFromRemote(from, nbytes);
+  return this->PushSubmission(RPCCode::kCopyFromRemote, to_bytes, nbytes, callback);
+}
+
+void RPCEndpoint::WaitSubmitted(uint64_t seq) {
+  SessionLock lock(this);
+  while (num_completed_ < seq && !submissions_.empty()) {
+    this->CompleteNextSubmission();
+  }
+}
+
+void RPCEndpoint::ReserveSubmission() {
+  // Bound the responses the remote may have to buffer, and never send a request while a
+  // download is pending, so that both sides do not block on sending a large packet.
+  while (submissions_.size() >= kMaxPendingSubmissions || num_pending_downloads_ != 0) {
+    this->CompleteNextSubmission();
+  }
+}
+
+uint64_t RPCEndpoint::PushSubmission(RPCCode code, void* to_bytes, uint64_t nbytes,
+                                     RPCSession::FAsyncCallback callback) {
+  this->FlushWriter();
+  Submission submission;
+  submission.code = code;
+  submission.to_bytes = to_bytes;
+  submission.nbytes = nbytes;
+  submission.callback = std::move(callback);
+  submissions_.emplace_back(std::move(submission));
+  if (code == RPCCode::kCopyFromRemote) ++num_pending_downloads_;
+  return ++num_submitted_;
+}
+
+void RPCEndpoint::CompleteNextSubmission() {
+  Submission submission = std::move(submissions_.front());
+  submissions_.pop_front();
+  if (submission.code == RPCCode::kCopyFromRemote) --num_pending_downloads_;
+  ++num_completed_;
+
+  TVMValue value;
+  int32_t tcode = kTVMNullptr;
+  value.v_handle = nullptr;
+  try {
+    // The remote handles the requests in order, so the next response belongs to the oldest
+    // submission.
+    if (submission.code == RPCCode::kCopyFromRemote) {
+      ICHECK(HandleUntilReturnEvent(true, [](TVMArgs) {}) == RPCCode::kCopyAck);
+      handler_->ReadArray(static_cast<char*>(submission.to_bytes), submission.nbytes);
+      handler_->FinishCopyAck();
+      submission.callback(RPCCode::kReturn, TVMArgs(&value, &tcode, 1));
+    } else {
+      RPCCode code = HandleUntilReturnEvent(true, [&submission](TVMArgs args) {
+        submission.callback(RPCCode::kReturn, args);
+      });
+      ICHECK(code == RPCCode::kReturn) << "code=" << RPCCodeToString(code);
+    }
+  } catch (const std::exception& e) {
+    value.v_str = e.what();
+    tcode = kTVMStr;
+    submission.callback(RPCCode::kException, TVMArgs(&value, &tcode, 1));
+  }
+  // The callback only records the response, the submission is released after unlocking.
+  completed_.emplace_back(std::move(submission));
+}
+
+void RPCEndpoint::DrainSubmissions() {
+  while (!submissions_.empty()) {
+    this->CompleteNextSubmission();
+  }
+}
+
+void RPCEndpoint::CopyToRemoteChunked(void* from_bytes, DLTensor* to, uint64_t nbytes,
+                                      uint64_t chunk_bytes, bool compress) {
+  SessionLock lock(this);
+  this->DrainSubmissions();
+  RPCCode code = RPCCode::kCopyToRemoteChunk;
+
+  uint64_t tensor_total_size_bytes = static_cast<uint64_t>(GetDataSize(*to));
+  ICHECK_LE(to->byte_offset + nbytes, tensor_total_size_bytes)
+      << "CopyToRemote: overflow in tensor size: (byte_offset=" << to->byte_offset
+      << ", nbytes=" << nbytes << ", tensor_total_size=" << tensor_total_size_bytes << ")";
+  ICHECK_GT(chunk_bytes, 0U);
+  if (nbytes == 0) return;
+
+  const char* from = static_cast<const char*>(from_bytes);
+  std::vector<char> compressed;
+  DLTensor chunk = *to;
+  for (uint64_t offset = 0; offset < nbytes; offset += chunk_bytes) {
+    uint64_t num_bytes = std::min(chunk_bytes, nbytes - offset);
+    int32_t codec = static_cast<int32_t>(RPCChunkCodec::kRaw);
+    const char* payload = from + offset;
+    uint64_t payload_bytes = num_bytes;
+    if (compress) {
+      compressed.resize(support::LZCompressBound(num_bytes));
+      size_t compressed_bytes = support::LZCompress(payload, num_bytes, compressed.data());
+      if (compressed_bytes < num_bytes) {
+        codec = static_cast<int32_t>(RPCChunkCodec::kLZ);
+        payload = compressed.data();
+        payload_bytes = compressed_bytes;
+      }
+    }
+    int32_t last = offset + num_bytes == nbytes;
+    chunk.byte_offset = to->byte_offset + offset;
+
+    uint64_t packet_nbytes = RemoteCopyCalculatePacketOverheadSize(&chunk, code, num_bytes) +
+                             sizeof(codec) + sizeof(last) + sizeof(payload_bytes) + payload_bytes;
+    handler_->Write(packet_nbytes);
+    handler_->Write(code);
+    RPCReference::SendDLTensor(handler_, &chunk);
+    handler_->Write(num_bytes);
+    handler_->Write(codec);
+    handler_->Write(last);
+    handler_->Write(payload_bytes);
+    handler_->WriteArray(payload, payload_bytes);
+    // The remote handles this chunk while the next one is prepared and sent.
+    FlushWriter();
+  }
+  ICHECK(HandleUntilReturnEvent(true, [](TVMArgs) {}) == RPCCode::kReturn);
+}
+
+void RPCEndpoint::CopyFromRemoteChunked(DLTensor* from, void* to_bytes, uint64_t nbytes,
+                                        uint64_t chunk_bytes, bool compress) {
+  SessionLock lock(this);
+  this->DrainSubmissions();
+  RPCCode code = RPCCode::kCopyFromRemoteChunked;
+
+  uint64_t tensor_total_size_bytes = static_cast<uint64_t>(GetDataSize(*from));
+  ICHECK_LE(from->byte_offset + nbytes, tensor_total_size_bytes)
+      << "CopyFromRemote: overflow in tensor size: (byte_offset=" << from->byte_offset
+      << ", nbytes=" << nbytes << ", tensor_total_size=" << tensor_total_size_bytes << ")";
+  ICHECK_GT(chunk_bytes, 0U);
+  if (nbytes == 0) return;
+
+  int32_t compress_flag = compress;
+  uint64_t packet_nbytes = RemoteCopyCalculatePacketOverheadSize(from, code, nbytes) +
+                           sizeof(chunk_bytes) + sizeof(compress_flag);
+  handler_->Write(packet_nbytes);
+  handler_->Write(code);
+  RPCReference::SendDLTensor(handler_, from);
+  handler_->Write(nbytes);
+  handler_->Write(chunk_bytes);
+  handler_->Write(compress_flag);
+
+  char* to = static_cast<char*>(to_bytes);
+  std::vector<char> payload;
+  for (uint64_t offset = 0; offset < nbytes;) {
+    ICHECK(HandleUntilReturnEvent(true, [](TVMArgs) {}) == RPCCode::kCopyAck);
+    uint64_t num_bytes;
+    int32_t codec;
+    uint64_t payload_bytes;
+    handler_->Read(&num_bytes);
+    handler_->Read(&codec);
+    handler_->Read(&payload_bytes);
+    ICHECK_GT(num_bytes, 0U) << "CopyFromRemote: received an empty chunk";
+    ICHECK_LE(offset + num_bytes, nbytes) << "CopyFromRemote: received too many bytes";
+    if (static_cast<RPCChunkCodec>(codec) == RPCChunkCodec::kLZ) {
+      payload.resize(payload_bytes);
+      handler_->ReadArray(payload.data(), payload_bytes);
+      ICHECK(support::LZDecompress(payload.data(), payload_bytes, to + offset, num_bytes))
+          << "CopyFromRemote: received a corrupted compressed chunk";
+    } else {
+      ICHECK_EQ(payload_bytes, num_bytes);
+      handler_->ReadArray(to + offset, num_bytes);
+    }
+    handler_->FinishCopyAck();
+    offset += num_bytes;
+  }
 }
 
 // SysCallEventHandler functions
@@ -980,6 +1363,12 @@ void RPCEndpoint::EventHandler::HandleSyscall(RPCCode code) {
     case RPCCode::kCopyAmongRemote:
       SysCallHandler(RPCCopyAmongRemote);
       break;
+    case RPCCode::kCopyToRemoteChunk:
+      this->HandleCopyToRemoteChunk();
+      break;
+    case RPCCode::kCopyFromRemoteChunked:
+      this->HandleCopyFromRemoteChunked();
+      break;
     default:
       LOG(FATAL) << "Unknown event " << static_cast<int>(code);
   }
@@ -1010,6 +1399,12 @@ class RPCClientSession : public RPCSession, public DeviceAPI {
   }
 
   void CopyToRemote(void* local_from_bytes, DLTensor* remote_to, uint64_t nbytes) final {
+    uint64_t chunk_bytes = GetTransferChunkBytes(remote_to, nbytes);
+    if (chunk_bytes != 0) {
+      endpoint_->CopyToRemoteChunked(local_from_bytes, remote_to, nbytes, chunk_bytes,
+                                     UseCompression());
+      return;
+    }
     RPCCode code = RPCCode::kCopyToRemote;
     uint64_t overhead = RemoteCopyCalculatePacketOverheadSize(remote_to, code, nbytes);
     uint64_t rpc_max_size = GetRPCMaxTransferSize();
@@ -1036,6 +1431,12 @@ class RPCClientSession : public RPCSession, public DeviceAPI {
   }
 
   void CopyFromRemote(DLTensor* remote_from, void* local_to_bytes, uint64_t nbytes) final {
+    uint64_t chunk_bytes = GetTransferChunkBytes(remote_from, nbytes);
+    if (chunk_bytes != 0) {
+      endpoint_->CopyFromRemoteChunked(remote_from, local_to_bytes, nbytes, chunk_bytes,
+                                       UseCompression());
+      return;
+    }
     RPCCode code = RPCCode::kCopyFromRemote;
     uint64_t overhead = RemoteCopyCalculatePacketOverheadSize(remote_from, code, nbytes);
     uint64_t rpc_max_size = GetRPCMaxTransferSize();
@@ -1126,7 +1527,79 @@ class RPCClientSession : public RPCSession, public DeviceAPI {
 
   bool IsLocalSession() const final { return false; }
 
+  uint64_t SubmitCallFunc(PackedFuncHandle func, const TVMValue* arg_values,
+                          const int* arg_type_codes, int num_args, FAsyncCallback callback) final {
+    return endpoint_->SubmitCallFunc(func, arg_values, arg_type_codes, num_args, callback);
+  }
+
+  uint64_t SubmitCopyToRemote(void* local_from_bytes, DLTensor* remote_to, uint64_t nbytes,
+                              FAsyncCallback callback) final {
+    // Copies which need several packets take the synchronous path.
+    if (!FitsInOnePacket(remote_to, RPCCode::kCopyToRemote, nbytes)) {
+      return RPCSession::SubmitCopyToRemote(local_from_bytes, remote_to, nbytes, callback);
+    }
+    return endpoint_->SubmitCopyToRemote(local_from_bytes, remote_to, nbytes, callback);
+  }
+
+  uint64_t SubmitCopyFromRemote(DLTensor* remote_from, void* local_to_bytes, uint64_t nbytes,
+                                FAsyncCallback callback) final {
+    if (!FitsInOnePacket(remote_from, RPCCode::kCopyFromRemote, nbytes)) {
+      return RPCSession::SubmitCopyFromRemote(remote_from, local_to_bytes, nbytes, callback);
+    }
+    return endpoint_->SubmitCopyFromRemote(remote_from, local_to_bytes, nbytes, callback);
+  }
+
+  void WaitSubmitted(uint64_t seq) final { endpoint_->WaitSubmitted(seq); }
+
+  /*!
+   * \brief Configure the chunked tensor transfer.
+   * \param chunk_bytes The size of a chunk, tensors up to this size and all tensors when it is 0
+   *  are sent as a single packet.
+   * \param compress Whether to compress the chunks if the remote supports it.
+   */
+  void SetTransferOptions(int64_t chunk_bytes, bool compress) {
+    ICHECK_GE(chunk_bytes, 0);
+    transfer_chunk_bytes_ = chunk_bytes;
+    transfer_compress_ = compress;
+  }
+
  private:
+  // The chunk size to transfer nbytes of the tensor with, or 0 to use a single packet.
+  uint64_t GetTransferChunkBytes(const DLTensor* tensor, uint64_t nbytes) {
+    if (transfer_chunk_bytes_ == 0 || nbytes <= static_cast<uint64_t>(transfer_chunk_bytes_)) {
+      return 0;
+    }
+    if ((GetRemoteTransferFeatures() & kRPCTransferChunked) == 0) return 0;
+    // Chunks hold whole elements, so the remote can swap their bytes independently.
+    uint64_t elem_bytes = std::max((tensor->dtype.bits * tensor->dtype.lanes + 7) / 8, 1);
+    return std::max(elem_bytes, transfer_chunk_bytes_ / elem_bytes * elem_bytes);
+  }
+
+  bool FitsInOnePacket(DLTensor* tensor, RPCCode code, uint64_t nbytes) {
+    uint64_t overhead = RemoteCopyCalculatePacketOverheadSize(tensor, code, nbytes);
+    return nbytes <= GetRPCMaxTransferSize() - std::min(overhead, GetRPCMaxTransferSize());
+  }
+
+  bool UseCompression() {
+    return transfer_compress_ && (GetRemoteTransferFeatures() & kRPCTransferLZ) != 0;
+  }
+
+  int GetRemoteTransferFeatures() {
+    if (remote_transfer_features_ >= 0) {
+      return remote_transfer_features_;
+    }
+    // Servers which predate the chunked transfer and the CRT do not register the function.
+    remote_transfer_features_ = 0;
+    PackedFuncHandle rpc_func = GetFunction("tvm.rpc.server.GetTransferFeatures");
+    if (rpc_func != nullptr) {
+      CallFunc(rpc_func, nullptr, nullptr, 0, [this](TVMArgs args) {
+        // Use args[1] as return value, args[0] is tcode
+        remote_transfer_features_ = args[1];
+      });
+    }
+    return remote_transfer_features_;
+  }
+
   uint64_t GetRPCMaxTransferSize() {
     if (rpc_chunk_max_size_bytes_ > 0) {
       return (uint64_t)rpc_chunk_max_size_bytes_;
@@ -1150,12 +1623,29 @@ class RPCClientSession : public RPCSession, public DeviceAPI {
 
   std::shared_ptr<RPCEndpoint> endpoint_;
   int64_t rpc_chunk_max_size_bytes_ = -1;
+  // The chunk size of the tensor transfer, 0 disables the chunked transfer.
+  int64_t transfer_chunk_bytes_ = 1 << 20;
+  // Whether to compress the chunks.
+  bool transfer_compress_ = false;
+  // The transfer features of the remote, -1 until queried.
+  int remote_transfer_features_ = -1;
 };
 
 std::shared_ptr<RPCSession> CreateClientSession(std::shared_ptr<RPCEndpoint> endpoint) {
   return std::make_shared<RPCClientSession>(endpoint);
 }
 
+TVM_REGISTER_GLOBAL("tvm.rpc.server.GetTransferFeatures").set_body_typed([]() {
+  return static_cast<int>(kRPCTransferChunked | kRPCTransferLZ);
+});
+
+TVM_REGISTER_GLOBAL("rpc.SetTransferOptions")
+    .set_body_typed([](Module mod, int64_t chunk_bytes, bool compress) {
+      auto* sess = dynamic_cast<RPCClientSession*>(RPCModuleGetSession(mod).get());
+      ICHECK(sess != nullptr) << "Transfer options can only be set on an RPC client session";
+      sess->SetTransferOptions(chunk_bytes, compress);
+    });
+
 uint64_t RemoteCopyCalculatePacketOverheadSize(DLTensor* tensor, RPCCode code, uint64_t nbytes) {
   uint64_t shape_bytes = tensor->ndim * sizeof(int64_t);
   uint64_t to_data = reinterpret_cast<uint64_t>(static_cast<uint8_t*>(tensor->data));
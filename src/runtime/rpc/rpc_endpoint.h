@@ -26,10 +26,12 @@
 
 #include <tvm/runtime/packed_func.h>
 
+#include <deque>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "../../support/ring_buffer.h"
 #include "../minrpc/rpc_reference.h"
@@ -61,6 +63,17 @@ enum class TrackerCode : int {
   kGetPendingMatchKeys = 7
 };
 
+/*! \brief The optional transfer features a server reports in tvm.rpc.server.GetTransferFeatures */
+enum RPCTransferFeature : int {
+  /*! \brief kCopyToRemoteChunk and kCopyFromRemoteChunked are supported. */
+  kRPCTransferChunked = 1,
+  /*! \brief Chunks may be compressed with support::LZCompress. */
+  kRPCTransferLZ = 2
+};
+
+/*! \brief The encoding of the payload of a chunk. */
+enum class RPCChunkCodec : int32_t { kRaw = 0, kLZ = 1 };
+
 /*!
  * \brief Communication endpoints to connect local and remote RPC sessions.
  *        An endpoint can either be a client or a server.
@@ -147,6 +160,77 @@ class RPCEndpoint {
    * \param type_hint Hint of content data type.
    */
   void CopyFromRemote(DLTensor* from, void* to_bytes, uint64_t nbytes);
+  /*!
+   * \brief Copy bytes into remote array content as a stream of chunks.
+   *
+   *  The chunks are sent back to back without waiting for the remote, which copies each one to
+   *  the device as it arrives, so the serialization, the transfer and the device copy overlap.
+   *  Only the last chunk is acknowledged.
+   *
+   * \param from_bytes The source host data.
+   * \param to The target array.
+   * \param nbytes The size of the memory in bytes.
+   * \param chunk_bytes The size of a chunk.
+   * \param compress Whether to compress the chunks, a chunk which does not shrink is sent raw.
+   */
+  void CopyToRemoteChunked(void* from_bytes, DLTensor* to, uint64_t nbytes, uint64_t chunk_bytes,
+                           bool compress);
+  /*!
+   * \brief Copy bytes from remote array content as a stream of chunks. The remote sends every
+   *  chunk as soon as it is copied from the device.
+   * \param from The source array.
+   * \param to_bytes The target host data.
+   * \param nbytes The size of the memory in bytes.
+   * \param chunk_bytes The size of a chunk.
+   * \param compress Whether the remote should compress the chunks.
+   */
+  void CopyFromRemoteChunked(DLTensor* from, void* to_bytes, uint64_t nbytes, uint64_t chunk_bytes,
+                             bool compress);
+
+  /*!
+   * \brief Send a call into a remote function without waiting for its return.
+   *
+   *  The remote handles the requests of a connection in order, so the responses of the
+   *  submissions are matched to them by their sequence number. Many small calls and copies can
+   *  be in flight at once, which hides the round trip time.
+   *
+   * \param handle The function handle.
+   * \param arg_values The argument values.
+   * \param arg_type_codes the type codes of the argument.
+   * \param num_args Number of arguments.
+   * \param callback The callback to receive the return value or the exception, invoked when
+   *  the submission is waited for.
+   * \return The sequence number of the submission.
+   */
+  uint64_t SubmitCallFunc(RPCSession::PackedFuncHandle handle, const TVMValue* arg_values,
+                          const int* arg_type_codes, int num_args,
+                          RPCSession::FAsyncCallback callback);
+  /*!
+   * \brief Send a copy into remote array content without waiting for it to complete.
+   * \param from_bytes The source host data, which can be released once the function returns.
+   * \param to The target array.
+   * \param nbytes The size of the memory in bytes.
+   * \param callback The callback to signal the copy complete.
+   * \return The sequence number of the submission.
+   */
+  uint64_t SubmitCopyToRemote(void* from_bytes, DLTensor* to, uint64_t nbytes,
+                              RPCSession::FAsyncCallback callback);
+  /*!
+   * \brief Request a copy from remote array content without waiting for it to complete.
+   * \param from The source array.
+   * \param to_bytes The target host data, which must stay alive until the callback is invoked.
+   * \param nbytes The size of the memory in bytes.
+   * \param callback The callback to signal the copy complete.
+   * \return The sequence number of the submission.
+   */
+  uint64_t SubmitCopyFromRemote(DLTensor* from, void* to_bytes, uint64_t nbytes,
+                                RPCSession::FAsyncCallback callback);
+  /*!
+   * \brief Wait until the submission with the given sequence number and all the submissions
+   *  before it complete.
+   * \param seq The sequence number.
+   */
+  void WaitSubmitted(uint64_t seq);
 
   /*!
    * \brief Call a remote defined system function with arguments.
@@ -171,6 +255,7 @@ class RPCEndpoint {
 
  private:
   class EventHandler;
+  class SessionLock;
   // Handle events until receives a return
   // Also flushes channels so that the function advances.
   RPCCode HandleUntilReturnEvent(bool client_mode, RPCSession::FEncodeReturn setreturn);
@@ -178,6 +263,45 @@ class RPCEndpoint {
   void Init();
   // Shutdown
   void Shutdown();
+  // Send all the pending data of the writer.
+  void FlushWriter();
+  // Write the request packets.
+  void SendCallFunc(RPCSession::PackedFuncHandle handle, const TVMValue* arg_values,
+                    const int* arg_type_codes, int num_args);
+  void SendCopyToRemote(void* from_bytes, DLTensor* to, uint64_t nbytes);
+  void SendCopyFromRemote(DLTensor* from, uint64_t nbytes);
+  // Complete submissions until another one can be sent.
+  void ReserveSubmission();
+  // Flush a submitted request and record it as pending.
+  uint64_t PushSubmission(RPCCode code, void* to_bytes, uint64_t nbytes,
+                          RPCSession::FAsyncCallback callback);
+  // Receive the response of the oldest pending submission.
+  void CompleteNextSubmission();
+  // Complete all the pending submissions, which must precede any synchronous request.
+  void DrainSubmissions();
+
+  /*! \brief A request which was sent without waiting for its response. */
+  struct Submission {
+    /*! \brief The request code. */
+    RPCCode code;
+    /*! \brief The target host data of a copy from remote. */
+    void* to_bytes;
+    /*! \brief The size of a copy from remote. */
+    uint64_t nbytes;
+    /*! \brief The callback to receive the response. */
+    RPCSession::FAsyncCallback callback;
+  };
+  // The maximum number of submissions in flight.
+  static constexpr size_t kMaxPendingSubmissions = 128;
+  // The pending submissions in order.
+  std::deque<Submission> submissions_;
+  // The completed submissions, released by SessionLock after unlocking mutex_.
+  std::vector<Submission> completed_;
+  // The number of submitted and completed requests.
+  uint64_t num_submitted_{0};
+  uint64_t num_completed_{0};
+  // The number of pending copies from remote.
+  int num_pending_downloads_{0};
   // Internal channel.
   std::unique_ptr<RPCChannel> channel_;
   // Internal mutex
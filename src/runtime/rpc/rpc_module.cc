@@ -26,8 +26,11 @@
 #include <tvm/runtime/profiling.h>
 #include <tvm/runtime/registry.h>
 
+#include <atomic>
 #include <cstring>
+#include <limits>
 #include <memory>
+#include <string>
 #if defined(_M_X64) || defined(__x86_64__)
 #include <immintrin.h>
 #endif
@@ -76,6 +79,52 @@ NDArray NDArrayFromRemoteOpaqueHandle(std::shared_ptr<RPCSession> sess, void* ha
   return NDArray(GetObjectPtr<Object>(data));
 }
 
+/*!
+ * \brief The result of a call or copy submitted to a remote session.
+ */
+class RPCFutureObj : public Object {
+ public:
+  /*! \brief The session of the submission. */
+  std::shared_ptr<RPCSession> sess;
+  /*! \brief The sequence number of the submission. */
+  uint64_t seq{0};
+  /*! \brief Whether the submission completed, set after the result. */
+  std::atomic<bool> done{false};
+  /*! \brief The return value of a call. */
+  TVMRetValue value;
+  /*! \brief The error message if the submission failed. */
+  std::string error;
+  /*! \brief The local array a copy from remote writes into. */
+  NDArray target;
+
+  /*! \brief Wait for the submission to complete. */
+  void Wait() {
+    if (!done.load(std::memory_order_acquire)) sess->WaitSubmitted(seq);
+    ICHECK(done.load(std::memory_order_acquire)) << "The submission " << seq << " did not complete";
+  }
+
+  /*!
+   * \brief Make a callback which completes the future.
+   * \param future The future.
+   * \param wrap_return Whether to wrap the return value into a remote object.
+   */
+  static RPCSession::FAsyncCallback MakeCallback(ObjectPtr<RPCFutureObj> future, bool wrap_return);
+
+  static constexpr const char* _type_key = "rpc.RPCFuture";
+  TVM_DECLARE_FINAL_OBJECT_INFO(RPCFutureObj, Object);
+};
+
+/*!
+ * \brief Managed reference to RPCFutureObj.
+ * \sa RPCFutureObj
+ */
+class RPCFuture : public ObjectRef {
+ public:
+  TVM_DEFINE_MUTABLE_OBJECT_REF_METHODS(RPCFuture, ObjectRef, RPCFutureObj);
+};
+
+TVM_REGISTER_OBJECT_TYPE(RPCFutureObj);
+
 /*!
  * \brief A wrapped remote function as a PackedFunc.
  */
@@ -87,7 +136,52 @@ class RPCWrappedFunc : public Object {
     std::vector<TVMValue> values(args.values, args.values + args.size());
     std::vector<int> type_codes(args.type_codes, args.type_codes + args.size());
     std::vector<std::unique_ptr<DLTensor>> temp_dltensors;
+    ConvertArgs(args, &values, &type_codes, &temp_dltensors);
+    auto set_return = [this, rv](TVMArgs args) { WrapRemoteReturnToValue(sess_, args, rv); };
+    sess_->CallFunc(handle_, values.data(), type_codes.data(), args.size(), set_return);
+  }
 
+  /*!
+   * \brief Call the remote function without waiting for its return.
+   * \param args The arguments.
+   * \return The future of the return value.
+   */
+  RPCFuture Submit(TVMArgs args) const {
+    std::vector<TVMValue> values(args.values, args.values + args.size());
+    std::vector<int> type_codes(args.type_codes, args.type_codes + args.size());
+    std::vector<std::unique_ptr<DLTensor>> temp_dltensors;
+    ConvertArgs(args, &values, &type_codes, &temp_dltensors);
+    auto future = make_object<RPCFutureObj>();
+    future->sess = sess_;
+    future->seq = sess_->SubmitCallFunc(handle_, values.data(), type_codes.data(), args.size(),
+                                        RPCFutureObj::MakeCallback(future, /*wrap_return=*/true));
+    return RPCFuture(future);
+  }
+
+  // wrap a remote return via Set
+  static void WrapRemoteReturnToValue(const std::shared_ptr<RPCSession>& sess, TVMArgs args,
+                                      TVMRetValue* rv);
+
+  ~RPCWrappedFunc() {
+    try {
+      sess_->FreeHandle(handle_, kTVMPackedFuncHandle);
+    } catch (const Error& e) {
+      // fault tolerance to remote close
+    }
+  }
+
+ private:
+  // remote function handle
+  void* handle_{nullptr};
+  // pointer to the session.
+  std::shared_ptr<RPCSession> sess_;
+
+  // rewrite the arguments to their remote variant, temp_dltensors keeps the remote views alive.
+  void ConvertArgs(TVMArgs args, std::vector<TVMValue>* values_ptr,
+                   std::vector<int>* type_codes_ptr,
+                   std::vector<std::unique_ptr<DLTensor>>* temp_dltensors) const {
+    std::vector<TVMValue>& values = *values_ptr;
+    std::vector<int>& type_codes = *type_codes_ptr;
     // scan and check whether we need rewrite these arguments
     // to their remote variant.
     for (int i = 0; i < args.size(); ++i) {
@@ -109,7 +203,7 @@ class RPCWrappedFunc : public Object {
           dptr->device = RemoveSessMask(dptr->device);
           dptr->data = static_cast<RemoteSpace*>(dptr->data)->data;
           values[i].v_handle = dptr.get();
-          temp_dltensors.emplace_back(std::move(dptr));
+          temp_dltensors->emplace_back(std::move(dptr));
           break;
         }
         case kDLDevice: {
@@ -123,28 +217,10 @@ class RPCWrappedFunc : public Object {
         }
       }
     }
-    auto set_return = [this, rv](TVMArgs args) { this->WrapRemoteReturnToValue(args, rv); };
-    sess_->CallFunc(handle_, values.data(), type_codes.data(), args.size(), set_return);
   }
 
-  ~RPCWrappedFunc() {
-    try {
-      sess_->FreeHandle(handle_, kTVMPackedFuncHandle);
-    } catch (const Error& e) {
-      // fault tolerance to remote close
-    }
-  }
-
- private:
-  // remote function handle
-  void* handle_{nullptr};
-  // pointer to the session.
-  std::shared_ptr<RPCSession> sess_;
-
   // unwrap a remote value to the underlying handle.
   void* UnwrapRemoteValueToHandle(const TVMArgValue& arg) const;
-  // wrap a remote return via Set
-  void WrapRemoteReturnToValue(TVMArgs args, TVMRetValue* rv) const;
 
   // remove a remote session mask
   Device RemoveSessMask(Device dev) const {
@@ -155,6 +231,13 @@ class RPCWrappedFunc : public Object {
   }
 };
 
+/*! \brief The callable of the PackedFunc of a remote function. */
+struct RPCWrappedFuncCaller {
+  std::shared_ptr<RPCWrappedFunc> wf;
+
+  void operator()(TVMArgs args, TVMRetValue* rv) const { wf->operator()(args, rv); }
+};
+
 // RPC that represents a remote module session.
 class RPCModuleNode final : public ModuleNode {
  public:
@@ -232,8 +315,7 @@ class RPCModuleNode final : public ModuleNode {
 
   PackedFunc WrapRemoteFunc(RPCSession::PackedFuncHandle handle) {
     if (handle == nullptr) return PackedFunc();
-    auto wf = std::make_shared<RPCWrappedFunc>(handle, sess_);
-    return PackedFunc([wf](TVMArgs args, TVMRetValue* rv) { return wf->operator()(args, rv); });
+    return PackedFunc(RPCWrappedFuncCaller{std::make_shared<RPCWrappedFunc>(handle, sess_)});
   }
 
   // The module handle
@@ -267,26 +349,26 @@ void* RPCWrappedFunc::UnwrapRemoteValueToHandle(const TVMArgValue& arg) const {
   }
 }
 
-void RPCWrappedFunc::WrapRemoteReturnToValue(TVMArgs args, TVMRetValue* rv) const {
+void RPCWrappedFunc::WrapRemoteReturnToValue(const std::shared_ptr<RPCSession>& sess,
+                                             TVMArgs args, TVMRetValue* rv) {
   int tcode = args[0];
 
   if (tcode == kTVMNullptr) return;
   if (tcode == kTVMPackedFuncHandle) {
     ICHECK_EQ(args.size(), 2);
     void* handle = args[1];
-    auto wf = std::make_shared<RPCWrappedFunc>(handle, sess_);
-    *rv = PackedFunc([wf](TVMArgs args, TVMRetValue* rv) { return wf->operator()(args, rv); });
+    *rv = PackedFunc(RPCWrappedFuncCaller{std::make_shared<RPCWrappedFunc>(handle, sess)});
   } else if (tcode == kTVMModuleHandle) {
     ICHECK_EQ(args.size(), 2);
     void* handle = args[1];
-    auto n = make_object<RPCModuleNode>(handle, sess_);
+    auto n = make_object<RPCModuleNode>(handle, sess);
     *rv = Module(n);
   } else if (tcode == kTVMDLTensorHandle || tcode == kTVMNDArrayHandle) {
     ICHECK_EQ(args.size(), 3);
     DLTensor* tensor = args[1];
     void* nd_handle = args[2];
-    *rv = NDArrayFromRemoteOpaqueHandle(sess_, tensor->data, tensor,
-                                        AddRPCSessionMask(tensor->device, sess_->table_index()),
+    *rv = NDArrayFromRemoteOpaqueHandle(sess, tensor->data, tensor,
+                                        AddRPCSessionMask(tensor->device, sess->table_index()),
                                         nd_handle);
   } else {
     ICHECK_EQ(args.size(), 2);
@@ -294,6 +376,52 @@ void RPCWrappedFunc::WrapRemoteReturnToValue(TVMArgs args, TVMRetValue* rv) cons
   }
 }
 
+RPCSession::FAsyncCallback RPCFutureObj::MakeCallback(ObjectPtr<RPCFutureObj> future,
+                                                      bool wrap_return) {
+  return [future, wrap_return](RPCCode status, TVMArgs args) {
+    if (status == RPCCode::kException) {
+      future->error = args[0].operator std::string();
+    } else if (wrap_return) {
+      RPCWrappedFunc::WrapRemoteReturnToValue(future->sess, args, &future->value);
+    }
+    future->done.store(true, std::memory_order_release);
+  };
+}
+
+/*!
+ * \brief Submit a copy between a local CPU array and a remote array.
+ * \param from The source array.
+ * \param to The target array.
+ * \return The future of the copy.
+ */
+RPCFuture SubmitRemoteCopy(NDArray from, NDArray to) {
+  ICHECK_EQ(GetDataSize(*from.operator->()), GetDataSize(*to.operator->()))
+      << "ValueError: Cannot copy between arrays of different sizes";
+  auto future = make_object<RPCFutureObj>();
+  auto callback = RPCFutureObj::MakeCallback(future, /*wrap_return=*/false);
+  uint64_t nbytes = GetDataSize(*from.operator->());
+  if (IsRPCSessionDevice(to->device)) {
+    ICHECK_EQ(from->device.device_type, kDLCPU) << "ValueError: Expect a copy from a CPU array";
+    DLTensor to_tensor = *to.operator->();
+    to_tensor.device = RemoveRPCSessionMask(to->device);
+    to_tensor.data = static_cast<const RemoteSpace*>(to->data)->data;
+    void* from_bytes = static_cast<char*>(from->data) + from->byte_offset;
+    future->sess = static_cast<const RemoteSpace*>(to->data)->sess;
+    future->seq = future->sess->SubmitCopyToRemote(from_bytes, &to_tensor, nbytes, callback);
+  } else {
+    ICHECK(IsRPCSessionDevice(from->device)) << "ValueError: Expect a copy from or to remote";
+    ICHECK_EQ(to->device.device_type, kDLCPU) << "ValueError: Expect a copy to a CPU array";
+    DLTensor from_tensor = *from.operator->();
+    from_tensor.device = RemoveRPCSessionMask(from->device);
+    from_tensor.data = static_cast<const RemoteSpace*>(from->data)->data;
+    void* to_bytes = static_cast<char*>(to->data) + to->byte_offset;
+    future->target = to;
+    future->sess = static_cast<const RemoteSpace*>(from->data)->sess;
+    future->seq = future->sess->SubmitCopyFromRemote(&from_tensor, to_bytes, nbytes, callback);
+  }
+  return RPCFuture(future);
+}
+
 Module CreateRPCSessionModule(std::shared_ptr<RPCSession> sess) {
   auto n = make_object<RPCModuleNode>(nullptr, sess);
   RPCSession::InsertToSessionTable(sess);
@@ -491,5 +619,35 @@ TVM_REGISTER_GLOBAL("tvm.rpc.NDArrayFromRemoteOpaqueHandle")
                                            dev, ndarray_handle);
     });
 
+TVM_REGISTER_GLOBAL("rpc.SubmitCall").set_body([](TVMArgs args, TVMRetValue* rv) {
+  PackedFunc func = args[0];
+  // Only a remote function is submitted, a local one is rejected before it runs.
+  const RPCWrappedFuncCaller* caller = nullptr;
+  if (func != nullptr) {
+    caller = static_cast<const PackedFuncObj*>(func.get())->GetCallable<RPCWrappedFuncCaller>();
+  }
+  CHECK(caller != nullptr) << "ValueError: Can only submit calls of remote functions";
+  *rv = caller->wf->Submit(TVMArgs(args.values + 1, args.type_codes + 1, args.size() - 1));
+});
+
+TVM_REGISTER_GLOBAL("rpc.SubmitCopy").set_body_typed(SubmitRemoteCopy);
+
+TVM_REGISTER_GLOBAL("rpc.FutureDone").set_body_typed([](RPCFuture future) {
+  return future->done.load(std::memory_order_acquire);
+});
+
+TVM_REGISTER_GLOBAL("rpc.FutureResult").set_body([](TVMArgs args, TVMRetValue* rv) {
+  RPCFuture future = args[0];
+  future->Wait();
+  if (!future->error.empty()) {
+    LOG(FATAL) << future->error;
+  }
+  *rv = future->value;
+});
+
+TVM_REGISTER_GLOBAL("rpc.WaitSubmitted").set_body_typed([](Module sess) {
+  RPCModuleGetSession(sess)->WaitSubmitted(std::numeric_limits<uint64_t>::max());
+});
+
 }  // namespace runtime
 }  // namespace tvm
@@ -25,15 +25,21 @@
 #if defined(__linux__) || defined(__ANDROID__)
 
 #include <errno.h>
+#include <fcntl.h>
 #include <signal.h>
+#include <sys/mman.h>
 #include <sys/types.h>
 #include <tvm/runtime/registry.h>
 #include <unistd.h>
 
 #include <cstdlib>
+#include <cstring>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "../../support/pipe.h"
+#include "../../support/shm_ring.h"
 #include "rpc_endpoint.h"
 #include "rpc_local_session.h"
 
@@ -75,7 +81,66 @@ class PipeChannel final : public RPCChannel {
   pid_t child_pid_;
 };
 
-Module CreatePipeClient(std::vector<std::string> cmd) {
+class SharedMemoryPipeChannel final : public RPCChannel {
+ public:
+  SharedMemoryPipeChannel(int readfd, int writefd, pid_t child_pid, void* region,
+                          size_t region_size)
+      : pipe_(readfd, writefd, child_pid), region_(region), region_size_(region_size) {
+    ICHECK(shm_.Attach(region, region_size, true, readfd, writefd));
+  }
+
+  ~SharedMemoryPipeChannel() { munmap(region_, region_size_); }
+
+  size_t Send(const void* data, size_t size) final {
+    ssize_t n = shm_.Send(data, size);
+    if (n == -1) {
+      LOG(FATAL) << "Shared memory pipe write error";
+    }
+    return static_cast<size_t>(n);
+  }
+
+  size_t Recv(void* data, size_t size) final {
+    ssize_t n = shm_.Recv(data, size);
+    if (n == -1) {
+      LOG(FATAL) << "Shared memory pipe read error";
+    }
+    return static_cast<size_t>(n);
+  }
+
+ private:
+  // Owns the pipes and the child process.
+  PipeChannel pipe_;
+  support::SharedMemoryPipe shm_;
+  void* region_;
+  size_t region_size_;
+};
+
+/*!
+ * \brief Create an unlinked file of the given size in shared memory.
+ * \return The file descriptor.
+ */
+int CreateSharedMemoryFile(size_t size) {
+  std::string path = "/dev/shm/tvm-rpc-XXXXXX";
+  int fd = mkstemp(&path[0]);
+  if (fd == -1) {
+    path = "/tmp/tvm-rpc-XXXXXX";
+    fd = mkstemp(&path[0]);
+  }
+  ICHECK_NE(fd, -1) << "Cannot create the shared memory of the pipe: " << strerror(errno);
+  unlink(path.c_str());
+  ICHECK_EQ(ftruncate(fd, static_cast<off_t>(size)), 0)
+      << "Cannot allocate the shared memory of the pipe: " << strerror(errno);
+  return fd;
+}
+
+/*!
+ * \brief Start a pipe server and connect to it.
+ * \param cmd The command of the server, which receives the pipe descriptors as the last
+ *        arguments.
+ * \param shm_capacity The capacity of the shared memory rings, 0 to send the bytes through
+ *        the pipes.
+ */
+Module CreatePipeClient(std::vector<std::string> cmd, uint64_t shm_capacity) {
   int parent2child[2];
   int child2parent[2];
   ICHECK_EQ(pipe(parent2child), 0);
@@ -86,6 +151,18 @@ Module CreatePipeClient(std::vector<std::string> cmd) {
   int child_read = parent2child[0];
   int child_write = child2parent[1];
 
+  int shm_fd = -1;
+  size_t shm_size = 0;
+  void* region = nullptr;
+  if (shm_capacity != 0) {
+    shm_size = support::SharedMemoryPipe::RegionSize(shm_capacity);
+    shm_fd = CreateSharedMemoryFile(shm_size);
+    region = mmap(nullptr, shm_size, PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
+    ICHECK(region != MAP_FAILED) << "Cannot map the shared memory of the pipe";
+    // Initialized before the server starts, which checks the region when it attaches.
+    support::SharedMemoryPipe::InitRegion(region, shm_capacity);
+  }
+
   pid_t pid = fork();
   if (pid == 0) {
     // child process
@@ -93,12 +170,16 @@ Module CreatePipeClient(std::vector<std::string> cmd) {
     close(parent_write);
     std::string sread_pipe = std::to_string(child_read);
     std::string swrite_pipe = std::to_string(child_write);
+    std::string sshm = std::to_string(shm_fd);
     std::vector<char*> argv;
     for (auto& str : cmd) {
       argv.push_back(dmlc::BeginPtr(str));
     }
     argv.push_back(dmlc::BeginPtr(sread_pipe));
     argv.push_back(dmlc::BeginPtr(swrite_pipe));
+    if (shm_fd != -1) {
+      argv.push_back(dmlc::BeginPtr(sshm));
+    }
     argv.push_back(nullptr);
     execvp(argv[0], &argv[0]);
   }
@@ -106,9 +187,14 @@ Module CreatePipeClient(std::vector<std::string> cmd) {
   close(child_read);
   close(child_write);
 
-  auto endpt = RPCEndpoint::Create(
-      std::unique_ptr<PipeChannel>(new PipeChannel(parent_read, parent_write, pid)), "pipe",
-      "pipe");
+  std::unique_ptr<RPCChannel> channel;
+  if (shm_fd != -1) {
+    close(shm_fd);
+    channel.reset(new SharedMemoryPipeChannel(parent_read, parent_write, pid, region, shm_size));
+  } else {
+    channel.reset(new PipeChannel(parent_read, parent_write, pid));
+  }
+  auto endpt = RPCEndpoint::Create(std::move(channel), "pipe", "pipe");
   endpt->InitRemoteSession(TVMArgs(nullptr, nullptr, 0));
   return CreateRPCSessionModule(CreateClientSession(endpt));
 }
@@ -118,9 +204,20 @@ TVM_REGISTER_GLOBAL("rpc.CreatePipeClient").set_body([](TVMArgs args, TVMRetValu
   for (int i = 0; i < args.size(); ++i) {
     cmd.push_back(args[i].operator std::string());
   }
-  *rv = CreatePipeClient(cmd);
+  *rv = CreatePipeClient(cmd, 0);
 });
 
+TVM_REGISTER_GLOBAL("rpc.CreateSharedMemoryPipeClient")
+    .set_body([](TVMArgs args, TVMRetValue* rv) {
+      int64_t capacity = args[0];
+      ICHECK_GT(capacity, 0);
+      std::vector<std::string> cmd;
+      for (int i = 1; i < args.size(); ++i) {
+        cmd.push_back(args[i].operator std::string());
+      }
+      *rv = CreatePipeClient(cmd, capacity);
+    });
+
 }  // namespace runtime
 }  // namespace tvm
 #endif
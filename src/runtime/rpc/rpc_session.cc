@@ -93,6 +93,30 @@ void RPCSession::AsyncStreamWait(Device dev, TVMStreamHandle stream,
   }
 }
 
+uint64_t RPCSession::SubmitCallFunc(PackedFuncHandle func, const TVMValue* arg_values,
+                                    const int* arg_type_codes, int num_args,
+                                    FAsyncCallback callback) {
+  ICHECK(!this->IsAsync()) << "Cannot submit to an async session";
+  this->AsyncCallFunc(func, arg_values, arg_type_codes, num_args, callback);
+  return 0;
+}
+
+uint64_t RPCSession::SubmitCopyToRemote(void* local_from_bytes, DLTensor* remote_to,
+                                        uint64_t nbytes, FAsyncCallback callback) {
+  ICHECK(!this->IsAsync()) << "Cannot submit to an async session";
+  this->AsyncCopyToRemote(local_from_bytes, remote_to, nbytes, callback);
+  return 0;
+}
+
+uint64_t RPCSession::SubmitCopyFromRemote(DLTensor* remote_from, void* local_to_bytes,
+                                          uint64_t nbytes, FAsyncCallback callback) {
+  ICHECK(!this->IsAsync()) << "Cannot submit to an async session";
+  this->AsyncCopyFromRemote(remote_from, local_to_bytes, nbytes, callback);
+  return 0;
+}
+
+void RPCSession::WaitSubmitted(uint64_t seq) {}
+
 class RPCSessTable {
  public:
   static constexpr int kMaxRPCSession = 32;
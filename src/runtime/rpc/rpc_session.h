@@ -241,6 +241,55 @@ class RPCSession {
    */
   virtual void AsyncStreamWait(Device dev, TVMStreamHandle stream, FAsyncCallback on_compelte);
 
+  // Pipelined variant of API
+  // These APIs are used by the RPC client to keep many calls and copies in flight.
+  // The submissions complete in order, their callbacks are invoked when a submission
+  // is waited for or before the next synchronous request of the session.
+  // The default implementations complete the request before they return.
+
+  /*!
+   * \brief Call func without waiting for its return.
+   * \param func The function handle.
+   * \param arg_values The argument values.
+   * \param arg_type_codes the type codes of the argument.
+   * \param num_args Number of arguments.
+   * \param callback The callback to pass the return value or exception.
+   * \return The sequence number of the submission, 0 if it completed already.
+   */
+  virtual uint64_t SubmitCallFunc(PackedFuncHandle func, const TVMValue* arg_values,
+                                  const int* arg_type_codes, int num_args,
+                                  FAsyncCallback callback);
+
+  /*!
+   * \brief Pipelined version of CopyToRemote.
+   * \param local_from_bytes The source host data, which can be released once the function
+   *        returns.
+   * \param remote_to The target array.
+   * \param nbytes The size of the memory in bytes.
+   * \param callback The callback to signal copy complete.
+   * \return The sequence number of the submission, 0 if it completed already.
+   */
+  virtual uint64_t SubmitCopyToRemote(void* local_from_bytes, DLTensor* remote_to,
+                                      uint64_t nbytes, FAsyncCallback callback);
+
+  /*!
+   * \brief Pipelined version of CopyFromRemote.
+   * \param remote_from The source array.
+   * \param local_to_bytes The target host data.
+   * \param nbytes The size of the memory in bytes.
+   * \param callback The callback to signal copy complete.
+   * \return The sequence number of the submission, 0 if it completed already.
+   * \note local_to_bytes must stay alive until callback is called.
+   */
+  virtual uint64_t SubmitCopyFromRemote(DLTensor* remote_from, void* local_to_bytes,
+                                        uint64_t nbytes, FAsyncCallback callback);
+
+  /*!
+   * \brief Wait until a submission and all the submissions before it complete.
+   * \param seq The sequence number of the submission.
+   */
+  virtual void WaitSubmitted(uint64_t seq);
+
   /*!
    * \return The session table index of the session.
    */
@@ -36,6 +36,7 @@
 #include <atomic>
 #include <condition_variable>
 #include <cstring>
+#include <deque>
 #include <memory>
 #include <mutex>
 #include <sstream>
@@ -60,10 +61,25 @@ uint32_t GetSpinCount() {
   return atoi(val);
 }
 
+bool GetUseSharedThreadPool() {
+  const char* val = getenv("TVM_THREAD_POOL_SHARED");
+  return val != nullptr && atoi(val) != 0;
+}
+
+uint32_t GetWorkStealingGranularity() {
+  const char* val = getenv("TVM_THREAD_POOL_WORK_STEALING");
+  if (!val) {
+    return 0;
+  }
+  return atoi(val);
+}
+
 }  // namespace
 
 // stride in the page, fit to cache line.
 constexpr int kSyncStride = 64 / sizeof(std::atomic<int>);
+// stride of the work stealing ranges, fit to cache line.
+constexpr int kRangeStride = 64 / sizeof(std::atomic<uint64_t>);
 
 /*!
  * \brief Thread local main environment.
@@ -76,14 +92,16 @@ class ParallelLauncher {
     this->cdata = cdata;
     this->flambda = flambda;
     this->env.num_task = num_task;
+    this->work_stealing = false;
     has_error_.store(false);
     // reshape
     if (static_cast<size_t>(num_task) > par_errors_.size()) {
       par_errors_.resize(num_task + 1);
-      if (need_sync) {
-        delete[] sync_counter_;
-        sync_counter_ = new std::atomic<int>[num_task * kSyncStride];
-      }
+    }
+    if (need_sync && num_task > sync_counter_size_) {
+      delete[] sync_counter_;
+      sync_counter_ = new std::atomic<int>[num_task * kSyncStride];
+      sync_counter_size_ = num_task;
     }
     if (need_sync) {
       for (int i = 0; i < num_task; ++i) {
@@ -94,6 +112,52 @@ class ParallelLauncher {
       this->env.sync_handle = nullptr;
     }
   }
+  /*!
+   * \brief Switch the launch initialized by Init into work stealing mode.
+   *
+   *  The task ids are split into one contiguous range per worker. Each worker
+   *  takes tasks from the front of its own range and, once it runs dry, steals
+   *  from the back of the ranges owned by the other workers.
+   *
+   * \param num_workers The number of workers taking part in the launch.
+   */
+  void InitWorkStealing(int num_workers) {
+    int num_task = this->env.num_task;
+    if (num_workers > range_size_) {
+      ranges_.reset(new std::atomic<uint64_t>[num_workers * kRangeStride]);
+      range_size_ = num_workers;
+    }
+    for (int i = 0; i < num_workers; ++i) {
+      uint32_t begin = static_cast<int64_t>(num_task) * i / num_workers;
+      uint32_t end = static_cast<int64_t>(num_task) * (i + 1) / num_workers;
+      ranges_[i * kRangeStride].store(PackRange(begin, end), std::memory_order_relaxed);
+    }
+    // In work stealing mode we wait for the workers instead of the tasks, so that
+    // no worker can still be scanning the ranges when the next launch starts.
+    num_pending_.store(num_workers);
+    num_stealing_workers_ = num_workers;
+    this->work_stealing = true;
+  }
+  /*!
+   * \brief Run tasks as worker worker_id of a work stealing launch until
+   *  no pending task is left in any range.
+   * \param worker_id The index of the range owned by this worker.
+   */
+  void RunWorkStealing(int worker_id) {
+    int task_id;
+    while (true) {
+      bool found = TakeTask(worker_id, false, &task_id);
+      for (int i = 1; i < num_stealing_workers_ && !found; ++i) {
+        found = TakeTask((worker_id + i) % num_stealing_workers_, true, &task_id);
+      }
+      if (!found) break;
+      if ((*flambda)(task_id, &env, cdata) != 0) {
+        par_errors_[task_id] = TVMGetLastError();
+        has_error_.store(true);
+      }
+    }
+    num_pending_.fetch_sub(1);
+  }
   ~ParallelLauncher() { delete[] sync_counter_; }
   // Wait n jobs to finish
   int WaitForJobs() {
@@ -130,14 +194,52 @@ class ParallelLauncher {
   // Whether this thread is worker of the pool.
   // used to prevent recursive launch.
   bool is_worker{false};
+  // Whether this thread is running a task of its own launch, which uses this launcher.
+  // used to prevent recursive launch.
+  bool is_launching{false};
+  // Whether the current launch is scheduled by work stealing.
+  bool work_stealing{false};
 
  private:
+  static uint64_t PackRange(uint32_t begin, uint32_t end) {
+    return (static_cast<uint64_t>(begin) << 32) | end;
+  }
+  /*!
+   * \brief Take one task out of the range owned by worker_id.
+   * \param worker_id The owner of the range.
+   * \param from_back Whether to take the task from the back (steal) or front (local pop).
+   * \param task_id The task id taken.
+   * \return Whether a task is taken.
+   */
+  bool TakeTask(int worker_id, bool from_back, int* task_id) {
+    std::atomic<uint64_t>& range = ranges_[worker_id * kRangeStride];
+    uint64_t cur = range.load(std::memory_order_acquire);
+    while (true) {
+      uint32_t begin = static_cast<uint32_t>(cur >> 32);
+      uint32_t end = static_cast<uint32_t>(cur);
+      if (begin >= end) return false;
+      uint64_t next = from_back ? PackRange(begin, end - 1) : PackRange(begin + 1, end);
+      if (range.compare_exchange_weak(cur, next, std::memory_order_acq_rel,
+                                      std::memory_order_acquire)) {
+        *task_id = static_cast<int>(from_back ? end - 1 : begin);
+        return true;
+      }
+    }
+  }
   // The pending jobs.
   std::atomic<int32_t> num_pending_;
   // Whether error has been countered.
   std::atomic<bool> has_error_;
   // The counter page.
   std::atomic<int32_t>* sync_counter_{nullptr};
+  // The number of tasks the counter page can host.
+  int sync_counter_size_{0};
+  // The [begin, end) task ranges of each worker packed in 64 bits, used by work stealing.
+  std::unique_ptr<std::atomic<uint64_t>[]> ranges_;
+  // The number of workers the ranges can host.
+  int range_size_{0};
+  // The number of workers taking part in the current work stealing launch.
+  int num_stealing_workers_{0};
   // The error message
   std::vector<std::string> par_errors_;
 };
@@ -264,6 +366,7 @@ class ThreadPool {
     if (exclude_worker0 && atoi(exclude_worker0) == 0) {
       exclude_worker0_ = false;
     }
+    steal_granularity_ = GetWorkStealingGranularity();
     Init();
   }
 
@@ -286,8 +389,17 @@ class ThreadPool {
 
   int Launch(FTVMParallelLambda flambda, void* cdata, int num_task, int need_sync) {
     ParallelLauncher* launcher = ParallelLauncher::ThreadLocal();
-    ICHECK(!launcher->is_worker)
-        << "Cannot launch parallel job inside worker, consider fuse then parallel";
+    if (launcher->is_worker || launcher->is_launching) {
+      // The workers of this pool are all busy with the outer job, and the launcher
+      // of this thread still serves it, run the nested job in the current thread.
+      return RunSerially(flambda, cdata, num_task == 0 ? 1 : num_task);
+    }
+    if (num_task == 0 && steal_granularity_ > 0 && num_workers_used_ > 1) {
+      launcher->is_launching = true;
+      int res = LaunchWorkStealing(launcher, flambda, cdata);
+      launcher->is_launching = false;
+      return res;
+    }
     if (num_task == 0) {
       num_task = num_workers_used_;
     }
@@ -296,6 +408,7 @@ class ThreadPool {
           << "Request parallel sync task larger than number of threads used "
           << " workers=" << num_workers_used_ << " request=" << num_task;
     }
+    launcher->is_launching = true;
     launcher->Init(flambda, cdata, num_task, need_sync != 0);
     SpscTaskQueue::Task tsk;
     tsk.launcher = launcher;
@@ -314,11 +427,21 @@ class ThreadPool {
       }
     }
     int res = launcher->WaitForJobs();
+    launcher->is_launching = false;
     return res;
   }
 
   static ThreadPool* ThreadLocal() { return dmlc::ThreadLocalStore<ThreadPool>::Get(); }
 
+  /*!
+   * \brief Set the number of tasks each worker's share of a launch is split into
+   *  when the pool picks the number of tasks, 0 disables work stealing.
+   */
+  void SetWorkStealingGranularity(int granularity) {
+    ICHECK_GE(granularity, 0) << "The work stealing granularity can not be negative";
+    steal_granularity_ = granularity;
+  }
+
   void UpdateWorkerConfiguration(threading::ThreadGroup::AffinityMode mode, int nthreads,
                                  const std::vector<unsigned int>& cpus) {
     // this will also reset the affinity of the ThreadGroup
@@ -343,6 +466,49 @@ class ThreadPool {
     num_workers_used_ = threads_->Configure(threading::ThreadGroup::kBig, 0, exclude_worker0_);
   }
 
+  /*!
+   * \brief Run all the tasks of a job in the calling thread.
+   * \param flambda The parallel function to be launched.
+   * \param cdata The closure data.
+   * \param num_task The number of tasks.
+   */
+  static int RunSerially(FTVMParallelLambda flambda, void* cdata, int num_task) {
+    std::atomic<int32_t> sync_counter{0};
+    TVMParallelGroupEnv env;
+    env.num_task = num_task;
+    // the tasks run one after another, so only a single task can pass a barrier
+    env.sync_handle = num_task == 1 ? &sync_counter : nullptr;
+    for (int i = 0; i < num_task; ++i) {
+      if ((*flambda)(i, &env, cdata) != 0) return -1;
+    }
+    return 0;
+  }
+
+  /*!
+   * \brief Launch the job with finer grained tasks which are balanced by work stealing.
+   *
+   *  Each worker starts with steal_granularity_ tasks, so a worker slowed down by
+   *  co-located load hands its remaining tasks over to the idle ones instead of
+   *  stalling the whole launch. The tasks can not synchronize with each other as
+   *  they do not necessarily run concurrently.
+   */
+  int LaunchWorkStealing(ParallelLauncher* launcher, FTVMParallelLambda flambda, void* cdata) {
+    int num_workers = num_workers_used_;
+    launcher->Init(flambda, cdata, num_workers * steal_granularity_, false);
+    launcher->InitWorkStealing(num_workers);
+    SpscTaskQueue::Task tsk;
+    tsk.launcher = launcher;
+    for (int i = exclude_worker0_; i < num_workers; ++i) {
+      tsk.task_id = i;
+      queues_[i]->Push(tsk);
+    }
+    // use the main thread as worker 0
+    if (exclude_worker0_) {
+      launcher->RunWorkStealing(0);
+    }
+    return launcher->WaitForJobs();
+  }
+
   // Internal worker function.
   void RunWorker(int worker_id) {
     SpscTaskQueue* queue = queues_[worker_id].get();
@@ -354,6 +520,10 @@ class ThreadPool {
     static size_t spin_count = GetSpinCount();
     while (queue->Pop(&task, spin_count)) {
       ICHECK(task.launcher != nullptr);
+      if (task.launcher->work_stealing) {
+        task.launcher->RunWorkStealing(task.task_id);
+        continue;
+      }
       TVMParallelGroupEnv* penv = &(task.launcher->env);
       void* cdata = task.launcher->cdata;
       if ((*task.launcher->flambda)(task.task_id, penv, cdata) == 0) {
@@ -368,10 +538,152 @@ class ThreadPool {
   int num_workers_used_;
   // if or not to exclude worker 0 and use main to run task 0
   bool exclude_worker0_{true};
+  // number of tasks per worker when work stealing is enabled, 0 means disabled
+  int steal_granularity_{0};
   std::vector<std::unique_ptr<SpscTaskQueue> > queues_;
   std::unique_ptr<tvm::runtime::threading::ThreadGroup> threads_;
 };
 
+/*!
+ * \brief A thread pool shared by all the threads of the process.
+ *
+ *  Every launch is published as a job in a shared list. The idle workers pick
+ *  the jobs in a round robin way and claim their tasks one at a time, while the
+ *  launching thread claims the tasks of its own job as well. So concurrent
+ *  launches from different threads are multiplexed on the same set of workers,
+ *  and a launch nested in a task is served by whatever worker becomes idle
+ *  instead of oversubscribing cores. Since a job can always be finished by the
+ *  launching thread alone, nested launches never deadlock. Note that the tasks
+ *  of a job do not necessarily run concurrently, so parallel barriers are not
+ *  supported.
+ */
+class SharedThreadPool {
+ public:
+  SharedThreadPool() : num_workers_(tvm::runtime::threading::MaxConcurrency()) {
+    threads_ = std::unique_ptr<tvm::runtime::threading::ThreadGroup>(
+        new tvm::runtime::threading::ThreadGroup(
+            num_workers_, [this](int) { this->RunWorker(); },
+            true /* include_main_thread */));
+    threads_->Configure(threading::ThreadGroup::kBig, 0, true);
+  }
+
+  ~SharedThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      exit_now_ = true;
+      cv_.notify_all();
+    }
+    threads_.reset();
+  }
+
+  int Launch(FTVMParallelLambda flambda, void* cdata, int num_task) {
+    if (num_task == 0) {
+      num_task = num_workers_;
+    }
+    Job job;
+    job.flambda = flambda;
+    job.cdata = cdata;
+    job.env.num_task = num_task;
+    job.env.sync_handle = nullptr;
+    job.num_pending.store(num_task);
+    job.errors.resize(num_task);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      jobs_.push_back(&job);
+      if (num_task > 2) {
+        cv_.notify_all();
+      } else {
+        cv_.notify_one();
+      }
+    }
+    RunJob(&job);
+    // The job lives on this stack, also wait for the helpers to leave it.
+    while (job.num_pending.load() != 0 || job.num_helpers.load() != 0) {
+      tvm::runtime::threading::Yield();
+    }
+    if (!job.has_error.load()) return 0;
+    std::ostringstream os;
+    for (int i = 0; i < num_task; ++i) {
+      if (job.errors[i].length() != 0) {
+        os << "Task " << i << " error: " << job.errors[i] << '\n';
+      }
+    }
+    TVMAPISetLastError(os.str().c_str());
+    return -1;
+  }
+
+  static SharedThreadPool* Global() {
+    static SharedThreadPool* inst = new SharedThreadPool();
+    return inst;
+  }
+
+  /*! \brief Whether the parallel launches use the shared thread pool. */
+  static std::atomic<bool>* Enabled() {
+    static std::atomic<bool> enabled{GetUseSharedThreadPool()};
+    return &enabled;
+  }
+
+ private:
+  /*! \brief A parallel launch published in the pool. */
+  struct Job {
+    FTVMParallelLambda flambda;
+    void* cdata;
+    TVMParallelGroupEnv env;
+    // The next task to be claimed.
+    std::atomic<int32_t> next_task{0};
+    // The tasks which are not finished.
+    std::atomic<int32_t> num_pending{0};
+    // The workers which are working on the job besides the launching thread.
+    std::atomic<int32_t> num_helpers{0};
+    std::atomic<bool> has_error{false};
+    std::vector<std::string> errors;
+  };
+
+  // Claim and run the tasks of the job until all of them are claimed.
+  void RunJob(Job* job) {
+    int num_task = job->env.num_task;
+    for (int task_id = job->next_task.fetch_add(1); task_id < num_task;
+         task_id = job->next_task.fetch_add(1)) {
+      if ((*job->flambda)(task_id, &job->env, job->cdata) != 0) {
+        job->errors[task_id] = TVMGetLastError();
+        job->has_error.store(true);
+      }
+      job->num_pending.fetch_sub(1);
+    }
+    // All the tasks are claimed, the job does not need more helpers.
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = std::find(jobs_.begin(), jobs_.end(), job);
+    if (it != jobs_.end()) jobs_.erase(it);
+  }
+
+  // Internal worker function.
+  void RunWorker() {
+    while (true) {
+      Job* job;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return !jobs_.empty() || exit_now_; });
+        if (exit_now_) return;
+        // rotate the jobs so that concurrent launches share the workers
+        job = jobs_.front();
+        jobs_.pop_front();
+        jobs_.push_back(job);
+        job->num_helpers.fetch_add(1);
+      }
+      RunJob(job);
+      job->num_helpers.fetch_sub(1);
+    }
+  }
+
+  int num_workers_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  // The jobs which still have tasks to be claimed.
+  std::deque<Job*> jobs_;
+  bool exit_now_{false};
+  std::unique_ptr<tvm::runtime::threading::ThreadGroup> threads_;
+};
+
 /*!
  * \brief args[0] is the AffinityMode, args[1] is the number of threads.
  *  args2 is a list of CPUs which is used to set the CPU affinity.
@@ -391,6 +703,19 @@ TVM_REGISTER_GLOBAL("runtime.config_threadpool").set_body([](TVMArgs args, TVMRe
   threading::Configure(mode, nthreads, cpus);
 });
 
+/*!
+ * \brief args[0] is the number of tasks per worker used by work stealing, 0 disables it.
+ */
+TVM_REGISTER_GLOBAL("runtime.config_threadpool_work_stealing")
+    .set_body_typed([](int granularity) { threading::ConfigureWorkStealing(granularity); });
+
+/*!
+ * \brief args[0] is whether to use the thread pool shared by all the threads.
+ */
+TVM_REGISTER_GLOBAL("runtime.config_threadpool_shared").set_body_typed([](bool enable) {
+  threading::ConfigureSharedThreadPool(enable);
+});
+
 namespace threading {
 void ResetThreadPool() { tvm::runtime::ThreadPool::ThreadLocal()->Reset(); }
 /*!
@@ -406,6 +731,14 @@ void Configure(tvm::runtime::threading::ThreadGroup::AffinityMode mode, int nthr
   tvm::runtime::threading::SetMaxConcurrency(cpus.size());
   tvm::runtime::ThreadPool::ThreadLocal()->UpdateWorkerConfiguration(mode, nthreads, cpus);
 }
+
+void ConfigureWorkStealing(int granularity) {
+  tvm::runtime::ThreadPool::ThreadLocal()->SetWorkStealingGranularity(granularity);
+}
+
+void ConfigureSharedThreadPool(bool enable) {
+  tvm::runtime::SharedThreadPool::Enabled()->store(enable);
+}
 }  // namespace threading
 }  // namespace runtime
 }  // namespace tvm
@@ -421,6 +754,9 @@ int TVMBackendParallelLaunch(FTVMParallelLambda flambda, void* cdata, int num_ta
     return 0;
   } else {
 #if !TVM_THREADPOOL_USE_OPENMP
+    if (tvm::runtime::SharedThreadPool::Enabled()->load(std::memory_order_relaxed)) {
+      return tvm::runtime::SharedThreadPool::Global()->Launch(flambda, cdata, num_task);
+    }
     int res = tvm::runtime::ThreadPool::ThreadLocal()->Launch(flambda, cdata, num_task, 1);
     return res;
 #else
@@ -442,6 +778,10 @@ int TVMBackendParallelBarrier(int task_id, TVMParallelGroupEnv* penv) {
 #pragma omp barrier
 #else
   using tvm::runtime::kSyncStride;
+  ICHECK(penv->sync_handle != nullptr)
+      << "Parallel barrier needs the tasks of a launch to run concurrently, which is not the "
+      << "case for a launch nested in another one, a work stealing launch "
+      << "(TVM_THREAD_POOL_WORK_STEALING) or a shared thread pool launch (TVM_THREAD_POOL_SHARED)";
   int num_task = penv->num_task;
   std::atomic<int>* sync_counter = reinterpret_cast<std::atomic<int>*>(penv->sync_handle);
   int old_counter = sync_counter[task_id * kSyncStride].fetch_add(1, std::memory_order_release);
@@ -0,0 +1,423 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file runtime/binned_allocator.h
+ */
+#ifndef TVM_RUNTIME_VM_BINNED_ALLOCATOR_H_
+#define TVM_RUNTIME_VM_BINNED_ALLOCATOR_H_
+
+#include <tvm/runtime/device_api.h>
+#include <tvm/runtime/vm/memory_manager.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+namespace vm {
+
+/*!
+ * \brief An allocator which keeps the free blocks in size class bins.
+ *
+ *  Device memory is requested in segments. A request is served by the smallest
+ *  free block which fits, and on devices whose data pointers support arithmetic
+ *  the block is split so that the remainder serves other requests. Freed blocks
+ *  are merged with their free neighbours. Small blocks are first kept in a few
+ *  caches sharded by thread, so that threads rarely contend on the bins.
+ *
+ *  Unused segments are returned to the device when the reserved memory would
+ *  exceed the high water mark, when they stay idle longer than the idle trim
+ *  time, or when a device allocation fails.
+ */
+class BinnedAllocator final : public Allocator {
+ public:
+  static constexpr size_t kDefaultPageSize = 4096;
+  /*! \brief The largest block kept in the thread caches. */
+  static constexpr size_t kMaxCachedSize = 1 << 20;
+  /*! \brief The maximum number of blocks of the same size kept in a thread cache. */
+  static constexpr size_t kMaxCachedBlocksPerSize = 4;
+  /*! \brief The number of thread cache shards. */
+  static constexpr size_t kNumCacheShards = 8;
+  /*! \brief The number of bins per power of two. */
+  static constexpr int kBinsPerPow2 = 4;
+  static constexpr int kNumBins = 64 * kBinsPerPow2;
+
+  /*! \brief The memory statistics of the allocator. */
+  struct Stats {
+    /*! \brief The memory requested from the device. */
+    size_t reserved_bytes{0};
+    /*! \brief The memory handed out and not freed yet. */
+    size_t allocated_bytes{0};
+    /*! \brief The freed memory kept in the thread caches. */
+    size_t cached_bytes{0};
+    /*! \brief The memory in the free blocks of the bins. */
+    size_t free_bytes{0};
+    /*! \brief The size of the largest free block in the bins. */
+    size_t largest_free_block{0};
+    /*! \brief The number of device allocations. */
+    size_t num_segments{0};
+    /*! \brief The number of free blocks in the bins. */
+    size_t num_free_blocks{0};
+    /*!
+     * \brief The share of the free memory in the bins which the largest free block cannot
+     *  serve, out of 100, i.e. 0 when the free memory is in one block.
+     */
+    double fragmentation{0};
+  };
+
+  /*!
+   * \brief Create the allocator.
+   * \param dev The device to allocate on.
+   * \param high_water_mark The reserved memory above which unused segments are released,
+   *  0 means unlimited.
+   * \param idle_trim_ms The time in milliseconds after which an unused segment is released,
+   *  a negative value disables the idle trim.
+   * \param page_size The granularity of the allocations.
+   */
+  explicit BinnedAllocator(Device dev, size_t high_water_mark = 0, int64_t idle_trim_ms = -1,
+                           size_t page_size = kDefaultPageSize)
+      : Allocator(kBinned),
+        page_size_(page_size),
+        high_water_mark_(high_water_mark),
+        idle_trim_(idle_trim_ms),
+        can_split_(SupportsPointerArithmetic(dev)),
+        device_(dev) {
+    last_trim_ = Clock::now();
+  }
+
+  ~BinnedAllocator() {
+    Trim();
+    std::lock_guard<std::mutex> lock(mu_);
+    if (!allocated_blocks_.empty()) {
+      LOG(WARNING) << "BinnedAllocator is destroyed while " << allocated_blocks_.size()
+                   << " blocks are still in use";
+    }
+  }
+
+  Buffer Alloc(size_t nbytes, size_t alignment, DLDataType type_hint) override {
+    size_t size = std::max<size_t>(1, (nbytes + page_size_ - 1) / page_size_) * page_size_;
+    Buffer buf;
+    if (size <= kMaxCachedSize && alignment <= static_cast<size_t>(kAllocAlignment)) {
+      CacheShard& shard = CurrentShard();
+      std::lock_guard<std::mutex> lock(shard.mu);
+      auto it = shard.blocks.find(size);
+      if (it != shard.blocks.end() && !it->second.empty()) {
+        buf = it->second.back();
+        it->second.pop_back();
+        cached_bytes_.fetch_sub(size, std::memory_order_relaxed);
+        allocated_bytes_.fetch_add(size, std::memory_order_relaxed);
+        return buf;
+      }
+    }
+    std::lock_guard<std::mutex> lock(mu_);
+    MaybeTrimIdle();
+    Block* block = FindBestFit(size, alignment);
+    if (block == nullptr) {
+      block = AllocSegment(size, alignment, type_hint);
+    } else {
+      RemoveFromBin(block);
+      Split(block, size);
+    }
+    block->allocated = true;
+    allocated_blocks_[block->ptr] = block;
+    allocated_bytes_.fetch_add(block->size, std::memory_order_relaxed);
+    buf.device = device_;
+    buf.data = block->ptr;
+    buf.size = block->size;
+    return buf;
+  }
+
+  void Free(const Buffer& buffer) override {
+    allocated_bytes_.fetch_sub(buffer.size, std::memory_order_relaxed);
+    if (buffer.size <= kMaxCachedSize) {
+      CacheShard& shard = CurrentShard();
+      std::lock_guard<std::mutex> lock(shard.mu);
+      std::vector<Buffer>& blocks = shard.blocks[buffer.size];
+      if (blocks.size() < kMaxCachedBlocksPerSize) {
+        blocks.push_back(buffer);
+        cached_bytes_.fetch_add(buffer.size, std::memory_order_relaxed);
+        return;
+      }
+    }
+    std::lock_guard<std::mutex> lock(mu_);
+    FreeBlock(buffer.data);
+    MaybeTrimIdle();
+  }
+
+  size_t UsedMemory() const override { return reserved_bytes_.load(std::memory_order_relaxed); }
+
+  /*! \brief Return the cached blocks to the bins and release all the unused segments. */
+  void Trim() {
+    std::lock_guard<std::mutex> lock(mu_);
+    FlushCaches();
+    ReleaseSegments(0, [](Block*) { return true; });
+  }
+
+  /*! \brief Get the memory statistics. */
+  Stats GetStats() {
+    std::lock_guard<std::mutex> lock(mu_);
+    Stats stats;
+    stats.reserved_bytes = reserved_bytes_.load(std::memory_order_relaxed);
+    stats.allocated_bytes = allocated_bytes_.load(std::memory_order_relaxed);
+    stats.cached_bytes = cached_bytes_.load(std::memory_order_relaxed);
+    stats.num_segments = num_segments_;
+    for (int i = kNumBins - 1; i >= 0; --i) {
+      stats.num_free_blocks += bins_[i].size();
+      for (const Block* block : bins_[i]) {
+        stats.free_bytes += block->size;
+      }
+      if (stats.largest_free_block == 0 && !bins_[i].empty()) {
+        stats.largest_free_block = (*bins_[i].rbegin())->size;
+      }
+    }
+    if (stats.free_bytes != 0) {
+      stats.fragmentation =
+          100.0 * (stats.free_bytes - stats.largest_free_block) / stats.free_bytes;
+    }
+    return stats;
+  }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  /*! \brief A block of memory carved out of a segment. */
+  struct Block {
+    void* ptr{nullptr};
+    size_t size{0};
+    bool allocated{false};
+    // The neighbour blocks in the same segment.
+    Block* prev{nullptr};
+    Block* next{nullptr};
+    // When the block was freed.
+    Clock::time_point freed_at;
+  };
+
+  /*! \brief Order the free blocks of a bin by size, then by address. */
+  struct BlockComparator {
+    bool operator()(const Block* a, const Block* b) const {
+      if (a->size != b->size) return a->size < b->size;
+      return std::less<void*>()(a->ptr, b->ptr);
+    }
+  };
+
+  /*! \brief The freed small blocks kept for the threads mapped to the shard. */
+  struct CacheShard {
+    std::mutex mu;
+    std::unordered_map<size_t, std::vector<Buffer>> blocks;
+  };
+
+  static bool SupportsPointerArithmetic(Device dev) {
+    switch (static_cast<int>(dev.device_type)) {
+      case kDLCPU:
+      case kDLCUDA:
+      case kDLCUDAHost:
+      case kDLCUDAManaged:
+      case kDLROCM:
+      case kDLROCMHost:
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  static int BinIndex(size_t size) {
+    int log2 = 0;
+    while ((size >> (log2 + 1)) != 0) ++log2;
+    // split each power of two into kBinsPerPow2 bins using the bits after the leading one
+    int sub = log2 >= 2 ? static_cast<int>((size >> (log2 - 2)) & (kBinsPerPow2 - 1)) : 0;
+    return std::min(log2 * kBinsPerPow2 + sub, kNumBins - 1);
+  }
+
+  CacheShard& CurrentShard() {
+    size_t index = std::hash<std::thread::id>()(std::this_thread::get_id()) % kNumCacheShards;
+    return shards_[index];
+  }
+
+  // Best fit search, the caller holds mu_.
+  Block* FindBestFit(size_t size, size_t alignment) {
+    Block key;
+    key.size = size;
+    for (int bin = BinIndex(size); bin < kNumBins; ++bin) {
+      for (auto it = bins_[bin].lower_bound(&key); it != bins_[bin].end(); ++it) {
+        Block* block = *it;
+        // without splitting, do not waste more than the requested size
+        if (!can_split_ && block->size > 2 * size) return nullptr;
+        if (alignment > 1 && reinterpret_cast<uintptr_t>(block->ptr) % alignment != 0) continue;
+        return block;
+      }
+    }
+    return nullptr;
+  }
+
+  void InsertToBin(Block* block) { bins_[BinIndex(block->size)].insert(block); }
+
+  void RemoveFromBin(Block* block) { bins_[BinIndex(block->size)].erase(block); }
+
+  // Split the tail of block beyond size into a new free block, the caller holds mu_.
+  void Split(Block* block, size_t size) {
+    if (!can_split_ || block->size - size < page_size_) return;
+    Block* rest = new Block();
+    rest->ptr = static_cast<char*>(block->ptr) + size;
+    rest->size = block->size - size;
+    rest->prev = block;
+    rest->next = block->next;
+    rest->freed_at = Clock::now();
+    if (block->next != nullptr) block->next->prev = rest;
+    block->next = rest;
+    block->size = size;
+    InsertToBin(rest);
+  }
+
+  // Free the block at ptr and merge it with its free neighbours, the caller holds mu_.
+  void FreeBlock(void* ptr) {
+    auto it = allocated_blocks_.find(ptr);
+    ICHECK(it != allocated_blocks_.end()) << "BinnedAllocator does not own the buffer " << ptr;
+    Block* block = it->second;
+    allocated_blocks_.erase(it);
+    block->allocated = false;
+    if (block->prev != nullptr && !block->prev->allocated) {
+      Block* prev = block->prev;
+      RemoveFromBin(prev);
+      prev->size += block->size;
+      prev->next = block->next;
+      if (block->next != nullptr) block->next->prev = prev;
+      delete block;
+      block = prev;
+    }
+    if (block->next != nullptr && !block->next->allocated) {
+      Block* next = block->next;
+      RemoveFromBin(next);
+      block->size += next->size;
+      block->next = next->next;
+      if (next->next != nullptr) next->next->prev = block;
+      delete next;
+    }
+    block->freed_at = Clock::now();
+    InsertToBin(block);
+  }
+
+  // Request a new segment from the device, the caller holds mu_.
+  Block* AllocSegment(size_t size, size_t alignment, DLDataType type_hint) {
+    size_t reserved = reserved_bytes_.load(std::memory_order_relaxed);
+    if (high_water_mark_ != 0 && reserved + size > high_water_mark_) {
+      ReleaseSegments(reserved + size - high_water_mark_, [](Block*) { return true; });
+    }
+    void* data = nullptr;
+    alignment = std::max(alignment, static_cast<size_t>(kAllocAlignment));
+    try {
+      data = DeviceAPI::Get(device_)->AllocDataSpace(device_, size, alignment, type_hint);
+    } catch (InternalError& err) {
+      LOG(WARNING) << "BinnedAllocator got InternalError during allocation: " << err.message();
+      LOG(WARNING) << "Trying to release all unused memory and reallocate...";
+      FlushCaches();
+      ReleaseSegments(0, [](Block*) { return true; });
+      data = DeviceAPI::Get(device_)->AllocDataSpace(device_, size, alignment, type_hint);
+    }
+    reserved_bytes_.fetch_add(size, std::memory_order_relaxed);
+    ++num_segments_;
+    VLOG(1) << "allocate segment " << size << " B, reserved memory " << reserved_bytes_ << " B";
+    Block* block = new Block();
+    block->ptr = data;
+    block->size = size;
+    return block;
+  }
+
+  /*!
+   * \brief Release the unused segments, the caller holds mu_.
+   * \param nbytes The amount of memory to be released, 0 means as much as possible.
+   * \param pred The predicate on the free segment to be released.
+   */
+  void ReleaseSegments(size_t nbytes, std::function<bool(Block*)> pred) {
+    size_t released = 0;
+    for (int bin = kNumBins - 1; bin >= 0; --bin) {
+      for (auto it = bins_[bin].begin(); it != bins_[bin].end();) {
+        Block* block = *it;
+        if (block->prev != nullptr || block->next != nullptr || !pred(block)) {
+          ++it;
+          continue;
+        }
+        it = bins_[bin].erase(it);
+        DeviceAPI::Get(device_)->FreeDataSpace(device_, block->ptr);
+        reserved_bytes_.fetch_sub(block->size, std::memory_order_relaxed);
+        --num_segments_;
+        released += block->size;
+        delete block;
+        if (nbytes != 0 && released >= nbytes) return;
+      }
+    }
+    if (released != 0) {
+      VLOG(1) << "release " << released << " B, reserved memory " << reserved_bytes_ << " B";
+    }
+  }
+
+  // Release the segments which stayed unused for longer than idle_trim_, the caller holds mu_.
+  void MaybeTrimIdle() {
+    if (idle_trim_.count() < 0) return;
+    Clock::time_point now = Clock::now();
+    if (now - last_trim_ < idle_trim_) return;
+    last_trim_ = now;
+    ReleaseSegments(0, [this, now](Block* block) { return now - block->freed_at >= idle_trim_; });
+  }
+
+  // Return the blocks in the thread caches to the bins, the caller holds mu_.
+  void FlushCaches() {
+    for (CacheShard& shard : shards_) {
+      std::lock_guard<std::mutex> lock(shard.mu);
+      for (auto& it : shard.blocks) {
+        for (const Buffer& buf : it.second) {
+          cached_bytes_.fetch_sub(buf.size, std::memory_order_relaxed);
+          FreeBlock(buf.data);
+        }
+      }
+      shard.blocks.clear();
+    }
+  }
+
+  size_t page_size_;
+  size_t high_water_mark_;
+  std::chrono::milliseconds idle_trim_;
+  bool can_split_;
+  Device device_;
+  std::atomic<size_t> reserved_bytes_{0};
+  std::atomic<size_t> allocated_bytes_{0};
+  std::atomic<size_t> cached_bytes_{0};
+  size_t num_segments_{0};
+  Clock::time_point last_trim_;
+  /*! \brief The free blocks, binned by size class. */
+  std::set<Block*, BlockComparator> bins_[kNumBins];
+  /*! \brief The blocks handed out, including the ones kept in the caches. */
+  std::unordered_map<void*, Block*> allocated_blocks_;
+  CacheShard shards_[kNumCacheShards];
+  /*! \brief Guards the bins and the segments, taken before the lock of a shard. */
+  std::mutex mu_;
+};
+
+}  // namespace vm
+}  // namespace runtime
+}  // namespace tvm
+
+#endif  // TVM_RUNTIME_VM_BINNED_ALLOCATOR_H_
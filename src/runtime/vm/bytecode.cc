@@ -346,6 +346,7 @@ Instruction Instruction::AllocStorage(RegName size, Index alignment, DLDataType
   instr.alloc_storage.alignment = alignment;
   instr.alloc_storage.dtype_hint = dtype_hint;
   instr.alloc_storage.device_index = device_index;
+  instr.alloc_storage.arena_offset = -1;
   return instr;
 }
 
@@ -620,6 +621,9 @@ void InstructionPrint(std::ostream& os, const Instruction& instr) {
          << instr.alloc_storage.alignment << " "
          << DLDataType2String(instr.alloc_storage.dtype_hint) << " "
          << instr.alloc_storage.device_index;
+      if (instr.alloc_storage.arena_offset >= 0) {
+        os << " arena_offset(" << instr.alloc_storage.arena_offset << ")";
+      }
       break;
     }
     case Opcode::ShapeOf: {
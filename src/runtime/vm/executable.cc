@@ -30,11 +30,17 @@
 #include <tvm/runtime/vm/vm.h>
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <iomanip>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <random>
 #include <sstream>
+#include <thread>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -55,6 +61,149 @@ VMInstructionSerializer SerializeInstruction(const Instruction& instr);
 // Helper to deserialize a serialized vm instruction.
 Instruction DeserializeInstruction(const VMInstructionSerializer& instr);
 
+struct Executable::LazyConstants {
+  /*! \brief The decoding state of a constant. */
+  enum State : int { kPending, kDecoding, kReady };
+
+  /*! \brief Marks the constants which are not stored in the code section. */
+  static constexpr size_t kNotLazy = static_cast<size_t>(-1);
+
+  explicit LazyConstants(std::vector<size_t> offsets)
+      : offsets(std::move(offsets)),
+        values(this->offsets.size()),
+        states(new std::atomic<int>[this->offsets.size()]) {
+    for (size_t i = 0; i < this->offsets.size(); ++i) states[i].store(kPending);
+  }
+
+  ~LazyConstants() { StopPrefetch(); }
+
+  /*! \brief Whether the constant at \p const_index is decoded from the code section. */
+  bool IsLazy(size_t const_index) const { return offsets[const_index] != kNotLazy; }
+
+  /*! \brief Get the constant at \p const_index, decoding it from \p code if needed. */
+  const ObjectRef& Get(size_t const_index, const std::string& code) {
+    std::atomic<int>& state = states[const_index];
+    if (state.load(std::memory_order_acquire) == kReady) return values[const_index];
+    {
+      // Claim the constant, or wait for the thread decoding it.
+      std::unique_lock<std::mutex> lock(mutex);
+      cv.wait(lock, [&state] { return state.load(std::memory_order_relaxed) != kDecoding; });
+      if (state.load(std::memory_order_relaxed) == kReady) return values[const_index];
+      state.store(kDecoding, std::memory_order_relaxed);
+    }
+    auto start = std::chrono::steady_clock::now();
+    NDArray value;
+    try {
+      dmlc::MemoryFixedSizeStream strm(const_cast<char*>(code.data()) + offsets[const_index],
+                                       code.size() - offsets[const_index]);
+      STREAM_CHECK(value.Load(&strm), "constant tensor");
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(mutex);
+      state.store(kPending, std::memory_order_relaxed);
+      cv.notify_all();
+      throw;
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    std::lock_guard<std::mutex> lock(mutex);
+    values[const_index] = std::move(value);
+    state.store(kReady, std::memory_order_release);
+    num_decoded.fetch_add(1, std::memory_order_relaxed);
+    decode_ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+                        std::memory_order_relaxed);
+    cv.notify_all();
+    return values[const_index];
+  }
+
+  /*! \brief Stop and join the prefetch thread, if any. */
+  void StopPrefetch() {
+    if (!prefetcher.joinable()) return;
+    stop_prefetch.store(true);
+    prefetcher.join();
+  }
+
+  /*! \brief The offset of each constant in the code section, or kNotLazy. */
+  std::vector<size_t> offsets;
+  /*! \brief The decoded constants. */
+  std::vector<ObjectRef> values;
+  /*! \brief The State of each constant. */
+  std::unique_ptr<std::atomic<int>[]> states;
+  /*! \brief Guards the transitions out of kPending and kDecoding. */
+  std::mutex mutex;
+  /*! \brief Signaled when a constant leaves kDecoding. */
+  std::condition_variable cv;
+  /*! \brief The background thread decoding the constants ahead of their first use. */
+  std::thread prefetcher;
+  /*! \brief Asks the prefetch thread to stop. */
+  std::atomic<bool> stop_prefetch{false};
+  /*! \brief The number of constants decoded so far. */
+  std::atomic<int64_t> num_decoded{0};
+  /*! \brief The time spent decoding constants so far. */
+  std::atomic<int64_t> decode_ns{0};
+};
+
+constexpr size_t Executable::LazyConstants::kNotLazy;
+
+Executable::~Executable() {
+  // The prefetch thread reads code_, stop it before the members are destroyed.
+  if (lazy_constants_) lazy_constants_->StopPrefetch();
+}
+
+const ObjectRef& Executable::GetConstant(Index const_index) const {
+  ICHECK_LT(static_cast<size_t>(const_index), constants.size());
+  if (!lazy_constants_ || !lazy_constants_->IsLazy(const_index)) return constants[const_index];
+  return lazy_constants_->Get(const_index, code_);
+}
+
+void Executable::DecodeConstants() {
+  if (!lazy_constants_) return;
+  for (size_t i = 0; i < constants.size(); ++i) {
+    if (lazy_constants_->IsLazy(i)) constants[i] = lazy_constants_->Get(i, code_);
+  }
+}
+
+void Executable::PrefetchConstants() {
+  if (!lazy_constants_ || lazy_constants_->prefetcher.joinable()) return;
+  // Decode the constants in the order they are loaded by main and then by the other functions.
+  std::vector<const VMFunction*> funcs;
+  auto it = global_map.find("main");
+  if (it != global_map.end()) funcs.push_back(&functions[it->second]);
+  for (const VMFunction& func : functions) {
+    if (funcs.empty() || &func != funcs[0]) funcs.push_back(&func);
+  }
+  std::vector<size_t> order;
+  std::unordered_set<size_t> seen;
+  for (const VMFunction* func : funcs) {
+    for (const Instruction& instr : func->instructions) {
+      if (instr.op != Opcode::LoadConst) continue;
+      size_t const_index = static_cast<size_t>(instr.const_index);
+      if (lazy_constants_->IsLazy(const_index) && seen.insert(const_index).second) {
+        order.push_back(const_index);
+      }
+    }
+  }
+  LazyConstants* lazy = lazy_constants_.get();
+  const std::string* code = &code_;
+  lazy->prefetcher = std::thread([lazy, code, order]() {
+    for (size_t const_index : order) {
+      if (lazy->stop_prefetch.load(std::memory_order_relaxed)) return;
+      try {
+        lazy->Get(const_index, *code);
+      } catch (const std::exception& e) {
+        // Leave the constant to be decoded, and the error reported, on first use.
+        LOG(WARNING) << "Failed to prefetch constant " << const_index << ": " << e.what();
+      }
+    }
+  });
+}
+
+int64_t Executable::NumDecodedConstants() const {
+  return lazy_constants_ ? lazy_constants_->num_decoded.load() : 0;
+}
+
+double Executable::ConstantDecodeTime() const {
+  return lazy_constants_ ? lazy_constants_->decode_ns.load() / 1e3 : 0;
+}
+
 PackedFunc Executable::GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) {
   if (name == "get_lib") {
     return PackedFunc(
@@ -97,6 +246,8 @@ PackedFunc Executable::GetFunction(const std::string& name, const ObjectPtr<Obje
       uint64_t byte_limit = args[1];
       MoveLateBoundConstantsToFile(path, static_cast<size_t>(byte_limit));
     });
+  } else if (name == "prefetch_constants") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { PrefetchConstants(); });
   } else if (name == "load_late_bound_consts") {
     return PackedFunc([this](TVMArgs args, TVMRetValue* rv) {
       CHECK_EQ(args.size(), 1);
@@ -169,8 +320,7 @@ std::string Executable::GetBytecode() const {
 std::string Executable::GetConstants() const {
   std::ostringstream oss;
   for (size_t i = 0; i < constants.size(); ++i) {
-    const auto& constant = constants[i];
-    auto ndarray = Downcast<NDArray>(constant);
+    auto ndarray = Downcast<NDArray>(GetConstant(i));
     oss << "VM Const[" << i
         << "]: " << RuntimeObject2String(ndarray, virtual_devices[host_device_index])
         << " on device index " << const_device_indexes[i] << std::endl;
@@ -211,8 +361,8 @@ std::string Executable::Stats() const {
 
   // Get the number of constants and the shape of each of them.
   oss << "  Constant shapes (# " << constants.size() << "): [";
-  for (const auto& it : constants) {
-    const auto constant = Downcast<NDArray>(it);
+  for (size_t i = 0; i < constants.size(); ++i) {
+    const auto constant = Downcast<NDArray>(GetConstant(i));
     const auto& shape = constant.Shape();
 
     // Scalar
@@ -267,6 +417,8 @@ void SaveHeader(dmlc::Stream* strm) {
 }
 
 TVMByteArray Executable::Save() {
+  // The code section is rewritten below, decode the constants still pointing into it.
+  DecodeConstants();
   // Initialize the stream object.
   code_.clear();
   dmlc::MemoryStringStream strm(&code_);
@@ -301,7 +453,13 @@ void Executable::SaveVirtualDevicesSection(dmlc::Stream* strm) {
 }
 
 void Executable::MoveLateBoundConstantsToStream(dmlc::Stream* stream, size_t byte_limit) {
+  runtime::SaveParams(stream, MoveLateBoundConstants(byte_limit));
+}
+
+Map<String, NDArray> Executable::MoveLateBoundConstants(size_t byte_limit) {
   ICHECK(late_bound_constant_names.empty());
+  DecodeConstants();
+  lazy_constants_.reset();
   late_bound_constant_names.reserve(constants.size());
   Map<String, NDArray> map;
   size_t total_late_bound_bytes = 0;
@@ -323,14 +481,12 @@ void Executable::MoveLateBoundConstantsToStream(dmlc::Stream* stream, size_t byt
   }
   VLOG(1) << "moved " << map.size() << " constants of " << total_late_bound_bytes
           << " bytes (out of " << constants.size() << " overall) to be late-bound";
-  runtime::SaveParams(stream, map);
+  return map;
 }
 
 void Executable::MoveLateBoundConstantsToFile(const std::string& path, size_t byte_limit) {
-  std::string bytes;
-  dmlc::MemoryStringStream stream(&bytes);
-  MoveLateBoundConstantsToStream(&stream, byte_limit);
-  SaveBinaryToFile(path, bytes);
+  // Save in the mappable format, so that loading the file aliases it instead of copying.
+  SaveBinaryToFile(path, runtime::SaveMappableParams(MoveLateBoundConstants(byte_limit)));
 }
 
 void Executable::LoadLateBoundConstantsFromStream(dmlc::Stream* stream) {
@@ -338,12 +494,16 @@ void Executable::LoadLateBoundConstantsFromStream(dmlc::Stream* stream) {
     VLOG(1) << "Found no late-bound constants to load";
     return;
   }
+  SetLateBoundConstants(runtime::LoadParams(stream));
+}
+
+void Executable::SetLateBoundConstants(Map<String, NDArray> map) {
   ICHECK_EQ(late_bound_constant_names.size(), constants.size());
-  Map<String, NDArray> map = runtime::LoadParams(stream);
   VLOG(1) << "loaded " << map.size() << " late-bound constants";
   for (size_t const_index = 0; const_index < constants.size(); ++const_index) {
     if (!late_bound_constant_names[const_index].defined()) {
-      ICHECK(constants[const_index].defined())
+      ICHECK(constants[const_index].defined() ||
+             (lazy_constants_ && lazy_constants_->IsLazy(const_index)))
           << "Undefined immediate constant at index " << const_index;
       continue;
     }
@@ -360,10 +520,11 @@ void Executable::LoadLateBoundConstantsFromStream(dmlc::Stream* stream) {
 }
 
 void Executable::LoadLateBoundConstantsFromFile(const std::string& path) {
-  std::string bytes;
-  LoadBinaryFromFile(path, &bytes);
-  dmlc::MemoryStringStream stream(&bytes);
-  LoadLateBoundConstantsFromStream(&stream);
+  if (late_bound_constant_names.empty()) {
+    VLOG(1) << "Found no late-bound constants to load";
+    return;
+  }
+  SetLateBoundConstants(runtime::LoadParamsFromFile(path));
 }
 
 void Executable::SaveGlobalSection(dmlc::Stream* strm) {
@@ -417,7 +578,30 @@ void Executable::SaveConstantSection(dmlc::Stream* stream) {
   stream->Write(const_device_indexes);
 }
 
-void Executable::LoadConstantSection(dmlc::Stream* stream) {
+namespace {
+/*! \brief Skip over a tensor written by SaveDLTensor, without reading its data. */
+bool SkipDLTensor(dmlc::SeekStream* strm, size_t stream_size) {
+  uint64_t header, reserved;
+  Device dev;
+  int ndim;
+  DLDataType dtype;
+  if (!strm->Read(&header) || !strm->Read(&reserved) || header != kTVMNDArrayMagic ||
+      !strm->Read(&dev) || !strm->Read(&ndim) || !strm->Read(&dtype) || ndim < 0) {
+    return false;
+  }
+  std::vector<int64_t> shape(ndim);
+  if (ndim != 0 && !strm->ReadArray(&shape[0], ndim)) return false;
+  int64_t data_byte_size;
+  if (!strm->Read(&data_byte_size) || data_byte_size < 0 ||
+      static_cast<size_t>(data_byte_size) > stream_size - strm->Tell()) {
+    return false;
+  }
+  strm->Seek(strm->Tell() + data_byte_size);
+  return true;
+}
+}  // namespace
+
+void Executable::LoadConstantSection(dmlc::SeekStream* stream) {
   uint64_t sz;
   // Load the overall number of constants.
   STREAM_CHECK(stream->Read(&sz, sizeof(sz)), "constants table size");
@@ -428,6 +612,8 @@ void Executable::LoadConstantSection(dmlc::Stream* stream) {
   constants.resize(size);
   late_bound_constant_names.resize(size);
   bool any_late_bound = false;
+  // The immediate constants are decoded from code_ on first use.
+  std::vector<size_t> offsets(size, LazyConstants::kNotLazy);
 
   // Load each of the constants.
   for (size_t const_index = 0; const_index < size; const_index++) {
@@ -436,9 +622,8 @@ void Executable::LoadConstantSection(dmlc::Stream* stream) {
     if (tag == kImmediateConstTag) {
       // Immediate constants tagged by 0.
       VLOG(1) << "load " << const_index << " as immediate";
-      runtime::NDArray ndarray;
-      STREAM_CHECK(ndarray.Load(stream), "constant tensor");
-      constants[const_index] = std::move(ndarray);
+      offsets[const_index] = stream->Tell();
+      STREAM_CHECK(SkipDLTensor(stream, code_.size()), "constant tensor");
       late_bound_constant_names[const_index] = String(ObjectPtr<StringObj>(nullptr));
     } else if (tag == kLateBoundConstTag) {
       // Late-bound constants tagged by 1.
@@ -456,6 +641,7 @@ void Executable::LoadConstantSection(dmlc::Stream* stream) {
   if (!any_late_bound) {
     late_bound_constant_names.clear();
   }
+  lazy_constants_.reset(new LazyConstants(std::move(offsets)));
 
   // Load the const to device index mapping.
   std::vector<Index> indexes;
@@ -581,6 +767,7 @@ VMInstructionSerializer SerializeInstruction(const Instruction& instr) {
       fields.push_back(dtype.lanes);
       fields.push_back(instr.alloc_storage.device_index);
       fields.push_back(instr.dst);
+      fields.push_back(instr.alloc_storage.arena_offset);
       break;
     }
     case Opcode::AllocADT: {
@@ -681,7 +868,7 @@ void Executable::SaveCodeSection(dmlc::Stream* strm) {
   for (const auto& func : this->functions) {
     // Save the function info.
     VMFunctionSerializer func_format(func.name, func.register_file_size, func.instructions.size(),
-                                     func.params, func.param_device_indexes);
+                                     func.params, func.param_device_indexes, func.arena_sizes);
     func_format.Save(strm);
 
     // Serialize each instruction.
@@ -894,8 +1081,8 @@ Instruction DeserializeInstruction(const VMInstructionSerializer& instr) {
       return Instruction::AllocClosure(clo_index, num_freevar, free_vars, dst);
     }
     case Opcode::AllocStorage: {
-      // Number of fields = 7
-      DCHECK_GE(instr.fields.size(), 7U);
+      // Number of fields = 8
+      DCHECK_GE(instr.fields.size(), 8U);
       Index allocation_size = instr.fields[0];
       Index alignment = instr.fields[1];
 
@@ -907,7 +1094,10 @@ Instruction DeserializeInstruction(const VMInstructionSerializer& instr) {
       Index device_type = instr.fields[5];
       RegName dst = instr.fields[6];
 
-      return Instruction::AllocStorage(allocation_size, alignment, dtype, device_type, dst);
+      Instruction alloc_storage =
+          Instruction::AllocStorage(allocation_size, alignment, dtype, device_type, dst);
+      alloc_storage.alloc_storage.arena_offset = instr.fields[7];
+      return alloc_storage;
     }
     case Opcode::If: {
       // Number of fields = 4
@@ -1019,6 +1209,7 @@ void Executable::LoadCodeSection(dmlc::Stream* strm) {
     VMFunction vm_func =
         VMFunction(loaded_func.name, loaded_func.params, instructions,
                    loaded_func.register_file_size, loaded_func.param_device_indexes);
+    vm_func.arena_sizes = loaded_func.arena_sizes;
     auto it = this->global_map.find(loaded_func.name);
     ICHECK(it != this->global_map.end());
     ICHECK_LE(it->second, this->global_map.size());
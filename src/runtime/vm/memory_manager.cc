@@ -21,11 +21,15 @@
  * \file tvm/runtime/vm/memory_manager.cc
  * \brief Allocate and manage memory for the runtime.
  */
+#include <tvm/runtime/profiling.h>
+#include <tvm/runtime/registry.h>
 #include <tvm/runtime/vm/memory_manager.h>
 
+#include <cstdlib>
 #include <memory>
 #include <utility>
 
+#include "binned_allocator.h"
 #include "naive_allocator.h"
 #include "pooled_allocator.h"
 
@@ -130,6 +134,15 @@ Allocator* MemoryManager::GetOrCreateAllocator(Device dev, AllocatorType type) {
         alloc.reset(new PooledAllocator(dev));
         break;
       }
+      case kBinned: {
+        VLOG(1) << "New binned allocator for " << DeviceName(dev.device_type) << "("
+                << dev.device_id << ")";
+        const char* high_water_mark = getenv("TVM_VM_ALLOCATOR_HIGH_WATER_MARK");
+        const char* idle_trim_ms = getenv("TVM_VM_ALLOCATOR_IDLE_TRIM_MS");
+        alloc.reset(new BinnedAllocator(dev, high_water_mark ? atoll(high_water_mark) : 0,
+                                        idle_trim_ms ? atoll(idle_trim_ms) : -1));
+        break;
+      }
       default:
         LOG(FATAL) << "Unknown allocator type: " << type;
     }
@@ -170,6 +183,36 @@ NDArray Allocator::Empty(std::vector<int64_t> shape, DLDataType dtype, DLDevice
   return NDArray(GetObjectPtr<Object>(container));
 }
 
+static BinnedAllocator* GetBinnedAllocator(int device_type, int device_id) {
+  Device dev{static_cast<DLDeviceType>(device_type), device_id};
+  Allocator* alloc = MemoryManager::GetAllocator(dev);
+  ICHECK_EQ(alloc->type(), kBinned) << "The allocator for " << DeviceName(dev.device_type) << "("
+                                    << dev.device_id << ") is not a binned allocator";
+  return static_cast<BinnedAllocator*>(alloc);
+}
+
+TVM_REGISTER_GLOBAL("runtime.VMBinnedAllocatorStats")
+    .set_body_typed([](int device_type, int device_id) {
+      BinnedAllocator::Stats stats = GetBinnedAllocator(device_type, device_id)->GetStats();
+      Map<String, ObjectRef> ret;
+      ret.Set("Reserved Bytes", ObjectRef(make_object<profiling::CountNode>(stats.reserved_bytes)));
+      ret.Set("Allocated Bytes",
+              ObjectRef(make_object<profiling::CountNode>(stats.allocated_bytes)));
+      ret.Set("Cached Bytes", ObjectRef(make_object<profiling::CountNode>(stats.cached_bytes)));
+      ret.Set("Free Bytes", ObjectRef(make_object<profiling::CountNode>(stats.free_bytes)));
+      ret.Set("Largest Free Block",
+              ObjectRef(make_object<profiling::CountNode>(stats.largest_free_block)));
+      ret.Set("Segments", ObjectRef(make_object<profiling::CountNode>(stats.num_segments)));
+      ret.Set("Free Blocks", ObjectRef(make_object<profiling::CountNode>(stats.num_free_blocks)));
+      ret.Set("Fragmentation", ObjectRef(make_object<profiling::PercentNode>(stats.fragmentation)));
+      return ret;
+    });
+
+TVM_REGISTER_GLOBAL("runtime.VMBinnedAllocatorTrim").set_body_typed([](int device_type,
+                                                                       int device_id) {
+  GetBinnedAllocator(device_type, device_id)->Trim();
+});
+
 }  // namespace vm
 }  // namespace runtime
 }  // namespace tvm
@@ -42,8 +42,8 @@ namespace tvm {
 namespace runtime {
 namespace vm {
 
-PackedFunc VirtualMachineDebug::GetFunction(const std::string& name,
-                                            const ObjectPtr<Object>& sptr_to_self) {
+PackedFunc VirtualMachineDebug::GetRequestFunction(const std::string& name,
+                                                   const ObjectPtr<Object>& sptr_to_self) {
   if (name == "profile") {
     return TypedPackedFunc<profiling::Report(String, Array<profiling::MetricCollector>)>(
         [sptr_to_self, this](String arg_name, Array<profiling::MetricCollector> collectors) {
@@ -86,10 +86,17 @@ PackedFunc VirtualMachineDebug::GetFunction(const std::string& name,
       return report->AsJSON();
     });
   } else {
-    return VirtualMachine::GetFunction(name, sptr_to_self);
+    return VirtualMachine::GetRequestFunction(name, sptr_to_self);
   }
 }
 
+ObjectPtr<VirtualMachine> VirtualMachineDebug::CreateExecutionContext() {
+  auto vm = make_object<VirtualMachineDebug>();
+  ShareProgramState(vm.get());
+  vm->packed_index_map_ = packed_index_map_;
+  return vm;
+}
+
 void VirtualMachineDebug::LoadExecutable(const ObjectPtr<Executable>& exec) {
   VirtualMachine::LoadExecutable(exec);
   for (auto kv : exec_->primitive_map) {
@@ -97,7 +104,7 @@ void VirtualMachineDebug::LoadExecutable(const ObjectPtr<Executable>& exec) {
   }
 }
 
-void VirtualMachineDebug::OpStartHook(Instruction instr) {
+void VirtualMachineDebug::OpStartHook(const Instruction& instr) {
   if (prof_ && prof_.operator*().IsRunning()) {
     if (instr.op == Opcode::LoadConst) {
       Device dev = GetDevice(exec_->const_device_indexes[instr.const_index]);
@@ -42,16 +42,20 @@ class VirtualMachineDebug : public VirtualMachine {
  public:
   VirtualMachineDebug() : VirtualMachine(), prof_({}) {}
 
-  PackedFunc GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) final;
-
   void LoadExecutable(const ObjectPtr<Executable>& exec) final;
 
   ~VirtualMachineDebug() {}
 
+ protected:
+  PackedFunc GetRequestFunction(const std::string& name,
+                                const ObjectPtr<Object>& sptr_to_self) final;
+
+  ObjectPtr<VirtualMachine> CreateExecutionContext() final;
+
  private:
   void InvokePacked(Index packed_index, const PackedFunc& func, Index arg_count, Index output_size,
                     const std::vector<ObjectRef>& args) final;
-  void OpStartHook(Instruction instr) final;
+  void OpStartHook(const Instruction& instr) final;
   void OpStopHook() final;
 
   std::unordered_map<Index, std::string> packed_index_map_;
@@ -60,17 +60,21 @@ struct VMFunctionSerializer {
   std::vector<std::string> params;
   /*! \brief The index for the devices holding each parameter of the VMFunction. */
   std::vector<Index> param_device_indexes;
+  /*! \brief The size of the statically planned arena on each device. */
+  std::vector<Index> arena_sizes;
 
   VMFunctionSerializer() = default;
 
   VMFunctionSerializer(const std::string& name, Index register_file_size, size_t num_instructions,
                        const std::vector<std::string>& params,
-                       const std::vector<Index>& param_device_indexes)
+                       const std::vector<Index>& param_device_indexes,
+                       const std::vector<Index>& arena_sizes)
       : name(name),
         register_file_size(register_file_size),
         num_instructions(num_instructions),
         params(params),
-        param_device_indexes(param_device_indexes) {}
+        param_device_indexes(param_device_indexes),
+        arena_sizes(arena_sizes) {}
 
   /*!
    * \brief Load the serialized function header.
@@ -88,6 +92,7 @@ struct VMFunctionSerializer {
     num_instructions = static_cast<size_t>(std::stoll(func_info[2]));
     if (!strm->Read(&params)) return false;
     if (!strm->Read(&param_device_indexes)) return false;
+    if (!strm->Read(&arena_sizes)) return false;
     return true;
   }
 
@@ -103,6 +108,7 @@ struct VMFunctionSerializer {
     strm->Write(func_info);
     strm->Write(params);
     strm->Write(param_device_indexes);
+    strm->Write(arena_sizes);
   }
 };
 
@@ -26,18 +26,33 @@
 #include <tvm/runtime/container/adt.h>
 #include <tvm/runtime/data_type.h>
 #include <tvm/runtime/debug.h>
+#include <tvm/runtime/device_api.h>
 #include <tvm/runtime/logging.h>
 #include <tvm/runtime/memory.h>
 #include <tvm/runtime/object.h>
+#include <tvm/runtime/profiling.h>
 #include <tvm/runtime/vm/vm.h>
 
 #include <algorithm>
 #include <chrono>
+#include <functional>
 #include <iostream>
+#include <memory>
 #include <stdexcept>
 #include <vector>
 
 #include "../file_utils.h"
+#include "../library_module.h"
+
+// Dispatch the VM instructions with computed goto (labels as values) when the compiler supports
+// it, and with a portable switch otherwise.
+#ifndef TVM_VM_USE_COMPUTED_GOTO
+#if defined(__GNUC__) || defined(__clang__)
+#define TVM_VM_USE_COMPUTED_GOTO 1
+#else
+#define TVM_VM_USE_COMPUTED_GOTO 0
+#endif
+#endif
 
 using namespace tvm::runtime;
 
@@ -117,11 +132,11 @@ std::vector<int64_t> ToShape(NDArray shape_tensor) {
   return shape;
 }
 
-void VirtualMachine::OpStartHook(Instruction instr) {}
+void VirtualMachine::OpStartHook(const Instruction& instr) {}
 void VirtualMachine::OpStopHook() {}
 
-PackedFunc VirtualMachine::GetFunction(const std::string& name,
-                                       const ObjectPtr<Object>& sptr_to_self) {
+PackedFunc VirtualMachine::GetRequestFunction(const std::string& name,
+                                              const ObjectPtr<Object>& sptr_to_self) {
   if (name == "invoke") {
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
       ICHECK(exec_) << "The executable is not created yet.";
@@ -130,7 +145,7 @@ PackedFunc VirtualMachine::GetFunction(const std::string& name,
       auto git = exec_->global_map.find(func_name);
       ICHECK(git != exec_->global_map.end())
           << "Cannot find function " << func_name << " in the executable";
-      auto func = exec_->functions[git->second];
+      const auto& func = exec_->functions[git->second];
       if (func.params.empty()) {
         *rv = Invoke(func, {});
       } else {
@@ -187,7 +202,33 @@ PackedFunc VirtualMachine::GetFunction(const std::string& name,
         return 1;
       }
     });
-  } else if (name == "get_input_index") {
+  } else if (name == "set_input") {
+    return PackedFunc(
+        [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { SetInput(args[0], args, 1); });
+  } else if (name == "set_one_input") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      ICHECK_EQ(args.size(), 3) << "The expected number of arguments is 3 "
+                                << "(func_name, index or name, tensor)";
+      SetOneInput(args[0], args[1], args[2]);
+    });
+  }
+  return nullptr;
+}
+
+PackedFunc VirtualMachine::GetFunction(const std::string& name,
+                                       const ObjectPtr<Object>& sptr_to_self) {
+  PackedFunc func = GetRequestFunction(name, sptr_to_self);
+  if (func != nullptr) {
+    // The state of a request lives on the calling thread in concurrent mode.
+    return PackedFunc([sptr_to_self, this, name, func](TVMArgs args, TVMRetValue* rv) {
+      if (concurrent_) {
+        GetThreadContextFunction(name).CallPacked(args, rv);
+      } else {
+        func.CallPacked(args, rv);
+      }
+    });
+  }
+  if (name == "get_input_index") {
     return TypedPackedFunc<int64_t(std::string, std::string)>(
         [this](std::string input_name, std::string func_name) {
           return GetInputIndexFromVMFunction(func_name, input_name);
@@ -208,27 +249,114 @@ PackedFunc VirtualMachine::GetFunction(const std::string& name,
       }
       this->Init(devices, alloc_types);
     });
-  } else if (name == "set_input") {
-    return PackedFunc(
-        [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { SetInput(args[0], args, 1); });
-  } else if (name == "set_one_input") {
-    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
-      ICHECK_EQ(args.size(), 3) << "The expected number of arguments is 3 "
-                                << "(func_name, index or name, tensor)";
-      SetOneInput(args[0], args[1], args[2]);
-    });
   } else if (name == "load_late_bound_consts") {
     return PackedFunc([this](TVMArgs args, TVMRetValue* rv) {
       CHECK_EQ(args.size(), 1);
       std::string path = args[0];
       exec_->LoadLateBoundConstantsFromFile(path);
     });
+  } else if (name == "get_invoke_stats") {
+    return PackedFunc(
+        [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = GetInvokeStats(); });
+  } else if (name == "enable_concurrent_execution") {
+    return PackedFunc(
+        [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { EnableConcurrentExecution(); });
   } else {
     LOG(FATAL) << "Unknown packed function: " << name;
     return PackedFunc([sptr_to_self, name](TVMArgs args, TVMRetValue* rv) {});
   }
 }
 
+class VirtualMachine::ThreadContextReleaser {
+ public:
+  /*! \return The releaser of the calling thread. */
+  static ThreadContextReleaser* ThreadLocal() {
+    static thread_local ThreadContextReleaser releaser;
+    return &releaser;
+  }
+
+  /*!
+   * \brief Remember a table the calling thread added a context to.
+   * \param table The table.
+   */
+  void Register(const std::shared_ptr<ThreadContextTable>& table) {
+    // Forget the tables of the virtual machines destroyed since.
+    tables_.erase(std::remove_if(tables_.begin(), tables_.end(),
+                                 [](const std::weak_ptr<ThreadContextTable>& weak) {
+                                   return weak.expired();
+                                 }),
+                  tables_.end());
+    tables_.push_back(table);
+  }
+
+  ~ThreadContextReleaser() {
+    for (const auto& weak : tables_) {
+      std::shared_ptr<ThreadContextTable> table = weak.lock();
+      if (table == nullptr) continue;
+      ThreadContext context;
+      {
+        std::lock_guard<std::mutex> lock(table->mutex);
+        auto it = table->contexts.find(this);
+        if (it == table->contexts.end()) continue;
+        context = std::move(it->second);
+        table->contexts.erase(it);
+      }
+      // The context, and the tensors it holds, are freed outside of the lock.
+    }
+  }
+
+ private:
+  /*! \brief The tables holding a context of the thread. */
+  std::vector<std::weak_ptr<ThreadContextTable>> tables_;
+};
+
+PackedFunc VirtualMachine::GetThreadContextFunction(const std::string& name) {
+  ThreadContextReleaser* releaser = ThreadContextReleaser::ThreadLocal();
+  std::lock_guard<std::mutex> lock(thread_contexts_->mutex);
+  ThreadContext& context = thread_contexts_->contexts[releaser];
+  if (context.vm == nullptr) {
+    context.vm = CreateExecutionContext();
+    releaser->Register(thread_contexts_);
+  }
+  auto it = context.functions.find(name);
+  if (it == context.functions.end()) {
+    it = context.functions.emplace(name, context.vm->GetFunction(name, context.vm)).first;
+  }
+  return it->second;
+}
+
+ObjectPtr<VirtualMachine> VirtualMachine::CreateExecutionContext() {
+  auto vm = make_object<VirtualMachine>();
+  ShareProgramState(vm.get());
+  return vm;
+}
+
+void VirtualMachine::ShareProgramState(VirtualMachine* context) const {
+  context->exec_ = exec_;
+  context->packed_funcs_ = packed_funcs_;
+  context->dispatch_streams_ = dispatch_streams_;
+  context->devices_ = devices_;
+  context->allocators_ = allocators_;
+  // The constant pool is complete, so the context only shares references to the constants.
+  context->const_pool_ = const_pool_;
+  context->invoke_stats_ = invoke_stats_;
+}
+
+void VirtualMachine::EnableConcurrentExecution() {
+  ICHECK(exec_) << "The executable is not created yet.";
+  ICHECK(!devices_.empty()) << "Did you forget to init the VirtualMachine with devices?";
+  if (concurrent_) return;
+  // Load every constant up front, so that no request writes the shared constant pool.
+  const_pool_.resize(exec_->constants.size());
+  for (size_t i = 0; i < exec_->constants.size(); ++i) {
+    if (!const_pool_[i].defined()) {
+      Device dev = GetDevice(exec_->const_device_indexes[i]);
+      const_pool_[i] = CopyTo(exec_->GetConstant(i), dev);
+    }
+  }
+  concurrent_ = true;
+}
+
 void VirtualMachine::SetInput(std::string func_name, TVMArgs args, int offset) {
   const auto& vm_func = CheckAndGetVMFunction(func_name);
   size_t params_num = vm_func.params.size();
@@ -325,24 +453,120 @@ inline Allocator* VirtualMachine::GetAllocator(Index device_index) const {
   return allocators_[device_index];
 }
 
+namespace {
+
+/*! \brief The number of opcodes, which are also the first dispatch handlers. */
+constexpr uint8_t kNumOpcodes = static_cast<uint8_t>(Opcode::KillRegister) + 1;
+
+/*!
+ * \brief The superinstructions of the dispatch stream. Each one executes a common sequence of
+ *  instructions starting at the current pc without going back to the dispatcher in between.
+ */
+enum SuperInstruction : uint8_t {
+  /*! \brief AllocStorage followed by AllocTensor. */
+  kAllocStorageTensor = kNumOpcodes,
+  /*! \brief AllocTensor followed by InvokePacked. */
+  kAllocTensorInvokePacked,
+  /*! \brief AllocStorage followed by AllocTensor and InvokePacked. */
+  kAllocStorageTensorInvokePacked,
+  kNumDispatchOps,
+};
+
+/*!
+ * \brief Pre-decode the instructions of a function into the handlers dispatched by the VM.
+ *
+ * Fusing an instruction with its successors is always safe: every pc still gets its own handler,
+ * so a jump landing in the middle of a superinstruction executes the remaining instructions one
+ * by one.
+ */
+std::vector<uint8_t> DecodeDispatchStream(const VMFunction& func) {
+  const std::vector<Instruction>& code = func.instructions;
+  auto is_op = [&code](size_t pc, Opcode op) { return pc < code.size() && code[pc].op == op; };
+  std::vector<uint8_t> stream(code.size());
+  for (size_t pc = 0; pc < code.size(); ++pc) {
+    uint8_t op = static_cast<uint8_t>(code[pc].op);
+    ICHECK_LT(op, kNumOpcodes) << "Unknown instruction opcode: " << int(op) << " in function "
+                               << func.name;
+    if (is_op(pc, Opcode::AllocStorage) && is_op(pc + 1, Opcode::AllocTensor)) {
+      op = is_op(pc + 2, Opcode::InvokePacked) ? kAllocStorageTensorInvokePacked
+                                               : kAllocStorageTensor;
+    } else if (is_op(pc, Opcode::AllocTensor) && is_op(pc + 1, Opcode::InvokePacked)) {
+      op = kAllocTensorInvokePacked;
+    }
+    stream[pc] = op;
+  }
+  return stream;
+}
+
+}  // namespace
+
 void VirtualMachine::PushFrame(Index arg_count, Index ret_pc, const VMFunction& vm_func) {
   auto frame = VMFrame(ret_pc, func_index_, arg_count, code_, vm_func.register_file_size);
-  frames_.push_back(frame);
+  frame.dispatch = dispatch_;
+  if (!vm_func.arena_sizes.empty()) {
+    frame.arena_owner = &vm_func;
+    frame.arenas = AcquireArenas(vm_func);
+  }
+  frames_.push_back(std::move(frame));
 }
 
 Index VirtualMachine::PopFrame() {
   ICHECK_GT(frames_.size(), 0);
-  const VMFrame& fr = frames_.back();
+  VMFrame& fr = frames_.back();
   func_index_ = fr.func_index;
   code_ = fr.code;
+  dispatch_ = fr.dispatch;
   pc_ = fr.pc;
+  if (fr.arena_owner != nullptr) {
+    // Drop the views into the arenas before the arenas can be handed to another frame.
+    fr.register_file.clear();
+    idle_arenas_[fr.arena_owner].push_back(std::move(fr.arenas));
+  }
   auto call_stack_size = frames_.size();
   frames_.pop_back();
   return call_stack_size;
 }
 
-void VirtualMachine::InvokeGlobal(const VMFunction& func, const std::vector<ObjectRef>& args) {
-  VLOG(2) << "Invoking global " << func.name << " with " << args.size() << " args";
+std::vector<Storage> VirtualMachine::AcquireArenas(const VMFunction& func) {
+  auto it = idle_arenas_.find(&func);
+  if (it != idle_arenas_.end() && !it->second.empty()) {
+    std::vector<Storage> arenas = std::move(it->second.back());
+    it->second.pop_back();
+    return arenas;
+  }
+  std::vector<Storage> arenas(func.arena_sizes.size());
+  for (size_t i = 0; i < func.arena_sizes.size(); ++i) {
+    if (func.arena_sizes[i] == 0) continue;
+    Allocator* allocator = GetAllocator(i);
+    ICHECK(allocator) << "Did you forget to init the VirtualMachine with devices?";
+    auto storage_obj = SimpleObjAllocator().make_object<StorageObj>();
+    storage_obj->buffer = allocator->Alloc(func.arena_sizes[i], kAllocAlignment,
+                                           DLDataType{kDLUInt, 8, 1});
+    VLOG(2) << "allocated arena of " << func.name << " with size=" << func.arena_sizes[i]
+            << ", device_index=" << i;
+    arenas[i] = Storage(storage_obj);
+  }
+  return arenas;
+}
+
+void VirtualMachine::InvokeGlobal(const VMFunction& vm_func, const std::vector<ObjectRef>& args) {
+  VLOG(2) << "Invoking global " << vm_func.name << " with " << args.size() << " args";
+
+  // The function may be a copy of the one held by the executable, e.g. when it is invoked through
+  // the C++ API. The per-function state of the VM is keyed by the executable's copy.
+  Index func_index;
+  const VMFunction* begin = exec_->functions.data();
+  const VMFunction* end = begin + exec_->functions.size();
+  if (!std::less<const VMFunction*>()(&vm_func, begin) &&
+      std::less<const VMFunction*>()(&vm_func, end)) {
+    func_index = &vm_func - begin;
+  } else {
+    auto it = exec_->global_map.find(vm_func.name);
+    ICHECK(it != exec_->global_map.end())
+        << "The function " << vm_func.name << " does not belong to the loaded executable";
+    func_index = it->second;
+  }
+  const VMFunction& func = exec_->functions[func_index];
 
   PushFrame(func.params.size(), this->pc_ + 1, func);
   for (size_t i = 0; i < args.size(); ++i) {
@@ -352,6 +576,7 @@ void VirtualMachine::InvokeGlobal(const VMFunction& func, const std::vector<Obje
   }
 
   code_ = func.instructions.data();
+  dispatch_ = dispatch_streams_[func_index].data();
   pc_ = 0;
 }
 
@@ -363,11 +588,57 @@ ObjectRef VirtualMachine::Invoke(const VMFunction& func, const std::vector<Objec
                << (i == exec_->host_device_index ? " (using as host device)" : "");
   }
 
+  if (!invoke_stats_) {
+    InvokeGlobal(func, args);
+    RunLoop();
+    return return_register_;
+  }
+  int64_t decoded_before = exec_->NumDecodedConstants();
+  auto start = std::chrono::steady_clock::now();
   InvokeGlobal(func, args);
   RunLoop();
+  auto end = std::chrono::steady_clock::now();
+  double latency_us = std::chrono::duration<double, std::micro>(end - start).count();
+  std::lock_guard<std::mutex> lock(invoke_stats_->mutex);
+  if (invoke_stats_->num_invokes++ == 0) {
+    invoke_stats_->time_to_first_inference_us =
+        std::chrono::duration<double, std::micro>(end - invoke_stats_->load_time).count();
+    invoke_stats_->first_invoke_us = latency_us;
+    invoke_stats_->first_invoke_decoded_constants =
+        exec_->NumDecodedConstants() - decoded_before;
+  } else {
+    invoke_stats_->steady_invoke_total_us += latency_us;
+  }
   return return_register_;
 }
 
+Map<String, ObjectRef> VirtualMachine::GetInvokeStats() const {
+  ICHECK(exec_) << "The executable is not created yet.";
+  Map<String, ObjectRef> stats;
+  std::lock_guard<std::mutex> lock(invoke_stats_->mutex);
+  int64_t num_invokes = invoke_stats_->num_invokes;
+  stats.Set("num_invokes", ObjectRef(make_object<profiling::CountNode>(num_invokes)));
+  if (num_invokes > 0) {
+    stats.Set("time_to_first_inference", ObjectRef(make_object<profiling::DurationNode>(
+                                             invoke_stats_->time_to_first_inference_us)));
+    stats.Set("first_invoke",
+              ObjectRef(make_object<profiling::DurationNode>(invoke_stats_->first_invoke_us)));
+    stats.Set("first_invoke_decoded_constants",
+              ObjectRef(make_object<profiling::CountNode>(
+                  invoke_stats_->first_invoke_decoded_constants)));
+  }
+  if (num_invokes > 1) {
+    stats.Set("steady_state_invoke",
+              ObjectRef(make_object<profiling::DurationNode>(
+                  invoke_stats_->steady_invoke_total_us / (num_invokes - 1))));
+  }
+  stats.Set("decoded_constants",
+            ObjectRef(make_object<profiling::CountNode>(exec_->NumDecodedConstants())));
+  stats.Set("constant_decode_time",
+            ObjectRef(make_object<profiling::DurationNode>(exec_->ConstantDecodeTime())));
+  return stats;
+}
+
 ObjectRef VirtualMachine::Invoke(const std::string& name, const std::vector<ObjectRef>& args) {
   ICHECK(exec_) << "The executable has not been created yet.";
   auto it = exec_->global_map.find(name);
@@ -388,9 +659,9 @@ void VirtualMachine::InvokePacked(Index packed_index, const PackedFunc& func, In
     }
   }
 
-  std::vector<TVMValue> values(arity);
-  std::vector<int> codes(arity);
-  runtime::TVMArgsSetter setter(values.data(), codes.data());
+  packed_values_.resize(arity);
+  packed_codes_.resize(arity);
+  runtime::TVMArgsSetter setter(packed_values_.data(), packed_codes_.data());
   int idx = 0;
   bool is_empty_output = false;
   for (Index i = 0; i < arg_count; i++) {
@@ -417,8 +688,14 @@ void VirtualMachine::InvokePacked(Index packed_index, const PackedFunc& func, In
   }
 
   if (!is_empty_output) {
+    // Kernels of a library module are called directly with the packed arguments.
+    if (TVMBackendPackedCFunc faddr = GetBackendPackedCFunc(func)) {
+      CallBackendPackedCFunc(faddr, packed_values_.data(), packed_codes_.data(),
+                             static_cast<int>(arity));
+      return;
+    }
     TVMRetValue rv;
-    func.CallPacked(TVMArgs(values.data(), codes.data(), arity), &rv);
+    func.CallPacked(TVMArgs(packed_values_.data(), packed_codes_.data(), arity), &rv);
   }
 }
 
@@ -427,6 +704,14 @@ void VirtualMachine::LoadExecutable(const ObjectPtr<Executable>& exec) {
   ICHECK(exec->late_bound_constant_names.empty())
       << "Need to load late-bound-constants before creating VM";
   exec_ = exec;
+  idle_arenas_.clear();
+  invoke_stats_ = std::make_shared<InvokeStats>();
+  invoke_stats_->load_time = std::chrono::steady_clock::now();
+
+  dispatch_streams_.clear();
+  for (const VMFunction& func : exec_->functions) {
+    dispatch_streams_.push_back(DecodeDispatchStream(func));
+  }
 
   runtime::Module lib = exec_->GetLib();
 
@@ -515,102 +800,211 @@ int64_t VirtualMachine::LoadScalarInt(Index r) const {
   return result;
 }
 
+inline void VirtualMachine::ExecuteInvokePacked(const Instruction& instr) {
+  ICHECK_LE(instr.packed_index, packed_funcs_.size());
+  const auto& func = packed_funcs_[instr.packed_index];
+  const auto& arity = instr.arity;
+  packed_args_.clear();
+  for (Index i = 0; i < arity; ++i) {
+    auto arg = ReadRegister(instr.packed_args[i]);
+    packed_args_.push_back(arg);
+#if TVM_LOG_DEBUG
+    if (i < arity) {
+      const bool is_input = i < arity - instr.output_size;
+      VLOG(2) << (is_input ? "input" : "placeholder") << " arg " << i << " = "
+              << RuntimeObject2String(arg, GetDevice(exec_->host_device_index),
+                                      /*show_contents=*/is_input);
+    }
+#endif
+  }
+
+  // We no longer need to write the registers back, we write directly
+  // through the registers mutably.
+  InvokePacked(instr.packed_index, func, arity, instr.output_size, packed_args_);
+  // Do not keep the arguments alive past the call.
+  packed_args_.clear();
+
+#if TVM_LOG_DEBUG
+  for (Index i = arity - instr.output_size; i < arity; ++i) {
+    auto arg = ReadRegister(instr.packed_args[i]);
+    VLOG(2) << "output arg " << i << " = "
+            << RuntimeObject2String(arg, GetDevice(exec_->host_device_index));
+  }
+#endif
+}
+
+inline void VirtualMachine::ExecuteAllocTensor(const Instruction& instr) {
+  OpStartHook(instr);
+  auto shape = std::vector<int64_t>(instr.alloc_tensor.ndim);
+
+  for (uint32_t i = 0; i < instr.alloc_tensor.ndim; ++i) {
+    shape[i] = instr.alloc_tensor.shape[i];
+  }
+
+  auto storage_obj = ReadRegister(instr.alloc_tensor.storage);
+  auto offset = LoadScalarInt(instr.alloc_tensor.offset);
+  auto storage = Downcast<Storage>(storage_obj);
+  auto obj = storage->AllocNDArray(offset, shape, instr.alloc_tensor.dtype);
+  VLOG(2) << "allocated "
+          << RuntimeObject2String(obj, GetDevice(exec_->host_device_index),
+                                  /*show_contents=*/false);
+
+  WriteRegister(instr.dst, obj);
+  OpStopHook();
+}
+
+inline void VirtualMachine::ExecuteAllocStorage(const Instruction& instr) {
+  OpStartHook(instr);
+  auto size = LoadScalarInt(instr.alloc_storage.allocation_size);
+  auto alignment = instr.alloc_storage.alignment;
+
+  auto storage_obj = SimpleObjAllocator().make_object<StorageObj>();
+  if (instr.alloc_storage.arena_offset >= 0) {
+    // A view into the arena of the frame, planned by the compiler.
+    const Storage& arena = frames_.back().arenas[instr.alloc_storage.device_index];
+    ICHECK(arena.defined()) << "The arena of device " << instr.alloc_storage.device_index
+                            << " is not allocated";
+    storage_obj->buffer = arena->buffer;
+    storage_obj->buffer.data =
+        static_cast<char*>(arena->buffer.data) + instr.alloc_storage.arena_offset;
+    storage_obj->buffer.size = size;
+    storage_obj->arena = arena;
+    WriteRegister(instr.dst, Storage(storage_obj));
+    OpStopHook();
+    return;
+  }
+  Allocator* allocator = GetAllocator(instr.alloc_storage.device_index);
+  ICHECK(allocator) << "Did you forget to init the VirtualMachine with devices?";
+  VLOG(2) << "allocating with allocation_size=" << size << ", alignment=" << alignment
+          << ", dtype_hint=" << DLDataType2String(instr.alloc_storage.dtype_hint)
+          << ", device_index=" << instr.alloc_storage.device_index;
+
+  storage_obj->buffer = allocator->Alloc(size, alignment, instr.alloc_storage.dtype_hint);
+  Storage storage(storage_obj);
+  WriteRegister(instr.dst, storage);
+  OpStopHook();
+}
+
+// With computed goto every handler jumps straight to the next one, which gives the branch
+// predictor one indirect branch per handler instead of a single shared one.
+#if TVM_VM_USE_COMPUTED_GOTO
+#define TVM_VM_HANDLER(id, name) \
+  case id:                       \
+  handle_##name:
+#define TVM_VM_DISPATCH()                                  \
+  do {                                                     \
+    VLOG(2) << "Executing(" << pc_ << "): " << code_[pc_]; \
+    goto* kDispatchTable[dispatch_[pc_]];                  \
+  } while (0)
+#else
+#define TVM_VM_HANDLER(id, name) case id:
+#define TVM_VM_DISPATCH() goto main_loop
+#endif
+#define TVM_VM_OPCODE(name) TVM_VM_HANDLER(static_cast<uint8_t>(Opcode::name), name)
+#define TVM_VM_SUPERINSTRUCTION(name) TVM_VM_HANDLER(name, name)
+
 void VirtualMachine::RunLoop() {
   ICHECK(this->exec_);
   ICHECK(this->code_);
+  ICHECK(this->dispatch_);
   pc_ = 0;
   Index frame_start = frames_.size();
+#if TVM_VM_USE_COMPUTED_GOTO
+  // Indexed by the dispatch stream, in the order of Opcode followed by SuperInstruction.
+  static const void* const kDispatchTable[] = {&&handle_Move,
+                                               &&handle_Ret,
+                                               &&handle_Invoke,
+                                               &&handle_InvokeClosure,
+                                               &&handle_InvokePacked,
+                                               &&handle_AllocTensor,
+                                               &&handle_AllocTensorReg,
+                                               &&handle_AllocADT,
+                                               &&handle_AllocClosure,
+                                               &&handle_GetField,
+                                               &&handle_If,
+                                               &&handle_LoadConst,
+                                               &&handle_Goto,
+                                               &&handle_GetTag,
+                                               &&handle_LoadConsti,
+                                               &&handle_Fatal,
+                                               &&handle_AllocStorage,
+                                               &&handle_ShapeOf,
+                                               &&handle_ReshapeTensor,
+                                               &&handle_DeviceCopy,
+                                               &&handle_KillRegister,
+                                               &&handle_kAllocStorageTensor,
+                                               &&handle_kAllocTensorInvokePacked,
+                                               &&handle_kAllocStorageTensorInvokePacked};
+  static_assert(sizeof(kDispatchTable) / sizeof(kDispatchTable[0]) == kNumDispatchOps,
+                "The dispatch table must have one handler per dispatch op");
+#endif
   while (true) {
+#if !TVM_VM_USE_COMPUTED_GOTO
   main_loop:
-    auto const& instr = code_[this->pc_];
-    VLOG(2) << "Executing(" << pc_ << "): " << instr;
+#endif
+    VLOG(2) << "Executing(" << pc_ << "): " << code_[pc_];
 
-    switch (instr.op) {
-      case Opcode::Move: {
+    switch (dispatch_[pc_]) {
+      TVM_VM_OPCODE(Move) {
+        const Instruction& instr = code_[pc_];
         ObjectRef from_obj;
         from_obj = ReadRegister(instr.from);
         WriteRegister(instr.dst, from_obj);
         pc_++;
-        goto main_loop;
+        TVM_VM_DISPATCH();
       }
-      case Opcode::Fatal: {
-        throw std::runtime_error("VM encountered fatal error");
-      }
-      case Opcode::LoadConst: {
+      TVM_VM_OPCODE(Fatal) { throw std::runtime_error("VM encountered fatal error"); }
+      TVM_VM_OPCODE(LoadConst) {
+        const Instruction& instr = code_[pc_];
         bool is_not_cached = const_pool_.size() <= static_cast<size_t>(instr.const_index) ||
                              !const_pool_[instr.const_index].defined();
         if (is_not_cached) {
           OpStartHook(instr);
         }
-        auto constant_obj = exec_->constants[instr.const_index];
         // We cache the allocated object in the constant pool. To measure, the
         // first iteration will set the pool up. The other iterations will
-        // directly reuse the allocated objects.
+        // directly reuse the allocated objects. The executable decodes the
+        // constant on its first use.
         if (const_pool_.size() <= static_cast<size_t>(instr.const_index)) {
           const_pool_.resize(instr.const_index + 1);
         }
 
         if (!const_pool_[instr.const_index].defined()) {
           Device dev = GetDevice(exec_->const_device_indexes[instr.const_index]);
-          const_pool_[instr.const_index] = CopyTo(constant_obj, dev);
+          const_pool_[instr.const_index] = CopyTo(exec_->GetConstant(instr.const_index), dev);
         }
         WriteRegister(instr.dst, const_pool_[instr.const_index]);
         if (is_not_cached) {
           OpStopHook();
         }
         pc_++;
-        goto main_loop;
+        TVM_VM_DISPATCH();
       }
-      case Opcode::LoadConsti: {
+      TVM_VM_OPCODE(LoadConsti) {
+        const Instruction& instr = code_[pc_];
         auto tensor = NDArray::Empty({1}, {kDLInt, 64, 1}, GetDevice(exec_->host_device_index));
         reinterpret_cast<int64_t*>(tensor->data)[0] = instr.load_consti.val;
         WriteRegister(instr.dst, tensor);
         pc_++;
-        goto main_loop;
+        TVM_VM_DISPATCH();
       }
-      case Opcode::Invoke: {
+      TVM_VM_OPCODE(Invoke) {
+        const Instruction& instr = code_[pc_];
         std::vector<ObjectRef> args;
         for (Index i = 0; i < instr.num_args; ++i) {
           args.push_back(ReadRegister(instr.invoke_args_registers[i]));
         }
         InvokeGlobal(exec_->functions[instr.func_index], args);
         frames_.back().caller_return_register = instr.dst;
-        goto main_loop;
+        TVM_VM_DISPATCH();
       }
-      case Opcode::InvokePacked: {
-        ICHECK_LE(instr.packed_index, packed_funcs_.size());
-        const auto& func = packed_funcs_[instr.packed_index];
-        const auto& arity = instr.arity;
-        std::vector<ObjectRef> args;
-        for (Index i = 0; i < arity; ++i) {
-          auto arg = ReadRegister(instr.packed_args[i]);
-          args.push_back(arg);
-#if TVM_LOG_DEBUG
-          if (i < arity) {
-            const bool is_input = i < arity - instr.output_size;
-            VLOG(2) << (is_input ? "input" : "placeholder") << " arg " << i << " = "
-                    << RuntimeObject2String(arg, GetDevice(exec_->host_device_index),
-                                            /*show_contents=*/is_input);
-          }
-#endif
-        }
-
-        // We no longer need to write the registers back, we write directly
-        // through the registers mutably.
-        InvokePacked(instr.packed_index, func, arity, instr.output_size, args);
-
-#if TVM_LOG_DEBUG
-        for (Index i = arity - instr.output_size; i < arity; ++i) {
-          auto arg = ReadRegister(instr.packed_args[i]);
-          VLOG(2) << "output arg " << i << " = "
-                  << RuntimeObject2String(arg, GetDevice(exec_->host_device_index));
-        }
-#endif
-
+      TVM_VM_OPCODE(InvokePacked) {
+        ExecuteInvokePacked(code_[pc_]);
         pc_++;
-        goto main_loop;
+        TVM_VM_DISPATCH();
       }
-      case Opcode::InvokeClosure: {
+      TVM_VM_OPCODE(InvokeClosure) {
+        const Instruction& instr = code_[pc_];
         auto object = ReadRegister(instr.closure);
         const auto* closure = object.as<VMClosureObj>();
         ICHECK(closure);
@@ -623,17 +1017,19 @@ void VirtualMachine::RunLoop() {
         }
         InvokeGlobal(exec_->functions[closure->func_index], args);
         frames_.back().caller_return_register = instr.dst;
-        goto main_loop;
+        TVM_VM_DISPATCH();
       }
-      case Opcode::GetField: {
+      TVM_VM_OPCODE(GetField) {
+        const Instruction& instr = code_[pc_];
         auto object = ReadRegister(instr.object);
         const auto& tuple = Downcast<ADT>(object);
         auto field = tuple[instr.field_index];
         WriteRegister(instr.dst, field);
         pc_++;
-        goto main_loop;
+        TVM_VM_DISPATCH();
       }
-      case Opcode::GetTag: {
+      TVM_VM_OPCODE(GetTag) {
+        const Instruction& instr = code_[pc_];
         auto object = ReadRegister(instr.get_tag.object);
         const auto& adt = Downcast<ADT>(object);
         auto tag = adt.tag();
@@ -641,13 +1037,14 @@ void VirtualMachine::RunLoop() {
         reinterpret_cast<int32_t*>(tag_tensor->data)[0] = tag;
         WriteRegister(instr.dst, tag_tensor);
         pc_++;
-        goto main_loop;
+        TVM_VM_DISPATCH();
       }
-      case Opcode::Goto: {
-        pc_ += instr.pc_offset;
-        goto main_loop;
+      TVM_VM_OPCODE(Goto) {
+        pc_ += code_[pc_].pc_offset;
+        TVM_VM_DISPATCH();
       }
-      case Opcode::If: {
+      TVM_VM_OPCODE(If) {
+        const Instruction& instr = code_[pc_];
         int32_t test_val = LoadScalarInt(instr.if_op.test);
         int32_t target_val = LoadScalarInt(instr.if_op.target);
 
@@ -659,30 +1056,15 @@ void VirtualMachine::RunLoop() {
           pc_ += instr.if_op.false_offset;
         }
 
-        goto main_loop;
+        TVM_VM_DISPATCH();
       }
-      case Opcode::AllocTensor: {
-        OpStartHook(instr);
-        auto shape = std::vector<int64_t>(instr.alloc_tensor.ndim);
-
-        for (uint32_t i = 0; i < instr.alloc_tensor.ndim; ++i) {
-          shape[i] = instr.alloc_tensor.shape[i];
-        }
-
-        auto storage_obj = ReadRegister(instr.alloc_tensor.storage);
-        auto offset = LoadScalarInt(instr.alloc_tensor.offset);
-        auto storage = Downcast<Storage>(storage_obj);
-        auto obj = storage->AllocNDArray(offset, shape, instr.alloc_tensor.dtype);
-        VLOG(2) << "allocated "
-                << RuntimeObject2String(obj, GetDevice(exec_->host_device_index),
-                                        /*show_contents=*/false);
-
-        WriteRegister(instr.dst, obj);
-        OpStopHook();
+      TVM_VM_OPCODE(AllocTensor) {
+        ExecuteAllocTensor(code_[pc_]);
         pc_++;
-        goto main_loop;
+        TVM_VM_DISPATCH();
       }
-      case Opcode::AllocTensorReg: {
+      TVM_VM_OPCODE(AllocTensorReg) {
+        const Instruction& instr = code_[pc_];
         OpStartHook(instr);
         Device cpu_dev = GetDevice(exec_->host_device_index);
         auto shape_obj = ReadRegister(instr.alloc_tensor_reg.shape_register);
@@ -699,9 +1081,10 @@ void VirtualMachine::RunLoop() {
         WriteRegister(instr.dst, obj);
         OpStopHook();
         pc_++;
-        goto main_loop;
+        TVM_VM_DISPATCH();
       }
-      case Opcode::AllocADT: {
+      TVM_VM_OPCODE(AllocADT) {
+        const Instruction& instr = code_[pc_];
         std::vector<ObjectRef> fields;
         for (Index i = 0; i < instr.num_fields; ++i) {
           fields.push_back(ReadRegister(instr.datatype_fields[i]));
@@ -709,37 +1092,25 @@ void VirtualMachine::RunLoop() {
         ObjectRef obj = ADT(instr.constructor_tag, fields);
         WriteRegister(instr.dst, obj);
         pc_++;
-        goto main_loop;
+        TVM_VM_DISPATCH();
       }
-      case Opcode::AllocClosure: {
+      TVM_VM_OPCODE(AllocClosure) {
+        const Instruction& instr = code_[pc_];
         std::vector<ObjectRef> free_vars;
         for (Index i = 0; i < instr.num_freevar; i++) {
           free_vars.push_back(ReadRegister(instr.free_vars[i]));
         }
         WriteRegister(instr.dst, VMClosure(instr.func_index, free_vars));
         pc_++;
-        goto main_loop;
+        TVM_VM_DISPATCH();
       }
-      case Opcode::AllocStorage: {
-        OpStartHook(instr);
-        auto size = LoadScalarInt(instr.alloc_storage.allocation_size);
-        auto alignment = instr.alloc_storage.alignment;
-
-        auto storage_obj = SimpleObjAllocator().make_object<StorageObj>();
-        Allocator* allocator = GetAllocator(instr.alloc_storage.device_index);
-        ICHECK(allocator) << "Did you forget to init the VirtualMachine with devices?";
-        VLOG(2) << "allocating with allocation_size=" << size << ", alignment=" << alignment
-                << ", dtype_hint=" << DLDataType2String(instr.alloc_storage.dtype_hint)
-                << ", device_index=" << instr.alloc_storage.device_index;
-
-        storage_obj->buffer = allocator->Alloc(size, alignment, instr.alloc_storage.dtype_hint);
-        Storage storage(storage_obj);
-        WriteRegister(instr.dst, storage);
-        OpStopHook();
+      TVM_VM_OPCODE(AllocStorage) {
+        ExecuteAllocStorage(code_[pc_]);
         pc_++;
-        goto main_loop;
+        TVM_VM_DISPATCH();
       }
-      case Opcode::ShapeOf: {
+      TVM_VM_OPCODE(ShapeOf) {
+        const Instruction& instr = code_[pc_];
         auto input = ReadRegister(instr.shape_of.tensor);
         NDArray input_array = Downcast<NDArray>(input);
         int ndim = input_array->ndim;
@@ -752,13 +1123,13 @@ void VirtualMachine::RunLoop() {
                 << RuntimeObject2String(out_tensor, GetDevice(exec_->host_device_index));
         WriteRegister(instr.dst, out_tensor);
         pc_++;
-        goto main_loop;
+        TVM_VM_DISPATCH();
       }
-      case Opcode::Ret: {
+      TVM_VM_OPCODE(Ret) {
         // If we have hit the point from which we started
         // running, we should return to the caller breaking
         // the dispatch loop.
-        return_register_ = ReadRegister(instr.result);
+        return_register_ = ReadRegister(code_[pc_].result);
         auto caller_return_register = frames_.back().caller_return_register;
 
         if (PopFrame() == frame_start) {
@@ -766,10 +1137,11 @@ void VirtualMachine::RunLoop() {
           // Otherwise we are just returning from a local call.
         } else {
           WriteRegister(caller_return_register, return_register_);
-          goto main_loop;
+          TVM_VM_DISPATCH();
         }
       }
-      case Opcode::ReshapeTensor: {
+      TVM_VM_OPCODE(ReshapeTensor) {
+        const Instruction& instr = code_[pc_];
         OpStartHook(instr);
         Device cpu_dev = GetDevice(exec_->host_device_index);
         auto tensor_obj = ReadRegister(instr.reshape_tensor.tensor);
@@ -791,9 +1163,10 @@ void VirtualMachine::RunLoop() {
         WriteRegister(instr.dst, out_tensor);
         OpStopHook();
         pc_++;
-        goto main_loop;
+        TVM_VM_DISPATCH();
       }
-      case Opcode::DeviceCopy: {
+      TVM_VM_OPCODE(DeviceCopy) {
+        const Instruction& instr = code_[pc_];
         OpStartHook(instr);
         auto tensor_src = ReadRegister(instr.device_copy.src);
         NDArray src_data = Downcast<NDArray>(tensor_src);
@@ -807,21 +1180,50 @@ void VirtualMachine::RunLoop() {
         WriteRegister(instr.dst, dst_data);
         OpStopHook();
         pc_++;
-        goto main_loop;
+        TVM_VM_DISPATCH();
       }
-      case Opcode::KillRegister: {
+      TVM_VM_OPCODE(KillRegister) {
+        const Instruction& instr = code_[pc_];
         OpStartHook(instr);
         WriteRegister(instr.dst, ObjectRef());
         OpStopHook();
         pc_++;
-        goto main_loop;
+        TVM_VM_DISPATCH();
+      }
+      TVM_VM_SUPERINSTRUCTION(kAllocStorageTensor) {
+        ExecuteAllocStorage(code_[pc_]);
+        VLOG(2) << "Executing(" << pc_ + 1 << "): " << code_[pc_ + 1];
+        ExecuteAllocTensor(code_[pc_ + 1]);
+        pc_ += 2;
+        TVM_VM_DISPATCH();
+      }
+      TVM_VM_SUPERINSTRUCTION(kAllocTensorInvokePacked) {
+        ExecuteAllocTensor(code_[pc_]);
+        VLOG(2) << "Executing(" << pc_ + 1 << "): " << code_[pc_ + 1];
+        ExecuteInvokePacked(code_[pc_ + 1]);
+        pc_ += 2;
+        TVM_VM_DISPATCH();
+      }
+      TVM_VM_SUPERINSTRUCTION(kAllocStorageTensorInvokePacked) {
+        ExecuteAllocStorage(code_[pc_]);
+        VLOG(2) << "Executing(" << pc_ + 1 << "): " << code_[pc_ + 1];
+        ExecuteAllocTensor(code_[pc_ + 1]);
+        VLOG(2) << "Executing(" << pc_ + 2 << "): " << code_[pc_ + 2];
+        ExecuteInvokePacked(code_[pc_ + 2]);
+        pc_ += 3;
+        TVM_VM_DISPATCH();
       }
       default:
-        LOG(FATAL) << "Unknown instruction opcode: " << int(instr.op);
+        LOG(FATAL) << "Unknown dispatch op: " << int(dispatch_[pc_]);
     }
   }
 }
 
+#undef TVM_VM_SUPERINSTRUCTION
+#undef TVM_VM_OPCODE
+#undef TVM_VM_DISPATCH
+#undef TVM_VM_HANDLER
+
 runtime::Module CreateVirtualMachine(Executable* exec) {
   auto vm = make_object<VirtualMachine>();
   vm->LoadExecutable(GetObjectPtr<Executable>(exec));
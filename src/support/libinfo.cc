@@ -127,6 +127,10 @@
 #define TVM_INFO_USE_FALLBACK_STL_MAP "NOT-FOUND"
 #endif
 
+#ifndef TVM_INFO_USE_OBJECT_POOL
+#define TVM_INFO_USE_OBJECT_POOL "NOT-FOUND"
+#endif
+
 #ifndef TVM_INFO_USE_BYODT_POSIT
 #define TVM_INFO_USE_BYODT_POSIT "NOT-FOUND"
 #endif
@@ -254,6 +258,7 @@ TVM_DLL Map<String, String> GetLibInfo() {
       {"HIDE_PRIVATE_SYMBOLS", TVM_INFO_HIDE_PRIVATE_SYMBOLS},
       {"USE_TF_TVMDSOOP", TVM_INFO_USE_TF_TVMDSOOP},
       {"USE_FALLBACK_STL_MAP", TVM_INFO_USE_FALLBACK_STL_MAP},
+      {"USE_OBJECT_POOL", TVM_INFO_USE_OBJECT_POOL},
       {"USE_BYODT_POSIT", TVM_INFO_USE_BYODT_POSIT},
       {"USE_BLAS", TVM_INFO_USE_BLAS},
       {"USE_MKL", TVM_INFO_USE_MKL},
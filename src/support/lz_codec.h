@@ -0,0 +1,190 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file lz_codec.h
+ * \brief A fast LZ77 block codec in the spirit of LZ4, used to compress tensor transfers.
+ *
+ *  A block is a list of sequences. Each sequence starts with a token whose high nibble is the
+ *  number of literals and whose low nibble is the match length minus kMinMatch, a nibble of 15
+ *  is extended by bytes which are added until one is not 255. The literals follow, then the
+ *  two byte little endian offset of the match and the extension of the match length. The last
+ *  sequence only has literals. The encoder is greedy with a single hash table probe per
+ *  position, trading ratio for speed.
+ */
+#ifndef TVM_SUPPORT_LZ_CODEC_H_
+#define TVM_SUPPORT_LZ_CODEC_H_
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+namespace tvm {
+namespace support {
+namespace lz {
+/*! \brief The shortest match which is encoded. */
+constexpr size_t kMinMatch = 4;
+/*! \brief The input ends with this many literals, so a match never reads past the end. */
+constexpr size_t kLastLiterals = 5;
+/*! \brief The largest match offset. */
+constexpr size_t kMaxOffset = 65535;
+/*! \brief The number of bits of the hash table index. */
+constexpr int kHashBits = 14;
+
+inline uint32_t Load32(const uint8_t* ptr) {
+  uint32_t value;
+  std::memcpy(&value, ptr, sizeof(value));
+  return value;
+}
+
+inline uint8_t* WriteLength(uint8_t* out, size_t length) {
+  while (length >= 255) {
+    *out++ = 255;
+    length -= 255;
+  }
+  *out++ = static_cast<uint8_t>(length);
+  return out;
+}
+
+inline uint8_t* WriteLiterals(uint8_t* out, const uint8_t* literals, size_t num_literals,
+                              size_t match_code) {
+  uint8_t* token = out++;
+  *token = static_cast<uint8_t>((num_literals < 15 ? num_literals : 15) << 4);
+  *token |= static_cast<uint8_t>(match_code < 15 ? match_code : 15);
+  if (num_literals >= 15) out = WriteLength(out, num_literals - 15);
+  std::memcpy(out, literals, num_literals);
+  return out + num_literals;
+}
+
+inline bool ReadLength(const uint8_t** in, const uint8_t* end, size_t* length) {
+  uint8_t byte;
+  do {
+    if (*in == end) return false;
+    byte = *(*in)++;
+    *length += byte;
+  } while (byte == 255);
+  return true;
+}
+}  // namespace lz
+
+/*!
+ * \brief The largest size of a compressed block.
+ * \param size The size of the input.
+ */
+inline size_t LZCompressBound(size_t size) { return size + size / 255 + 16; }
+
+/*!
+ * \brief Compress a block.
+ * \param src The input.
+ * \param size The size of the input.
+ * \param dst The output, which must hold LZCompressBound(size) bytes.
+ * \return The size of the compressed block.
+ */
+inline size_t LZCompress(const char* src, size_t size, char* dst) {
+  using namespace lz;
+  const uint8_t* in = reinterpret_cast<const uint8_t*>(src);
+  uint8_t* out = reinterpret_cast<uint8_t*>(dst);
+  size_t anchor = 0;
+  if (size >= kMinMatch + kLastLiterals) {
+    // The positions plus one of the last sequences with each hash, zero is empty.
+    std::unique_ptr<uint32_t[]> table(new uint32_t[1 << kHashBits]());
+    size_t match_limit = size - kLastLiterals;
+    size_t pos = 0;
+    // Like LZ4, the step grows with consecutive misses to skip quickly over incompressible data.
+    size_t misses = 0;
+    while (pos + kMinMatch <= match_limit) {
+      uint32_t sequence = Load32(in + pos);
+      uint32_t hash = (sequence * 2654435761U) >> (32 - kHashBits);
+      size_t candidate = table[hash];
+      table[hash] = static_cast<uint32_t>(pos + 1);
+      if (candidate == 0 || pos - (candidate - 1) > kMaxOffset ||
+          Load32(in + candidate - 1) != sequence) {
+        pos += 1 + (misses++ >> 6);
+        continue;
+      }
+      misses = 0;
+      size_t ref = candidate - 1;
+      size_t length = kMinMatch;
+      while (pos + length < match_limit && in[ref + length] == in[pos + length]) ++length;
+      out = WriteLiterals(out, in + anchor, pos - anchor, length - kMinMatch);
+      size_t offset = pos - ref;
+      *out++ = static_cast<uint8_t>(offset & 0xFF);
+      *out++ = static_cast<uint8_t>(offset >> 8);
+      if (length - kMinMatch >= 15) out = WriteLength(out, length - kMinMatch - 15);
+      pos += length;
+      anchor = pos;
+    }
+  }
+  out = WriteLiterals(out, in + anchor, size - anchor, 0);
+  return out - reinterpret_cast<uint8_t*>(dst);
+}
+
+/*!
+ * \brief Decompress a block.
+ * \param src The compressed block.
+ * \param size The size of the compressed block.
+ * \param dst The output.
+ * \param dst_size The size of the decompressed data.
+ * \return Whether the block is valid and decompresses to exactly dst_size bytes.
+ */
+inline bool LZDecompress(const char* src, size_t size, char* dst, size_t dst_size) {
+  using namespace lz;
+  const uint8_t* in = reinterpret_cast<const uint8_t*>(src);
+  const uint8_t* in_end = in + size;
+  uint8_t* out = reinterpret_cast<uint8_t*>(dst);
+  uint8_t* out_begin = out;
+  uint8_t* out_end = out + dst_size;
+  while (in < in_end) {
+    uint8_t token = *in++;
+    size_t num_literals = token >> 4;
+    if (num_literals == 15 && !ReadLength(&in, in_end, &num_literals)) return false;
+    if (num_literals > static_cast<size_t>(in_end - in) ||
+        num_literals > static_cast<size_t>(out_end - out)) {
+      return false;
+    }
+    std::memcpy(out, in, num_literals);
+    in += num_literals;
+    out += num_literals;
+    // The last sequence has no match.
+    if (in == in_end) break;
+    if (in_end - in < 2) return false;
+    size_t offset = in[0] | (static_cast<size_t>(in[1]) << 8);
+    in += 2;
+    size_t length = token & 15;
+    if (length == 15 && !ReadLength(&in, in_end, &length)) return false;
+    length += kMinMatch;
+    if (offset == 0 || offset > static_cast<size_t>(out - out_begin) ||
+        length > static_cast<size_t>(out_end - out)) {
+      return false;
+    }
+    const uint8_t* match = out - offset;
+    if (offset >= length) {
+      std::memcpy(out, match, length);
+    } else {
+      // The match overlaps the output, e.g. a run of a repeated pattern.
+      for (size_t i = 0; i < length; ++i) out[i] = match[i];
+    }
+    out += length;
+  }
+  return out == out_end;
+}
+
+}  // namespace support
+}  // namespace tvm
+#endif  // TVM_SUPPORT_LZ_CODEC_H_
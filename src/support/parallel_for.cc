@@ -21,10 +21,23 @@
  * \file parallel_for.cc
  * \brief An implementation to run loop in parallel.
  */
+#include <tvm/ir/expr.h>
 #include <tvm/runtime/logging.h>
+#include <tvm/runtime/registry.h>
 #include <tvm/support/parallel_for.h>
 
-#include <future>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <thread>
 #include <utility>
 #include <vector>
@@ -47,49 +60,228 @@ std::vector<std::vector<int>> rr_partitioner(int begin, int end, int step, int n
   return ret;
 }
 
-void parallel_for(int begin, int end, const std::function<void(int)>& f, int step,
-                  const PartitionerFuncType partitioner) {
-  static bool GLOBAL_PARALLEL_FOR_FLAG{false};
-  static std::mutex M_GLOBAL_PARALLEL_FOR_FLAG;
-  {
-    std::unique_lock<std::mutex> l(M_GLOBAL_PARALLEL_FOR_FLAG);
-    ICHECK(!GLOBAL_PARALLEL_FOR_FLAG) << "There's another parallel_for running. Maybe you're "
-                                      << "currently inside another parallel_for loop.";
-    GLOBAL_PARALLEL_FOR_FLAG = true;
+namespace {
+
+/*!
+ * \brief A parallel loop run by its calling thread and the idle threads of the pool.
+ *
+ *  The caller always takes part, so a loop completes even when all pool threads are busy, e.g. in
+ *  a parallel loop nested in another one.
+ */
+struct ParallelJob {
+  /*!
+   * \brief Run tasks until there are none left to claim.
+   * \param participant_id The index of the participant, unique within the job.
+   */
+  std::function<void(int participant_id)> work;
+  /*! \brief The maximum number of participants, including the caller. */
+  int max_participants;
+  /*! \brief The number of participants which joined, guarded by the pool mutex. */
+  int num_joined{1};
+  /*! \brief The number of pool threads running the job, guarded by the pool mutex. */
+  int num_active{0};
+  /*! \brief Whether all tasks are claimed. */
+  std::atomic<bool> exhausted{false};
+  /*! \brief Whether a task failed, the remaining tasks are skipped. */
+  std::atomic<bool> failed{false};
+  /*! \brief The message of the first failure. */
+  std::string error;
+  /*! \brief The first failure if it is not a std::exception, thrown again on the caller. */
+  std::exception_ptr foreign_exception;
+  /*! \brief The mutex of error and foreign_exception. */
+  std::mutex error_mutex;
+  /*! \brief The time when the job was submitted. */
+  std::chrono::steady_clock::time_point submit_time;
+  /*! \brief The total time spent by the participants in work, in nanoseconds. */
+  std::atomic<int64_t> busy_ns{0};
+
+  /*! \brief Run the work of a participant and record its time and its failure. */
+  void Run(int participant_id) {
+    auto start = std::chrono::steady_clock::now();
+    try {
+      work(participant_id);
+    } catch (const std::exception& e) {
+      std::lock_guard<std::mutex> lock(error_mutex);
+      if (!failed.exchange(true)) error = e.what();
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(error_mutex);
+      if (!failed.exchange(true)) foreign_exception = std::current_exception();
+    }
+    exhausted = true;
+    busy_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now() - start)
+                   .count();
+  }
+};
+
+/*!
+ * \brief The persistent threads which run the parallel loops of the compiler.
+ *
+ *  A loop is split into tasks which the participants claim through atomic cursors, and a
+ *  participant which runs out of tasks steals those of the others, so an uneven split does not
+ *  leave threads idle.
+ */
+class ParallelForPool {
+ public:
+  /*! \return The pool of the process, created on first use and again after a fork. */
+  static ParallelForPool* Global() {
+    static std::mutex mutex;
+    static ParallelForPool* inst = nullptr;
+    std::lock_guard<std::mutex> lock(mutex);
+#ifndef _WIN32
+    // The threads do not survive a fork, the pool of the parent is deliberately leaked.
+    if (inst != nullptr && inst->pid_ != getpid()) inst = nullptr;
+#endif
+    if (inst == nullptr) {
+      int num_threads = static_cast<int>(std::thread::hardware_concurrency());
+      inst = new ParallelForPool(std::max(num_threads, 1) - 1);
+    }
+    return inst;
+  }
+
+  /*! \return The number of threads which can run a loop, including the caller. */
+  int num_threads() const { return static_cast<int>(threads_.size()) + 1; }
+
+  /*! \brief Run a job with the caller as participant 0 and return once it is complete. */
+  void Run(ParallelJob* job) {
+    auto start = std::chrono::steady_clock::now();
+    job->submit_time = start;
+    bool shared = job->max_participants > 1 && !threads_.empty();
+    if (shared) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      jobs_.push_back(job);
+    }
+    if (shared) cv_.notify_all();
+    job->Run(0);
+    if (shared) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      jobs_.erase(std::find(jobs_.begin(), jobs_.end(), job));
+      done_cv_.wait(lock, [job] { return job->num_active == 0; });
+    }
+    auto end = std::chrono::steady_clock::now();
+    // The overhead of a call is its time beyond the busy time of an average participant.
+    double wall_ns =
+        static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+                                .count());
+    double busy_ns = static_cast<double>(job->busy_ns);
+    double overhead_ns = std::max(wall_ns - busy_ns / job->num_joined, 0.0);
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    stats_.num_calls += 1;
+    stats_.num_participants += job->num_joined;
+    stats_.wall_seconds += wall_ns * 1e-9;
+    stats_.busy_seconds += busy_ns * 1e-9;
+    stats_.overhead_seconds += overhead_ns * 1e-9;
+  }
+
+  /*! \brief The statistics of the calls. */
+  struct Stats {
+    int64_t num_calls{0};
+    int64_t num_participants{0};
+    double wall_seconds{0};
+    double busy_seconds{0};
+    double overhead_seconds{0};
+    double wake_seconds{0};
+  };
+
+  Stats GetStats() {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    return stats_;
   }
 
-  int default_num_threads = std::thread::hardware_concurrency();
-  const auto& run_partitions = partitioner(begin, end, step, default_num_threads);
-
-  std::vector<std::thread> threads;
-  threads.reserve(run_partitions.size());
-  std::vector<std::future<void>> res_vec;
-  res_vec.reserve(run_partitions.size());
-  for (const auto& run_partition : run_partitions) {
-    std::packaged_task<void(const std::vector<int>&, const std::function<void(int)>&)> task(
-        [](const std::vector<int>& run_partition, const std::function<void(int)>& f) {
-          for (const auto& i : run_partition) {
-            f(i);
-          }
-        });
-    res_vec.emplace_back(task.get_future());
-    threads.emplace_back(std::move(task), run_partition, f);
+ private:
+  explicit ParallelForPool(int num_threads) {
+#ifndef _WIN32
+    pid_ = getpid();
+#endif
+    for (int i = 0; i < num_threads; ++i) {
+      threads_.emplace_back([this] { this->WorkerLoop(); });
+      threads_.back().detach();
+    }
   }
 
-  for (auto&& thread : threads) {
-    thread.join();
+  /*! \brief Find a job which takes another participant, with the mutex held. */
+  ParallelJob* FindJob() {
+    // The most recent job first, which finishes the loops nested in a running task early.
+    for (auto it = jobs_.rbegin(); it != jobs_.rend(); ++it) {
+      ParallelJob* job = *it;
+      if (!job->exhausted && job->num_joined < job->max_participants) return job;
+    }
+    return nullptr;
   }
-  {
-    std::unique_lock<std::mutex> l(M_GLOBAL_PARALLEL_FOR_FLAG);
-    ICHECK(GLOBAL_PARALLEL_FOR_FLAG);
-    GLOBAL_PARALLEL_FOR_FLAG = false;
+
+  void WorkerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      ParallelJob* job = nullptr;
+      cv_.wait(lock, [this, &job] { return (job = FindJob()) != nullptr; });
+      int participant_id = job->num_joined++;
+      ++job->num_active;
+      lock.unlock();
+      double wake_seconds =
+          std::chrono::duration<double>(std::chrono::steady_clock::now() - job->submit_time)
+              .count();
+      job->Run(participant_id);
+      {
+        std::lock_guard<std::mutex> stats_lock(stats_mutex_);
+        stats_.wake_seconds += wake_seconds;
+      }
+      lock.lock();
+      if (--job->num_active == 0) done_cv_.notify_all();
+    }
   }
-  try {
-    for (auto&& i : res_vec) {
-      i.get();
+
+  /*! \brief The threads of the pool. */
+  std::vector<std::thread> threads_;
+  /*! \brief The jobs which take participants, in the order of submission. */
+  std::vector<ParallelJob*> jobs_;
+  /*! \brief The mutex of the jobs. */
+  std::mutex mutex_;
+  /*! \brief Signaled when a job is submitted. */
+  std::condition_variable cv_;
+  /*! \brief Signaled when the last pool thread leaves a job. */
+  std::condition_variable done_cv_;
+  /*! \brief The statistics of the calls. */
+  Stats stats_;
+  /*! \brief The mutex of the statistics. */
+  std::mutex stats_mutex_;
+#ifndef _WIN32
+  /*! \brief The process which created the pool. */
+  pid_t pid_;
+#endif
+};
+
+}  // namespace
+
+void parallel_for(int begin, int end, const std::function<void(int)>& f, int step,
+                  const PartitionerFuncType partitioner) {
+  ParallelForPool* pool = ParallelForPool::Global();
+  const auto& run_partitions = partitioner(begin, end, step, pool->num_threads());
+  if (run_partitions.empty()) return;
+  int num_partitions = static_cast<int>(run_partitions.size());
+  // The next task of each partition, claimed by its owner as well as by the thieves.
+  std::unique_ptr<std::atomic<size_t>[]> cursors(new std::atomic<size_t>[num_partitions]);
+  for (int i = 0; i < num_partitions; ++i) {
+    cursors[i] = 0;
+  }
+
+  ParallelJob job;
+  job.max_participants = num_partitions;
+  job.work = [&](int participant_id) {
+    // Drain the own partition, then steal from the following ones.
+    for (int k = 0; k < num_partitions; ++k) {
+      int p = (participant_id + k) % num_partitions;
+      const std::vector<int>& tasks = run_partitions[p];
+      for (size_t i; !job.failed && (i = cursors[p]++) < tasks.size();) {
+        f(tasks[i]);
+      }
     }
-  } catch (const std::exception& e) {
-    LOG(FATAL) << "Parallel_for error with " << e.what();
+  };
+  pool->Run(&job);
+  if (job.foreign_exception) {
+    std::rethrow_exception(job.foreign_exception);
+  }
+  if (job.failed) {
+    LOG(FATAL) << "Parallel_for error with " << job.error;
   }
 }
 
@@ -101,44 +293,39 @@ void parallel_for_dynamic(int begin, int end, int num_threads,
   }
   CHECK_LE(begin, end) << "ValueError: The interval [begin, end) requires `begin <= end`";
   CHECK_GT(num_threads, 0) << "ValueError: `num_threads` should be positive";
-  // Step 2. Launch threads
-  // Step 2.1. Launch worker 1 to worker `num_threads - 1`
+  // Step 2. Run the tasks on up to `num_threads` threads of the pool, with the caller as
+  // thread 0. The thread ids are the participant ids, so they are unique within the call.
   std::atomic<int> counter{begin};
-  std::vector<std::future<void>> futures;
-  std::vector<std::thread> threads;
-  futures.reserve(num_threads - 1);
-  threads.reserve(num_threads - 1);
-  auto worker = [end, &counter, &f](int thread_id) -> void {
-    for (int task_id; (task_id = counter++) < end;) {
+  ParallelJob job;
+  job.max_participants = num_threads;
+  job.work = [end, &counter, &f, &job](int thread_id) {
+    for (int task_id; !job.failed && (task_id = counter++) < end;) {
       f(thread_id, task_id);
     }
   };
-  for (int thread_id = 1; thread_id < num_threads; ++thread_id) {
-    std::packaged_task<void(int)> task(worker);
-    futures.emplace_back(task.get_future());
-    threads.emplace_back(std::move(task), thread_id);
+  ParallelForPool::Global()->Run(&job);
+  // Step 3. Check exceptions
+  if (job.foreign_exception) {
+    std::rethrow_exception(job.foreign_exception);
   }
-  // Step 2.2. Launch worker 0 inplace
-  try {
-    worker(0);
-  } catch (const std::exception& e) {
-    for (auto&& thread : threads) {
-      thread.join();
-    }
-    LOG(FATAL) << "RuntimeError: parallel_for_dynamic error with " << e.what();
-  }
-  // Step 3. Join threads and check exceptions
-  for (auto&& thread : threads) {
-    thread.join();
-  }
-  try {
-    for (auto&& future : futures) {
-      future.get();
-    }
-  } catch (const std::exception& e) {
-    LOG(FATAL) << "RuntimeError: parallel_for_dynamic error with " << e.what();
+  if (job.failed) {
+    LOG(FATAL) << "RuntimeError: parallel_for_dynamic error with " << job.error;
   }
 }
 
+TVM_REGISTER_GLOBAL("support.ParallelForStats").set_body_typed([]() {
+  ParallelForPool::Stats stats = ParallelForPool::Global()->GetStats();
+  Map<String, ObjectRef> result;
+  result.Set("num_threads", Integer(ParallelForPool::Global()->num_threads()));
+  result.Set("num_calls", Integer(stats.num_calls));
+  result.Set("num_participants", Integer(stats.num_participants));
+  result.Set("wall_seconds", FloatImm(DataType::Float(64), stats.wall_seconds));
+  result.Set("busy_seconds", FloatImm(DataType::Float(64), stats.busy_seconds));
+  result.Set("wake_seconds", FloatImm(DataType::Float(64), stats.wake_seconds));
+  double overhead_us = stats.num_calls == 0 ? 0 : stats.overhead_seconds * 1e6 / stats.num_calls;
+  result.Set("overhead_us_per_call", FloatImm(DataType::Float(64), overhead_us));
+  return result;
+});
+
 }  // namespace support
 }  // namespace tvm
@@ -0,0 +1,263 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file shm_ring.h
+ * \brief Byte stream between two processes through rings in shared memory.
+ *
+ *  The bytes are copied into a ring in a region mapped by both processes, and a pipe only
+ *  carries a one byte wake up when the reader sleeps on an empty ring. Header only and free of
+ *  runtime dependencies, so that the minrpc servers can use it.
+ */
+#ifndef TVM_SUPPORT_SHM_RING_H_
+#define TVM_SUPPORT_SHM_RING_H_
+
+#ifndef _WIN32
+#include <errno.h>
+#include <poll.h>
+#include <sched.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+namespace tvm {
+namespace support {
+
+/*! \brief A single producer single consumer byte ring in shared memory. */
+class SharedMemoryRing {
+ public:
+  /*! \brief The control block at the start of the ring. */
+  struct Header {
+    /*! \brief The total number of bytes read. */
+    alignas(64) std::atomic<uint64_t> head;
+    /*! \brief The total number of bytes written. */
+    alignas(64) std::atomic<uint64_t> tail;
+    /*! \brief Whether the reader sleeps until it is woken up through the pipe. */
+    alignas(64) std::atomic<uint32_t> waiting;
+  };
+
+  /*! \return The bytes of shared memory used by a ring of the given capacity. */
+  static size_t RegionSize(uint64_t capacity) {
+    return RoundUp(sizeof(Header)) + static_cast<size_t>(RoundUp(capacity));
+  }
+
+  /*!
+   * \brief Attach to a ring in shared memory.
+   * \param region The start of the ring, RegionSize(capacity) bytes.
+   * \param capacity The capacity of the ring.
+   * \param init Whether to initialize the ring, done by the process which creates the region.
+   */
+  void Attach(char* region, uint64_t capacity, bool init) {
+    header_ = init ? new (region) Header() : reinterpret_cast<Header*>(region);
+    if (init) {
+      header_->head.store(0);
+      header_->tail.store(0);
+      header_->waiting.store(0);
+    }
+    data_ = region + RoundUp(sizeof(Header));
+    capacity_ = capacity;
+  }
+
+  /*!
+   * \brief Write as many bytes as there is space for.
+   * \return The number of bytes written.
+   */
+  size_t Write(const void* data, size_t size) {
+    uint64_t tail = header_->tail.load(std::memory_order_relaxed);
+    uint64_t head = header_->head.load(std::memory_order_acquire);
+    size_t n = static_cast<size_t>(std::min<uint64_t>(size, capacity_ - (tail - head)));
+    size_t offset = static_cast<size_t>(tail % capacity_);
+    size_t first = std::min<size_t>(n, capacity_ - offset);
+    std::memcpy(data_ + offset, data, first);
+    std::memcpy(data_, static_cast<const char*>(data) + first, n - first);
+    // Sequentially consistent, so that the writer sees a reader which went to sleep before it.
+    header_->tail.store(tail + n, std::memory_order_seq_cst);
+    return n;
+  }
+
+  /*!
+   * \brief Read as many bytes as are available.
+   * \return The number of bytes read.
+   */
+  size_t Read(void* data, size_t size) {
+    uint64_t head = header_->head.load(std::memory_order_relaxed);
+    uint64_t tail = header_->tail.load(std::memory_order_acquire);
+    size_t n = static_cast<size_t>(std::min<uint64_t>(size, tail - head));
+    size_t offset = static_cast<size_t>(head % capacity_);
+    size_t first = std::min<size_t>(n, capacity_ - offset);
+    std::memcpy(data, data_ + offset, first);
+    std::memcpy(static_cast<char*>(data) + first, data_, n - first);
+    header_->head.store(head + n, std::memory_order_release);
+    return n;
+  }
+
+  /*! \return Whether there are no bytes to read. */
+  bool Empty() const {
+    return header_->tail.load(std::memory_order_seq_cst) ==
+           header_->head.load(std::memory_order_relaxed);
+  }
+
+  /*! \return The control block. */
+  Header* header() const { return header_; }
+
+ private:
+  static uint64_t RoundUp(uint64_t size) { return (size + 63) / 64 * 64; }
+
+  Header* header_{nullptr};
+  char* data_{nullptr};
+  uint64_t capacity_{0};
+};
+
+/*!
+ * \brief One end of a byte stream over two rings in shared memory, the process which creates
+ *  the region is the client end.
+ */
+class SharedMemoryPipe {
+ public:
+  /*! \brief The layout information at the start of the region. */
+  struct RegionHeader {
+    /*! \brief Identifies an initialized region. */
+    uint64_t magic;
+    /*! \brief The capacity of each ring. */
+    uint64_t capacity;
+  };
+  /*! \brief The magic number of a region. */
+  static constexpr uint64_t kMagic = 0x50524d4853564d54;
+
+  /*! \return The bytes of shared memory used by a pipe with rings of the given capacity. */
+  static size_t RegionSize(uint64_t capacity) {
+    return kRingOffset + 2 * SharedMemoryRing::RegionSize(capacity);
+  }
+
+  /*!
+   * \brief Initialize the region, done by the client before the server can attach to it.
+   * \param region The start of the region, RegionSize(capacity) bytes.
+   * \param capacity The capacity of each ring.
+   */
+  static void InitRegion(void* region, uint64_t capacity) {
+    char* base = static_cast<char*>(region);
+    RegionHeader* header = reinterpret_cast<RegionHeader*>(base);
+    header->capacity = capacity;
+    char* client_ring = base + kRingOffset;
+    SharedMemoryRing ring;
+    ring.Attach(client_ring, capacity, true);
+    ring.Attach(client_ring + SharedMemoryRing::RegionSize(capacity), capacity, true);
+    header->magic = kMagic;
+  }
+
+  /*!
+   * \brief Attach to an initialized region.
+   * \param region The start of the region.
+   * \param region_size The size of the region.
+   * \param is_client Whether this is the client end.
+   * \param read_fd The pipe to receive wake ups from the peer.
+   * \param write_fd The pipe to wake up the peer.
+   * \return Whether the region is valid.
+   */
+  bool Attach(void* region, size_t region_size, bool is_client, int read_fd, int write_fd) {
+    char* base = static_cast<char*>(region);
+    RegionHeader* header = reinterpret_cast<RegionHeader*>(base);
+    if (region_size < sizeof(RegionHeader) || header->magic != kMagic ||
+        header->capacity == 0 || RegionSize(header->capacity) > region_size) {
+      return false;
+    }
+    uint64_t capacity = header->capacity;
+    char* client_ring = base + kRingOffset;
+    char* server_ring = client_ring + SharedMemoryRing::RegionSize(capacity);
+    send_.Attach(is_client ? client_ring : server_ring, capacity, false);
+    recv_.Attach(is_client ? server_ring : client_ring, capacity, false);
+    read_fd_ = read_fd;
+    write_fd_ = write_fd;
+    return true;
+  }
+
+  /*!
+   * \brief Send bytes, waiting for space in the ring if it is full.
+   * \return The number of bytes sent, -1 if the peer closed the pipe.
+   */
+  ssize_t Send(const void* data, size_t size) {
+    if (size == 0) return 0;
+    size_t n;
+    for (int spins = 0; (n = send_.Write(data, size)) == 0; ++spins) {
+      if (spins < kSpinCount) {
+        sched_yield();
+        continue;
+      }
+      // Sleep a little, but notice when the peer is gone.
+      pollfd pfd;
+      pfd.fd = read_fd_;
+      pfd.events = 0;
+      pfd.revents = 0;
+      if (poll(&pfd, 1, 1) < 0 && errno != EINTR) return -1;
+      if ((pfd.revents & (POLLHUP | POLLERR | POLLNVAL)) != 0) return -1;
+    }
+    if (send_.header()->waiting.exchange(0) != 0) {
+      char bell = 0;
+      if (write(write_fd_, &bell, 1) != 1) return -1;
+    }
+    return static_cast<ssize_t>(n);
+  }
+
+  /*!
+   * \brief Receive bytes, waiting for the peer if the ring is empty.
+   * \return The number of bytes received, 0 if the peer closed the pipe, -1 on error.
+   */
+  ssize_t Recv(void* data, size_t size) {
+    if (size == 0) return 0;
+    while (true) {
+      size_t n = recv_.Read(data, size);
+      if (n != 0) return static_cast<ssize_t>(n);
+      for (int spins = 0; spins < kSpinCount && recv_.Empty(); ++spins) {
+        sched_yield();
+      }
+      if (!recv_.Empty()) continue;
+      recv_.header()->waiting.store(1);
+      if (!recv_.Empty()) {
+        // The writer may still ring the bell, which only causes a spurious wake up later.
+        recv_.header()->waiting.store(0);
+        continue;
+      }
+      char bells[64];
+      ssize_t ret = read(read_fd_, bells, sizeof(bells));
+      if (ret == 0 && recv_.Empty()) return 0;
+      if (ret < 0 && errno != EINTR) return -1;
+    }
+  }
+
+ private:
+  /*! \brief The offset of the first ring in the region. */
+  static constexpr size_t kRingOffset = 64;
+  /*! \brief The number of times to yield before sleeping. */
+  static constexpr int kSpinCount = 256;
+
+  SharedMemoryRing send_;
+  SharedMemoryRing recv_;
+  int read_fd_{-1};
+  int write_fd_{-1};
+};
+
+}  // namespace support
+}  // namespace tvm
+#endif  // _WIN32
+#endif  // TVM_SUPPORT_SHM_RING_H_
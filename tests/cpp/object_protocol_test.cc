@@ -19,8 +19,14 @@
 
 #include <dmlc/logging.h>
 #include <gtest/gtest.h>
+#include <tvm/runtime/container/map.h>
+#include <tvm/runtime/container/shape_tuple.h>
 #include <tvm/runtime/memory.h>
 #include <tvm/runtime/object.h>
+#include <tvm/runtime/registry.h>
+
+#include <thread>
+#include <vector>
 
 namespace tvm {
 namespace test {
@@ -95,3 +101,31 @@ TEST(ObjectHierachy, Basic) {
   ICHECK(refB.as<ObjAA>() == nullptr);
   ICHECK(refB.as<ObjB>() != nullptr);
 }
+
+TEST(ObjectAllocator, Pool) {
+  using namespace tvm::runtime;
+  using namespace tvm::test;
+  auto count = []() {
+    Map<String, ShapeTuple> stats = (*Registry::Get("runtime.ObjectAllocatorStats"))();
+    auto it = stats.find("test.ObjAA");
+    return it != stats.end() ? (*it).second : ShapeTuple({0, 0});
+  };
+  ShapeTuple before = count();
+
+  std::vector<ObjectRef> objs;
+  for (int i = 0; i < 1000; ++i) {
+    objs.push_back(ObjectRef(PoolObjAllocator().make_object<ObjAA>()));
+    ICHECK_EQ(objs.back()->type_index(), ObjAA::RuntimeTypeIndex());
+    ICHECK(objs.back().as<ObjA>() != nullptr);
+  }
+  ShapeTuple allocated = count();
+  ICHECK_EQ(allocated[0] - before[0], 1000);
+  ICHECK_EQ(allocated[1] - before[1], 0);
+
+  // Objects freed by another thread go to the cache of that thread.
+  std::thread([&objs]() { objs.resize(500); }).join();
+  objs.clear();
+  ShapeTuple freed = count();
+  ICHECK_EQ(freed[0] - before[0], 1000);
+  ICHECK_EQ(freed[1] - before[1], 1000);
+}
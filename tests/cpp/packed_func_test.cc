@@ -24,6 +24,11 @@
 #include <tvm/tir/expr.h>
 #include <tvm/tir/transform.h>
 
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
 TEST(PackedFunc, Basic) {
   using namespace tvm;
   using namespace tvm::tir;
@@ -307,3 +312,54 @@ TEST(TypedPackedFunc, RValue) {
     tf(1, true);
   }
 }
+
+TEST(Registry, Intern) {
+  using namespace tvm::runtime;
+  const Registry::Handle* handle = Registry::Intern("testing.registry_intern");
+  ICHECK_EQ(handle->name(), "testing.registry_intern");
+  ICHECK(handle->Get() == nullptr);
+  ICHECK(Registry::Intern("testing.registry_intern") == handle);
+
+  Registry::Register("testing.registry_intern").set_body_typed([]() { return 1; });
+  ICHECK_EQ(static_cast<int>((*handle->Get())()), 1);
+  ICHECK(Registry::Get("testing.registry_intern") == handle->Get());
+  Registry::Register("testing.registry_intern", true).set_body_typed([]() { return 2; });
+  ICHECK_EQ(static_cast<int>((*handle->Get())()), 2);
+
+  ICHECK(Registry::Remove("testing.registry_intern"));
+  ICHECK(handle->Get() == nullptr);
+  ICHECK(Registry::Get("testing.registry_intern") == nullptr);
+  ICHECK(!Registry::Remove("testing.registry_intern"));
+}
+
+TEST(Registry, ConcurrentAccess) {
+  using namespace tvm::runtime;
+  const int kNumFuncs = 2000;
+  std::atomic<bool> failed{false};
+  std::vector<std::thread> threads;
+  // Lookups of existing functions race with registrations which grow the tables.
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&failed]() {
+      for (int i = 0; i < 10000; ++i) {
+        if (Registry::Get("runtime.SourceModuleCreate") == nullptr) failed = true;
+      }
+    });
+  }
+  threads.emplace_back([]() {
+    for (int i = 0; i < kNumFuncs; ++i) {
+      Registry::Register("testing.registry_concurrent." + std::to_string(i))
+          .set_body_typed([i]() { return i; });
+    }
+  });
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  ICHECK(!failed);
+  for (int i = 0; i < kNumFuncs; ++i) {
+    std::string name = "testing.registry_concurrent." + std::to_string(i);
+    const PackedFunc* f = Registry::Get(name);
+    ICHECK(f != nullptr);
+    ICHECK_EQ(static_cast<int>((*f)()), i);
+    ICHECK(Registry::Remove(name));
+  }
+}
@@ -22,6 +22,7 @@
 #include <tvm/runtime/logging.h>
 #include <tvm/support/parallel_for.h>
 
+#include <atomic>
 #include <thread>
 #include <vector>
 
@@ -92,20 +93,34 @@ TEST(ParallelFor, NestedWithNormalForLoop) {
 }
 
 TEST(ParallelFor, NestedWithParallelFor) {
-  // Currently do not support using nested parallel_for
   using tvm::support::parallel_for;
 
-  bool exception = false;
-  try {
-    parallel_for(0, 100, [](int i) {
-      parallel_for(0, 100, [](int j) {
-        // Blank loop
+  std::vector<std::atomic<int>> counts(100 * 100);
+  parallel_for(0, 100, [&counts](int i) {
+    parallel_for(0, 100, [&counts, i](int j) { counts[i * 100 + j]++; });
+  });
+  for (const auto& count : counts) {
+    ICHECK_EQ(count, 1);
+  }
+}
+
+TEST(ParallelFor, UnbalancedPartitions) {
+  using tvm::support::parallel_for;
+
+  // All tasks in one partition, which the other threads steal from.
+  std::vector<std::atomic<int>> counts(1000);
+  parallel_for(
+      0, 1000, [&counts](int i) { counts[i]++; }, 1,
+      [](int begin, int end, int step, int num_threads) {
+        std::vector<std::vector<int>> partitions(num_threads);
+        for (int i = begin; i < end; i += step) {
+          partitions[0].push_back(i);
+        }
+        return partitions;
       });
-    });
-  } catch (const std::exception& e) {
-    exception = true;
+  for (const auto& count : counts) {
+    ICHECK_EQ(count, 1);
   }
-  ICHECK(exception);
 }
 
 TEST(ParallelFor, Exception) {
@@ -130,6 +145,20 @@ TEST(ParallelForDynamic, Basic) {
   }
 }
 
+TEST(ParallelForDynamic, UniqueThreadIds) {
+  using tvm::support::parallel_for_dynamic;
+  int num_threads = 4;
+  std::vector<std::atomic<int>> running(num_threads);
+  std::atomic<bool> shared{false};
+  parallel_for_dynamic(0, 1000, num_threads, [&](int thread_id, int task_id) {
+    ICHECK_LT(thread_id, num_threads);
+    if (running[thread_id]++ != 0) shared = true;
+    parallel_for_dynamic(0, 10, 2, [](int thread_id, int task_id) { ICHECK_LT(thread_id, 2); });
+    running[thread_id]--;
+  });
+  ICHECK(!shared);
+}
+
 TEST(ParallelForDynamic, ExceptionOnMain) {
   using tvm::support::parallel_for_dynamic;
   int num_threads = 1;
@@ -146,6 +175,18 @@ TEST(ParallelForDynamic, ExceptionOnMain) {
   ICHECK(exception);
 }
 
+TEST(ParallelForDynamic, NonStdException) {
+  using tvm::support::parallel_for_dynamic;
+  int num_threads = 3;
+  bool exception = false;
+  try {
+    parallel_for_dynamic(0, 100, num_threads, [](int thread_id, int task_id) { throw task_id; });
+  } catch (int task_id) {
+    exception = true;
+  }
+  ICHECK(exception);
+}
+
 TEST(ParallelForDynamic, ExceptionOnArbitrary) {
   using tvm::support::parallel_for_dynamic;
   int num_threads = 3;
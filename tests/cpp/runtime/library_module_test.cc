@@ -0,0 +1,67 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "../../../src/runtime/library_module.h"
+
+namespace tvm {
+namespace runtime {
+
+namespace {
+
+// A kernel in the calling convention of MakePackedAPI, which adds its first tensor to its second.
+int AddKernel(TVMValue* args, int* type_codes, int num_args, TVMValue* out_ret_value,
+              int* out_ret_tcode, void* resource_handle) {
+  if (num_args != 2 || type_codes[0] != kTVMDLTensorHandle) return -1;
+  DLTensor* a = static_cast<DLTensor*>(args[0].v_handle);
+  DLTensor* b = static_cast<DLTensor*>(args[1].v_handle);
+  for (int64_t i = 0; i < a->shape[0]; ++i) {
+    static_cast<float*>(b->data)[i] += static_cast<float*>(a->data)[i];
+  }
+  return 0;
+}
+
+}  // namespace
+
+TEST(LibraryModule, BackendPackedCFunc) {
+  PackedFunc pf = WrapPackedFunc(AddKernel, ObjectPtr<Object>());
+  EXPECT_EQ(GetBackendPackedCFunc(pf), &AddKernel);
+  EXPECT_EQ(GetBackendPackedCFunc(PackedFunc([](TVMArgs args, TVMRetValue* rv) {})), nullptr);
+  EXPECT_EQ(GetBackendPackedCFunc(PackedFunc(nullptr)), nullptr);
+
+  float a_data[4] = {1, 2, 3, 4};
+  float b_data[4] = {0, 0, 0, 0};
+  int64_t shape[1] = {4};
+  DLTensor a{a_data, {kDLCPU, 0}, 1, {kDLFloat, 32, 1}, shape, nullptr, 0};
+  DLTensor b{b_data, {kDLCPU, 0}, 1, {kDLFloat, 32, 1}, shape, nullptr, 0};
+  TVMValue values[2];
+  values[0].v_handle = &a;
+  values[1].v_handle = &b;
+  int type_codes[2] = {kTVMDLTensorHandle, kTVMDLTensorHandle};
+  // The direct call and the packed call run the same kernel.
+  CallBackendPackedCFunc(GetBackendPackedCFunc(pf), values, type_codes, 2);
+  pf(&a, &b);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(b_data[i], 2 * a_data[i]);
+  }
+}
+
+}  // namespace runtime
+}  // namespace tvm
@@ -0,0 +1,110 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "../../../../src/runtime/vm/binned_allocator.h"
+
+namespace tvm {
+namespace runtime {
+namespace vm {
+
+constexpr size_t kLargeSize = BinnedAllocator::kMaxCachedSize * 4;
+
+TEST(BinnedAllocator, BestFitSplit) {
+  Device dev{kDLCPU, 0};
+  BinnedAllocator alloc(dev);
+  DLDataType dtype{kDLFloat, 32, 1};
+  Buffer large = alloc.Alloc(kLargeSize, kAllocAlignment, dtype);
+  EXPECT_EQ(large.size, kLargeSize);
+  alloc.Free(large);
+  // a smaller request reuses the front of the freed block
+  Buffer first = alloc.Alloc(kLargeSize / 2 + 1, kAllocAlignment, dtype);
+  EXPECT_EQ(first.data, large.data);
+  EXPECT_EQ(first.size, kLargeSize / 2 + BinnedAllocator::kDefaultPageSize);
+  // the remainder serves the next request without a new segment
+  Buffer second = alloc.Alloc(kLargeSize / 4 + 1, kAllocAlignment, dtype);
+  EXPECT_EQ(second.data, static_cast<char*>(large.data) + first.size);
+  BinnedAllocator::Stats stats = alloc.GetStats();
+  EXPECT_EQ(stats.num_segments, 1);
+  EXPECT_EQ(stats.reserved_bytes, kLargeSize);
+  EXPECT_EQ(stats.allocated_bytes, first.size + second.size);
+  EXPECT_EQ(stats.largest_free_block, kLargeSize - first.size - second.size);
+  // freeing both merges the blocks back into one segment
+  alloc.Free(first);
+  alloc.Free(second);
+  stats = alloc.GetStats();
+  EXPECT_EQ(stats.num_free_blocks, 1);
+  EXPECT_EQ(stats.largest_free_block, kLargeSize);
+  EXPECT_EQ(stats.fragmentation, 0.0);
+  alloc.Trim();
+  EXPECT_EQ(alloc.UsedMemory(), 0);
+}
+
+TEST(BinnedAllocator, Fragmentation) {
+  Device dev{kDLCPU, 0};
+  BinnedAllocator alloc(dev);
+  DLDataType dtype{kDLFloat, 32, 1};
+  Buffer segment = alloc.Alloc(kLargeSize * 4, kAllocAlignment, dtype);
+  alloc.Free(segment);
+  Buffer a = alloc.Alloc(kLargeSize, kAllocAlignment, dtype);
+  Buffer b = alloc.Alloc(kLargeSize, kAllocAlignment, dtype);
+  Buffer c = alloc.Alloc(kLargeSize, kAllocAlignment, dtype);
+  // the freed blocks around b cannot merge, so the largest one serves 2 of the 3 free parts
+  alloc.Free(a);
+  alloc.Free(c);
+  BinnedAllocator::Stats stats = alloc.GetStats();
+  EXPECT_EQ(stats.free_bytes, kLargeSize * 3);
+  EXPECT_EQ(stats.largest_free_block, kLargeSize * 2);
+  EXPECT_DOUBLE_EQ(stats.fragmentation, 100.0 / 3);
+  alloc.Free(b);
+  EXPECT_EQ(alloc.GetStats().fragmentation, 0.0);
+  alloc.Trim();
+}
+
+TEST(BinnedAllocator, ThreadCache) {
+  Device dev{kDLCPU, 0};
+  BinnedAllocator alloc(dev);
+  DLDataType dtype{kDLFloat, 32, 1};
+  Buffer buf = alloc.Alloc(1000, kAllocAlignment, dtype);
+  alloc.Free(buf);
+  EXPECT_EQ(alloc.GetStats().cached_bytes, BinnedAllocator::kDefaultPageSize);
+  Buffer reused = alloc.Alloc(2000, kAllocAlignment, dtype);
+  EXPECT_EQ(reused.data, buf.data);
+  alloc.Free(reused);
+  alloc.Trim();
+  EXPECT_EQ(alloc.GetStats().cached_bytes, 0);
+  EXPECT_EQ(alloc.UsedMemory(), 0);
+}
+
+TEST(BinnedAllocator, HighWaterMark) {
+  Device dev{kDLCPU, 0};
+  BinnedAllocator alloc(dev, kLargeSize * 2);
+  DLDataType dtype{kDLFloat, 32, 1};
+  Buffer first = alloc.Alloc(kLargeSize * 2, kAllocAlignment, dtype);
+  alloc.Free(first);
+  // the unused segment is too small and released to stay below the high water mark
+  Buffer second = alloc.Alloc(kLargeSize * 3, kAllocAlignment, dtype);
+  EXPECT_EQ(alloc.UsedMemory(), kLargeSize * 3);
+  alloc.Free(second);
+}
+
+}  // namespace vm
+}  // namespace runtime
+}  // namespace tvm
@@ -20,7 +20,12 @@
 #include <dmlc/logging.h>
 #include <gtest/gtest.h>
 
+#include <random>
+#include <string>
+#include <vector>
+
 #include "../../src/support/hexdump.h"
+#include "../../src/support/lz_codec.h"
 #include "../../src/support/utils.h"
 
 namespace tvm {
@@ -62,5 +67,40 @@ TEST(StartsWithTests, Basic) {
   EXPECT_FALSE(::tvm::support::StartsWith("abc", "abcd"));
 }
 
+std::string LZRoundTrip(const std::string& data) {
+  std::vector<char> compressed(::tvm::support::LZCompressBound(data.size()));
+  size_t size = ::tvm::support::LZCompress(data.data(), data.size(), compressed.data());
+  EXPECT_LE(size, compressed.size());
+  std::string result(data.size(), '\0');
+  EXPECT_TRUE(::tvm::support::LZDecompress(compressed.data(), size, &result[0], result.size()));
+  // A truncated stream must be rejected.
+  if (!data.empty()) {
+    EXPECT_FALSE(
+        ::tvm::support::LZDecompress(compressed.data(), size - 1, &result[0], result.size()));
+  }
+  return result;
+}
+
+TEST(LZCodecTests, RoundTrip) {
+  std::mt19937 rng(42);
+  for (size_t size : {0, 1, 7, 13, 100, 4096, 100000}) {
+    std::string random(size, '\0');
+    std::string sparse(size, '\0');
+    for (size_t i = 0; i < size; ++i) {
+      random[i] = static_cast<char>(rng());
+      if (i % 97 == 0) sparse[i] = static_cast<char>(rng());
+    }
+    EXPECT_EQ(LZRoundTrip(random), random);
+    EXPECT_EQ(LZRoundTrip(sparse), sparse);
+  }
+}
+
+TEST(LZCodecTests, CompressesRedundantData) {
+  std::string data(1 << 16, 'a');
+  std::vector<char> compressed(::tvm::support::LZCompressBound(data.size()));
+  size_t size = ::tvm::support::LZCompress(data.data(), data.size(), compressed.data());
+  EXPECT_LT(size, data.size() / 100);
+}
+
 }  // namespace test
 }  // namespace tvm
@@ -23,6 +23,7 @@
 #include <tvm/runtime/threading_backend.h>
 
 #include <atomic>
+#include <chrono>
 #include <memory>
 #include <sstream>
 #include <thread>
@@ -146,6 +147,84 @@ TEST(ThreadingBackend, TVMBackendParallelLaunchMultipleThreads) {
   }
 }
 
+TEST(ThreadingBackend, TVMBackendParallelLaunchWorkStealing) {
+  tvm::runtime::threading::ConfigureWorkStealing(4);
+  for (int i = 0; i < 3; ++i) {
+    std::atomic<size_t> acc(0);
+    EXPECT_EQ(TVMBackendParallelLaunch(atomic_add_task_id, &acc, 0), 0);
+    EXPECT_EQ(acc.load(std::memory_order_relaxed), N * (N - 1) / 2);
+  }
+  // A slow task should not prevent the other tasks from being completed.
+  std::atomic<size_t> acc(0);
+  TVMBackendParallelLaunch(
+      [](int task_id, TVMParallelGroupEnv* penv, void* cdata) -> int {
+        if (task_id == 0) {
+          std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        AtomicCompute(task_id, N, reinterpret_cast<std::atomic<size_t>*>(cdata), penv);
+        return 0;
+      },
+      &acc, 0);
+  EXPECT_EQ(acc.load(std::memory_order_relaxed), N * (N - 1) / 2);
+  tvm::runtime::threading::ConfigureWorkStealing(0);
+}
+
+// Each task launches a nested job and counts the nested jobs which got the right result.
+static FTVMParallelLambda nested_launch_task_id = [](int task_id, TVMParallelGroupEnv* penv,
+                                                     void* cdata) -> int {
+  auto* num_correct = reinterpret_cast<std::atomic<int>*>(cdata);
+  std::atomic<size_t> acc(0);
+  int ret = TVMBackendParallelLaunch(atomic_add_task_id, &acc, 0);
+  if (acc.load(std::memory_order_relaxed) == N * (N - 1) / 2) {
+    num_correct->fetch_add(1);
+  }
+  if (task_id == 0) {
+    num_correct[1].store(penv->num_task);
+  }
+  return ret;
+};
+
+TEST(ThreadingBackend, TVMBackendParallelLaunchNested) {
+  // Launch from a new thread whose thread pool has four workers, so that the outer job runs on
+  // several threads even on a single core host.
+  std::thread t([]() {
+    tvm::runtime::threading::Configure(
+        tvm::runtime::threading::ThreadGroup::kSpecifyThreadShareAllCore, 0, {0, 1, 2, 3});
+    for (bool shared : {false, true}) {
+      tvm::runtime::threading::ConfigureSharedThreadPool(shared);
+      // the number of correct nested jobs and the number of tasks of the outer job
+      std::atomic<int> result[2] = {{0}, {0}};
+      EXPECT_EQ(TVMBackendParallelLaunch(nested_launch_task_id, result, 0), 0);
+      if (!shared) {
+        // the shared pool may have been created by another thread with fewer workers
+        EXPECT_GT(result[1].load(), 1);
+      }
+      EXPECT_EQ(result[0].load(), result[1].load());
+    }
+    tvm::runtime::threading::ConfigureSharedThreadPool(false);
+  });
+  t.join();
+}
+
+TEST(ThreadingBackend, TVMBackendParallelLaunchSharedThreadPool) {
+  tvm::runtime::threading::ConfigureSharedThreadPool(true);
+  size_t num_jobs_per_thread = 10;
+  std::vector<std::unique_ptr<std::thread>> ts;
+  for (size_t i = 0; i < 4; ++i) {
+    ts.emplace_back(new std::thread([&]() {
+      for (size_t j = 0; j < num_jobs_per_thread; ++j) {
+        std::atomic<size_t> acc(0);
+        EXPECT_EQ(TVMBackendParallelLaunch(atomic_add_task_id, &acc, 0), 0);
+        EXPECT_EQ(acc.load(std::memory_order_relaxed), N * (N - 1) / 2);
+      }
+    }));
+  }
+  for (auto& t : ts) {
+    t->join();
+  }
+  tvm::runtime::threading::ConfigureSharedThreadPool(false);
+}
+
 TEST(ThreadingBackend, TVMBackendAffinityConfigure) {
   int max_concurrency = tvm::runtime::threading::MaxConcurrency();
   std::vector<std::unique_ptr<std::thread>> ts;
@@ -17,6 +17,7 @@
 import os
 import numpy as np
 import tvm
+import tvm.testing
 from tvm import te, runtime
 import json
 import base64
@@ -39,6 +40,60 @@ def test_save_load():
     np.testing.assert_equal(param2["y"].numpy(), y)
 
 
+def test_save_load_mappable():
+    x = np.random.uniform(size=(10, 2)).astype("float32")
+    y = np.arange(7).astype("int8")
+    params = {"x": x, "y": y}
+    param_bytes = runtime.save_mappable_param_dict(params)
+    # The mappable format can still be loaded from bytes.
+    param2 = relay.load_param_dict(param_bytes)
+    np.testing.assert_equal(param2["x"].numpy(), x)
+    np.testing.assert_equal(param2["y"].numpy(), y)
+
+    temp = utils.tempdir()
+    path = temp.relpath("params.bin")
+    with open(path, "wb") as fo:
+        fo.write(param_bytes)
+    param3 = runtime.load_param_dict_from_file(path)
+    np.testing.assert_equal(param3["x"].numpy(), x)
+    np.testing.assert_equal(param3["y"].numpy(), y)
+    # Writing a mapped tensor does not change the file.
+    param3["x"].copyfrom(np.zeros((10, 2), dtype="float32"))
+    param4 = runtime.load_param_dict_from_file(path)
+    np.testing.assert_equal(param4["x"].numpy(), x)
+
+    # Files in the original format are loaded too.
+    with open(path, "wb") as fo:
+        fo.write(runtime.save_param_dict(params))
+    param5 = runtime.load_param_dict_from_file(path)
+    np.testing.assert_equal(param5["y"].numpy(), y)
+
+
+def test_graph_executor_load_params_from_file():
+    x = relay.var("x", shape=(10,), dtype="float32")
+    w = relay.var("w", shape=(10,), dtype="float32")
+    func = relay.Function([x, w], relay.multiply(x, w))
+    w_np = np.random.uniform(size=(10,)).astype("float32")
+    lib = relay.build(tvm.IRModule.from_expr(func), target="llvm")
+
+    temp = utils.tempdir()
+    path = temp.relpath("params.bin")
+    with open(path, "wb") as fo:
+        fo.write(runtime.save_mappable_param_dict({"w": w_np}))
+    mod = graph_executor.GraphModule(lib["default"](tvm.cpu()))
+    mod.load_params_from_file(path)
+    x_np = np.random.uniform(size=(10,)).astype("float32")
+    mod.set_input("x", x_np)
+    mod.run()
+    tvm.testing.assert_allclose(mod.get_output(0).numpy(), x_np * w_np, rtol=1e-5)
+
+    # Zero copy inputs are bound to the operators set up after the parameters were aliased.
+    x_nd = tvm.nd.array(np.random.uniform(size=(10,)).astype("float32"))
+    mod.module["set_input_zero_copy"]("x", x_nd)
+    mod.run()
+    tvm.testing.assert_allclose(mod.get_output(0).numpy(), x_nd.numpy() * w_np, rtol=1e-5)
+
+
 def test_ndarray_reflection():
     # Make two `NDArrayWrapper`s that point to the same underlying array.
     np_array = np.random.uniform(size=(10, 2)).astype("float32")
@@ -91,5 +146,7 @@ def test_bigendian_rpc_param():
 
 if __name__ == "__main__":
     test_save_load()
+    test_save_load_mappable()
+    test_graph_executor_load_params_from_file()
     test_ndarray_reflection()
     test_bigendian_rpc_param()
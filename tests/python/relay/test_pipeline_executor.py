@@ -15,9 +15,10 @@
 # specific language governing permissions and limitations
 # under the License.
 
-import pytest
+import json
 import os
 import time
+import pytest
 import numpy as np
 import tvm
 import tvm.testing
@@ -419,9 +420,68 @@ def test_pipeline():
                 assert statistic_time < 10
                 time.sleep(1)
 
+            # Checking the per-stage statistics of the pipeline mode. A stage counts a run after
+            # forwarding its outputs, so the counts may lag behind the outputs for a moment.
+            stages = ["runtime0", "runtime1", "runtime2"]
+            statistic_time = 0
+            while True:
+                stats = json.loads(pipeline_module_test.get_stage_stats().json())
+                assert [call["Name"] for call in stats["calls"]] == stages
+                counts = [call["Count"]["count"] for call in stats["calls"]]
+                if counts == [len(datas)] * len(stages):
+                    break
+                statistic_time = statistic_time + 1
+                # Setting the timeout to 10 seconds.
+                assert statistic_time < 100, counts
+                time.sleep(0.1)
+            assert stats["device_metrics"]["pipeline"]["Bottleneck"] in stages
+
             # Reset the cpu affinity after a test.
             reset_cpu_affinity(affinity)
 
 
+def test_pipeline_batcher():
+    if not pipeline_executor.pipeline_executor_enabled():
+        return
+    # Two stages built for a batch of 4 rows.
+    dshape = (4, 3)
+    data = relay.var("data", relay.TensorType(dshape, "float32"))
+    mod1 = tvm.IRModule.from_expr(relay.Function([data], relay.add(data, relay.const(1.0))))
+    data = relay.var("data", relay.TensorType(dshape, "float32"))
+    mod2 = tvm.IRModule.from_expr(relay.Function([data], relay.multiply(data, relay.const(2.0))))
+
+    pipe_config = pipeline_executor.PipelineConfig()
+    pipe_config["input"]["data"].connect(pipe_config[mod1]["input"]["data"])
+    pipe_config[mod1]["output"][0].connect(pipe_config[mod2]["input"]["data"])
+    pipe_config[mod2]["output"][0].connect(pipe_config["output"]["0"])
+    for mod in [mod1, mod2]:
+        pipe_config[mod].target = "llvm"
+        pipe_config[mod].dev = tvm.cpu(0)
+    with tvm.transform.PassContext(opt_level=3):
+        pipeline_mod_factory = pipeline_executor.build(pipe_config)
+    pipeline_module = pipeline_executor.PipelineModule(pipeline_mod_factory)
+
+    batcher = pipeline_module.create_batcher(max_wait_ms=50)
+    assert batcher.max_batch_size == 4
+    rows = [1, 2, 1, 3, 1]
+    datas = [np.random.rand(n, 3).astype("float32") for n in rows]
+    futures = [batcher.submit({"data": d}) for d in datas]
+    for d, future in zip(datas, futures):
+        output = future.result()[0].numpy()
+        tvm.testing.assert_allclose(output, (d + 1.0) * 2.0, rtol=1e-5)
+        assert future.done()
+        # The batcher stops tracking a request once its outputs are taken.
+        assert batcher._is_ready(future._request_id)
+    assert 2 <= batcher.num_batches <= len(rows)
+
+    # A request whose future is dropped is released without waiting for it.
+    batcher.submit({"data": datas[0]})
+    future = batcher.submit({"data": datas[1]})
+    tvm.testing.assert_allclose(future.result()[0].numpy(), (datas[1] + 1.0) * 2.0, rtol=1e-5)
+
+    with pytest.raises(tvm.TVMError):
+        batcher.submit({"data": np.zeros((5, 3), "float32")})
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -1193,6 +1193,111 @@ def test_storage_size_and_offset_on_cpu():
     assert "VM Const[1]: NDArray[(),int64,(1,0)]=[0] on device index 0" in exe.constants
 
 
+def test_vm_plan_static_arena(target, dev):
+    x_np = np.random.uniform(size=(8, 16)).astype("float32")
+    x = relay.var("x", shape=(8, 16), dtype="float32")
+    y = relay.nn.relu(relay.add(x, x))
+    y = relay.multiply(relay.exp(y), relay.reshape(y, [8, 16]))
+    mod = tvm.IRModule.from_expr(relay.Function([x], relay.subtract(y, x)))
+    expected = np.maximum(x_np + x_np, 0)
+    expected = np.exp(expected) * expected - x_np
+
+    # Disable fusion so the function has intermediate storages to plan.
+    config = {"relay.vm.plan_static_arena": True}
+    with tvm.transform.PassContext(opt_level=0, config=config):
+        exe = relay.vm.compile(mod, target)
+    # The storage of the result escapes the function and is allocated dynamically.
+    assert "arena_offset" in exe.bytecode
+    assert exe.bytecode.count("alloc_storage") > exe.bytecode.count("arena_offset")
+
+    code, lib = exe.save()
+    exe = runtime.vm.Executable.load_exec(code, lib)
+    assert "arena_offset" in exe.bytecode
+    vm = runtime.vm.VirtualMachine(exe, dev)
+    # Run twice so the second run reuses the arenas of the first.
+    for _ in range(2):
+        tvm.testing.assert_allclose(vm.run(x_np).numpy(), expected, rtol=1e-5)
+
+
+def test_vm_concurrent_execution():
+    import threading
+
+    x = relay.var("x", shape=(8, 16), dtype="float32")
+    w = relay.const(np.random.uniform(size=(16, 16)).astype("float32"))
+    y = relay.nn.relu(relay.nn.dense(x, w))
+    mod = tvm.IRModule.from_expr(relay.Function([x], y))
+    with tvm.transform.PassContext(opt_level=3):
+        exe = relay.vm.compile(mod, "llvm")
+    dev = tvm.cpu()
+    vm = runtime.vm.VirtualMachine(exe, dev)
+    vm.enable_concurrent_execution()
+
+    num_threads, num_requests = 4, 20
+    inputs = [
+        [np.random.uniform(size=(8, 16)).astype("float32") for _ in range(num_requests)]
+        for _ in range(num_threads)
+    ]
+    results = [[None] * num_requests for _ in range(num_threads)]
+
+    def worker(tid):
+        for i, data in enumerate(inputs[tid]):
+            vm.invoke_stateful("main", data)
+            results[tid][i] = vm.get_outputs()[0].numpy()
+
+    threads = [threading.Thread(target=worker, args=(tid,)) for tid in range(num_threads)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+
+    w_np = w.data.numpy()
+    for tid in range(num_threads):
+        for i, data in enumerate(inputs[tid]):
+            expected = np.maximum(np.dot(data, w_np.T), 0)
+            tvm.testing.assert_allclose(results[tid][i], expected, rtol=1e-5)
+
+
+def test_vm_lazy_constants():
+    c = relay.var("c", shape=(), dtype="bool")
+    x = relay.var("x", shape=(4,), dtype="float32")
+    a = relay.const(np.random.uniform(size=(4,)).astype("float32"))
+    b = relay.const(np.random.uniform(size=(4,)).astype("float32"))
+    mod = tvm.IRModule.from_expr(relay.Function([c, x], relay.If(c, x + a, x * b)))
+    with tvm.transform.PassContext(opt_level=3):
+        exe = relay.vm.compile(mod, "llvm")
+    code, lib = exe.save()
+    x_np = np.random.uniform(size=(4,)).astype("float32")
+
+    exe = runtime.vm.Executable.load_exec(code, lib)
+    vm = runtime.vm.VirtualMachine(exe, tvm.cpu())
+    assert vm.invoke_stats()["decoded_constants"].value == 0
+    res = vm.invoke("main", np.array(True), x_np)
+    tvm.testing.assert_allclose(res.numpy(), x_np + a.data.numpy())
+    stats = vm.invoke_stats()
+    assert stats["num_invokes"].value == 1
+    assert stats["time_to_first_inference"].microseconds >= stats["first_invoke"].microseconds
+    first_decoded = stats["decoded_constants"].value
+    assert stats["first_invoke_decoded_constants"].value == first_decoded > 0
+    res = vm.invoke("main", np.array(False), x_np)
+    tvm.testing.assert_allclose(res.numpy(), x_np * b.data.numpy())
+    stats = vm.invoke_stats()
+    assert stats["num_invokes"].value == 2
+    assert "steady_state_invoke" in stats
+    # The constant of the other branch was only decoded by the second invocation.
+    assert stats["decoded_constants"].value > first_decoded
+
+    exe = runtime.vm.Executable.load_exec(code, lib)
+    exe.prefetch_constants()
+    vm = runtime.vm.VirtualMachine(exe, tvm.cpu())
+    res = vm.invoke("main", np.array(False), x_np)
+    tvm.testing.assert_allclose(res.numpy(), x_np * b.data.numpy())
+    # Saving decodes every constant, so the executable round trips.
+    code, _ = exe.save()
+    vm = runtime.vm.VirtualMachine(runtime.vm.Executable.load_exec(code, lib), tvm.cpu())
+    res = vm.invoke("main", np.array(True), x_np)
+    tvm.testing.assert_allclose(res.numpy(), x_np + a.data.numpy())
+
+
 @tvm.testing.requires_cuda
 def test_reshape_shape_on_cpu():
     """Tests the argument to a reshape places the shape on the CPU host even if the rest
@@ -27,9 +27,9 @@ import pytest
 
 import tvm
 from tvm.meta_schedule.cost_model import PyCostModel, RandomModel
-from tvm.meta_schedule.feature_extractor import RandomFeatureExtractor
+from tvm.meta_schedule.feature_extractor import PyFeatureExtractor, RandomFeatureExtractor
 from tvm.meta_schedule.runner import RunnerResult
-from tvm.meta_schedule.cost_model import XGBModel
+from tvm.meta_schedule.cost_model import GBDTModel, XGBModel
 from tvm.meta_schedule.search_strategy import MeasureCandidate
 from tvm.meta_schedule.tune_context import TuneContext
 from tvm.meta_schedule.utils import derived_object
@@ -219,5 +219,96 @@ def test_meta_schedule_xgb_model_reupdate():
     model.predict(TuneContext(), [_dummy_candidate() for i in range(predict_sample_count)])
 
 
+def test_meta_schedule_gbdt_model():
+    extractor = RandomFeatureExtractor()
+    model = GBDTModel(extractor=extractor, num_warmup_samples=2)
+    update_sample_count = 10
+    predict_sample_count = 100
+    model.update(
+        TuneContext(),
+        [_dummy_candidate() for i in range(update_sample_count)],
+        [_dummy_result() for i in range(update_sample_count)],
+    )
+    res = model.predict(TuneContext(), [_dummy_candidate() for i in range(predict_sample_count)])
+    assert res.shape == (predict_sample_count,)
+    assert np.isfinite(res).all()
+
+
+def test_meta_schedule_gbdt_model_reload():
+    extractor = RandomFeatureExtractor()
+    model = GBDTModel(extractor=extractor, num_warmup_samples=10)
+    update_sample_count = 20
+    predict_sample_count = 30
+    model.update(
+        TuneContext(),
+        [_dummy_candidate() for i in range(update_sample_count)],
+        [_dummy_result() for i in range(update_sample_count)],
+    )
+    random_state = model.extractor.random_state  # save feature extractor's random state
+    path = os.path.join(tempfile.mkdtemp(), "test_output_meta_schedule_gbdt_model.bin")
+    model.save(path)
+    res1 = model.predict(TuneContext(), [_dummy_candidate() for i in range(predict_sample_count)])
+    model.extractor.random_state = random_state  # load feature extractor's random state
+    new_model = GBDTModel(extractor=model.extractor, num_warmup_samples=10)
+    new_model.load(path)
+    res2 = new_model.predict(
+        TuneContext(), [_dummy_candidate() for i in range(predict_sample_count)]
+    )
+    shutil.rmtree(os.path.dirname(path))
+    assert (res1 == res2).all()
+
+
+def test_meta_schedule_gbdt_model_reupdate():
+    extractor = RandomFeatureExtractor()
+    model = GBDTModel(extractor=extractor, num_warmup_samples=2)
+    update_sample_count = 60
+    predict_sample_count = 100
+    for _ in range(3):
+        model.update(
+            TuneContext(),
+            [_dummy_candidate() for i in range(update_sample_count)],
+            [_dummy_result() for i in range(update_sample_count)],
+        )
+    model.predict(TuneContext(), [_dummy_candidate() for i in range(predict_sample_count)])
+
+
+def test_meta_schedule_gbdt_model_ranking():
+    @derived_object
+    class QueuedFeatureExtractor(PyFeatureExtractor):
+        def __init__(self):
+            super().__init__()
+            self.queue = []
+
+        def extract_from(
+            self, context: TuneContext, candidates: List[MeasureCandidate]
+        ) -> List[np.ndarray]:
+            result = [tvm.nd.array(x) for x in self.queue[: len(candidates)]]
+            self.queue = self.queue[len(candidates) :]
+            return result
+
+    def _features(count):
+        return [np.random.rand(np.random.randint(1, 4), 8).astype("float32") for _ in range(count)]
+
+    def _cost(x):
+        # the throughput adds up over the stores, which is what the model fits
+        return 1.0 / float(np.sum(0.2 + x[:, 0] + 0.5 * (x[:, 1] > 0.5)))
+
+    np.random.seed(0)
+    extractor = QueuedFeatureExtractor()
+    model = GBDTModel(extractor=extractor, num_warmup_samples=0)
+    train = _features(300)
+    extractor.queue = list(train)
+    model.update(
+        TuneContext(),
+        [_dummy_candidate() for _ in train],
+        [RunnerResult([_cost(x)], None) for x in train],
+    )
+    test = _features(100)
+    extractor.queue = list(test)
+    scores = model.predict(TuneContext(), [_dummy_candidate() for _ in test])
+    throughputs = np.array([1.0 / _cost(x) for x in test])
+    assert np.corrcoef(scores, throughputs)[0, 1] > 0.9
+
+
 if __name__ == "__main__":
     sys.exit(pytest.main([__file__] + sys.argv[1:]))
@@ -16,7 +16,10 @@
 # under the License.
 # pylint: disable=missing-module-docstring,missing-function-docstring,missing-class-docstring
 """Test Meta Schedule Database"""
+import glob
+import multiprocessing
 import os.path as osp
+import struct
 import sys
 import tempfile
 from typing import Callable
@@ -26,7 +29,7 @@ import tvm
 from tvm import tir
 from tvm.ir.module import IRModule
 from tvm.meta_schedule.arg_info import ArgInfo
-from tvm.meta_schedule.database import JSONDatabase, TuningRecord
+from tvm.meta_schedule.database import IndexedDatabase, JSONDatabase, TuningRecord
 from tvm.script import tir as T
 from tvm.tir import Schedule
 
@@ -295,5 +298,181 @@ def test_meta_schedule_database_reload():
             _equal_record(ret[1], records[2])
 
 
+def _make_record(mod: IRModule, token, run_secs) -> TuningRecord:
+    return TuningRecord(
+        _create_schedule(mod, _schedule_matmul).trace,
+        run_secs,
+        token,
+        tvm.target.Target("llvm"),
+        ArgInfo.from_prim_func(func=mod["main"]),  # pylint: disable=unsubscriptable-object
+    )
+
+
+def test_meta_schedule_indexed_database_reload():
+    mod: IRModule = Matmul
+    with tempfile.TemporaryDirectory() as tmpdir:
+        path = osp.join(tmpdir, "database")
+        database = IndexedDatabase(path)
+        token = database.commit_workload(mod)
+        assert database.has_workload(mod)
+        assert not database.has_workload(MatmulRelu)
+        records = [_make_record(mod, token, run_secs) for run_secs in [[7.0], [1.0], [4.0]]]
+        for record in records:
+            database.commit_tuning_record(record)
+        ret = database.get_top_k(token, 2)
+        _equal_record(ret[0], records[1])
+        _equal_record(ret[1], records[2])
+        new_database = IndexedDatabase(path, allow_missing=False)
+        assert len(new_database) == 3
+        assert new_database.has_workload(mod)
+        token = new_database.commit_workload(mod)
+        ret = new_database.get_top_k(token, 5)
+        assert len(ret) == 3
+        for actual, expected in zip(ret, [records[1], records[2], records[0]]):
+            _equal_record(actual, expected)
+
+
+def test_meta_schedule_indexed_database_compact():
+    mod: IRModule = Matmul
+    mod_2: IRModule = MatmulRelu
+    with tempfile.TemporaryDirectory() as tmpdir:
+        path = osp.join(tmpdir, "database")
+        # every entry goes to a segment of its own
+        database = IndexedDatabase(path, max_segment_bytes=1)
+        token = database.commit_workload(mod)
+        database.commit_workload(mod_2)
+        records = [_make_record(mod, token, [float(i)]) for i in [5, 3, 9, 1]]
+        for record in records:
+            database.commit_tuning_record(record)
+        assert len(glob.glob(path + ".[0-9]*")) == 6
+        database.compact(records_per_workload=2)
+        assert glob.glob(path + ".[0-9]*") == [path + ".6"]
+        assert len(database) == 2
+        for new_database in [database, IndexedDatabase(path)]:
+            assert new_database.has_workload(mod_2)
+            ret = new_database.get_top_k(new_database.commit_workload(mod), 5)
+            assert len(ret) == 2
+            _equal_record(ret[0], records[3])
+            _equal_record(ret[1], records[1])
+
+
+def test_meta_schedule_indexed_database_damaged_tail():
+    mod: IRModule = Matmul
+    with tempfile.TemporaryDirectory() as tmpdir:
+        path = osp.join(tmpdir, "database")
+        database = IndexedDatabase(path)
+        token = database.commit_workload(mod)
+        database.commit_tuning_record(_make_record(mod, token, [2.0]))
+        # an entry cut short by a crash
+        with open(path + ".0", "ab") as file:
+            file.write(b"\x02\x00\x00\x00\xff")
+        database = IndexedDatabase(path)
+        assert len(database) == 1
+        token = database.commit_workload(mod)
+        database.commit_tuning_record(_make_record(mod, token, [1.0]))
+        assert osp.exists(path + ".1")
+        database = IndexedDatabase(path)
+        assert len(database) == 2
+        (ret,) = database.get_top_k(database.commit_workload(mod), 1)
+        assert str(ret.run_secs) == str(_make_record(mod, token, [1.0]).run_secs)
+
+
+def test_meta_schedule_indexed_database_damaged_entry():
+    mod: IRModule = Matmul
+    with tempfile.TemporaryDirectory() as tmpdir:
+        path = osp.join(tmpdir, "database")
+        database = IndexedDatabase(path)
+        token = database.commit_workload(mod)
+        for run_secs in [1.0, 2.0, 3.0]:
+            database.commit_tuning_record(_make_record(mod, token, [run_secs]))
+        # damage the payload of the record of 2.0, in the middle of the segment
+        with open(path + ".0", "rb") as file:
+            data = bytearray(file.read())
+        offsets = []
+        offset = 32  # the segment header
+        while offset < len(data):
+            _, payload_size = struct.unpack_from("<II", data, offset)
+            offsets.append((offset, payload_size))
+            offset += 32 + payload_size
+        offset, payload_size = offsets[2]
+        data[offset + 32 + payload_size // 2] ^= 1
+        with open(path + ".0", "wb") as file:
+            file.write(data)
+        # the damage is only noticed when the record is parsed
+        database = IndexedDatabase(path)
+        assert len(database) == 3
+        token = database.commit_workload(mod)
+        (ret,) = database.get_top_k(token, 1)
+        assert ret.run_secs[0].value == 1.0
+        with pytest.raises(tvm.TVMError, match="checksum"):
+            database.get_top_k(token, 3)
+
+
+def _count_workload_entries(segment_path: str) -> int:
+    with open(segment_path, "rb") as file:
+        data = file.read()
+    count = 0
+    offset = 32  # the segment header
+    while offset < len(data):
+        kind, payload_size = struct.unpack_from("<II", data, offset)
+        count += kind == 1
+        offset += 32 + payload_size
+    return count
+
+
+def _commit_records_in_process(path: str, run_secs_list):
+    database = IndexedDatabase(path)
+    for mod in [Matmul, MatmulRelu]:
+        token = database.commit_workload(mod)
+        for run_secs in run_secs_list:
+            database.commit_tuning_record(_make_record(mod, token, [run_secs]))
+
+
+def test_meta_schedule_indexed_database_multi_process():
+    with tempfile.TemporaryDirectory() as tmpdir:
+        path = osp.join(tmpdir, "database")
+        context = multiprocessing.get_context("spawn")
+        processes = [
+            context.Process(
+                target=_commit_records_in_process,
+                args=(path, [float(i * 5 + j) for j in range(5)]),
+            )
+            for i in range(4)
+        ]
+        for process in processes:
+            process.start()
+        for process in processes:
+            process.join()
+            assert process.exitcode == 0
+        # each workload is written once, by whichever process committed it first
+        assert _count_workload_entries(path + ".0") == 2
+        database = IndexedDatabase(path, allow_missing=False)
+        assert len(database) == 40
+        for mod in [Matmul, MatmulRelu]:
+            ret = database.get_top_k(database.commit_workload(mod), 100)
+            assert [record.run_secs[0].value for record in ret] == [float(i) for i in range(20)]
+
+
+def test_meta_schedule_indexed_database_tail():
+    mod: IRModule = Matmul
+    with tempfile.TemporaryDirectory() as tmpdir:
+        path = osp.join(tmpdir, "database")
+        database = IndexedDatabase(path)
+        other = IndexedDatabase(path)
+        token = database.commit_workload(mod)
+        assert other.has_workload(mod)
+        database.commit_tuning_record(_make_record(mod, token, [3.0]))
+        assert len(other) == 1
+        other.commit_tuning_record(_make_record(mod, other.commit_workload(mod), [1.0]))
+        assert _count_workload_entries(path + ".0") == 1
+        ret = database.get_top_k(token, 2)
+        assert [record.run_secs[0].value for record in ret] == [1.0, 3.0]
+        # the records dropped by compaction in one process are gone in the other
+        other.compact(records_per_workload=1)
+        assert len(database) == 1
+        (ret,) = database.get_top_k(database.commit_workload(mod), 2)
+        assert ret.run_secs[0].value == 1.0
+
+
 if __name__ == "__main__":
     sys.exit(pytest.main([__file__] + sys.argv[1:]))
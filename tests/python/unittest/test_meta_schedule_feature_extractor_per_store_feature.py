@@ -1587,5 +1587,35 @@ def test_cpu_layout_transform():
     )
 
 
+def test_feature_cache():
+    def _create_schedule():
+        sch = tir.Schedule(matmul, debug_mask="all")
+        i, j, k = sch.get_loops(sch.get_block("C"))
+        i_o, i_i = sch.split(i, factors=[None, 16])
+        j_o, j_i = sch.split(j, factors=[None, 8])
+        sch.reorder(i_o, j_o, k, j_i, i_i)
+        sch.vectorize(j_i)
+        return sch
+
+    context = _make_context(tvm.target.Target("llvm"))
+    extractor = ms.feature_extractor.PerStoreFeature()
+    uncached = ms.feature_extractor.PerStoreFeature(feature_cache_size=0)
+    assert uncached.cache_stats() == {}
+    (expected,) = uncached.extract_from(context, [_make_candidate(_create_schedule)])
+    # the same module scheduled twice, and another module
+    candidates = [
+        _make_candidate(_create_schedule),
+        _make_candidate(_create_schedule),
+        _make_candidate(lambda: tir.Schedule(matmul)),
+    ]
+    features = extractor.extract_from(context, candidates)
+    assert extractor.cache_stats() == {"hits": 1, "misses": 2, "size": 2}
+    features_again = extractor.extract_from(context, candidates)
+    assert extractor.cache_stats() == {"hits": 4, "misses": 2, "size": 2}
+    for feature in [features[0], features[1], features_again[0], features_again[1]]:
+        assert_allclose(feature.numpy(), expected.numpy())
+    assert_allclose(features_again[2].numpy(), features[2].numpy())
+
+
 if __name__ == "__main__":
     sys.exit(pytest.main([__file__] + sys.argv[1:]))
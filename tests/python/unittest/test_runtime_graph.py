@@ -19,6 +19,7 @@ import tvm.testing
 from tvm import te, runtime
 import numpy as np
 import json
+import threading
 from tvm import rpc
 from tvm import relay
 from tvm.contrib import utils, graph_executor
@@ -138,6 +139,117 @@ def test_load_unexpected_params():
     rt_mod.load_params(runtime.save_param_dict(new_params))
 
 
+def test_inter_op_parallelism():
+    # Several branches with storage reuse, so both the data and the storage
+    # dependencies are exercised.
+    x = relay.var("x", shape=(4, 16))
+    branches = []
+    for i in range(4):
+        y = relay.nn.relu(x + relay.const(float(i)))
+        y = relay.exp(relay.negative(y))
+        branches.append(relay.sum(y * relay.const(float(i + 1)), axis=1))
+    z = relay.concatenate(branches, axis=0)
+    mod = tvm.IRModule.from_expr(relay.Function([x], relay.sigmoid(z)))
+    with tvm.transform.PassContext(opt_level=0):
+        lib = relay.build(mod, target="llvm")
+    x_np = np.random.uniform(-1, 1, size=(4, 16)).astype("float32")
+
+    ref = graph_executor.GraphModule(lib["default"](tvm.cpu(0)))
+    ref.run(x=x_np)
+    expected = ref.get_output(0).numpy()
+
+    for num_threads in [0, 2, 1]:
+        m = graph_executor.GraphModule(lib["default"](tvm.cpu(0)))
+        m.set_inter_op_parallelism(num_threads)
+        for _ in range(5):
+            m.run(x=x_np)
+            tvm.testing.assert_allclose(m.get_output(0).numpy(), expected, rtol=1e-5)
+
+
+def test_graph_executor_pool():
+    import threading
+
+    x = relay.var("x", shape=(8, 16), dtype="float32")
+    w = relay.var("w", shape=(16, 16), dtype="float32")
+    mod = tvm.IRModule.from_expr(relay.Function([x, w], relay.nn.relu(relay.nn.dense(x, w))))
+    w_np = np.random.uniform(size=(16, 16)).astype("float32")
+    lib = relay.build(mod, target="llvm", params={"w": w_np})
+
+    pool = graph_executor.create_pool(lib, 3, tvm.cpu(0))
+    assert len(pool.instances) == 3
+
+    num_threads, num_requests = 6, 10
+    errors = []
+
+    def worker():
+        for _ in range(num_requests):
+            data = np.random.uniform(size=(8, 16)).astype("float32")
+            with pool.checkout() as m:
+                m.run(x=data)
+                out = m.get_output(0).numpy()
+            try:
+                tvm.testing.assert_allclose(out, np.maximum(np.dot(data, w_np.T), 0), rtol=1e-5)
+            except AssertionError as err:
+                errors.append(err)
+
+    threads = [threading.Thread(target=worker) for _ in range(num_threads)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    assert not errors
+
+    # The activations belong to each instance.
+    m0, m1 = pool.instances[0], pool.instances[1]
+    a = np.random.uniform(size=(8, 16)).astype("float32")
+    b = np.random.uniform(size=(8, 16)).astype("float32")
+    m0.run(x=a)
+    m1.run(x=b)
+    expected = np.maximum(np.dot(a, w_np.T), 0)
+    tvm.testing.assert_allclose(m0.get_output(0).numpy(), expected, rtol=1e-5)
+    # The parameters are shared.
+    m0.set_input(1, np.zeros((16, 16), dtype="float32"))
+    m1.run(x=b)
+    tvm.testing.assert_allclose(m1.get_output(0).numpy(), np.zeros((8, 16), dtype="float32"))
+
+
+def test_inter_op_parallelism_parallel_kernels():
+    # Branches whose kernels parallelize their loops, so that the kernel launches nest in the
+    # launches of the operators.
+    x = relay.var("x", shape=(64, 256))
+    branches = [relay.exp(relay.nn.relu(x + relay.const(float(i)))) for i in range(4)]
+    mod = tvm.IRModule.from_expr(relay.Function([x], relay.concatenate(branches, axis=0)))
+    with tvm.transform.PassContext(opt_level=3):
+        lib = relay.build(mod, target="llvm")
+    x_np = np.random.uniform(-1, 1, size=(64, 256)).astype("float32")
+    expected = np.concatenate([np.exp(np.maximum(x_np + i, 0)) for i in range(4)], axis=0)
+    errors = []
+
+    def run():
+        try:
+            # A new thread gets its own thread pool, configured with four workers so that the
+            # operators run on several threads even on a single core host.
+            config_threadpool = tvm.get_global_func("runtime.config_threadpool")
+            config_threadpool(-3, 0, ["0", "1", "2", "3"])
+            for num_threads in [0, 2]:
+                m = graph_executor.GraphModule(lib["default"](tvm.cpu(0)))
+                m.set_inter_op_parallelism(num_threads)
+                for _ in range(5):
+                    m.run(x=x_np)
+                    tvm.testing.assert_allclose(m.get_output(0).numpy(), expected, rtol=1e-5)
+        except Exception as err:  # pylint: disable=broad-except
+            errors.append(err)
+
+    thread = threading.Thread(target=run, daemon=True)
+    thread.start()
+    thread.join(timeout=120)
+    assert not thread.is_alive(), "the inter-op parallel run did not finish"
+    assert not errors, errors[0]
+
+
 if __name__ == "__main__":
     test_graph_simple()
     test_load_unexpected_params()
+    test_inter_op_parallelism()
+    test_inter_op_parallelism_parallel_kernels()
+    test_graph_executor_pool()
@@ -19,6 +19,7 @@ from tvm import te
 import tvm.testing
 import multiprocessing
 import os
+import socket
 import stat
 import sys
 import time
@@ -109,6 +110,44 @@ def test_rpc_simple():
     check_remote()
 
 
+@tvm.testing.requires_rpc
+def test_rpc_multiplexed_server():
+    server = rpc.Server(key="x1", num_workers=2, session_timeout=2, max_sessions_per_worker=2)
+
+    # concurrent sessions are served by different workers
+    first = rpc.connect("127.0.0.1", server.port, key="x1")
+    second = rpc.connect("127.0.0.1", server.port, key="x1")
+    pids = {
+        first.get_function("rpc.test.getpid")(),
+        second.get_function("rpc.test.getpid")(),
+    }
+    assert len(pids) == 2
+    assert first.get_function("rpc.test.addone")(10) == 11
+    del first, second
+
+    # a session which exceeds its timeout is killed, the others keep working
+    slow = rpc.connect("127.0.0.1", server.port, key="x1")
+    with pytest.raises(tvm.error.TVMError):
+        slow.get_function("rpc.test.sleep")(10)
+    client = rpc.connect("127.0.0.1", server.port, key="x1")
+    assert client.get_function("rpc.test.strcat")("abc", 11) == "abc:11"
+    server.terminate()
+
+
+@tvm.testing.requires_rpc
+def test_rpc_multiplexed_server_idle_connection():
+    server = rpc.Server(key="x1", num_workers=1)
+
+    # a connection which never sends its handshake does not hold up the other clients
+    idle = socket.create_connection(("127.0.0.1", server.port))
+    start = time.time()
+    client = rpc.connect("127.0.0.1", server.port, key="x1")
+    assert client.get_function("rpc.test.addone")(10) == 11
+    assert time.time() - start < 2
+    idle.close()
+    server.terminate()
+
+
 @tvm.testing.requires_rpc
 def test_rpc_runtime_string():
     server = rpc.Server(key="x1")
@@ -157,6 +196,100 @@ def test_rpc_large_array():
     check_remote()
 
 
+@tvm.testing.requires_rpc
+def test_rpc_compressed_array():
+    server = rpc.Server()
+    remote = rpc.connect("127.0.0.1", server.port)
+    # 1000 bytes do not divide the 4292 bytes of the tensors, so the last chunk is partial.
+    remote.set_transfer_options(chunk_bytes=1000, compress=True)
+
+    def check_remote():
+        dev = remote.cpu(0)
+        # Zeros are sent compressed, random data falls back to raw chunks.
+        for x in [
+            np.zeros((37, 29), dtype="float32"),
+            np.random.uniform(size=(37, 29)).astype("float32"),
+        ]:
+            a = tvm.nd.array(x, dev)
+            np.testing.assert_equal(a.numpy(), x)
+
+    check_remote()
+
+
+@tvm.testing.requires_rpc
+def test_rpc_submit():
+    server = rpc.Server(key="x1")
+    client = rpc.connect("127.0.0.1", server.port, key="x1")
+
+    def check_remote():
+        addone = client.get_function("rpc.test.addone")
+        futures = [client.submit(addone, i) for i in range(300)]
+        failed = client.submit(client.get_function("rpc.test.except"), "abc")
+        strcat = client.submit(client.get_function("rpc.test.strcat"), "abc", 11)
+
+        x = np.random.uniform(size=(64, 3)).astype("float32")
+        r_cpu = tvm.nd.empty(x.shape, x.dtype, client.cpu(0))
+        y = tvm.nd.empty(x.shape, x.dtype)
+        upload = client.submit_copy(tvm.nd.array(x), r_cpu)
+        download = client.submit_copy(r_cpu, y)
+
+        assert strcat.result() == "abc:11"
+        assert all(f.done() for f in futures)
+        assert [f.result() for f in futures] == list(range(1, 301))
+        with pytest.raises(tvm._ffi.base.TVMError):
+            failed.result()
+        assert upload.result() is None
+        download.result()
+        np.testing.assert_equal(y.numpy(), x)
+        # synchronous calls wait for the pending submissions
+        last = client.submit(addone, 41)
+        assert addone(1) == 2
+        assert last.done() and last.result() == 42
+        client.wait_all()
+
+        # a local function is rejected before it runs
+        calls = []
+        with pytest.raises(tvm.TVMError):
+            client.submit(lambda x: calls.append(x), 1)
+        assert not calls
+
+    check_remote()
+
+
+@tvm.testing.requires_rpc
+@tvm.testing.requires_llvm
+def test_rpc_submit_time_evaluator():
+    n = 102
+    A = te.placeholder((n,), name="A")
+    B = te.compute(A.shape, lambda *i: A(*i) + 1.0, name="B")
+    s = te.create_schedule(B.op)
+    server = rpc.Server(key="x1")
+    client = rpc.connect("127.0.0.1", server.port, key="x1")
+
+    def check_remote():
+        temp = utils.tempdir()
+        dev = client.cpu(0)
+        f = tvm.build(s, [A, B], "llvm", name="myadd")
+        path_dso = temp.relpath("dev_lib.so")
+        f.export_library(path_dso)
+        client.upload(path_dso)
+        f1 = client.load_module("dev_lib.so")
+        a = tvm.nd.array(np.random.uniform(size=n).astype(A.dtype), dev)
+        b = tvm.nd.array(np.zeros(n, dtype=A.dtype), dev)
+        futures = [
+            client.submit_time_evaluator(f1, f1.entry_name, dev, a, b, number=2, repeat=3)
+            for _ in range(4)
+        ]
+        for future in futures:
+            result = future.result()
+            assert future.done()
+            assert len(result.results) == 3
+            assert all(cost > 0 for cost in result.results)
+        np.testing.assert_equal(b.numpy(), a.numpy() + 1)
+
+    check_remote()
+
+
 @tvm.testing.requires_rpc
 def test_rpc_echo():
     def check(remote):
@@ -189,6 +322,11 @@ def test_rpc_echo():
         minrpc_exec = temp.relpath("minrpc")
         tvm.rpc.with_minrpc(cc.create_executable)(minrpc_exec, [])
         check(rpc.PopenSession(minrpc_exec))
+        # minrpc over shared memory, with tensors larger than the rings
+        shm_client = rpc.PopenSession(minrpc_exec, shared_memory_bytes=1 << 16)
+        check(shm_client)
+        x = np.random.uniform(size=(512, 1024)).astype("float32")
+        np.testing.assert_equal(tvm.nd.array(x, shm_client.cpu()).numpy(), x)
         # minrpc on the remote
         server = rpc.Server()
         client = rpc.connect(